@@ -236,45 +236,79 @@ TArray<uint8> UCUBlueprintLibrary::Conv_SoundWaveToWavBytes(USoundWave* SoundWav
 
 void UCUBlueprintLibrary::Conv_CompactBytesToTransforms(const TArray<uint8>& InCompactBytes, TArray<FTransform>& OutTransforms)
 {	
-	TArray<float> FloatView;
-	FloatView.SetNumUninitialized(InCompactBytes.Num() / 4);
-	FPlatformMemory::Memcpy(FloatView.GetData(), InCompactBytes.GetData(), InCompactBytes.Num());
-
-	//is our float array exactly divisible by 9?
-	if (FloatView.Num() % 9 != 0)
+	//is our byte array exactly 9 floats per transform?
+	if (InCompactBytes.Num() % (9 * sizeof(float)) != 0)
 	{
 		UE_LOG(LogTemp, Log, TEXT("Conv_CompactBytesToTransforms::float array is not divisible by 9"));
 		return;
 	}
 
-	int32 TransformNum = FloatView.Num() / 9;
+	const int32 TransformNum = InCompactBytes.Num() / (9 * sizeof(float));
 	OutTransforms.SetNumUninitialized(TransformNum);
 
-	for (int i = 0; i < FloatView.Num() - 8; i += 9)
+	//read each transform's floats straight from the bytes, they may be unaligned
+	const uint8* Bytes = InCompactBytes.GetData();
+	FTransform* Out = OutTransforms.GetData();
+	for (int32 i = 0; i < TransformNum; i++)
 	{
-		OutTransforms[i/9] = FTransform(FRotator(FloatView[i], FloatView[i+1], FloatView[i+2]), FVector(FloatView[i+3], FloatView[i + 4], FloatView[i + 5]), FVector(FloatView[i+6], FloatView[i+7], FloatView[i+8]));
+		float F[9];
+		FPlatformMemory::Memcpy(F, Bytes + i * sizeof(F), sizeof(F));
+		Out[i] = FTransform(FRotator(F[0], F[1], F[2]), FVector(F[3], F[4], F[5]), FVector(F[6], F[7], F[8]));
 	}
 }
 
-void UCUBlueprintLibrary::Conv_CompactPositionBytesToTransforms(const TArray<uint8>& InCompactBytes, TArray<FTransform>& OutTransforms)
+TArray<uint8> UCUBlueprintLibrary::Conv_TransformsToCompactBytes(const TArray<FTransform>& InTransforms)
+{
+	TArray<uint8> CompactBytes;
+	CompactBytes.SetNumUninitialized(InTransforms.Num() * 9 * sizeof(float));
+
+	uint8* Bytes = CompactBytes.GetData();
+	for (int32 i = 0; i < InTransforms.Num(); i++)
+	{
+		const FTransform& Transform = InTransforms[i];
+		const FRotator Rotator = Transform.Rotator();
+		const FVector Location = Transform.GetLocation();
+		const FVector Scale = Transform.GetScale3D();
+		const float F[9] = {
+			(float)Rotator.Pitch, (float)Rotator.Yaw, (float)Rotator.Roll,
+			(float)Location.X, (float)Location.Y, (float)Location.Z,
+			(float)Scale.X, (float)Scale.Y, (float)Scale.Z };
+		FPlatformMemory::Memcpy(Bytes + i * sizeof(F), F, sizeof(F));
+	}
+	return CompactBytes;
+}
+
+TArray<uint8> UCUBlueprintLibrary::EncodeQuantizedTransforms(const TArray<FTransform>& Transforms, const FCUTransformCodecSettings& Settings, const TArray<FTransform>& Previous)
 {
-	TArray<float> FloatView;
-	FloatView.SetNumUninitialized(InCompactBytes.Num() / 4);
-	FPlatformMemory::Memcpy(FloatView.GetData(), InCompactBytes.GetData(), InCompactBytes.Num());
+	TArray<uint8> Bytes;
+	FCUTransformCodec::Encode(Transforms, Settings, Bytes, Previous);
+	return Bytes;
+}
 
-	//is our float array exactly divisible by 3?
-	if (FloatView.Num() % 3 != 0)
+bool UCUBlueprintLibrary::DecodeQuantizedTransforms(const TArray<uint8>& InBytes, TArray<FTransform>& Transforms)
+{
+	return FCUTransformCodec::Decode(InBytes, Transforms);
+}
+
+void UCUBlueprintLibrary::Conv_CompactPositionBytesToTransforms(const TArray<uint8>& InCompactBytes, TArray<FTransform>& OutTransforms)
+{
+	//is our byte array exactly 3 floats per transform?
+	if (InCompactBytes.Num() % (3 * sizeof(float)) != 0)
 	{
 		UE_LOG(LogTemp, Log, TEXT("Conv_CompactPositionBytesToTransforms::float array is not divisible by 3"));
 		return;
 	}
 
-	int32 TransformNum = FloatView.Num() / 3;
+	const int32 TransformNum = InCompactBytes.Num() / (3 * sizeof(float));
 	OutTransforms.SetNumUninitialized(TransformNum);
 
-	for (int i = 0; i < FloatView.Num() - 2; i += 3)
+	const uint8* Bytes = InCompactBytes.GetData();
+	FTransform* Out = OutTransforms.GetData();
+	for (int32 i = 0; i < TransformNum; i++)
 	{
-		OutTransforms[i / 3] = FTransform(FVector(FloatView[i], FloatView[i + 1], FloatView[i + 2]));
+		float F[3];
+		FPlatformMemory::Memcpy(F, Bytes + i * sizeof(F), sizeof(F));
+		Out[i] = FTransform(FVector(F[0], F[1], F[2]));
 	}
 }
 
@@ -1,5 +1,6 @@
 #include "CUFileSubsystem.h"
 #include "HAL/PlatformFileManager.h"
+#include "Async/MappedFileHandle.h"
 #include "Misc/FileHelper.h"
 #include "Misc/Paths.h"
 
@@ -139,3 +140,51 @@ bool UCUFileSubsystem::DeleteFileAtPath(const FString& Path)
 	return false;
 }
 
+bool UCUFileSubsystem::AppendBytesToPath(const TArray<uint8>& Bytes, const FString& Path)
+{
+	IPlatformFile& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+
+	FString Directory, FileName;
+	SplitFullPath(Path, Directory, FileName);
+	if (!Directory.IsEmpty() && !PlatformFile.CreateDirectoryTree(*Directory))
+	{
+		return false;
+	}
+
+	TUniquePtr<IFileHandle> FileHandle(PlatformFile.OpenWrite(*Path, true));
+	if (!FileHandle)
+	{
+		return false;
+	}
+	return FileHandle->Write(Bytes.GetData(), Bytes.Num());
+}
+
+bool UCUFileSubsystem::ReadMappedPath(const FString& Path, TFunctionRef<void(const uint8* Data, int64 Size)> Reader)
+{
+	IPlatformFile& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+
+	TUniquePtr<IMappedFileHandle> MappedHandle(PlatformFile.OpenMapped(*Path));
+	if (MappedHandle)
+	{
+		if (MappedHandle->GetFileSize() == 0)
+		{
+			Reader(nullptr, 0);
+			return true;
+		}
+
+		TUniquePtr<IMappedFileRegion> Region(MappedHandle->MapRegion(0, MappedHandle->GetFileSize()));
+		if (Region)
+		{
+			Reader(Region->GetMappedPtr(), Region->GetMappedSize());
+			return true;
+		}
+	}
+
+	TArray<uint8> Bytes;
+	if (!FFileHelper::LoadFileToArray(Bytes, *Path, FILEREAD_Silent))
+	{
+		return false;
+	}
+	Reader(Bytes.GetData(), Bytes.Num());
+	return true;
+}
@@ -4,10 +4,190 @@
 #include "CULambdaRunnable.h"
 #include "Async/Async.h"
 #include "Engine/Engine.h"
+#include "Misc/QueuedThreadPool.h"
+#include "HAL/Runnable.h"
+#include "HAL/RunnableThread.h"
+
+namespace
+{
+	//Enough to tear down a level's worth of connections in parallel without flooding the OS with threads
+	const int32 BlockingThreadCount = 8;
+
+	class FCUBlockingWork : public IQueuedWork
+	{
+	public:
+		FCUBlockingWork(TFunction<void()>&& InFunction)
+			: Function(MoveTemp(InFunction))
+		{
+		}
+
+		virtual void DoThreadedWork() override
+		{
+			Function();
+			delete this;
+		}
+
+		//Pool is going away. This is usually teardown work that still has to happen, so run it here.
+		virtual void Abandon() override
+		{
+			Function();
+			delete this;
+		}
+
+	private:
+		TFunction<void()> Function;
+	};
+
+	class FCUTimerThread : public FRunnable
+	{
+	public:
+		FCUTimerThread()
+		{
+			WakeEvent = FPlatformProcess::GetSynchEventFromPool(false);
+			Thread = FRunnableThread::Create(this, TEXT("CUTimerThread"), 0, TPri_Normal);
+		}
+
+		virtual ~FCUTimerThread()
+		{
+			Thread->Kill(true);
+			delete Thread;
+			FPlatformProcess::ReturnSynchEventToPool(WakeEvent);
+		}
+
+		uint64 Add(TFunction<void()>&& Function, double Deadline, bool bOnGameThread)
+		{
+			FScopeLock Lock(&Section);
+			FEntry Entry;
+			Entry.Deadline = Deadline;
+			Entry.Id = NextId++;
+			Entry.Function = MoveTemp(Function);
+			Entry.bOnGameThread = bOnGameThread;
+			const uint64 Id = Entry.Id;
+			Heap.HeapPush(MoveTemp(Entry), FEarlier());
+
+			//only a new earliest deadline shortens the current wait
+			if (Heap.HeapTop().Id == Id)
+			{
+				WakeEvent->Trigger();
+			}
+			return Id;
+		}
+
+		bool Cancel(uint64 Id)
+		{
+			FScopeLock Lock(&Section);
+			const int32 Index = Heap.IndexOfByPredicate([Id](const FEntry& Entry)
+			{
+				return Entry.Id == Id;
+			});
+			if (Index == INDEX_NONE)
+			{
+				return false;
+			}
+			Heap.HeapRemoveAt(Index, FEarlier());
+			return true;
+		}
+
+		virtual uint32 Run() override
+		{
+			while (!bStopping)
+			{
+				TArray<FEntry> Due;
+				uint32 WaitMs = MAX_uint32;
+				{
+					FScopeLock Lock(&Section);
+					const double Now = FPlatformTime::Seconds();
+					while (Heap.Num() > 0 && Heap.HeapTop().Deadline <= Now)
+					{
+						FEntry Entry;
+						Heap.HeapPop(Entry, FEarlier());
+						Due.Add(MoveTemp(Entry));
+					}
+					if (Heap.Num() > 0)
+					{
+						WaitMs = (uint32)FMath::Max(1.0, FMath::CeilToDouble((Heap.HeapTop().Deadline - Now) * 1000.0));
+					}
+				}
+
+				//dispatch outside the lock, callbacks may set or clear timeouts
+				for (FEntry& Entry : Due)
+				{
+					if (Entry.bOnGameThread)
+					{
+						FCULambdaRunnable::RunShortLambdaOnGameThread(MoveTemp(Entry.Function));
+					}
+					else
+					{
+						//task graph rather than the blocking pool, a pool busy with disconnects must not hold up deadlines
+						FCULambdaRunnable::RunShortLambdaOnBackGroundTask(MoveTemp(Entry.Function));
+					}
+				}
+
+				if (Due.Num() == 0)
+				{
+					WakeEvent->Wait(WaitMs);
+				}
+			}
+			return 0;
+		}
+
+		virtual void Stop() override
+		{
+			bStopping = true;
+			WakeEvent->Trigger();
+		}
+
+	private:
+		struct FEntry
+		{
+			double Deadline = 0.0;
+			uint64 Id = 0;
+			TFunction<void()> Function;
+			bool bOnGameThread = true;
+		};
+
+		//Min-heap on deadline, equal deadlines fire in the order they were set
+		struct FEarlier
+		{
+			bool operator()(const FEntry& A, const FEntry& B) const
+			{
+				return A.Deadline < B.Deadline || (A.Deadline == B.Deadline && A.Id < B.Id);
+			}
+		};
+
+		FCriticalSection Section;
+		TArray<FEntry> Heap;
+		uint64 NextId = 1;
+		FEvent* WakeEvent = nullptr;
+		std::atomic<bool> bStopping{ false };
+		FRunnableThread* Thread = nullptr;
+	};
+
+	//Guards creation and shutdown of both executors, and queueing so the pool can't be destroyed midway
+	FCriticalSection ExecutorSection;
+	FQueuedThreadPool* BlockingPool = nullptr;
+	FCUTimerThread* TimerThread = nullptr;
+	bool bExecutorsShutDown = false;
+}
 
 void FCULambdaRunnable::RunLambdaOnBackGroundThread(TFunction< void()> InFunction)
 {
-	Async(EAsyncExecution::Thread, InFunction);
+	{
+		FScopeLock Lock(&ExecutorSection);
+		if (!bExecutorsShutDown)
+		{
+			if (!BlockingPool)
+			{
+				BlockingPool = FQueuedThreadPool::Allocate();
+				BlockingPool->Create(BlockingThreadCount, 0, TPri_Normal, TEXT("CUBlockingPool"));
+			}
+			BlockingPool->AddQueuedWork(new FCUBlockingWork(MoveTemp(InFunction)));
+			return;
+		}
+	}
+
+	//Shut down, keep the work from getting lost
+	InFunction();
 }
 
 void FCULambdaRunnable::RunLambdaOnBackGroundThreadPool(TFunction< void()> InFunction)
@@ -25,24 +205,85 @@ FGraphEventRef FCULambdaRunnable::RunShortLambdaOnBackGroundTask(TFunction< void
 	return FFunctionGraphTask::CreateAndDispatchWhenReady(InFunction, TStatId(), nullptr, ENamedThreads::AnyThread);
 }
 
-void FCULambdaRunnable::SetTimeout(TFunction<void()>OnDone, float DurationInSec, bool bCallbackOnGameThread /*=true*/)
+FCUTimeoutHandle FCULambdaRunnable::SetTimeout(TFunction<void()>OnDone, float DurationInSec, bool bCallbackOnGameThread /*=true*/)
+{
+	FCUTimeoutHandle Handle;
+
+	FScopeLock Lock(&ExecutorSection);
+	if (bExecutorsShutDown)
+	{
+		return Handle;
+	}
+	if (!TimerThread)
+	{
+		TimerThread = new FCUTimerThread();
+	}
+	Handle.Id = TimerThread->Add(MoveTemp(OnDone), FPlatformTime::Seconds() + DurationInSec, bCallbackOnGameThread);
+	return Handle;
+}
+
+bool FCULambdaRunnable::ClearTimeout(FCUTimeoutHandle& Handle)
 {
-	RunLambdaOnBackGroundThread([OnDone, DurationInSec, bCallbackOnGameThread]()
+	if (!Handle.IsValid())
 	{
-		FPlatformProcess::Sleep(DurationInSec);
+		return false;
+	}
+	const uint64 Id = Handle.Id;
+	Handle.Id = 0;
+
+	FScopeLock Lock(&ExecutorSection);
+	return TimerThread && TimerThread->Cancel(Id);
+}
 
-		if (bCallbackOnGameThread)
+void FCULambdaRunnable::ShutdownExecutors()
+{
+	FQueuedThreadPool* Pool = nullptr;
+	FCUTimerThread* Timer = nullptr;
+	{
+		FScopeLock Lock(&ExecutorSection);
+		bExecutorsShutDown = true;
+		Pool = BlockingPool;
+		Timer = TimerThread;
+		BlockingPool = nullptr;
+		TimerThread = nullptr;
+	}
+
+	//Outside the lock, running work may still queue more and that now runs inline
+	delete Timer;
+	if (Pool)
+	{
+		Pool->Destroy();
+		delete Pool;
+	}
+}
+
+void FCUSerialTaskQueue::Enqueue(TFunction<void()> InFunction)
+{
+	Queue.Enqueue(MoveTemp(InFunction));
+
+	//Only the enqueue that finds the queue idle starts a drain task, so at most one runs at a time
+	if (PendingCount.fetch_add(1) == 0)
+	{
+		TSharedRef<FCUSerialTaskQueue, ESPMode::ThreadSafe> Self = AsShared();
+		FCULambdaRunnable::RunShortLambdaOnBackGroundTask([Self]()
 		{
-			RunShortLambdaOnGameThread(OnDone);
-		}
-		else
+			Self->Drain();
+		});
+	}
+}
+
+void FCUSerialTaskQueue::Drain()
+{
+	do
+	{
+		TFunction<void()> Function;
+		if (Queue.Dequeue(Function) && Function)
 		{
-			OnDone();
+			Function();
 		}
-	});
+	} while (PendingCount.fetch_sub(1) > 1);
 }
 
-
 FCULatentAction* FCULatentAction::CreateLatentAction(struct FLatentActionInfo& LatentInfo, UObject* WorldContext)
 {
 	UWorld* World = GEngine->GetWorldFromContextObject(WorldContext, EGetWorldErrorMode::LogAndReturnNull);
@@ -0,0 +1,804 @@
+// Copyright 2018-current Getnamo. All Rights Reserved
+
+#include "CUTransformCodec.h"
+#include "Math/Float16.h"
+#include "Math/VectorRegister.h"
+#include "Templates/IntegerSequence.h"
+
+namespace
+{
+	enum ETransformFlags : uint8
+	{
+		HasScale = 1,
+		IsDelta = 2
+	};
+
+	const double HalfSqrt2 = 0.70710678118654752;
+
+	//Values per lane packed block, 32 per vector lane
+	const int32 BlockSize = 128;
+
+	//Widths above this don't fit a lane and use the scalar bit layout
+	const int32 MaxLaneWidth = 32;
+
+	void AppendVarint(TArray<uint8>& Out, uint64 Value)
+	{
+		while (Value >= 0x80)
+		{
+			Out.Add((uint8)(Value | 0x80));
+			Value >>= 7;
+		}
+		Out.Add((uint8)Value);
+	}
+
+	uint64 ZigZag(int64 Value)
+	{
+		return ((uint64)Value << 1) ^ (uint64)(Value >> 63);
+	}
+
+	int64 UnZigZag(uint64 Value)
+	{
+		return (int64)(Value >> 1) ^ -(int64)(Value & 1);
+	}
+
+	template<typename T>
+	void AppendRaw(TArray<uint8>& Out, const T& Value)
+	{
+		Out.Append((const uint8*)&Value, sizeof(T));
+	}
+
+	/** Bits needed for the largest of Values, 0 if they are all 0 */
+	template<typename T>
+	int32 BitWidth(const T* Values, int32 Count)
+	{
+		uint64 Any = 0;
+		for (int32 i = 0; i < Count; i++)
+		{
+			Any |= Values[i];
+		}
+		return Any ? 64 - (int32)FMath::CountLeadingZeros64(Any) : 0;
+	}
+
+	int64 BitBlockBytes(int64 Count, int32 Width)
+	{
+		return (Count * Width + 7) / 8;
+	}
+
+	/** Writes Count values of Width bits each into zeroed Block, least significant bit first */
+	template<typename T>
+	void WriteBitBlock(uint8* Block, const T* Values, int32 Count, int32 Width)
+	{
+		int64 BitOffset = 0;
+		for (int32 i = 0; i < Count; i++, BitOffset += Width)
+		{
+			const uint64 Value = Values[i];
+			int64 Byte = BitOffset >> 3;
+			int32 Shift = (int32)(BitOffset & 7);
+			for (int32 Written = 0; Written < Width; Byte++)
+			{
+				Block[Byte] |= (uint8)((Value >> Written) << Shift);
+				Written += 8 - Shift;
+				Shift = 0;
+			}
+		}
+	}
+
+	/** Value Index of a block written by WriteBitBlock */
+	uint64 ReadBitBlock(const uint8* Block, int64 BlockBytes, int64 Index, int32 Width)
+	{
+		if (Width == 0)
+		{
+			return 0;
+		}
+		const int64 BitOffset = Index * Width;
+		int64 Byte = BitOffset >> 3;
+		int32 Shift = (int32)(BitOffset & 7);
+
+		uint64 Value = 0;
+		for (int32 Read = 0; Read < Width; Byte += 8)
+		{
+			//one unaligned little endian load covers any width up to 57 bits
+			uint64 Window = 0;
+			FMemory::Memcpy(&Window, Block + Byte, (SIZE_T)FMath::Min<int64>(8, BlockBytes - Byte));
+			Window >>= Shift;
+			Value |= Window << Read;
+			Read += 64 - Shift;
+			Shift = 0;
+		}
+		return Width < 64 ? Value & ((uint64(1) << Width) - 1) : Value;
+	}
+
+	/**
+	* Lane packed blocks: value i of a block goes to lane i % 4 as the (i / 4)th Width bit value of that
+	* lane, so every lane shifts by the same immediate and a block is Width vector words. Kernels are
+	* instanced per width since NEON only shifts by compile time amounts.
+	*/
+	template<int32 Width, int32 Index>
+	FORCEINLINE void PackLane(const VectorRegister4Int* Values, VectorRegister4Int* Words)
+	{
+		constexpr int32 Bit = Index * Width;
+		constexpr int32 Word = Bit / 32;
+		constexpr int32 Shift = Bit % 32;
+
+		if constexpr (Shift == 0)
+		{
+			Words[Word] = VectorIntOr(Words[Word], Values[Index]);
+		}
+		else
+		{
+			Words[Word] = VectorIntOr(Words[Word], VectorShiftLeftImm(Values[Index], Shift));
+		}
+		if constexpr (Shift + Width > 32)
+		{
+			Words[Word + 1] = VectorIntOr(Words[Word + 1], VectorShiftRightImmLogical(Values[Index], 32 - Shift));
+		}
+	}
+
+	template<int32 Width, int32 Index>
+	FORCEINLINE void UnpackLane(const VectorRegister4Int* Words, VectorRegister4Int* Values)
+	{
+		constexpr int32 Bit = Index * Width;
+		constexpr int32 Word = Bit / 32;
+		constexpr int32 Shift = Bit % 32;
+
+		VectorRegister4Int Value;
+		if constexpr (Shift == 0)
+		{
+			Value = Words[Word];
+		}
+		else
+		{
+			Value = VectorShiftRightImmLogical(Words[Word], Shift);
+		}
+		if constexpr (Shift + Width > 32)
+		{
+			Value = VectorIntOr(Value, VectorShiftLeftImm(Words[Word + 1], 32 - Shift));
+		}
+		if constexpr (Width < 32)
+		{
+			constexpr int32 Mask = (int32)((1u << Width) - 1);
+			Value = VectorIntAnd(Value, MakeVectorRegisterInt(Mask, Mask, Mask, Mask));
+		}
+		Values[Index] = Value;
+	}
+
+	template<int32 Width, int32... Index>
+	FORCEINLINE void PackLanes(const VectorRegister4Int* Values, VectorRegister4Int* Words, TIntegerSequence<int32, Index...>)
+	{
+		(PackLane<Width, Index>(Values, Words), ...);
+	}
+
+	template<int32 Width, int32... Index>
+	FORCEINLINE void UnpackLanes(const VectorRegister4Int* Words, VectorRegister4Int* Values, TIntegerSequence<int32, Index...>)
+	{
+		(UnpackLane<Width, Index>(Words, Values), ...);
+	}
+
+	template<int32 Width>
+	void PackBlock(const uint32* Values, uint8* Out)
+	{
+		VectorRegister4Int Lanes[BlockSize / 4];
+		for (int32 i = 0; i < BlockSize / 4; i++)
+		{
+			Lanes[i] = VectorIntLoad(Values + i * 4);
+		}
+
+		VectorRegister4Int Words[Width];
+		for (int32 i = 0; i < Width; i++)
+		{
+			Words[i] = MakeVectorRegisterInt(0, 0, 0, 0);
+		}
+		PackLanes<Width>(Lanes, Words, TMakeIntegerSequence<int32, BlockSize / 4>());
+
+		for (int32 i = 0; i < Width; i++)
+		{
+			VectorIntStore(Words[i], Out + i * sizeof(VectorRegister4Int));
+		}
+	}
+
+	template<int32 Width>
+	void UnpackBlock(const uint8* Block, uint32* Values)
+	{
+		VectorRegister4Int Words[Width];
+		for (int32 i = 0; i < Width; i++)
+		{
+			Words[i] = VectorIntLoad(Block + i * sizeof(VectorRegister4Int));
+		}
+
+		VectorRegister4Int Lanes[BlockSize / 4];
+		UnpackLanes<Width>(Words, Lanes, TMakeIntegerSequence<int32, BlockSize / 4>());
+
+		for (int32 i = 0; i < BlockSize / 4; i++)
+		{
+			VectorIntStore(Lanes[i], Values + i * 4);
+		}
+	}
+
+	typedef void(*FPackBlockKernel)(const uint32*, uint8*);
+	typedef void(*FUnpackBlockKernel)(const uint8*, uint32*);
+
+	//Indexed by Width - 1
+	template<int32... Width>
+	const FPackBlockKernel* PackBlockKernels(TIntegerSequence<int32, Width...>)
+	{
+		static const FPackBlockKernel Kernels[] = { &PackBlock<Width + 1>... };
+		return Kernels;
+	}
+
+	template<int32... Width>
+	const FUnpackBlockKernel* UnpackBlockKernels(TIntegerSequence<int32, Width...>)
+	{
+		static const FUnpackBlockKernel Kernels[] = { &UnpackBlock<Width + 1>... };
+		return Kernels;
+	}
+
+	/** Bytes of a column of Count values: lane packed blocks, then the rest bit packed */
+	int64 ColumnBytes(int64 Count, int32 Width)
+	{
+		if (Width > MaxLaneWidth)
+		{
+			return BitBlockBytes(Count, Width);
+		}
+		return (Count / BlockSize) * Width * (int64)sizeof(VectorRegister4Int) + BitBlockBytes(Count % BlockSize, Width);
+	}
+
+	void AppendColumn(TArray<uint8>& Out, const uint32* Values, int32 Count, int32 Width)
+	{
+		if (Width == 0 || Count == 0)
+		{
+			return;
+		}
+		const int64 Start = Out.Num();
+		Out.AddZeroed((int32)ColumnBytes(Count, Width));
+		uint8* Column = Out.GetData() + Start;
+
+		const FPackBlockKernel Kernel = PackBlockKernels(TMakeIntegerSequence<int32, MaxLaneWidth>())[Width - 1];
+		const int32 NumBlocks = Count / BlockSize;
+		const int32 BlockBytes = Width * sizeof(VectorRegister4Int);
+		for (int32 Block = 0; Block < NumBlocks; Block++)
+		{
+			Kernel(Values + Block * BlockSize, Column + Block * BlockBytes);
+		}
+		WriteBitBlock(Column + NumBlocks * BlockBytes, Values + NumBlocks * BlockSize, Count % BlockSize, Width);
+	}
+
+	/** Columns too wide for a lane, only positions far from the origin at a fine precision */
+	void AppendWideColumn(TArray<uint8>& Out, const uint64* Values, int32 Count, int32 Width)
+	{
+		const int64 Start = Out.Num();
+		Out.AddZeroed((int32)ColumnBytes(Count, Width));
+		WriteBitBlock(Out.GetData() + Start, Values, Count, Width);
+	}
+
+	/** Unpacks a column of at most MaxLaneWidth bits into Values */
+	void ReadColumn(const uint8* Column, int32 Count, int32 Width, uint32* Values)
+	{
+		if (Width == 0)
+		{
+			FMemory::Memzero(Values, Count * sizeof(uint32));
+			return;
+		}
+
+		const FUnpackBlockKernel Kernel = UnpackBlockKernels(TMakeIntegerSequence<int32, MaxLaneWidth>())[Width - 1];
+		const int32 NumBlocks = Count / BlockSize;
+		const int32 BlockBytes = Width * sizeof(VectorRegister4Int);
+		for (int32 Block = 0; Block < NumBlocks; Block++)
+		{
+			Kernel(Column + Block * BlockBytes, Values + Block * BlockSize);
+		}
+
+		const uint8* Tail = Column + NumBlocks * BlockBytes;
+		const int64 TailBytes = BitBlockBytes(Count % BlockSize, Width);
+		for (int32 i = NumBlocks * BlockSize; i < Count; i++)
+		{
+			Values[i] = (uint32)ReadBitBlock(Tail, TailBytes, i - NumBlocks * BlockSize, Width);
+		}
+	}
+
+	/** Out = Offset + UnZigZag(Values) * Scale, four at a time */
+	void DequantizeColumn(const uint32* Values, int32 Count, double Offset, double Scale, double* Out)
+	{
+		const VectorRegister4Int One = MakeVectorRegisterInt(1, 1, 1, 1);
+		const VectorRegister4Int Zero = MakeVectorRegisterInt(0, 0, 0, 0);
+		const VectorRegister4Int LowMask = MakeVectorRegisterInt(0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF);
+		const VectorRegister4Double HighScale = MakeVectorRegisterDouble(65536.0, 65536.0, 65536.0, 65536.0);
+		const VectorRegister4Double OffsetV = MakeVectorRegisterDouble(Offset, Offset, Offset, Offset);
+		const VectorRegister4Double ScaleV = MakeVectorRegisterDouble(Scale, Scale, Scale, Scale);
+
+		int32 i = 0;
+		for (; i + 4 <= Count; i += 4)
+		{
+			const VectorRegister4Int Encoded = VectorIntLoad(Values + i);
+			const VectorRegister4Int Quantized = VectorIntXor(VectorShiftRightImmLogical(Encoded, 1), VectorIntSubtract(Zero, VectorIntAnd(Encoded, One)));
+
+			//float holds 16 bit halves exactly, recombined in double the value is exact for all of int32
+			const VectorRegister4Double Low(VectorIntToFloat(VectorIntAnd(Quantized, LowMask)));
+			const VectorRegister4Double High(VectorIntToFloat(VectorShiftRightImmArithmetic(Quantized, 16)));
+			const VectorRegister4Double Value = VectorMultiplyAdd(High, HighScale, Low);
+
+			VectorStore(VectorMultiplyAdd(Value, ScaleV, OffsetV), Out + i);
+		}
+		for (; i < Count; i++)
+		{
+			Out[i] = Offset + (double)UnZigZag(Values[i]) * Scale;
+		}
+	}
+
+	int64 Quantize(double Value, double Origin, double InvPrecision)
+	{
+		return FMath::RoundToInt64((Value - Origin) * InvPrecision);
+	}
+
+	/** Smallest three: index of the largest component, then the other three scaled to Bits each */
+	void PackRotation(const FQuat& Rotation, int32 Bits, uint32 OutPacked[4])
+	{
+		const FQuat Normalized = Rotation.GetNormalized();
+		const double Components[4] = { Normalized.X, Normalized.Y, Normalized.Z, Normalized.W };
+
+		int32 Largest = 0;
+		for (int32 i = 1; i < 4; i++)
+		{
+			if (FMath::Abs(Components[i]) > FMath::Abs(Components[Largest]))
+			{
+				Largest = i;
+			}
+		}
+
+		//q and -q are the same rotation, flip so the dropped component is positive
+		const double Sign = Components[Largest] < 0.0 ? -1.0 : 1.0;
+		const int64 MaxValue = (int64(1) << Bits) - 1;
+		const double Scale = MaxValue / (2.0 * HalfSqrt2);
+
+		OutPacked[0] = (uint32)Largest;
+		int32 Small = 1;
+		for (int32 i = 0; i < 4; i++)
+		{
+			if (i == Largest)
+			{
+				continue;
+			}
+			OutPacked[Small++] = (uint32)FMath::Clamp<int64>(FMath::RoundToInt64((Components[i] * Sign + HalfSqrt2) * Scale), 0, MaxValue);
+		}
+	}
+
+	/**
+	* Rebuilds the three small components and the dropped one of Count rotations in place, four at a
+	* time, all normalized. Small holds three columns of Count values.
+	*/
+	void ReconstructRotations(const uint32* Small, int32 Count, int32 Bits, float* OutSmall, float* OutLargest)
+	{
+		const float InvScale = (float)((2.0 * HalfSqrt2) / (double)((1u << Bits) - 1));
+		const float Bias = (float)-HalfSqrt2;
+		const VectorRegister4Float InvScaleV = MakeVectorRegisterFloat(InvScale, InvScale, InvScale, InvScale);
+		const VectorRegister4Float BiasV = MakeVectorRegisterFloat(Bias, Bias, Bias, Bias);
+		const VectorRegister4Float ZeroV = MakeVectorRegisterFloat(0.f, 0.f, 0.f, 0.f);
+		const VectorRegister4Float OneV = MakeVectorRegisterFloat(1.f, 1.f, 1.f, 1.f);
+
+		const uint32* A = Small;
+		const uint32* B = Small + Count;
+		const uint32* C = Small + Count * 2;
+
+		int32 i = 0;
+		for (; i + 4 <= Count; i += 4)
+		{
+			//components are at most 20 bits so the int to float conversion is exact
+			const VectorRegister4Float AV = VectorMultiplyAdd(VectorIntToFloat(VectorIntLoad(A + i)), InvScaleV, BiasV);
+			const VectorRegister4Float BV = VectorMultiplyAdd(VectorIntToFloat(VectorIntLoad(B + i)), InvScaleV, BiasV);
+			const VectorRegister4Float CV = VectorMultiplyAdd(VectorIntToFloat(VectorIntLoad(C + i)), InvScaleV, BiasV);
+
+			const VectorRegister4Float SumSquares = VectorMultiplyAdd(CV, CV, VectorMultiplyAdd(BV, BV, VectorMultiply(AV, AV)));
+			const VectorRegister4Float DV = VectorSqrt(VectorMax(ZeroV, VectorSubtract(OneV, SumSquares)));
+			const VectorRegister4Float InvLength = VectorReciprocalSqrtAccurate(VectorMultiplyAdd(DV, DV, SumSquares));
+
+			VectorStore(VectorMultiply(AV, InvLength), OutSmall + i);
+			VectorStore(VectorMultiply(BV, InvLength), OutSmall + Count + i);
+			VectorStore(VectorMultiply(CV, InvLength), OutSmall + Count * 2 + i);
+			VectorStore(VectorMultiply(DV, InvLength), OutLargest + i);
+		}
+		for (; i < Count; i++)
+		{
+			const float AS = A[i] * InvScale + Bias;
+			const float BS = B[i] * InvScale + Bias;
+			const float CS = C[i] * InvScale + Bias;
+			const float SumSquares = AS * AS + BS * BS + CS * CS;
+			const float DS = FMath::Sqrt(FMath::Max(0.f, 1.f - SumSquares));
+			const float InvLength = FMath::InvSqrt(SumSquares + DS * DS);
+
+			OutSmall[i] = AS * InvLength;
+			OutSmall[Count + i] = BS * InvLength;
+			OutSmall[Count * 2 + i] = CS * InvLength;
+			OutLargest[i] = DS * InvLength;
+		}
+	}
+
+	void PackScale(const FVector& Scale, uint16 OutHalfs[3])
+	{
+		for (int32 Axis = 0; Axis < 3; Axis++)
+		{
+			OutHalfs[Axis] = FFloat16((float)Scale[Axis]).Encoded;
+		}
+	}
+
+	bool IsBitSet(const uint8* BitSet, int32 Index)
+	{
+		return (BitSet[Index / 8] & (1 << (Index % 8))) != 0;
+	}
+
+	int32 CountBitsSet(const uint8* BitSet, int32 NumBytes)
+	{
+		int32 Count = 0;
+		for (int32 i = 0; i < NumBytes; i++)
+		{
+			Count += (int32)FMath::CountBits((uint64)BitSet[i]);
+		}
+		return Count;
+	}
+
+	struct FReader
+	{
+		const uint8* Data;
+		int32 Num;
+		int32 Pos = 0;
+		bool bError = false;
+
+		FReader(TArrayView<const uint8> Bytes)
+			: Data(Bytes.GetData())
+			, Num(Bytes.Num())
+		{
+		}
+
+		uint64 ReadVarint()
+		{
+			uint64 Value = 0;
+			for (int32 Shift = 0; Shift < 64; Shift += 7)
+			{
+				if (Pos >= Num)
+				{
+					bError = true;
+					return 0;
+				}
+				const uint8 Byte = Data[Pos++];
+				Value |= (uint64)(Byte & 0x7F) << Shift;
+				if (!(Byte & 0x80))
+				{
+					return Value;
+				}
+			}
+			bError = true;
+			return 0;
+		}
+
+		const uint8* ReadBytes(int64 Count)
+		{
+			if (bError || Count > Num - Pos)
+			{
+				bError = true;
+				return nullptr;
+			}
+			const uint8* Bytes = Data + Pos;
+			Pos += (int32)Count;
+			return Bytes;
+		}
+
+		template<typename T>
+		T ReadRaw()
+		{
+			T Value{};
+			if (const uint8* Bytes = ReadBytes(sizeof(T)))
+			{
+				FMemory::Memcpy(&Value, Bytes, sizeof(T));
+			}
+			return Value;
+		}
+	};
+}
+
+void FCUTransformCodec::Encode(TArrayView<const FTransform> Transforms, const FCUTransformCodecSettings& Settings, TArray<uint8>& OutBytes, TArrayView<const FTransform> Previous /*= TArrayView<const FTransform>()*/)
+{
+	const int32 Count = Transforms.Num();
+	const bool bDelta = Count > 0 && Previous.Num() == Count;
+	const bool bScale = Settings.bIncludeScale;
+	const int32 Bits = FMath::Clamp(Settings.RotationBits, 6, 20);
+	const float Precision = FMath::Max(Settings.PositionPrecision, 0.001f);
+	const double InvPrecision = 1.0 / Precision;
+	const FVector Origin = Settings.Origin;
+
+	//one pass per column, each loop is independent per transform
+	TArray<uint64> Positions;
+	Positions.SetNumUninitialized(Count * 3);
+	for (int32 Axis = 0; Axis < 3; Axis++)
+	{
+		uint64* Column = Positions.GetData() + Axis * Count;
+		for (int32 i = 0; i < Count; i++)
+		{
+			Column[i] = (uint64)Quantize(Transforms[i].GetTranslation()[Axis], Origin[Axis], InvPrecision);
+		}
+		if (bDelta)
+		{
+			//differences of the quantized values so the receiver never drifts
+			for (int32 i = 0; i < Count; i++)
+			{
+				Column[i] -= (uint64)Quantize(Previous[i].GetTranslation()[Axis], Origin[Axis], InvPrecision);
+			}
+		}
+		for (int32 i = 0; i < Count; i++)
+		{
+			Column[i] = ZigZag((int64)Column[i]);
+		}
+	}
+
+	const int32 BitSetBytes = bDelta ? (Count + 7) / 8 : 0;
+	TArray<uint8> RotationBitSet;
+	TArray<uint8> ScaleBitSet;
+	RotationBitSet.SetNumZeroed(BitSetBytes);
+	ScaleBitSet.SetNumZeroed(bScale ? BitSetBytes : 0);
+
+	//largest index column, then the three small component columns
+	TArray<uint32> Rotations[4];
+	for (TArray<uint32>& Column : Rotations)
+	{
+		Column.Reserve(Count);
+	}
+	TArray<uint16> Scales;
+	Scales.Reserve(bScale ? Count * 3 : 0);
+	for (int32 i = 0; i < Count; i++)
+	{
+		uint32 Rotation[4];
+		PackRotation(Transforms[i].GetRotation(), Bits, Rotation);
+		uint32 BaseRotation[4];
+		if (bDelta)
+		{
+			PackRotation(Previous[i].GetRotation(), Bits, BaseRotation);
+		}
+		if (!bDelta || FMemory::Memcmp(Rotation, BaseRotation, sizeof(Rotation)) != 0)
+		{
+			for (int32 Column = 0; Column < 4; Column++)
+			{
+				Rotations[Column].Add(Rotation[Column]);
+			}
+			if (bDelta)
+			{
+				RotationBitSet[i / 8] |= 1 << (i % 8);
+			}
+		}
+		if (bScale)
+		{
+			uint16 Scale[3];
+			PackScale(Transforms[i].GetScale3D(), Scale);
+			uint16 BaseScale[3];
+			if (bDelta)
+			{
+				PackScale(Previous[i].GetScale3D(), BaseScale);
+			}
+			if (!bDelta || FMemory::Memcmp(Scale, BaseScale, sizeof(Scale)) != 0)
+			{
+				Scales.Append(Scale, 3);
+				if (bDelta)
+				{
+					ScaleBitSet[i / 8] |= 1 << (i % 8);
+				}
+			}
+		}
+	}
+	const int32 NumRotations = Rotations[0].Num();
+
+	int32 PositionWidths[3];
+	int64 PositionBytes = 0;
+	for (int32 Axis = 0; Axis < 3; Axis++)
+	{
+		PositionWidths[Axis] = BitWidth(Positions.GetData() + Axis * Count, Count);
+		PositionBytes += ColumnBytes(Count, PositionWidths[Axis]);
+	}
+
+	OutBytes.Reserve(OutBytes.Num() + 48 + BitSetBytes * 2 + PositionBytes +
+		ColumnBytes(NumRotations, 2) + ColumnBytes(NumRotations, Bits) * 3 + Scales.Num() * 2);
+
+	OutBytes.Add(FormatVersion);
+	OutBytes.Add((bScale ? HasScale : 0) | (bDelta ? IsDelta : 0));
+	OutBytes.Add((uint8)Bits);
+	AppendRaw(OutBytes, Precision);
+	AppendRaw(OutBytes, (double)Origin.X);
+	AppendRaw(OutBytes, (double)Origin.Y);
+	AppendRaw(OutBytes, (double)Origin.Z);
+	AppendVarint(OutBytes, (uint64)Count);
+	for (int32 Axis = 0; Axis < 3; Axis++)
+	{
+		OutBytes.Add((uint8)PositionWidths[Axis]);
+	}
+
+	OutBytes.Append(RotationBitSet);
+	OutBytes.Append(ScaleBitSet);
+
+	TArray<uint32> Narrow;
+	for (int32 Axis = 0; Axis < 3; Axis++)
+	{
+		const uint64* Column = Positions.GetData() + Axis * Count;
+		if (PositionWidths[Axis] > MaxLaneWidth)
+		{
+			AppendWideColumn(OutBytes, Column, Count, PositionWidths[Axis]);
+			continue;
+		}
+		Narrow.SetNumUninitialized(Count, EAllowShrinking::No);
+		for (int32 i = 0; i < Count; i++)
+		{
+			Narrow[i] = (uint32)Column[i];
+		}
+		AppendColumn(OutBytes, Narrow.GetData(), Count, PositionWidths[Axis]);
+	}
+	AppendColumn(OutBytes, Rotations[0].GetData(), NumRotations, 2);
+	for (int32 Column = 1; Column < 4; Column++)
+	{
+		AppendColumn(OutBytes, Rotations[Column].GetData(), NumRotations, Bits);
+	}
+	OutBytes.Append((const uint8*)Scales.GetData(), Scales.Num() * sizeof(uint16));
+}
+
+bool FCUTransformCodec::Decode(TArrayView<const uint8> Bytes, TArray<FTransform>& InOutTransforms)
+{
+	FReader Reader(Bytes);
+	const uint8 Version = Reader.ReadRaw<uint8>();
+	const uint8 Flags = Reader.ReadRaw<uint8>();
+	const int32 Bits = Reader.ReadRaw<uint8>();
+	const float Precision = Reader.ReadRaw<float>();
+	FVector Origin;
+	Origin.X = Reader.ReadRaw<double>();
+	Origin.Y = Reader.ReadRaw<double>();
+	Origin.Z = Reader.ReadRaw<double>();
+	const uint64 Count = Reader.ReadVarint();
+	int32 PositionWidths[3];
+	for (int32 Axis = 0; Axis < 3; Axis++)
+	{
+		PositionWidths[Axis] = Reader.ReadRaw<uint8>();
+	}
+
+	const bool bDelta = (Flags & IsDelta) != 0;
+	const bool bScale = (Flags & HasScale) != 0;
+
+	//a full frame holds at least one rotation per transform, a delta frame a bit set entry
+	const uint64 MaxCount = (uint64)Bytes.Num() * (bDelta ? 8 : 1);
+	if (Reader.bError || Version != FormatVersion || Bits < 6 || Bits > 20 || !(Precision > 0.f) || Count > MaxCount ||
+		PositionWidths[0] > 64 || PositionWidths[1] > 64 || PositionWidths[2] > 64)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("FCUTransformCodec::Decode invalid header"));
+		return false;
+	}
+
+	const int32 Num = (int32)Count;
+
+	if (bDelta && InOutTransforms.Num() != Num)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("FCUTransformCodec::Decode delta frame of %d transforms against %d held"), Num, InOutTransforms.Num());
+		return false;
+	}
+
+	//every block is located and bounds checked before anything is written
+	const int32 BitSetBytes = bDelta ? (Num + 7) / 8 : 0;
+	const uint8* RotationBitSet = Reader.ReadBytes(BitSetBytes);
+	const uint8* ScaleBitSet = Reader.ReadBytes(bScale ? BitSetBytes : 0);
+	const int32 NumRotations = bDelta && RotationBitSet ? CountBitsSet(RotationBitSet, BitSetBytes) : Num;
+	const int32 NumScales = !bScale ? 0 : (bDelta && ScaleBitSet ? CountBitsSet(ScaleBitSet, BitSetBytes) : Num);
+
+	const uint8* PositionColumns[3];
+	for (int32 Axis = 0; Axis < 3; Axis++)
+	{
+		PositionColumns[Axis] = Reader.ReadBytes(ColumnBytes(Num, PositionWidths[Axis]));
+	}
+	const uint8* LargestColumn = Reader.ReadBytes(ColumnBytes(NumRotations, 2));
+	const uint8* SmallColumns[3];
+	for (int32 Column = 0; Column < 3; Column++)
+	{
+		SmallColumns[Column] = Reader.ReadBytes(ColumnBytes(NumRotations, Bits));
+	}
+	const uint8* ScaleBlock = Reader.ReadBytes((int64)NumScales * 3 * sizeof(uint16));
+
+	if (Reader.bError)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("FCUTransformCodec::Decode bytes end early"));
+		return false;
+	}
+
+	//columns are unpacked and dequantized in batches, full frames straight to world units and delta
+	//frames to quantized steps that are added to the held quantized positions below
+	TArray<uint32> Unpacked;
+	Unpacked.SetNumUninitialized(FMath::Max(Num, NumRotations * 3));
+	TArray<double> Locations;
+	Locations.SetNumUninitialized(Num * 3);
+	for (int32 Axis = 0; Axis < 3; Axis++)
+	{
+		const double Offset = bDelta ? 0.0 : Origin[Axis];
+		const double Scale = bDelta ? 1.0 : (double)Precision;
+		double* Out = Locations.GetData() + Axis * Num;
+		if (PositionWidths[Axis] > MaxLaneWidth)
+		{
+			const int64 WideBytes = ColumnBytes(Num, PositionWidths[Axis]);
+			for (int32 i = 0; i < Num; i++)
+			{
+				Out[i] = Offset + (double)UnZigZag(ReadBitBlock(PositionColumns[Axis], WideBytes, i, PositionWidths[Axis])) * Scale;
+			}
+			continue;
+		}
+		ReadColumn(PositionColumns[Axis], Num, PositionWidths[Axis], Unpacked.GetData());
+		DequantizeColumn(Unpacked.GetData(), Num, Offset, Scale, Out);
+	}
+
+	TArray<uint32> Largest;
+	Largest.SetNumUninitialized(NumRotations);
+	ReadColumn(LargestColumn, NumRotations, 2, Largest.GetData());
+	for (int32 Column = 0; Column < 3; Column++)
+	{
+		ReadColumn(SmallColumns[Column], NumRotations, Bits, Unpacked.GetData() + Column * NumRotations);
+	}
+	TArray<float> Components;
+	Components.SetNumUninitialized(NumRotations * 4);
+	ReconstructRotations(Unpacked.GetData(), NumRotations, Bits, Components.GetData(), Components.GetData() + NumRotations * 3);
+
+	auto GetRotation = [&](int32 Index)
+	{
+		double Quat[4];
+		const int32 Dropped = (int32)Largest[Index];
+		int32 Small = 0;
+		for (int32 i = 0; i < 4; i++)
+		{
+			Quat[i] = i == Dropped ? Components[NumRotations * 3 + Index] : Components[NumRotations * Small++ + Index];
+		}
+		return FQuat(Quat[0], Quat[1], Quat[2], Quat[3]);
+	};
+
+	if (!bDelta)
+	{
+		InOutTransforms.SetNumUninitialized(Num, EAllowShrinking::No);
+	}
+
+	FTransform* Out = InOutTransforms.GetData();
+	const double InvPrecision = 1.0 / Precision;
+	int32 RotationIndex = 0;
+	for (int32 i = 0; i < Num; i++)
+	{
+		FTransform& Transform = Out[i];
+		FVector Location(Locations[i], Locations[Num + i], Locations[Num * 2 + i]);
+		if (bDelta)
+		{
+			const FVector BaseLocation = Transform.GetTranslation();
+			for (int32 Axis = 0; Axis < 3; Axis++)
+			{
+				const double Base = (double)Quantize(BaseLocation[Axis], Origin[Axis], InvPrecision);
+				Location[Axis] = Origin[Axis] + (Base + Location[Axis]) * (double)Precision;
+			}
+			//changed entries are packed in transform order
+			if (IsBitSet(RotationBitSet, i))
+			{
+				Transform.SetRotation(GetRotation(RotationIndex++));
+			}
+		}
+		else
+		{
+			Transform = FTransform::Identity;
+			Transform.SetRotation(GetRotation(i));
+		}
+		Transform.SetLocation(Location);
+	}
+
+	int32 ScaleIndex = 0;
+	for (int32 i = 0; i < Num && bScale; i++)
+	{
+		if (bDelta && !IsBitSet(ScaleBitSet, i))
+		{
+			continue;
+		}
+		FVector Scale;
+		for (int32 Axis = 0; Axis < 3; Axis++)
+		{
+			FFloat16 Half;
+			FMemory::Memcpy(&Half.Encoded, ScaleBlock + (ScaleIndex * 3 + Axis) * sizeof(uint16), sizeof(uint16));
+			Scale[Axis] = Half.GetFloat();
+		}
+		ScaleIndex++;
+		Out[i].SetScale3D(Scale);
+	}
+	return true;
+}
+
+bool FCUTransformCodec::IsDeltaFrame(TArrayView<const uint8> Bytes)
+{
+	return Bytes.Num() > 1 && Bytes[0] == FormatVersion && (Bytes[1] & IsDelta) != 0;
+}
@@ -2,6 +2,7 @@
 
 
 #include "ICoreUtility.h"
+#include "CULambdaRunnable.h"
 
 DEFINE_LOG_CATEGORY(CoreUtilityLog);
 
@@ -11,7 +12,10 @@ public:
 
 	/** IModuleInterface implementation */
 	virtual void StartupModule() {};
-	virtual void ShutdownModule() {};
+	virtual void ShutdownModule()
+	{
+		FCULambdaRunnable::ShutdownExecutors();
+	};
 };
 
 
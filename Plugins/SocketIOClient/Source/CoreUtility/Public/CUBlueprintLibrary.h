@@ -6,6 +6,7 @@
 #include "Kismet/BlueprintFunctionLibrary.h"
 #include "Async/Future.h"
 #include "Sound/SoundWaveProcedural.h"
+#include "CUTransformCodec.h"
 #include "CUBlueprintLibrary.generated.h"
 
 /** Wrapper for EImageFormat::Type for BP */
@@ -114,6 +115,25 @@ public:
 	UFUNCTION(BlueprintPure, meta = (DisplayName = "To Transforms (Bytes)", BlueprintAutocast), Category = "CoreUtility|Conversion")
 	static void Conv_CompactBytesToTransforms(const TArray<uint8>& InCompactBytes, TArray<FTransform>& OutTransforms);
 
+	/** 
+	* Transforms to compact bytes [[pitch,yaw,roll,x,y,z,sx,sy,sz],...], prefer EncodeQuantizedTransforms for new protocols
+	*/
+	UFUNCTION(BlueprintPure, meta = (DisplayName = "To Compact Bytes (Transforms)", BlueprintAutocast), Category = "CoreUtility|Conversion")
+	static TArray<uint8> Conv_TransformsToCompactBytes(const TArray<FTransform>& InTransforms);
+
+	/**
+	* Quantized transform bytes, a fraction of the compact bytes size. Pass the frame sent last as
+	* Previous to only send what changed, see FCUTransformCodec.
+	*/
+	UFUNCTION(BlueprintCallable, meta = (AutoCreateRefTerm = "Previous"), Category = "CoreUtility|Conversion")
+	static TArray<uint8> EncodeQuantizedTransforms(const TArray<FTransform>& Transforms, const FCUTransformCodecSettings& Settings, const TArray<FTransform>& Previous);
+
+	/**
+	* Decodes quantized transform bytes into Transforms. Delta frames are applied to the frame already in Transforms.
+	*/
+	UFUNCTION(BlueprintCallable, Category = "CoreUtility|Conversion")
+	static bool DecodeQuantizedTransforms(const TArray<uint8>& InBytes, UPARAM(ref) TArray<FTransform>& Transforms);
+
 	/** 
 	* Compact Position bytes are [[x,y,z],...]
 	*/
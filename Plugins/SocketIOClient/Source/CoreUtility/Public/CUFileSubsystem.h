@@ -51,6 +51,16 @@ public:
 
 	UFUNCTION(BlueprintCallable, Category = FileUtility)
 	bool DeleteFileAtPath(const FString& Path);
+
+	/** Append bytes to the end of the file at path, creating file and directories if needed */
+	UFUNCTION(BlueprintCallable, Category = FileUtility)
+	bool AppendBytesToPath(const TArray<uint8>& Bytes, const FString& Path);
+
+	/** 
+	* Memory map the file and pass its contents to Reader without copying. C++ only.
+	* Falls back to a regular read on platforms without mapped file support.
+	*/
+	bool ReadMappedPath(const FString& Path, TFunctionRef<void(const uint8* Data, int64 Size)> Reader);
 	
 	//Lifetime
 	virtual	void Initialize(FSubsystemCollectionBase& Collection) override;
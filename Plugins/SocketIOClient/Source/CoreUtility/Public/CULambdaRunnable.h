@@ -5,6 +5,8 @@
 #include "Engine/LatentActionManager.h"
 #include "LatentActions.h"
 #include "Async/TaskGraphInterfaces.h"
+#include "Containers/Queue.h"
+#include <atomic>
 
 /** A simple latent action where we don't hold the value, expect capturing value in lambdas */
 class COREUTILITY_API FCULatentAction : public FPendingLatentAction
@@ -37,6 +39,17 @@ private:
 	bool Called;
 };
 
+/** Handle to a pending SetTimeout, pass it to ClearTimeout to cancel the callback */
+struct COREUTILITY_API FCUTimeoutHandle
+{
+	uint64 Id = 0;
+
+	bool IsValid() const
+	{
+		return Id != 0;
+	}
+};
+
 /**
 *	Convenience wrappers for common thread/task work flow. Run background task on thread, callback via task graph on game thread
 */
@@ -45,7 +58,8 @@ class COREUTILITY_API FCULambdaRunnable
 public:
 
 	/**
-	*	Runs the passed lambda on the background thread, new thread per call
+	*	Runs the passed lambda on a bounded set of threads kept for blocking work such as connects and disconnects.
+	*	Calls beyond the thread count queue up instead of spawning threads.
 	*/
 	static void RunLambdaOnBackGroundThread(TFunction< void()> InFunction);
 
@@ -65,8 +79,35 @@ public:
 	static FGraphEventRef RunShortLambdaOnBackGroundTask(TFunction< void()> InFunction);
 
 	/** 
-	*	Runs a thread with idle for duration before calling back on game thread. 
-	*	Due to context cost recommended for >0.1sec durations.
+	*	Calls back after duration, on game thread or else as a short background task. All timeouts share one
+	*	timer thread, resolution is about a millisecond.
+	*/
+	static FCUTimeoutHandle SetTimeout(TFunction<void()>OnDone, float DurationInSec, bool bCallbackOnGameThread = true);
+
+	/** 
+	*	Cancels a pending timeout and invalidates the handle. Returns false if it already fired or was cleared.
+	*/
+	static bool ClearTimeout(FCUTimeoutHandle& Handle);
+
+	/**
+	*	Stops the timer thread and blocking work threads, called on module shutdown. Pending timeouts are dropped,
+	*	queued blocking work runs on the calling thread.
 	*/
-	static void SetTimeout(TFunction<void()>OnDone, float DurationInSec, bool bCallbackOnGameThread = true);
+	static void ShutdownExecutors();
+};
+
+/**
+*	Runs enqueued lambdas one at a time and in order on the task graph. Separate queues run in parallel.
+*	Hold it in a thread-safe TSharedPtr, pending work keeps the queue alive until it has run.
+*/
+class COREUTILITY_API FCUSerialTaskQueue : public TSharedFromThis<FCUSerialTaskQueue, ESPMode::ThreadSafe>
+{
+public:
+	void Enqueue(TFunction<void()> InFunction);
+
+private:
+	void Drain();
+
+	TQueue<TFunction<void()>, EQueueMode::Mpsc> Queue;
+	std::atomic<int32> PendingCount{ 0 };
 };
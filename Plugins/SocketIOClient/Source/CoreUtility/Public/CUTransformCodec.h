@@ -0,0 +1,69 @@
+// Copyright 2018-current Getnamo. All Rights Reserved
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "CUTransformCodec.generated.h"
+
+/** Precision of quantized transform bytes, see FCUTransformCodec */
+USTRUCT(BlueprintType)
+struct COREUTILITY_API FCUTransformCodecSettings
+{
+	GENERATED_BODY()
+
+	/** Positions are sent relative to this point, pick one near the transforms to keep them small */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "CoreUtility|Transform Codec")
+	FVector Origin = FVector::ZeroVector;
+
+	/** Position step in cm, decoded positions are within half of it */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "CoreUtility|Transform Codec", meta = (ClampMin = "0.001"))
+	float PositionPrecision = 1.f;
+
+	/** Bits per quaternion component (6-20), a rotation takes 2 + 3 * bits. 10 is within ~0.1 degree. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "CoreUtility|Transform Codec", meta = (ClampMin = "6", ClampMax = "20"))
+	int32 RotationBits = 10;
+
+	/** Send scale as half floats, otherwise decoded transforms have unit scale */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "CoreUtility|Transform Codec")
+	bool bIncludeScale = false;
+};
+
+/**
+* Quantized transform arrays e.g. crowd snapshots. Positions are fixed point relative to the origin,
+* rotations use smallest-three quaternion compression and scale is optional. A frame can be encoded
+* against the previous one, then unchanged rotations and scales are skipped and positions are sent as
+* differences, so an idle crowd costs ~2 bits per transform. Bytes carry their own settings.
+*
+* Values are bit packed in fixed width columns: each position axis uses the bits of its largest zigzag
+* value in the frame and rotations take 2 + 3 * bits. Columns are packed and unpacked 128 values at a
+* time with vector kernels, positions are dequantized and rotations rebuilt four at a time.
+*
+* Layout: version, flags, rotation bits, precision (float), origin (3 doubles), varint count, x/y/z
+* bit widths (uint8 each). Delta frames then put a changed-rotation and a changed-scale bit set. Then
+* the x, y and z columns, the largest-component column (2 bits), the three small component columns and
+* the half float scales, rotations and scales only for changed transforms in delta frames. A column
+* of up to 32 bits is whole blocks of 128 values, value i of a block in lane i % 4 of Width 4x32 bit
+* words, then the remaining values bit packed and padded to a whole byte. Wider columns are bit packed.
+*/
+class COREUTILITY_API FCUTransformCodec
+{
+public:
+	/**
+	* Appends the quantized bytes of Transforms to OutBytes.
+	*
+	* @param Previous	Frame the receiver decoded last, encodes a delta frame against it. Ignored if empty or a different size.
+	*/
+	static void Encode(TArrayView<const FTransform> Transforms, const FCUTransformCodecSettings& Settings, TArray<uint8>& OutBytes, TArrayView<const FTransform> Previous = TArrayView<const FTransform>());
+
+	/**
+	* Decodes straight into InOutTransforms. A delta frame needs the previously decoded frame in it,
+	* full frames resize it. Returns false if the bytes are malformed or a delta frame doesn't match
+	* the held count, InOutTransforms is left untouched then.
+	*/
+	static bool Decode(TArrayView<const uint8> Bytes, TArray<FTransform>& InOutTransforms);
+
+	/** True if the bytes were encoded against a previous frame */
+	static bool IsDeltaFrame(TArrayView<const uint8> Bytes);
+
+	static constexpr uint8 FormatVersion = 3;
+};
@@ -9,6 +9,8 @@
 #include "Misc/FileHelper.h"
 #include "SIOJsonValue.h"
 #include "SIOJsonObject.h"
+#include "SIOJsonWrapperPool.h"
+#include "SIOJStructPlan.h"
 #include "JsonObjectConverter.h"
 #include "UObject/PropertyPortFlags.h"
 #include "Misc/Base64.h"
@@ -621,11 +623,8 @@ USIOJsonValue* USIOJConvert::ToSIOJsonValue(const TArray<TSharedPtr<FJsonValue>>
 		ValueArray.Add(InVal);
 	}
 
-	USIOJsonValue* ResultValue = NewObject<USIOJsonValue>();
 	TSharedPtr<FJsonValue> NewVal = MakeShareable(new FJsonValueArray(ValueArray));
-	ResultValue->SetRootValue(NewVal);
-
-	return ResultValue;
+	return FSIOJsonWrapperPool::AcquireValue(NewVal);
 }
 
 #if PLATFORM_WINDOWS
@@ -807,8 +806,8 @@ bool USIOJConvert::JsonObjectToUStruct(TSharedPtr<FJsonObject> JsonObject, UStru
 		//Json object we pass will have their trimmed BP names, e.g. boolKey vs boolKey_8_EDBB36654CF43866C376DE921373AF23
 		//so we have to match them to the verbose versions, get a map of the names
 
-		TSharedPtr<FTrimmedKeyMap> KeyMap = MakeShareable(new FTrimmedKeyMap);
-		SetTrimmedKeyMapForStruct(KeyMap, Struct);
+		//built once per struct and cached with its plan
+		TSharedPtr<FTrimmedKeyMap> KeyMap = FSIOJStructPlan::Get(Struct, true)->GetTrimmedKeyMap();
 
 		//Print our keymap for debug
 		//UE_LOG(LogTemp, Log, TEXT("Keymap: %s"), *KeyMap->ToString());
@@ -855,21 +854,8 @@ bool USIOJConvert::ToJsonFile(const FString& FilePath, UStruct* Struct, void* St
 
 bool USIOJConvert::StructToBytes(UStruct* Struct, void* StructPtr, TArray<uint8>& OutBytes, bool IsBlueprintStruct)
 {
-	//Get json object with trimmed values
-	TSharedPtr<FJsonObject> JsonObject = ToJsonObject(Struct, StructPtr, IsBlueprintStruct);
-	TSharedPtr<FJsonValue> TrimmedValue = MakeShareable(new FJsonValueObject(JsonObject));
-
-	if (IsBlueprintStruct)
-	{
-		TrimValueKeyNames(TrimmedValue);
-	}
-
-	//Convert to string
-	FString JsonString = ToJsonString(TrimmedValue);
-	FTCHARToUTF8 Utf8String(*JsonString);
-
-	OutBytes.Append((uint8*)Utf8String.Get(), Utf8String.Length());
-
+	//Written straight from struct memory by the cached plan, keys come out trimmed for BP structs
+	FSIOJStructPlan::Get(Struct, IsBlueprintStruct)->Write(StructPtr, OutBytes);
 	return true;
 }
 
@@ -880,7 +866,26 @@ bool USIOJConvert::BytesToStruct(const TArray<uint8>& InBytes, UStruct* Struct,
 	FFileHelper::BufferToString(JsonString, InBytes.GetData(), InBytes.Num());
 
 	//Read into struct
-	return JsonObjectToUStruct(ToJsonObject(JsonString), Struct, StructPtr, IsBlueprintStruct);
+	return FSIOJStructPlan::Get(Struct, IsBlueprintStruct)->Read(JsonString, StructPtr);
+}
+
+bool USIOJConvert::StructToCompactBytes(UStruct* Struct, const void* StructPtr, TArray<uint8>& OutBytes)
+{
+	if (!Struct || !StructPtr)
+	{
+		return false;
+	}
+	FSIOJStructPlan::Get(Struct)->WriteCompact(StructPtr, OutBytes);
+	return true;
+}
+
+bool USIOJConvert::CompactBytesToStruct(TArrayView<const uint8> InBytes, UStruct* Struct, void* StructPtr)
+{
+	if (!Struct || !StructPtr)
+	{
+		return false;
+	}
+	return FSIOJStructPlan::Get(Struct)->ReadCompact(InBytes, StructPtr);
 }
 
 void USIOJConvert::TrimValueKeyNames(const TSharedPtr<FJsonValue>& JsonValue)
@@ -1053,12 +1058,9 @@ void USIOJConvert::ReplaceJsonValueNamesWithMap(TSharedPtr<FJsonValue>& JsonValu
 	{
 		//Go through each key in the object
 		auto Object = JsonValue->AsObject();
-		auto SubMap = KeyMap->SubMap;
+		const TMap<FString, TSharedPtr<FTrimmedKeyMap>>& SubMap = KeyMap->SubMap;
 		auto AllValues = Object->Values;
 
-		FString PreviewPreValue = USIOJConvert::ToJsonString(Object);
-		//UE_LOG(LogTemp, Log, TEXT("Rep::PreObject: <%s>"), *PreviewPreValue);
-
 		for (auto Pair : AllValues)
 		{
 			if (SubMap.Contains(TMAP_STRING))
@@ -1083,9 +1085,6 @@ void USIOJConvert::ReplaceJsonValueNamesWithMap(TSharedPtr<FJsonValue>& JsonValu
 				}
 			}
 		}
-
-		FString PreviewPostValue = USIOJConvert::ToJsonString(Object);
-		//UE_LOG(LogTemp, Log, TEXT("Rep::PostObject: <%s>"), *PreviewPostValue);
 	}
 	else if (JsonValue->Type == EJson::Array)
 	{
@@ -0,0 +1,1838 @@
+// Copyright 2018-current Getnamo. All Rights Reserved
+
+#include "SIOJStructPlan.h"
+#include "SIOJConvert.h"
+#include "SIOJsonValue.h"
+#include "ISIOJson.h"
+#include "JsonObjectConverter.h"
+#include "JsonObjectWrapper.h"
+#include "Misc/Base64.h"
+#include "Misc/ScopeRWLock.h"
+#include "Misc/Crc.h"
+#include "Engine/UserDefinedStruct.h"
+#include "Serialization/JsonSerializer.h"
+#include "UObject/EnumProperty.h"
+#include "UObject/TextProperty.h"
+
+namespace
+{
+	FRWLock PlanLock;
+	TMap<TPair<const UStruct*, bool>, FSIOJStructPlan::FPlanPtr> PlanCache;
+
+	void AppendAscii(TArray<uint8>& Out, const ANSICHAR* Text)
+	{
+		Out.Append((const uint8*)Text, FCStringAnsi::Strlen(Text));
+	}
+
+	void AppendString(TArray<uint8>& Out, const TCHAR* Chars, int32 Length)
+	{
+		FTCHARToUTF8 Utf8(Chars, Length);
+		const uint8* Bytes = (const uint8*)Utf8.Get();
+		const int32 NumBytes = Utf8.Length();
+
+		Out.Add('"');
+		int32 RunStart = 0;
+		for (int32 i = 0; i < NumBytes; i++)
+		{
+			const uint8 Byte = Bytes[i];
+			if (Byte >= 0x20 && Byte != '"' && Byte != '\\')
+			{
+				continue;
+			}
+			Out.Append(Bytes + RunStart, i - RunStart);
+			RunStart = i + 1;
+
+			switch (Byte)
+			{
+			case '"':	AppendAscii(Out, "\\\"");	break;
+			case '\\':	AppendAscii(Out, "\\\\");	break;
+			case '\b':	AppendAscii(Out, "\\b");	break;
+			case '\f':	AppendAscii(Out, "\\f");	break;
+			case '\n':	AppendAscii(Out, "\\n");	break;
+			case '\r':	AppendAscii(Out, "\\r");	break;
+			case '\t':	AppendAscii(Out, "\\t");	break;
+			default:
+			{
+				ANSICHAR Escaped[8];
+				FCStringAnsi::Snprintf(Escaped, sizeof(Escaped), "\\u%04x", Byte);
+				AppendAscii(Out, Escaped);
+				break;
+			}
+			}
+		}
+		Out.Append(Bytes + RunStart, NumBytes - RunStart);
+		Out.Add('"');
+	}
+
+	void AppendString(TArray<uint8>& Out, const FString& String)
+	{
+		AppendString(Out, *String, String.Len());
+	}
+
+	void AppendInt(TArray<uint8>& Out, int64 Value)
+	{
+		ANSICHAR Text[32];
+		FCStringAnsi::Snprintf(Text, sizeof(Text), "%lld", (long long)Value);
+		AppendAscii(Out, Text);
+	}
+
+	void AppendUInt(TArray<uint8>& Out, uint64 Value)
+	{
+		ANSICHAR Text[32];
+		FCStringAnsi::Snprintf(Text, sizeof(Text), "%llu", (unsigned long long)Value);
+		AppendAscii(Out, Text);
+	}
+
+	//Fewest significant digits from 6 (15 for doubles) up that read back to the same value, so 0.1f is
+	//"0.1" not "0.100000001". 9 and 17 digits always read back. Json has no nan/inf so those become null.
+	void AppendDouble(TArray<uint8>& Out, double Value, bool bSinglePrecision)
+	{
+		if (!FMath::IsFinite(Value))
+		{
+			AppendAscii(Out, "null");
+			return;
+		}
+		ANSICHAR Text[40];
+		const int32 MaxDigits = bSinglePrecision ? 9 : 17;
+		for (int32 Digits = bSinglePrecision ? 6 : 15; Digits <= MaxDigits; Digits++)
+		{
+			FCStringAnsi::Snprintf(Text, sizeof(Text), "%.*g", Digits, Value);
+
+			//readers parse a double and narrow it for float properties
+			const double ReadBack = FCStringAnsi::Atod(Text);
+			if (bSinglePrecision ? (float)ReadBack == (float)Value : ReadBack == Value)
+			{
+				break;
+			}
+		}
+		AppendAscii(Out, Text);
+	}
+
+	void WriteJsonValue(const TSharedPtr<FJsonValue>& Value, TArray<uint8>& Out);
+
+	void WriteJsonObject(const TSharedPtr<FJsonObject>& Object, TArray<uint8>& Out)
+	{
+		if (!Object.IsValid())
+		{
+			AppendAscii(Out, "null");
+			return;
+		}
+		Out.Add('{');
+		bool bFirst = true;
+		for (const TPair<FString, TSharedPtr<FJsonValue>>& Pair : Object->Values)
+		{
+			if (!bFirst)
+			{
+				Out.Add(',');
+			}
+			bFirst = false;
+			AppendString(Out, Pair.Key);
+			Out.Add(':');
+			WriteJsonValue(Pair.Value, Out);
+		}
+		Out.Add('}');
+	}
+
+	void WriteJsonValue(const TSharedPtr<FJsonValue>& Value, TArray<uint8>& Out)
+	{
+		if (!Value.IsValid())
+		{
+			AppendAscii(Out, "null");
+			return;
+		}
+
+		switch (Value->Type)
+		{
+		case EJson::String:
+			//binaries read as base64
+			AppendString(Out, Value->AsString());
+			break;
+		case EJson::Number:
+			AppendDouble(Out, Value->AsNumber(), false);
+			break;
+		case EJson::Boolean:
+			AppendAscii(Out, Value->AsBool() ? "true" : "false");
+			break;
+		case EJson::Array:
+		{
+			Out.Add('[');
+			const TArray<TSharedPtr<FJsonValue>>& Items = Value->AsArray();
+			for (int32 i = 0; i < Items.Num(); i++)
+			{
+				if (i > 0)
+				{
+					Out.Add(',');
+				}
+				WriteJsonValue(Items[i], Out);
+			}
+			Out.Add(']');
+			break;
+		}
+		case EJson::Object:
+			WriteJsonObject(Value->AsObject(), Out);
+			break;
+		default:
+			AppendAscii(Out, "null");
+			break;
+		}
+	}
+
+	//Rebuilds the value the reader is sitting on for FJsonObjectConverter
+	TSharedPtr<FJsonValue> ReadJsonValue(TJsonReader<TCHAR>& Reader, EJsonNotation Notation)
+	{
+		switch (Notation)
+		{
+		case EJsonNotation::ObjectStart:
+		{
+			TSharedPtr<FJsonObject> Object = MakeShared<FJsonObject>();
+			while (Reader.ReadNext(Notation))
+			{
+				if (Notation == EJsonNotation::ObjectEnd)
+				{
+					return MakeShared<FJsonValueObject>(Object);
+				}
+				const FString Key = Reader.GetIdentifier();
+				TSharedPtr<FJsonValue> Value = ReadJsonValue(Reader, Notation);
+				if (!Value.IsValid())
+				{
+					return nullptr;
+				}
+				Object->SetField(Key, Value);
+			}
+			return nullptr;
+		}
+		case EJsonNotation::ArrayStart:
+		{
+			TArray<TSharedPtr<FJsonValue>> Items;
+			while (Reader.ReadNext(Notation))
+			{
+				if (Notation == EJsonNotation::ArrayEnd)
+				{
+					return MakeShared<FJsonValueArray>(Items);
+				}
+				TSharedPtr<FJsonValue> Value = ReadJsonValue(Reader, Notation);
+				if (!Value.IsValid())
+				{
+					return nullptr;
+				}
+				Items.Add(Value);
+			}
+			return nullptr;
+		}
+		case EJsonNotation::String:
+			return MakeShared<FJsonValueString>(Reader.GetValueAsString());
+		case EJsonNotation::Number:
+			return MakeShared<FJsonValueNumber>(Reader.GetValueAsNumber());
+		case EJsonNotation::Boolean:
+			return MakeShared<FJsonValueBoolean>(Reader.GetValueAsBoolean());
+		case EJsonNotation::Null:
+			return MakeShared<FJsonValueNull>();
+		default:
+			return nullptr;
+		}
+	}
+
+	bool SkipValue(TJsonReader<TCHAR>& Reader, EJsonNotation Notation)
+	{
+		switch (Notation)
+		{
+		case EJsonNotation::ObjectStart:
+			return Reader.SkipObject();
+		case EJsonNotation::ArrayStart:
+			return Reader.SkipArray();
+		case EJsonNotation::Error:
+			return false;
+		default:
+			return true;
+		}
+	}
+
+	bool IsIntegerText(const FString& Text)
+	{
+		int32 Index;
+		return !Text.FindChar(TEXT('.'), Index) && !Text.FindChar(TEXT('e'), Index) && !Text.FindChar(TEXT('E'), Index);
+	}
+
+	int64 FindEnumValue(const UEnum* Enum, const FString& Name)
+	{
+		int64 Value = Enum->GetValueByNameString(Name);
+		if (Value != INDEX_NONE)
+		{
+			return Value;
+		}
+
+		//blueprint enums are written by display name
+		for (int32 i = 0; i < Enum->NumEnums(); i++)
+		{
+			if (Enum->GetAuthoredNameStringByIndex(i) == Name || Enum->GetDisplayNameTextByIndex(i).ToString() == Name)
+			{
+				return Enum->GetValueByIndex(i);
+			}
+		}
+		return Name.IsNumeric() ? FCString::Atoi64(*Name) : INDEX_NONE;
+	}
+
+	//e.g. myVar_2_5E3A29B14F5AE1A2B43DF4A67C9A8B12, the name blueprint struct fields get internally
+	bool IsGeneratedFieldName(const FString& Key)
+	{
+		const int32 GuidStart = Key.Find(TEXT("_"), ESearchCase::CaseSensitive, ESearchDir::FromEnd);
+		if (GuidStart < 0 || Key.Len() - GuidStart - 1 != 32)
+		{
+			return false;
+		}
+		for (int32 i = GuidStart + 1; i < Key.Len(); i++)
+		{
+			if (!FChar::IsHexDigit(Key[i]))
+			{
+				return false;
+			}
+		}
+		const int32 IndexStart = Key.Find(TEXT("_"), ESearchCase::CaseSensitive, ESearchDir::FromEnd, GuidStart);
+		if (IndexStart <= 0 || IndexStart + 1 == GuidStart)
+		{
+			return false;
+		}
+		for (int32 i = IndexStart + 1; i < GuidStart; i++)
+		{
+			if (!FChar::IsDigit(Key[i]))
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+
+	void AppendVarint(TArray<uint8>& Out, uint64 Value)
+	{
+		while (Value >= 0x80)
+		{
+			Out.Add((uint8)(Value | 0x80));
+			Value >>= 7;
+		}
+		Out.Add((uint8)Value);
+	}
+
+	uint64 ZigZag(int64 Value)
+	{
+		return ((uint64)Value << 1) ^ (uint64)(Value >> 63);
+	}
+
+	int64 UnZigZag(uint64 Value)
+	{
+		return (int64)(Value >> 1) ^ -(int64)(Value & 1);
+	}
+
+	void AppendFixed(TArray<uint8>& Out, uint64 Value, int32 NumBytes)
+	{
+		for (int32 i = 0; i < NumBytes; i++)
+		{
+			Out.Add((uint8)(Value >> (i * 8)));
+		}
+	}
+
+	void AppendCompactBytes(TArray<uint8>& Out, const uint8* Bytes, int32 NumBytes)
+	{
+		AppendVarint(Out, NumBytes);
+		Out.Append(Bytes, NumBytes);
+	}
+
+	void AppendCompactString(TArray<uint8>& Out, const TCHAR* Chars, int32 Length)
+	{
+		FTCHARToUTF8 Utf8(Chars, Length);
+		AppendCompactBytes(Out, (const uint8*)Utf8.Get(), Utf8.Length());
+	}
+
+	void AppendCompactString(TArray<uint8>& Out, const FString& String)
+	{
+		AppendCompactString(Out, *String, String.Len());
+	}
+
+	//Length prefix for a body already written from Start, the body's size isn't known up front
+	void InsertLength(TArray<uint8>& Out, int32 Start)
+	{
+		uint8 Prefix[10];
+		int32 PrefixLength = 0;
+		uint64 Length = Out.Num() - Start;
+		while (Length >= 0x80)
+		{
+			Prefix[PrefixLength++] = (uint8)(Length | 0x80);
+			Length >>= 7;
+		}
+		Prefix[PrefixLength++] = (uint8)Length;
+		Out.Insert(Prefix, PrefixLength, Start);
+	}
+
+	TSharedPtr<FJsonValue> ParseJsonValue(const uint8* Utf8, int64 Length)
+	{
+		FUTF8ToTCHAR Json((const ANSICHAR*)Utf8, Length);
+		TSharedRef<TJsonReader<TCHAR>> Reader = TJsonReaderFactory<TCHAR>::CreateFromView(FStringView(Json.Get(), Json.Length()));
+		TSharedPtr<FJsonValue> Value;
+		FJsonSerializer::Deserialize(Reader, Value);
+		return Value;
+	}
+}
+
+struct FSIOJStructPlan::FCompactReader
+{
+	const uint8* Data;
+	int64 Size;
+	int64 Pos = 0;
+
+	/** A field had a different wire type or value than this struct version expects, it was skipped */
+	bool bMismatch = false;
+
+	bool ReadVarint(uint64& OutValue)
+	{
+		OutValue = 0;
+		for (int32 Shift = 0; Shift < 64 && Pos < Size; Shift += 7)
+		{
+			const uint8 Byte = Data[Pos++];
+			OutValue |= (uint64)(Byte & 0x7F) << Shift;
+			if (!(Byte & 0x80))
+			{
+				return true;
+			}
+		}
+		return false;
+	}
+
+	bool ReadFixed(uint64& OutValue, int32 NumBytes)
+	{
+		if (Pos + NumBytes > Size)
+		{
+			return false;
+		}
+		OutValue = 0;
+		for (int32 i = 0; i < NumBytes; i++)
+		{
+			OutValue |= (uint64)Data[Pos++] << (i * 8);
+		}
+		return true;
+	}
+
+	/** Reads a length prefix, OutEnd is where the body ends */
+	bool ReadLength(int64& OutEnd)
+	{
+		uint64 Length;
+		if (!ReadVarint(Length) || Length > (uint64)(Size - Pos))
+		{
+			return false;
+		}
+		OutEnd = Pos + (int64)Length;
+		return true;
+	}
+
+	bool ReadString(FString& OutString)
+	{
+		int64 End;
+		if (!ReadLength(End))
+		{
+			return false;
+		}
+		FUTF8ToTCHAR Chars((const ANSICHAR*)Data + Pos, End - Pos);
+		OutString = FString::ConstructFromPtrSize(Chars.Get(), Chars.Length());
+		Pos = End;
+		return true;
+	}
+
+	bool Skip(EWireType WireType)
+	{
+		uint64 Ignored;
+		int64 End;
+		switch (WireType)
+		{
+		case EWireType::Varint:
+			return ReadVarint(Ignored);
+		case EWireType::Fixed64:
+			return ReadFixed(Ignored, 8);
+		case EWireType::Fixed32:
+			return ReadFixed(Ignored, 4);
+		default:
+			if (!ReadLength(End))
+			{
+				return false;
+			}
+			Pos = End;
+			return true;
+		}
+	}
+};
+
+struct FSIOJStructPlan::FReadContext
+{
+	TJsonReader<TCHAR>& Reader;
+
+	/** A field had json it couldn't be read from, it was skipped */
+	bool bMismatch = false;
+};
+
+FSIOJStructPlan::FSIOJStructPlan(const UStruct* InStruct, bool bInBlueprintStruct)
+	: Struct(InStruct)
+	, bBlueprintStruct(bInBlueprintStruct)
+{
+}
+
+FSIOJStructPlan::~FSIOJStructPlan()
+{
+}
+
+FSIOJStructPlan::FPlanPtr FSIOJStructPlan::Get(const UStruct* Struct, bool bBlueprintStruct)
+{
+	TArray<const UStruct*> Building;
+	return GetInternal(Struct, bBlueprintStruct, Building);
+}
+
+FSIOJStructPlan::FPlanPtr FSIOJStructPlan::GetInternal(const UStruct* Struct, bool bBlueprintStruct, TArray<const UStruct*>& Building)
+{
+	const TPair<const UStruct*, bool> Key(Struct, bBlueprintStruct);
+	{
+		FReadScopeLock ReadLock(PlanLock);
+		const FPlanPtr* Found = PlanCache.Find(Key);
+		if (Found && (*Found)->IsCurrent())
+		{
+			return *Found;
+		}
+	}
+
+	//built without the lock, sub struct plans come from this cache too
+	TSharedPtr<FSIOJStructPlan, ESPMode::ThreadSafe> Plan = MakeShareable(new FSIOJStructPlan(Struct, bBlueprintStruct));
+	Building.Push(Struct);
+	Plan->Build(Building);
+	Building.Pop();
+
+	FWriteScopeLock WriteLock(PlanLock);
+	PlanCache.Add(Key, Plan);
+	return Plan;
+}
+
+FSIOJStructPlan::FStamp FSIOJStructPlan::MakeStamp(const UStruct* Struct)
+{
+	FStamp Stamp;
+	Stamp.Struct = Struct;
+	Stamp.FirstProperty = Struct->ChildProperties;
+	Stamp.PropertiesSize = Struct->GetPropertiesSize();
+	return Stamp;
+}
+
+bool FSIOJStructPlan::IsCurrent() const
+{
+	for (const FStamp& Stamp : Stamps)
+	{
+		const UStruct* Current = Stamp.Struct.Get();
+		if (!Current || Current->ChildProperties != Stamp.FirstProperty || Current->GetPropertiesSize() != Stamp.PropertiesSize)
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+void FSIOJStructPlan::Build(TArray<const UStruct*>& Building)
+{
+	Stamps.Add(MakeStamp(Struct));
+
+	if (Struct == FJsonObjectWrapper::StaticStruct())
+	{
+		bUseConverter = true;
+		return;
+	}
+
+	const bool bUserDefinedStruct = Struct->IsA<UUserDefinedStruct>();
+	for (TFieldIterator<FProperty> It(Struct); It; ++It)
+	{
+		FProperty* Property = *It;
+
+		//same key FJsonObjectConverter writes, blueprint structs lose their generated suffix like TrimKey
+		FString Key = FJsonObjectConverter::StandardizeCase(Property->GetAuthoredName());
+		FString TrimmedKey;
+		if (bBlueprintStruct && IsGeneratedFieldName(Key) && USIOJConvert::TrimKey(Key, TrimmedKey))
+		{
+			Key = TrimmedKey;
+		}
+
+		const int32 FieldIndex = Fields.Num();
+		FFieldPlan& Field = Fields.AddDefaulted_GetRef();
+		AppendString(Field.QuotedKey, Key);
+		Field.QuotedKey.Add(':');
+		Field.Offset = Property->GetOffset_ForInternal();
+		Field.ArrayDim = Property->ArrayDim;
+		Field.ElementSize = Property->GetElementSize();
+		BuildCodec(Property, Field.Codec, Building);
+
+		FieldIndices.Add(Key, FieldIndex);
+
+		//Blueprint struct ids hash the name the user typed, the generated suffix changes whenever the field
+		//is recreated and a non UE peer can't derive it
+		FString CompactKey = Key;
+		if (bUserDefinedStruct && IsGeneratedFieldName(CompactKey) && USIOJConvert::TrimKey(CompactKey, TrimmedKey))
+		{
+			CompactKey = TrimmedKey;
+		}
+
+		//18 bit ids keep most tags at three bytes, a collision drops the later field from the compact format
+		const uint32 CompactId = FCrc::StrCrc32(*CompactKey) % 0x3FFFF + 1;
+		if (const int32* Existing = CompactIndices.Find(CompactId))
+		{
+			UE_LOG(LogSIOJ, Warning, TEXT("FSIOJStructPlan: %s.%s has the same compact id as %s and is left out of compact bytes, rename one of them"),
+				*Struct->GetName(), *Key, *Fields[*Existing].Codec.Property->GetName());
+		}
+		else
+		{
+			CompactIndices.Add(CompactId, FieldIndex);
+			Field.CompactTag = (CompactId << 3) | (uint32)GetWireType(Field.Codec, Field.ArrayDim);
+		}
+		if (bBlueprintStruct)
+		{
+			//json written with the internal names still reads
+			const FString LongKey = FJsonObjectConverter::StandardizeCase(Property->GetName());
+			FieldIndices.FindOrAdd(LongKey, FieldIndex);
+			if (USIOJConvert::TrimKey(LongKey, TrimmedKey))
+			{
+				FieldIndices.FindOrAdd(TrimmedKey, FieldIndex);
+			}
+		}
+	}
+}
+
+void FSIOJStructPlan::BuildCodec(FProperty* Property, FCodec& OutCodec, TArray<const UStruct*>& Building)
+{
+	OutCodec.Property = Property;
+
+	auto BuildInner = [&](FProperty* InnerProperty, TUniquePtr<FCodec>& OutInner)
+	{
+		OutInner = MakeUnique<FCodec>();
+		BuildCodec(InnerProperty, *OutInner, Building);
+	};
+
+	if (FEnumProperty* EnumProperty = CastField<FEnumProperty>(Property))
+	{
+		OutCodec.Kind = EKind::Enum;
+		OutCodec.Numeric = EnumProperty->GetUnderlyingProperty();
+		OutCodec.Enum = EnumProperty->GetEnum();
+	}
+	else if (FNumericProperty* NumericProperty = CastField<FNumericProperty>(Property))
+	{
+		OutCodec.Numeric = NumericProperty;
+		if (UEnum* Enum = NumericProperty->GetIntPropertyEnum())
+		{
+			OutCodec.Enum = Enum;
+			OutCodec.Kind = (bBlueprintStruct && Property->IsA<FByteProperty>()) ? EKind::EnumDisplayName : EKind::Enum;
+		}
+		else if (NumericProperty->IsFloatingPoint())
+		{
+			OutCodec.Kind = Property->IsA<FFloatProperty>() ? EKind::Float : EKind::Double;
+		}
+		else if (Property->IsA<FUInt64Property>())
+		{
+			OutCodec.Kind = EKind::UInt;
+		}
+		else if (NumericProperty->IsInteger())
+		{
+			OutCodec.Kind = EKind::Int;
+		}
+	}
+	else if (Property->IsA<FBoolProperty>())
+	{
+		OutCodec.Kind = EKind::Bool;
+	}
+	else if (Property->IsA<FStrProperty>())
+	{
+		OutCodec.Kind = EKind::String;
+	}
+	else if (Property->IsA<FNameProperty>())
+	{
+		OutCodec.Kind = EKind::Name;
+	}
+	else if (Property->IsA<FTextProperty>())
+	{
+		OutCodec.Kind = EKind::Text;
+	}
+	else if (FArrayProperty* ArrayProperty = CastField<FArrayProperty>(Property))
+	{
+		OutCodec.Kind = (bBlueprintStruct && ArrayProperty->Inner->IsA<FByteProperty>()) ? EKind::Bytes : EKind::Array;
+		BuildInner(ArrayProperty->Inner, OutCodec.Inner);
+	}
+	else if (FSetProperty* SetProperty = CastField<FSetProperty>(Property))
+	{
+		OutCodec.Kind = EKind::Set;
+		BuildInner(SetProperty->ElementProp, OutCodec.Inner);
+	}
+	else if (FMapProperty* MapProperty = CastField<FMapProperty>(Property))
+	{
+		OutCodec.Kind = EKind::Map;
+		BuildInner(MapProperty->KeyProp, OutCodec.Key);
+		BuildInner(MapProperty->ValueProp, OutCodec.Inner);
+	}
+	else if (FStructProperty* StructProperty = CastField<FStructProperty>(Property))
+	{
+		UScriptStruct::ICppStructOps* StructOps = StructProperty->Struct->GetCppStructOps();
+		if (StructProperty->Struct != FJsonObjectWrapper::StaticStruct() && StructOps && StructOps->HasExportTextItem())
+		{
+			OutCodec.Kind = EKind::ExportText;
+		}
+		else
+		{
+			OutCodec.Kind = EKind::Struct;
+			if (Building.Contains(StructProperty->Struct))
+			{
+				OutCodec.RecursiveStruct = StructProperty->Struct;
+			}
+			else
+			{
+				OutCodec.StructPlan = GetInternal(StructProperty->Struct, bBlueprintStruct, Building);
+				for (const FStamp& Stamp : OutCodec.StructPlan->Stamps)
+				{
+					if (!Stamps.ContainsByPredicate([&Stamp](const FStamp& Existing) { return Existing.Struct == Stamp.Struct; }))
+					{
+						Stamps.Add(Stamp);
+					}
+				}
+			}
+		}
+	}
+}
+
+TSharedPtr<FTrimmedKeyMap> FSIOJStructPlan::GetTrimmedKeyMap() const
+{
+	FScopeLock Lock(&KeyMapSection);
+	if (!TrimmedKeyMap.IsValid())
+	{
+		TrimmedKeyMap = MakeShareable(new FTrimmedKeyMap);
+		USIOJConvert::SetTrimmedKeyMapForStruct(TrimmedKeyMap, const_cast<UStruct*>(Struct));
+	}
+	return TrimmedKeyMap;
+}
+
+void FSIOJStructPlan::Write(const void* StructPtr, TArray<uint8>& OutUtf8) const
+{
+	const int32 Start = OutUtf8.Num();
+	OutUtf8.Reserve(Start + LastWriteSize.load(std::memory_order_relaxed));
+
+	WriteStruct(StructPtr, OutUtf8);
+
+	LastWriteSize.store(OutUtf8.Num() - Start, std::memory_order_relaxed);
+}
+
+void FSIOJStructPlan::WriteStruct(const void* StructPtr, TArray<uint8>& Out) const
+{
+	if (bUseConverter)
+	{
+		TSharedRef<FJsonObject> Object = MakeShared<FJsonObject>();
+		FJsonObjectConverter::UStructToJsonObject(Struct, StructPtr, Object, 0, 0);
+		WriteJsonObject(Object, Out);
+		return;
+	}
+
+	Out.Add('{');
+	for (int32 i = 0; i < Fields.Num(); i++)
+	{
+		if (i > 0)
+		{
+			Out.Add(',');
+		}
+		WriteField(Fields[i], (const uint8*)StructPtr + Fields[i].Offset, Out);
+	}
+	Out.Add('}');
+}
+
+void FSIOJStructPlan::WriteField(const FFieldPlan& Field, const uint8* FieldPtr, TArray<uint8>& Out) const
+{
+	Out.Append(Field.QuotedKey);
+
+	//the converter handles static arrays itself
+	if (Field.ArrayDim == 1 || Field.Codec.Kind == EKind::Converter)
+	{
+		WriteValue(Field.Codec, FieldPtr, Out);
+		return;
+	}
+
+	Out.Add('[');
+	for (int32 Index = 0; Index < Field.ArrayDim; Index++)
+	{
+		if (Index > 0)
+		{
+			Out.Add(',');
+		}
+		WriteValue(Field.Codec, FieldPtr + Index * Field.ElementSize, Out);
+	}
+	Out.Add(']');
+}
+
+bool FSIOJStructPlan::WriteDelta(const void* StructPtr, const void* BasePtr, TArray<uint8>& OutUtf8) const
+{
+	return WriteDeltaStruct(StructPtr, BasePtr, OutUtf8);
+}
+
+bool FSIOJStructPlan::WriteDeltaStruct(const void* StructPtr, const void* BasePtr, TArray<uint8>& Out) const
+{
+	if (bUseConverter)
+	{
+		const UScriptStruct* ScriptStruct = Cast<UScriptStruct>(Struct);
+		if (ScriptStruct && ScriptStruct->CompareScriptStruct(StructPtr, BasePtr, PPF_None))
+		{
+			AppendAscii(Out, "{}");
+			return false;
+		}
+		WriteStruct(StructPtr, Out);
+		return true;
+	}
+
+	bool bChanged = false;
+	Out.Add('{');
+	for (const FFieldPlan& Field : Fields)
+	{
+		const uint8* FieldPtr = (const uint8*)StructPtr + Field.Offset;
+		const uint8* BaseFieldPtr = (const uint8*)BasePtr + Field.Offset;
+		const int32 Mark = Out.Num();
+
+		//nested structs only carry their own changed fields
+		if (Field.ArrayDim == 1 && Field.Codec.Kind == EKind::Struct)
+		{
+			if (bChanged)
+			{
+				Out.Add(',');
+			}
+			Out.Append(Field.QuotedKey);
+			const FSIOJStructPlan* SubPlan = Field.Codec.StructPlan.IsValid() ? Field.Codec.StructPlan.Get() : nullptr;
+			FPlanPtr RecursivePlan;
+			if (!SubPlan)
+			{
+				RecursivePlan = Get(Field.Codec.RecursiveStruct, bBlueprintStruct);
+				SubPlan = RecursivePlan.Get();
+			}
+			if (SubPlan->WriteDeltaStruct(FieldPtr, BaseFieldPtr, Out))
+			{
+				bChanged = true;
+			}
+			else
+			{
+				Out.SetNum(Mark, EAllowShrinking::No);
+			}
+			continue;
+		}
+
+		bool bIdentical = true;
+		for (int32 Index = 0; Index < Field.ArrayDim && bIdentical; Index++)
+		{
+			bIdentical = Field.Codec.Property->Identical(FieldPtr + Index * Field.ElementSize, BaseFieldPtr + Index * Field.ElementSize, PPF_None);
+		}
+		if (bIdentical)
+		{
+			continue;
+		}
+
+		if (bChanged)
+		{
+			Out.Add(',');
+		}
+		WriteField(Field, FieldPtr, Out);
+		bChanged = true;
+	}
+	Out.Add('}');
+	return bChanged;
+}
+
+void FSIOJStructPlan::WriteValue(const FCodec& Codec, const void* Value, TArray<uint8>& Out) const
+{
+	switch (Codec.Kind)
+	{
+	case EKind::Bool:
+		AppendAscii(Out, CastField<FBoolProperty>(Codec.Property)->GetPropertyValue(Value) ? "true" : "false");
+		break;
+	case EKind::Int:
+		AppendInt(Out, Codec.Numeric->GetSignedIntPropertyValue(Value));
+		break;
+	case EKind::UInt:
+		AppendUInt(Out, Codec.Numeric->GetUnsignedIntPropertyValue(Value));
+		break;
+	case EKind::Float:
+		AppendDouble(Out, Codec.Numeric->GetFloatingPointPropertyValue(Value), true);
+		break;
+	case EKind::Double:
+		AppendDouble(Out, Codec.Numeric->GetFloatingPointPropertyValue(Value), false);
+		break;
+	case EKind::Enum:
+		AppendString(Out, Codec.Enum->GetAuthoredNameStringByValue(Codec.Numeric->GetSignedIntPropertyValue(Value)));
+		break;
+	case EKind::EnumDisplayName:
+		AppendString(Out, Codec.Enum->GetDisplayNameTextByValue(Codec.Numeric->GetSignedIntPropertyValue(Value)).ToString());
+		break;
+	case EKind::String:
+		AppendString(Out, *(const FString*)Value);
+		break;
+	case EKind::Name:
+	{
+		TStringBuilder<128> Name;
+		((const FName*)Value)->AppendString(Name);
+		AppendString(Out, Name.GetData(), Name.Len());
+		break;
+	}
+	case EKind::Text:
+		AppendString(Out, ((const FText*)Value)->ToString());
+		break;
+	case EKind::Array:
+	{
+		FScriptArrayHelper Helper(CastField<FArrayProperty>(Codec.Property), Value);
+		Out.Add('[');
+		for (int32 i = 0; i < Helper.Num(); i++)
+		{
+			if (i > 0)
+			{
+				Out.Add(',');
+			}
+			WriteValue(*Codec.Inner, Helper.GetRawPtr(i), Out);
+		}
+		Out.Add(']');
+		break;
+	}
+	case EKind::Bytes:
+	{
+		FScriptArrayHelper Helper(CastField<FArrayProperty>(Codec.Property), Value);
+		AppendString(Out, FBase64::Encode(Helper.GetRawPtr(), Helper.Num()));
+		break;
+	}
+	case EKind::Set:
+	{
+		FScriptSetHelper Helper(CastField<FSetProperty>(Codec.Property), Value);
+		Out.Add('[');
+		bool bFirst = true;
+		for (int32 i = 0, Remaining = Helper.Num(); Remaining > 0; i++)
+		{
+			if (Helper.IsValidIndex(i))
+			{
+				if (!bFirst)
+				{
+					Out.Add(',');
+				}
+				bFirst = false;
+				WriteValue(*Codec.Inner, Helper.GetElementPtr(i), Out);
+				Remaining--;
+			}
+		}
+		Out.Add(']');
+		break;
+	}
+	case EKind::Map:
+	{
+		FScriptMapHelper Helper(CastField<FMapProperty>(Codec.Property), Value);
+		Out.Add('{');
+		bool bFirst = true;
+		for (int32 i = 0, Remaining = Helper.Num(); Remaining > 0; i++)
+		{
+			if (!Helper.IsValidIndex(i))
+			{
+				continue;
+			}
+			Remaining--;
+
+			//keys as FJsonValue::TryGetString gives them
+			const FCodec& KeyCodec = *Codec.Key;
+			const void* KeyPtr = Helper.GetKeyPtr(i);
+			FString KeyString;
+			switch (KeyCodec.Kind)
+			{
+			case EKind::Bool:
+				KeyString = CastField<FBoolProperty>(KeyCodec.Property)->GetPropertyValue(KeyPtr) ? TEXT("true") : TEXT("false");
+				break;
+			case EKind::Int:
+				KeyString = LexToString(KeyCodec.Numeric->GetSignedIntPropertyValue(KeyPtr));
+				break;
+			case EKind::UInt:
+				KeyString = LexToString(KeyCodec.Numeric->GetUnsignedIntPropertyValue(KeyPtr));
+				break;
+			case EKind::Float:
+			case EKind::Double:
+				KeyString = FString::SanitizeFloat(KeyCodec.Numeric->GetFloatingPointPropertyValue(KeyPtr), 0);
+				break;
+			case EKind::Enum:
+				KeyString = KeyCodec.Enum->GetAuthoredNameStringByValue(KeyCodec.Numeric->GetSignedIntPropertyValue(KeyPtr));
+				break;
+			case EKind::EnumDisplayName:
+				KeyString = KeyCodec.Enum->GetDisplayNameTextByValue(KeyCodec.Numeric->GetSignedIntPropertyValue(KeyPtr)).ToString();
+				break;
+			case EKind::String:
+				KeyString = *(const FString*)KeyPtr;
+				break;
+			case EKind::Name:
+				KeyString = ((const FName*)KeyPtr)->ToString();
+				break;
+			case EKind::Text:
+				KeyString = ((const FText*)KeyPtr)->ToString();
+				break;
+			default:
+				KeyCodec.Property->ExportTextItem_Direct(KeyString, KeyPtr, nullptr, nullptr, PPF_None);
+				break;
+			}
+
+			if (!bFirst)
+			{
+				Out.Add(',');
+			}
+			bFirst = false;
+			AppendString(Out, KeyString);
+			Out.Add(':');
+			WriteValue(*Codec.Inner, Helper.GetValuePtr(i), Out);
+		}
+		Out.Add('}');
+		break;
+	}
+	case EKind::Struct:
+		if (Codec.StructPlan.IsValid())
+		{
+			Codec.StructPlan->WriteStruct(Value, Out);
+		}
+		else
+		{
+			Get(Codec.RecursiveStruct, bBlueprintStruct)->WriteStruct(Value, Out);
+		}
+		break;
+	case EKind::ExportText:
+	{
+		FString Exported;
+		CastField<FStructProperty>(Codec.Property)->Struct->GetCppStructOps()->ExportTextItem(Exported, Value, nullptr, nullptr, PPF_None, nullptr);
+		AppendString(Out, Exported);
+		break;
+	}
+	default:
+		WriteJsonValue(FJsonObjectConverter::UPropertyToJsonValue(Codec.Property, Value, 0, 0), Out);
+		break;
+	}
+}
+
+bool FSIOJStructPlan::Read(FStringView Json, void* StructPtr) const
+{
+	auto Reader = TJsonReaderFactory<TCHAR>::CreateFromView(Json);
+	FReadContext Context{ *Reader };
+
+	EJsonNotation Notation;
+	if (!Reader->ReadNext(Notation) || Notation != EJsonNotation::ObjectStart || !ReadStruct(Context, StructPtr))
+	{
+		UE_LOG(LogSIOJ, Warning, TEXT("FSIOJStructPlan: invalid json for %s. %s"), *Struct->GetName(), *Reader->GetErrorMessage());
+		return false;
+	}
+	return !Context.bMismatch;
+}
+
+bool FSIOJStructPlan::ReadStruct(FReadContext& Context, void* StructPtr) const
+{
+	TJsonReader<TCHAR>& Reader = Context.Reader;
+
+	if (bUseConverter)
+	{
+		TSharedPtr<FJsonValue> Value = ReadJsonValue(Reader, EJsonNotation::ObjectStart);
+		if (!Value.IsValid())
+		{
+			return false;
+		}
+		if (!FJsonObjectConverter::JsonObjectToUStruct(Value->AsObject().ToSharedRef(), Struct, StructPtr, 0, 0))
+		{
+			Context.bMismatch = true;
+		}
+		return true;
+	}
+
+	EJsonNotation Notation;
+	while (Reader.ReadNext(Notation))
+	{
+		if (Notation == EJsonNotation::ObjectEnd)
+		{
+			return true;
+		}
+		if (Notation == EJsonNotation::Error)
+		{
+			return false;
+		}
+
+		const int32* FieldIndex = FieldIndices.Find(Reader.GetIdentifier());
+		if (!FieldIndex)
+		{
+			if (!SkipValue(Reader, Notation))
+			{
+				return false;
+			}
+			continue;
+		}
+
+		const FFieldPlan& Field = Fields[*FieldIndex];
+		uint8* FieldPtr = (uint8*)StructPtr + Field.Offset;
+
+		if (Field.ArrayDim == 1 || Field.Codec.Kind == EKind::Converter)
+		{
+			if (!ReadValue(Context, Field.Codec, Notation, FieldPtr))
+			{
+				return false;
+			}
+			continue;
+		}
+
+		if (Notation != EJsonNotation::ArrayStart)
+		{
+			Context.bMismatch = true;
+			if (!SkipValue(Reader, Notation))
+			{
+				return false;
+			}
+			continue;
+		}
+
+		//static array, extra items are dropped
+		for (int32 Index = 0; ; Index++)
+		{
+			if (!Reader.ReadNext(Notation) || Notation == EJsonNotation::Error)
+			{
+				return false;
+			}
+			if (Notation == EJsonNotation::ArrayEnd)
+			{
+				break;
+			}
+			const bool bRead = Index < Field.ArrayDim ?
+				ReadValue(Context, Field.Codec, Notation, FieldPtr + Index * Field.ElementSize) :
+				SkipValue(Reader, Notation);
+			if (!bRead)
+			{
+				return false;
+			}
+		}
+	}
+	return false;
+}
+
+bool FSIOJStructPlan::ReadValue(FReadContext& Context, const FCodec& Codec, EJsonNotation Notation, void* Value) const
+{
+	TJsonReader<TCHAR>& Reader = Context.Reader;
+
+	//null leaves the field as it was
+	if (Notation == EJsonNotation::Null)
+	{
+		return true;
+	}
+
+	bool bRead = false;
+	switch (Codec.Kind)
+	{
+	case EKind::Bool:
+		if (Notation == EJsonNotation::Boolean || Notation == EJsonNotation::Number)
+		{
+			const bool bValue = Notation == EJsonNotation::Boolean ? Reader.GetValueAsBoolean() : Reader.GetValueAsNumber() != 0.0;
+			CastField<FBoolProperty>(Codec.Property)->SetPropertyValue(Value, bValue);
+			bRead = true;
+		}
+		else if (Notation == EJsonNotation::String)
+		{
+			bRead = ReadFromString(Codec, Reader.GetValueAsString(), Value);
+		}
+		break;
+	case EKind::Int:
+	case EKind::UInt:
+	case EKind::Float:
+	case EKind::Double:
+	case EKind::Enum:
+	case EKind::EnumDisplayName:
+		if (Notation == EJsonNotation::Number)
+		{
+			if (Codec.Kind == EKind::Float || Codec.Kind == EKind::Double)
+			{
+				Codec.Numeric->SetFloatingPointPropertyValue(Value, Reader.GetValueAsNumber());
+			}
+			else if (IsIntegerText(Reader.GetValueAsNumberString()))
+			{
+				//exact past 2^53
+				Codec.Numeric->SetNumericPropertyValueFromString(Value, *Reader.GetValueAsNumberString());
+			}
+			else
+			{
+				Codec.Numeric->SetIntPropertyValue(Value, (int64)Reader.GetValueAsNumber());
+			}
+			bRead = true;
+		}
+		else if (Notation == EJsonNotation::String)
+		{
+			bRead = ReadFromString(Codec, Reader.GetValueAsString(), Value);
+		}
+		break;
+	case EKind::String:
+	case EKind::Name:
+	case EKind::Text:
+		if (Notation == EJsonNotation::String)
+		{
+			bRead = ReadFromString(Codec, Reader.GetValueAsString(), Value);
+		}
+		else if (Notation == EJsonNotation::Number)
+		{
+			bRead = ReadFromString(Codec, Reader.GetValueAsNumberString(), Value);
+		}
+		else if (Notation == EJsonNotation::Boolean)
+		{
+			bRead = ReadFromString(Codec, Reader.GetValueAsBoolean() ? TEXT("true") : TEXT("false"), Value);
+		}
+		break;
+	case EKind::Array:
+	case EKind::Bytes:
+		if (Notation == EJsonNotation::String && Codec.Inner->Property->IsA<FByteProperty>())
+		{
+			bRead = ReadFromString(Codec, Reader.GetValueAsString(), Value);
+		}
+		else if (Notation == EJsonNotation::ArrayStart)
+		{
+			FScriptArrayHelper Helper(CastField<FArrayProperty>(Codec.Property), Value);
+			Helper.EmptyValues();
+			while (true)
+			{
+				if (!Reader.ReadNext(Notation) || Notation == EJsonNotation::Error)
+				{
+					return false;
+				}
+				if (Notation == EJsonNotation::ArrayEnd)
+				{
+					break;
+				}
+				const int32 Index = Helper.AddValue();
+				if (!ReadValue(Context, *Codec.Inner, Notation, Helper.GetRawPtr(Index)))
+				{
+					return false;
+				}
+			}
+			return true;
+		}
+		break;
+	case EKind::Set:
+		if (Notation == EJsonNotation::ArrayStart)
+		{
+			FScriptSetHelper Helper(CastField<FSetProperty>(Codec.Property), Value);
+			Helper.EmptyElements();
+			while (true)
+			{
+				if (!Reader.ReadNext(Notation) || Notation == EJsonNotation::Error)
+				{
+					return false;
+				}
+				if (Notation == EJsonNotation::ArrayEnd)
+				{
+					break;
+				}
+				const int32 Index = Helper.AddDefaultValue_Invalid_NeedsRehash();
+				if (!ReadValue(Context, *Codec.Inner, Notation, Helper.GetElementPtr(Index)))
+				{
+					return false;
+				}
+			}
+			Helper.Rehash();
+			return true;
+		}
+		break;
+	case EKind::Map:
+		if (Notation == EJsonNotation::ObjectStart)
+		{
+			FScriptMapHelper Helper(CastField<FMapProperty>(Codec.Property), Value);
+			Helper.EmptyValues();
+			while (true)
+			{
+				if (!Reader.ReadNext(Notation) || Notation == EJsonNotation::Error)
+				{
+					return false;
+				}
+				if (Notation == EJsonNotation::ObjectEnd)
+				{
+					break;
+				}
+				const int32 Index = Helper.AddDefaultValue_Invalid_NeedsRehash();
+				if (!ReadFromString(*Codec.Key, Reader.GetIdentifier(), Helper.GetKeyPtr(Index)))
+				{
+					Context.bMismatch = true;
+				}
+				if (!ReadValue(Context, *Codec.Inner, Notation, Helper.GetValuePtr(Index)))
+				{
+					return false;
+				}
+			}
+			Helper.Rehash();
+			return true;
+		}
+		break;
+	case EKind::Struct:
+		if (Notation == EJsonNotation::ObjectStart)
+		{
+			if (Codec.StructPlan.IsValid())
+			{
+				return Codec.StructPlan->ReadStruct(Context, Value);
+			}
+			return Get(Codec.RecursiveStruct, bBlueprintStruct)->ReadStruct(Context, Value);
+		}
+		else if (Notation == EJsonNotation::String)
+		{
+			bRead = ReadFromString(Codec, Reader.GetValueAsString(), Value);
+		}
+		break;
+	case EKind::ExportText:
+		if (Notation == EJsonNotation::String)
+		{
+			bRead = ReadFromString(Codec, Reader.GetValueAsString(), Value);
+			break;
+		}
+		//objects take the converter path
+		[[fallthrough]];
+	default:
+	{
+		TSharedPtr<FJsonValue> JsonValue = ReadJsonValue(Reader, Notation);
+		if (!JsonValue.IsValid())
+		{
+			return false;
+		}
+		if (!FJsonObjectConverter::JsonValueToUProperty(JsonValue, Codec.Property, Value, 0, 0))
+		{
+			Context.bMismatch = true;
+		}
+		return true;
+	}
+	}
+
+	if (!bRead)
+	{
+		UE_LOG(LogSIOJ, Warning, TEXT("FSIOJStructPlan: json for %s doesn't fit its type, ignored"), *Codec.Property->GetName());
+		Context.bMismatch = true;
+		return SkipValue(Reader, Notation);
+	}
+	return true;
+}
+
+bool FSIOJStructPlan::ReadFromString(const FCodec& Codec, const FString& String, void* Value) const
+{
+	switch (Codec.Kind)
+	{
+	case EKind::Bool:
+		CastField<FBoolProperty>(Codec.Property)->SetPropertyValue(Value, FCString::ToBool(*String));
+		return true;
+	case EKind::Int:
+	case EKind::UInt:
+	case EKind::Float:
+	case EKind::Double:
+		Codec.Numeric->SetNumericPropertyValueFromString(Value, *String);
+		return true;
+	case EKind::Enum:
+	case EKind::EnumDisplayName:
+	{
+		const int64 EnumValue = FindEnumValue(Codec.Enum, String);
+		if (EnumValue == INDEX_NONE)
+		{
+			return false;
+		}
+		Codec.Numeric->SetIntPropertyValue(Value, EnumValue);
+		return true;
+	}
+	case EKind::String:
+		*(FString*)Value = String;
+		return true;
+	case EKind::Name:
+		*(FName*)Value = FName(*String);
+		return true;
+	case EKind::Text:
+		*(FText*)Value = FText::FromString(String);
+		return true;
+	case EKind::Array:
+	case EKind::Bytes:
+	{
+		TArray<uint8> Bytes;
+		if (!Codec.Inner->Property->IsA<FByteProperty>() || !FBase64::Decode(String, Bytes))
+		{
+			return false;
+		}
+		FScriptArrayHelper Helper(CastField<FArrayProperty>(Codec.Property), Value);
+		Helper.EmptyAndAddUninitializedValues(Bytes.Num());
+		FMemory::Memcpy(Helper.GetRawPtr(), Bytes.GetData(), Bytes.Num());
+		return true;
+	}
+	default:
+		return Codec.Property->ImportText_Direct(*String, Value, nullptr, PPF_None) != nullptr;
+	}
+}
+
+FSIOJStructPlan::EWireType FSIOJStructPlan::GetWireType(const FCodec& Codec, int32 ArrayDim)
+{
+	if (ArrayDim > 1 && Codec.Kind != EKind::Converter)
+	{
+		return EWireType::Sequence;
+	}
+
+	switch (Codec.Kind)
+	{
+	case EKind::Bool:
+	case EKind::Int:
+	case EKind::UInt:
+	case EKind::Enum:
+	case EKind::EnumDisplayName:
+		return EWireType::Varint;
+	case EKind::Float:
+		return EWireType::Fixed32;
+	case EKind::Double:
+		return EWireType::Fixed64;
+	case EKind::Array:
+		return IsRawBytes(Codec) ? EWireType::LengthPrefixed : EWireType::Sequence;
+	case EKind::Set:
+		return EWireType::Sequence;
+	case EKind::Map:
+		return EWireType::Map;
+	case EKind::Struct:
+		return EWireType::Struct;
+	case EKind::Converter:
+		return EWireType::Json;
+	default:
+		return EWireType::LengthPrefixed;
+	}
+}
+
+bool FSIOJStructPlan::IsLengthPrefixed(EWireType WireType)
+{
+	return WireType != EWireType::Varint && WireType != EWireType::Fixed64 && WireType != EWireType::Fixed32;
+}
+
+bool FSIOJStructPlan::IsRawBytes(const FCodec& Codec)
+{
+	return Codec.Kind == EKind::Bytes ||
+		(Codec.Kind == EKind::Array && Codec.Inner->Kind == EKind::Int && Codec.Inner->Property->IsA<FByteProperty>());
+}
+
+void FSIOJStructPlan::WriteCompact(const void* StructPtr, TArray<uint8>& OutBytes) const
+{
+	WriteCompactStruct(StructPtr, OutBytes);
+}
+
+void FSIOJStructPlan::WriteCompactStruct(const void* StructPtr, TArray<uint8>& Out) const
+{
+	if (bUseConverter)
+	{
+		//the body is the json object itself
+		TSharedRef<FJsonObject> Object = MakeShared<FJsonObject>();
+		FJsonObjectConverter::UStructToJsonObject(Struct, StructPtr, Object, 0, 0);
+		WriteJsonObject(Object, Out);
+		return;
+	}
+
+	for (const FFieldPlan& Field : Fields)
+	{
+		if (Field.CompactTag == 0)
+		{
+			continue;
+		}
+		AppendVarint(Out, Field.CompactTag);
+
+		const uint8* FieldPtr = (const uint8*)StructPtr + Field.Offset;
+		if (Field.ArrayDim == 1 || Field.Codec.Kind == EKind::Converter)
+		{
+			WriteCompactValue(Field.Codec, FieldPtr, Out);
+			continue;
+		}
+
+		const int32 Start = Out.Num();
+		AppendVarint(Out, Field.ArrayDim);
+		for (int32 Index = 0; Index < Field.ArrayDim; Index++)
+		{
+			WriteCompactValue(Field.Codec, FieldPtr + Index * Field.ElementSize, Out);
+		}
+		InsertLength(Out, Start);
+	}
+}
+
+void FSIOJStructPlan::WriteCompactValue(const FCodec& Codec, const void* Value, TArray<uint8>& Out) const
+{
+	if (IsRawBytes(Codec))
+	{
+		FScriptArrayHelper Helper(CastField<FArrayProperty>(Codec.Property), Value);
+		AppendCompactBytes(Out, Helper.GetRawPtr(), Helper.Num());
+		return;
+	}
+
+	switch (Codec.Kind)
+	{
+	case EKind::Bool:
+		AppendVarint(Out, CastField<FBoolProperty>(Codec.Property)->GetPropertyValue(Value) ? 1 : 0);
+		break;
+	case EKind::Int:
+	case EKind::Enum:
+	case EKind::EnumDisplayName:
+		AppendVarint(Out, ZigZag(Codec.Numeric->GetSignedIntPropertyValue(Value)));
+		break;
+	case EKind::UInt:
+		AppendVarint(Out, Codec.Numeric->GetUnsignedIntPropertyValue(Value));
+		break;
+	case EKind::Float:
+	{
+		const float FloatValue = (float)Codec.Numeric->GetFloatingPointPropertyValue(Value);
+		uint32 Bits;
+		FMemory::Memcpy(&Bits, &FloatValue, sizeof(Bits));
+		AppendFixed(Out, Bits, 4);
+		break;
+	}
+	case EKind::Double:
+	{
+		const double DoubleValue = Codec.Numeric->GetFloatingPointPropertyValue(Value);
+		uint64 Bits;
+		FMemory::Memcpy(&Bits, &DoubleValue, sizeof(Bits));
+		AppendFixed(Out, Bits, 8);
+		break;
+	}
+	case EKind::String:
+		AppendCompactString(Out, *(const FString*)Value);
+		break;
+	case EKind::Name:
+	{
+		TStringBuilder<128> Name;
+		((const FName*)Value)->AppendString(Name);
+		AppendCompactString(Out, Name.GetData(), Name.Len());
+		break;
+	}
+	case EKind::Text:
+		AppendCompactString(Out, ((const FText*)Value)->ToString());
+		break;
+	case EKind::Array:
+	{
+		FScriptArrayHelper Helper(CastField<FArrayProperty>(Codec.Property), Value);
+		const int32 Start = Out.Num();
+		AppendVarint(Out, Helper.Num());
+		for (int32 i = 0; i < Helper.Num(); i++)
+		{
+			WriteCompactValue(*Codec.Inner, Helper.GetRawPtr(i), Out);
+		}
+		InsertLength(Out, Start);
+		break;
+	}
+	case EKind::Set:
+	{
+		FScriptSetHelper Helper(CastField<FSetProperty>(Codec.Property), Value);
+		const int32 Start = Out.Num();
+		AppendVarint(Out, Helper.Num());
+		for (int32 i = 0, Remaining = Helper.Num(); Remaining > 0; i++)
+		{
+			if (Helper.IsValidIndex(i))
+			{
+				WriteCompactValue(*Codec.Inner, Helper.GetElementPtr(i), Out);
+				Remaining--;
+			}
+		}
+		InsertLength(Out, Start);
+		break;
+	}
+	case EKind::Map:
+	{
+		FScriptMapHelper Helper(CastField<FMapProperty>(Codec.Property), Value);
+		const int32 Start = Out.Num();
+		AppendVarint(Out, Helper.Num());
+		for (int32 i = 0, Remaining = Helper.Num(); Remaining > 0; i++)
+		{
+			if (Helper.IsValidIndex(i))
+			{
+				WriteCompactValue(*Codec.Key, Helper.GetKeyPtr(i), Out);
+				WriteCompactValue(*Codec.Inner, Helper.GetValuePtr(i), Out);
+				Remaining--;
+			}
+		}
+		InsertLength(Out, Start);
+		break;
+	}
+	case EKind::Struct:
+	{
+		const int32 Start = Out.Num();
+		if (Codec.StructPlan.IsValid())
+		{
+			Codec.StructPlan->WriteCompactStruct(Value, Out);
+		}
+		else
+		{
+			Get(Codec.RecursiveStruct, bBlueprintStruct)->WriteCompactStruct(Value, Out);
+		}
+		InsertLength(Out, Start);
+		break;
+	}
+	case EKind::ExportText:
+	{
+		FString Exported;
+		CastField<FStructProperty>(Codec.Property)->Struct->GetCppStructOps()->ExportTextItem(Exported, Value, nullptr, nullptr, PPF_None, nullptr);
+		AppendCompactString(Out, Exported);
+		break;
+	}
+	default:
+	{
+		//length prefixed json text
+		const int32 Start = Out.Num();
+		WriteJsonValue(FJsonObjectConverter::UPropertyToJsonValue(Codec.Property, Value, 0, 0), Out);
+		InsertLength(Out, Start);
+		break;
+	}
+	}
+}
+
+bool FSIOJStructPlan::ReadCompact(TArrayView<const uint8> Bytes, void* StructPtr) const
+{
+	//fields the sender doesn't have come out as defaults
+	if (const UScriptStruct* ScriptStruct = Cast<UScriptStruct>(Struct))
+	{
+		ScriptStruct->ClearScriptStruct(StructPtr);
+	}
+
+	FCompactReader Reader{ Bytes.GetData(), Bytes.Num() };
+	if (!ReadCompactStruct(Reader, Reader.Size, StructPtr))
+	{
+		UE_LOG(LogSIOJ, Warning, TEXT("FSIOJStructPlan: malformed compact bytes for %s at %lld"), *Struct->GetName(), Reader.Pos);
+		return false;
+	}
+	return !Reader.bMismatch;
+}
+
+bool FSIOJStructPlan::ReadCompactStruct(FCompactReader& Reader, int64 End, void* StructPtr) const
+{
+	if (bUseConverter)
+	{
+		TSharedPtr<FJsonValue> Value = ParseJsonValue(Reader.Data + Reader.Pos, End - Reader.Pos);
+		Reader.Pos = End;
+		const TSharedPtr<FJsonObject>* Object = nullptr;
+		if (!Value.IsValid() || !Value->TryGetObject(Object) || !FJsonObjectConverter::JsonObjectToUStruct(Object->ToSharedRef(), Struct, StructPtr, 0, 0))
+		{
+			Reader.bMismatch = true;
+		}
+		return true;
+	}
+
+	while (Reader.Pos < End)
+	{
+		uint64 Tag;
+		if (!Reader.ReadVarint(Tag))
+		{
+			return false;
+		}
+
+		const int32* FieldIndex = CompactIndices.Find((uint32)(Tag >> 3));
+		if (!FieldIndex || Fields[*FieldIndex].CompactTag != Tag)
+		{
+			//unknown fields are expected from newer senders, a known id with another wire type is not
+			if (FieldIndex)
+			{
+				Reader.bMismatch = true;
+			}
+			if (!Reader.Skip((EWireType)(Tag & 7)))
+			{
+				return false;
+			}
+			continue;
+		}
+
+		const FFieldPlan& Field = Fields[*FieldIndex];
+		uint8* FieldPtr = (uint8*)StructPtr + Field.Offset;
+
+		//length prefixed contents that don't fit e.g. an array whose item type changed are skipped, not fatal
+		int64 FieldEnd = INDEX_NONE;
+		if (IsLengthPrefixed((EWireType)(Tag & 7)))
+		{
+			const int64 FieldStart = Reader.Pos;
+			if (!Reader.ReadLength(FieldEnd))
+			{
+				return false;
+			}
+			Reader.Pos = FieldStart;
+		}
+
+		bool bRead = true;
+		if (Field.ArrayDim == 1 || Field.Codec.Kind == EKind::Converter)
+		{
+			bRead = ReadCompactValue(Reader, Field.Codec, FieldPtr);
+		}
+		else
+		{
+			//static array, extra items are dropped
+			int64 ArrayEnd;
+			uint64 Count;
+			bRead = Reader.ReadLength(ArrayEnd) && Reader.ReadVarint(Count);
+			for (int32 Index = 0; bRead && Index < Field.ArrayDim && (uint64)Index < Count; Index++)
+			{
+				bRead = ReadCompactValue(Reader, Field.Codec, FieldPtr + Index * Field.ElementSize);
+			}
+			if (bRead)
+			{
+				Reader.Pos = ArrayEnd;
+			}
+		}
+
+		if (FieldEnd == INDEX_NONE)
+		{
+			if (!bRead)
+			{
+				return false;
+			}
+		}
+		else if (!bRead || Reader.Pos != FieldEnd)
+		{
+			Reader.bMismatch = true;
+			Reader.Pos = FieldEnd;
+		}
+	}
+	return Reader.Pos == End;
+}
+
+bool FSIOJStructPlan::ReadCompactValue(FCompactReader& Reader, const FCodec& Codec, void* Value) const
+{
+	if (IsRawBytes(Codec))
+	{
+		int64 End;
+		if (!Reader.ReadLength(End))
+		{
+			return false;
+		}
+		FScriptArrayHelper Helper(CastField<FArrayProperty>(Codec.Property), Value);
+		Helper.EmptyAndAddUninitializedValues((int32)(End - Reader.Pos));
+		FMemory::Memcpy(Helper.GetRawPtr(), Reader.Data + Reader.Pos, End - Reader.Pos);
+		Reader.Pos = End;
+		return true;
+	}
+
+	uint64 Bits;
+	int64 End;
+	uint64 Count;
+	switch (Codec.Kind)
+	{
+	case EKind::Bool:
+		if (!Reader.ReadVarint(Bits))
+		{
+			return false;
+		}
+		CastField<FBoolProperty>(Codec.Property)->SetPropertyValue(Value, Bits != 0);
+		return true;
+	case EKind::Int:
+	case EKind::Enum:
+	case EKind::EnumDisplayName:
+		if (!Reader.ReadVarint(Bits))
+		{
+			return false;
+		}
+		Codec.Numeric->SetIntPropertyValue(Value, UnZigZag(Bits));
+		return true;
+	case EKind::UInt:
+		if (!Reader.ReadVarint(Bits))
+		{
+			return false;
+		}
+		Codec.Numeric->SetIntPropertyValue(Value, Bits);
+		return true;
+	case EKind::Float:
+	{
+		if (!Reader.ReadFixed(Bits, 4))
+		{
+			return false;
+		}
+		const uint32 FloatBits = (uint32)Bits;
+		float FloatValue;
+		FMemory::Memcpy(&FloatValue, &FloatBits, sizeof(FloatValue));
+		Codec.Numeric->SetFloatingPointPropertyValue(Value, FloatValue);
+		return true;
+	}
+	case EKind::Double:
+	{
+		if (!Reader.ReadFixed(Bits, 8))
+		{
+			return false;
+		}
+		double DoubleValue;
+		FMemory::Memcpy(&DoubleValue, &Bits, sizeof(DoubleValue));
+		Codec.Numeric->SetFloatingPointPropertyValue(Value, DoubleValue);
+		return true;
+	}
+	case EKind::String:
+	case EKind::Name:
+	case EKind::Text:
+	case EKind::ExportText:
+	{
+		FString String;
+		if (!Reader.ReadString(String))
+		{
+			return false;
+		}
+		if (!ReadFromString(Codec, String, Value))
+		{
+			Reader.bMismatch = true;
+		}
+		return true;
+	}
+	case EKind::Array:
+	{
+		//every item takes at least a byte, bounds the count before allocating
+		if (!Reader.ReadLength(End) || !Reader.ReadVarint(Count) || Count > (uint64)(End - Reader.Pos))
+		{
+			return false;
+		}
+		FScriptArrayHelper Helper(CastField<FArrayProperty>(Codec.Property), Value);
+		Helper.EmptyValues((int32)Count);
+		Helper.AddValues((int32)Count);
+		for (int32 i = 0; i < (int32)Count; i++)
+		{
+			if (!ReadCompactValue(Reader, *Codec.Inner, Helper.GetRawPtr(i)))
+			{
+				return false;
+			}
+		}
+		return Reader.Pos == End;
+	}
+	case EKind::Set:
+	{
+		if (!Reader.ReadLength(End) || !Reader.ReadVarint(Count) || Count > (uint64)(End - Reader.Pos))
+		{
+			return false;
+		}
+		FScriptSetHelper Helper(CastField<FSetProperty>(Codec.Property), Value);
+		Helper.EmptyElements((int32)Count);
+		for (uint64 i = 0; i < Count; i++)
+		{
+			const int32 Index = Helper.AddDefaultValue_Invalid_NeedsRehash();
+			if (!ReadCompactValue(Reader, *Codec.Inner, Helper.GetElementPtr(Index)))
+			{
+				Helper.Rehash();
+				return false;
+			}
+		}
+		Helper.Rehash();
+		return Reader.Pos == End;
+	}
+	case EKind::Map:
+	{
+		if (!Reader.ReadLength(End) || !Reader.ReadVarint(Count) || Count > (uint64)(End - Reader.Pos))
+		{
+			return false;
+		}
+		FScriptMapHelper Helper(CastField<FMapProperty>(Codec.Property), Value);
+		Helper.EmptyValues((int32)Count);
+		for (uint64 i = 0; i < Count; i++)
+		{
+			const int32 Index = Helper.AddDefaultValue_Invalid_NeedsRehash();
+			if (!ReadCompactValue(Reader, *Codec.Key, Helper.GetKeyPtr(Index)) ||
+				!ReadCompactValue(Reader, *Codec.Inner, Helper.GetValuePtr(Index)))
+			{
+				Helper.Rehash();
+				return false;
+			}
+		}
+		Helper.Rehash();
+		return Reader.Pos == End;
+	}
+	case EKind::Struct:
+		if (!Reader.ReadLength(End))
+		{
+			return false;
+		}
+		if (Codec.StructPlan.IsValid())
+		{
+			return Codec.StructPlan->ReadCompactStruct(Reader, End, Value);
+		}
+		return Get(Codec.RecursiveStruct, bBlueprintStruct)->ReadCompactStruct(Reader, End, Value);
+	default:
+	{
+		if (!Reader.ReadLength(End))
+		{
+			return false;
+		}
+		TSharedPtr<FJsonValue> JsonValue = ParseJsonValue(Reader.Data + Reader.Pos, End - Reader.Pos);
+		Reader.Pos = End;
+		if (!JsonValue.IsValid() || !FJsonObjectConverter::JsonValueToUProperty(JsonValue, Codec.Property, Value, 0, 0))
+		{
+			Reader.bMismatch = true;
+		}
+		return true;
+	}
+	}
+}
@@ -0,0 +1,93 @@
+// Copyright 2018-current Getnamo. All Rights Reserved
+
+#include "SIOJTypedArray.h"
+#include "SIOJsonValue.h"
+
+void FSIOJTypedArray::WriteHeader(ESIOJTypedArrayType Type, uint8* Out)
+{
+	Out[0] = 's';
+	Out[1] = 't';
+	Out[2] = (uint8)Type;
+	Out[3] = 0;
+}
+
+ESIOJTypedArrayType FSIOJTypedArray::GetType(const uint8* Bytes, int64 Num)
+{
+	if (!Bytes || Num < HeaderSize || Bytes[0] != 's' || Bytes[1] != 't' || Bytes[3] != 0 ||
+		Bytes[2] == 0 || Bytes[2] > (uint8)ESIOJTypedArrayType::Vector3f)
+	{
+		return ESIOJTypedArrayType::None;
+	}
+	return (ESIOJTypedArrayType)Bytes[2];
+}
+
+void FSIOJTypedArray::Encode(TArrayView<const FVector> Values, uint8* Out)
+{
+	WriteHeader(ESIOJTypedArrayType::Vector3f, Out);
+
+	//Out is only byte aligned
+	uint8* Elements = Out + HeaderSize;
+	for (int32 i = 0; i < Values.Num(); i++)
+	{
+		const FVector3f Value(Values[i]);
+		FMemory::Memcpy(Elements + i * sizeof(FVector3f), &Value, sizeof(FVector3f));
+	}
+}
+
+TSharedPtr<FJsonValue> FSIOJTypedArray::MakeValue(TArrayView<const FVector> Values)
+{
+	TArray<uint8> Bytes;
+	Encode(Values, Bytes);
+	return MakeBinaryValue(MoveTemp(Bytes));
+}
+
+bool FSIOJTypedArray::ToNumbers(const TSharedPtr<FJsonValue>& Value, TArray<float>& OutNumbers)
+{
+	const TArray<uint8>* Bytes = GetBinary(Value);
+	if (!Bytes)
+	{
+		return false;
+	}
+
+	const auto Convert = [&OutNumbers](auto View)
+	{
+		OutNumbers.SetNumUninitialized(View.Num());
+		for (int32 i = 0; i < View.Num(); i++)
+		{
+			OutNumbers[i] = (float)View[i];
+		}
+		return true;
+	};
+
+	TArrayView<const float> Floats;
+	if (View(Bytes->GetData(), Bytes->Num(), Floats))
+	{
+		OutNumbers = Floats;
+		return true;
+	}
+	TArrayView<const int32> Ints;
+	if (View(Bytes->GetData(), Bytes->Num(), Ints))
+	{
+		return Convert(Ints);
+	}
+	TArrayView<const uint16> Shorts;
+	if (View(Bytes->GetData(), Bytes->Num(), Shorts))
+	{
+		return Convert(Shorts);
+	}
+	return false;
+}
+
+const TArray<uint8>* FSIOJTypedArray::GetBinary(const TSharedPtr<FJsonValue>& Value)
+{
+	if (!Value.IsValid() || Value->Type != EJson::String || !FJsonValueBinary::IsBinary(Value))
+	{
+		return nullptr;
+	}
+	return &StaticCastSharedPtr<FJsonValueBinary>(Value)->GetBinary();
+}
+
+TSharedPtr<FJsonValue> FSIOJTypedArray::MakeBinaryValue(TArray<uint8>&& Bytes)
+{
+	return MakeShared<FJsonValueBinary>(MoveTemp(Bytes));
+}
@@ -7,6 +7,7 @@
 #include "SIOJsonObject.h"
 #include "SIOJsonValue.h"
 #include "SIOJRequestJSON.h"
+#include "SIOJsonWrapperPool.h"
 
 class FSIOJson : public ISIOJson
 {
@@ -21,7 +22,7 @@ class FSIOJson : public ISIOJson
 
 	virtual void ShutdownModule() override
 	{
-
+		FSIOJsonWrapperPool::Shutdown();
 	}
 };
 
@@ -0,0 +1,323 @@
+// Copyright 2018-current Getnamo. All Rights Reserved
+
+#include "SIOJsonHandleLibrary.h"
+#include "SIOJsonObject.h"
+#include "SIOJConvert.h"
+#include "SIOJsonWrapperPool.h"
+#include "ISIOJson.h"
+
+namespace
+{
+	const TSharedPtr<FJsonObject>* TryGetObject(const FSIOJsonHandle& Handle)
+	{
+		if (Handle.IsValid() && Handle.Value->Type == EJson::Object)
+		{
+			const TSharedPtr<FJsonObject>* Object = nullptr;
+			if (Handle.Value->TryGetObject(Object) && Object->IsValid())
+			{
+				return Object;
+			}
+		}
+		return nullptr;
+	}
+
+	const TArray<TSharedPtr<FJsonValue>>* TryGetArray(const FSIOJsonHandle& Handle)
+	{
+		const TArray<TSharedPtr<FJsonValue>>* Array = nullptr;
+		if (Handle.IsValid() && Handle.Value->TryGetArray(Array))
+		{
+			return Array;
+		}
+		return nullptr;
+	}
+}
+
+FSIOJsonHandle USIOJsonHandleLibrary::MakeJsonHandle(const FString& Json)
+{
+	return FSIOJsonHandle(USIOJConvert::JsonStringToJsonValue(Json));
+}
+
+void USIOJsonHandleLibrary::BreakJsonHandle(const FSIOJsonHandle& Handle, TEnumAsByte<ESIOJson::Type>& Type, double& Number, FString& String, bool& Bool)
+{
+	Type = USIOJsonValue::GetTypeOf(Handle.Value);
+	Number = 0.0;
+	String.Empty();
+	Bool = false;
+
+	switch (Type)
+	{
+	case ESIOJson::Number:
+		Number = Handle.Value->AsNumber();
+		break;
+	case ESIOJson::String:
+		String = Handle.Value->AsString();
+		break;
+	case ESIOJson::Boolean:
+		Bool = Handle.Value->AsBool();
+		break;
+	default:
+		break;
+	}
+}
+
+FSIOJsonHandle USIOJsonHandleLibrary::MakeStringHandle(const FString& Value)
+{
+	return FSIOJsonHandle(MakeShared<FJsonValueString>(Value));
+}
+
+FSIOJsonHandle USIOJsonHandleLibrary::MakeNumberHandle(double Value)
+{
+	return FSIOJsonHandle(MakeShared<FJsonValueNumber>(Value));
+}
+
+FSIOJsonHandle USIOJsonHandleLibrary::MakeBoolHandle(bool Value)
+{
+	return FSIOJsonHandle(MakeShared<FJsonValueBoolean>(Value));
+}
+
+FSIOJsonHandle USIOJsonHandleLibrary::MakeNullHandle()
+{
+	return FSIOJsonHandle(MakeShared<FJsonValueNull>());
+}
+
+FSIOJsonHandle USIOJsonHandleLibrary::MakeBinaryHandle(const TArray<uint8>& Value)
+{
+	return FSIOJsonHandle(MakeShared<FJsonValueBinary>(Value));
+}
+
+FSIOJsonHandle USIOJsonHandleLibrary::MakeArrayHandle(const TArray<FSIOJsonHandle>& Items)
+{
+	TArray<TSharedPtr<FJsonValue>> Values;
+	Values.Reserve(Items.Num());
+	for (const FSIOJsonHandle& Item : Items)
+	{
+		Values.Add(Item.IsValid() ? Item.Value : TSharedPtr<FJsonValue>(MakeShared<FJsonValueNull>()));
+	}
+	return FSIOJsonHandle(MakeShared<FJsonValueArray>(Values));
+}
+
+FSIOJsonHandle USIOJsonHandleLibrary::MakeObjectHandle()
+{
+	return FSIOJsonHandle(MakeShared<FJsonValueObject>(MakeShared<FJsonObject>()));
+}
+
+bool USIOJsonHandleLibrary::IsValidHandle(const FSIOJsonHandle& Handle)
+{
+	return Handle.IsValid();
+}
+
+TEnumAsByte<ESIOJson::Type> USIOJsonHandleLibrary::GetType(const FSIOJsonHandle& Handle)
+{
+	return USIOJsonValue::GetTypeOf(Handle.Value);
+}
+
+bool USIOJsonHandleLibrary::IsNull(const FSIOJsonHandle& Handle)
+{
+	return !Handle.IsValid() || Handle.Value->IsNull();
+}
+
+FSIOJsonHandle USIOJsonHandleLibrary::GetField(const FSIOJsonHandle& Handle, const FString& FieldName)
+{
+	if (const TSharedPtr<FJsonObject>* Object = TryGetObject(Handle))
+	{
+		return FSIOJsonHandle((*Object)->TryGetField(FieldName));
+	}
+	return FSIOJsonHandle();
+}
+
+bool USIOJsonHandleLibrary::HasField(const FSIOJsonHandle& Handle, const FString& FieldName)
+{
+	const TSharedPtr<FJsonObject>* Object = TryGetObject(Handle);
+	return Object && (*Object)->HasField(FieldName);
+}
+
+TArray<FString> USIOJsonHandleLibrary::GetFieldNames(const FSIOJsonHandle& Handle)
+{
+	TArray<FString> Names;
+	if (const TSharedPtr<FJsonObject>* Object = TryGetObject(Handle))
+	{
+		(*Object)->Values.GetKeys(Names);
+	}
+	return Names;
+}
+
+FSIOJsonHandle USIOJsonHandleLibrary::GetArrayItem(const FSIOJsonHandle& Handle, int32 Index)
+{
+	const TArray<TSharedPtr<FJsonValue>>* Array = TryGetArray(Handle);
+	if (Array && Array->IsValidIndex(Index))
+	{
+		return FSIOJsonHandle((*Array)[Index]);
+	}
+	return FSIOJsonHandle();
+}
+
+int32 USIOJsonHandleLibrary::GetArrayLength(const FSIOJsonHandle& Handle)
+{
+	const TArray<TSharedPtr<FJsonValue>>* Array = TryGetArray(Handle);
+	return Array ? Array->Num() : 0;
+}
+
+TArray<FSIOJsonHandle> USIOJsonHandleLibrary::AsArray(const FSIOJsonHandle& Handle)
+{
+	TArray<FSIOJsonHandle> Items;
+	if (const TArray<TSharedPtr<FJsonValue>>* Array = TryGetArray(Handle))
+	{
+		Items.Reserve(Array->Num());
+		for (const TSharedPtr<FJsonValue>& Item : *Array)
+		{
+			Items.Emplace(Item);
+		}
+	}
+	return Items;
+}
+
+double USIOJsonHandleLibrary::AsNumber(const FSIOJsonHandle& Handle)
+{
+	double Number = 0.0;
+	if (Handle.IsValid())
+	{
+		Handle.Value->TryGetNumber(Number);
+	}
+	return Number;
+}
+
+int32 USIOJsonHandleLibrary::AsInt(const FSIOJsonHandle& Handle)
+{
+	return (int32)AsNumber(Handle);
+}
+
+FString USIOJsonHandleLibrary::AsString(const FSIOJsonHandle& Handle)
+{
+	FString String;
+	if (Handle.IsValid())
+	{
+		Handle.Value->TryGetString(String);
+	}
+	return String;
+}
+
+bool USIOJsonHandleLibrary::AsBool(const FSIOJsonHandle& Handle)
+{
+	bool bValue = false;
+	if (Handle.IsValid())
+	{
+		Handle.Value->TryGetBool(bValue);
+	}
+	return bValue;
+}
+
+TArray<uint8> USIOJsonHandleLibrary::AsBinary(const FSIOJsonHandle& Handle)
+{
+	if (!Handle.IsValid())
+	{
+		return TArray<uint8>();
+	}
+	return FJsonValueBinary::AsBinary(Handle.Value);
+}
+
+FString USIOJsonHandleLibrary::EncodeJson(const FSIOJsonHandle& Handle)
+{
+	if (!Handle.IsValid())
+	{
+		return FString();
+	}
+	return USIOJConvert::ToJsonString(Handle.Value);
+}
+
+FSIOJsonHandle USIOJsonHandleLibrary::SetField(const FSIOJsonHandle& Handle, const FString& FieldName, const FSIOJsonHandle& Value)
+{
+	if (const TSharedPtr<FJsonObject>* Object = TryGetObject(Handle))
+	{
+		(*Object)->SetField(FieldName, Value.IsValid() ? Value.Value : TSharedPtr<FJsonValue>(MakeShared<FJsonValueNull>()));
+	}
+	else
+	{
+		UE_LOG(LogSIOJ, Warning, TEXT("SetField '%s' ignored, handle is not an object"), *FieldName);
+	}
+	return Handle;
+}
+
+FSIOJsonHandle USIOJsonHandleLibrary::RemoveField(const FSIOJsonHandle& Handle, const FString& FieldName)
+{
+	if (const TSharedPtr<FJsonObject>* Object = TryGetObject(Handle))
+	{
+		(*Object)->RemoveField(FieldName);
+	}
+	return Handle;
+}
+
+FSIOJsonPath USIOJsonHandleLibrary::MakeJsonPath(const FString& Path)
+{
+	return FSIOJsonPath(Path);
+}
+
+FSIOJsonPathSet USIOJsonHandleLibrary::MakeJsonPathSet(const TArray<FString>& Paths)
+{
+	return FSIOJsonPathSet(Paths);
+}
+
+bool USIOJsonHandleLibrary::IsValidPath(const FSIOJsonPath& Path)
+{
+	return Path.IsValid();
+}
+
+FSIOJsonHandle USIOJsonHandleLibrary::GetPath(const FSIOJsonHandle& Handle, const FSIOJsonPath& Path)
+{
+	const TSharedPtr<FJsonValue>* Value = Path.Resolve(Handle.Value);
+	return Value ? FSIOJsonHandle(*Value) : FSIOJsonHandle();
+}
+
+bool USIOJsonHandleLibrary::GetPathNumber(const FSIOJsonHandle& Handle, const FSIOJsonPath& Path, double& Number)
+{
+	Number = 0.0;
+	return Path.TryGetNumber(Handle.Value, Number);
+}
+
+bool USIOJsonHandleLibrary::GetPathString(const FSIOJsonHandle& Handle, const FSIOJsonPath& Path, FString& String)
+{
+	String.Empty();
+	return Path.TryGetString(Handle.Value, String);
+}
+
+bool USIOJsonHandleLibrary::GetPathBool(const FSIOJsonHandle& Handle, const FSIOJsonPath& Path, bool& Bool)
+{
+	Bool = false;
+	return Path.TryGetBool(Handle.Value, Bool);
+}
+
+TArray<FSIOJsonHandle> USIOJsonHandleLibrary::GetPaths(const FSIOJsonHandle& Handle, const FSIOJsonPathSet& Paths)
+{
+	TArray<const TSharedPtr<FJsonValue>*> Values;
+	Paths.Resolve(Handle.Value, Values);
+
+	TArray<FSIOJsonHandle> Handles;
+	Handles.Reserve(Values.Num());
+	for (const TSharedPtr<FJsonValue>* Value : Values)
+	{
+		Handles.Add(Value ? FSIOJsonHandle(*Value) : FSIOJsonHandle());
+	}
+	return Handles;
+}
+
+USIOJsonValue* USIOJsonHandleLibrary::Conv_HandleToJsonValue(const FSIOJsonHandle& Handle)
+{
+	return FSIOJsonWrapperPool::AcquireValue(Handle.Value);
+}
+
+FSIOJsonHandle USIOJsonHandleLibrary::Conv_JsonValueToHandle(USIOJsonValue* Value)
+{
+	if (!Value)
+	{
+		return FSIOJsonHandle();
+	}
+	return FSIOJsonHandle(Value->GetRootValue());
+}
+
+FSIOJsonHandle USIOJsonHandleLibrary::Conv_JsonObjectToHandle(USIOJsonObject* Object)
+{
+	if (!Object || !Object->GetRootObject().IsValid())
+	{
+		return FSIOJsonHandle();
+	}
+	return FSIOJsonHandle(MakeShared<FJsonValueObject>(Object->GetRootObject()));
+}
@@ -6,6 +6,8 @@
 #include "SIOJsonObject.h"
 #include "SIOJsonValue.h"
 #include "ISIOJson.h"
+#include "SIOJsonWrapperPool.h"
+#include "SIOJTypedArray.h"
 #include "Misc/Base64.h"
 #include "Policies/CondensedJsonPrintPolicy.h"
 #include "Serialization/JsonWriter.h"
@@ -140,10 +142,7 @@ USIOJsonValue* USIOJsonObject::GetField(const FString& FieldName) const
 	TSharedPtr<FJsonValue> NewVal = JsonObj->TryGetField(FieldName);
 	if (NewVal.IsValid())
 	{
-		USIOJsonValue* NewValue = NewObject<USIOJsonValue>();
-		NewValue->SetRootValue(NewVal);
-
-		return NewValue;
+		return FSIOJsonWrapperPool::AcquireValue(NewVal);
 	}
 	
 	return nullptr;
@@ -258,10 +257,7 @@ TArray<USIOJsonValue*> USIOJsonObject::GetArrayField(const FString& FieldName)
 	TArray< TSharedPtr<FJsonValue> > ValArray = JsonObj->GetArrayField(FieldName);
 	for (auto Value : ValArray)
 	{
-		USIOJsonValue* NewValue = NewObject<USIOJsonValue>();
-		NewValue->SetRootValue(Value);
-
-		OutArray.Add(NewValue);
+		OutArray.Add(FSIOJsonWrapperPool::AcquireValue(Value));
 	}
 
 	return OutArray;
@@ -345,8 +341,7 @@ bool USIOJsonObject::TryGetObjectField(const FString& FieldName, USIOJsonObject*
 
 	if (bSuccess)
 	{
-		OutObject = NewObject<USIOJsonObject>();
-		OutObject->SetRootObject(*JsonObjField);
+		OutObject = FSIOJsonWrapperPool::AcquireObject(*JsonObjField);
 	}
 
 	return bSuccess;
@@ -362,10 +357,7 @@ USIOJsonObject* USIOJsonObject::GetObjectField(const FString& FieldName) const
 
 	TSharedPtr<FJsonObject> JsonObjField = JsonObj->GetObjectField(FieldName);
 
-	USIOJsonObject* OutRestJsonObj = NewObject<USIOJsonObject>();
-	OutRestJsonObj->SetRootObject(JsonObjField);
-
-	return OutRestJsonObj;
+	return FSIOJsonWrapperPool::AcquireObject(JsonObjField);
 }
 
 void USIOJsonObject::SetObjectField(const FString& FieldName, USIOJsonObject* JsonObject)
@@ -431,6 +423,13 @@ void USIOJsonObject::SetBinaryField(const FString& FieldName, const TArray<uint8
 
 TArray<float> USIOJsonObject::GetNumberArrayField(const FString& FieldName)
 {
+	//typed arrays arrive as a single binary, no per element values to walk
+	TArray<float> TypedNumbers;
+	if (JsonObj.IsValid() && FSIOJTypedArray::ToNumbers(JsonObj->TryGetField(FieldName), TypedNumbers))
+	{
+		return TypedNumbers;
+	}
+
 	if (!JsonObj->HasTypedField<EJson::Array>(FieldName))
 	{
 		UE_LOG(LogSIOJ, Warning, TEXT("No field with name %s of type Array"), *FieldName);
@@ -585,10 +584,7 @@ TArray<USIOJsonObject*> USIOJsonObject::GetObjectArrayField(const FString& Field
 
 		TSharedPtr<FJsonObject> NewObj = Value->AsObject();
 
-		USIOJsonObject* NewJson = NewObject<USIOJsonObject>();
-		NewJson->SetRootObject(NewObj);
-
-		OutArray.Add(NewJson);
+		OutArray.Add(FSIOJsonWrapperPool::AcquireObject(NewObj));
 	}
 
 	return OutArray;
@@ -0,0 +1,319 @@
+// Copyright 2018-current Getnamo. All Rights Reserved
+
+#include "SIOJsonPath.h"
+#include "ISIOJson.h"
+
+namespace
+{
+	FSIOJsonPath::FSegment KeySegment(const FString& Key)
+	{
+		FSIOJsonPath::FSegment Segment;
+		Segment.Key = Key;
+		Segment.KeyHash = GetTypeHash(Key);
+
+		FTCHARToUTF8 Utf8Key(*Key);
+		Segment.Utf8Key.assign(Utf8Key.Get(), Utf8Key.Length());
+		return Segment;
+	}
+
+	FSIOJsonPath::FSegment IndexSegment(int32 Index)
+	{
+		FSIOJsonPath::FSegment Segment;
+		Segment.Index = Index;
+		Segment.bIsIndex = true;
+		return Segment;
+	}
+
+	bool IsSameSegment(const FSIOJsonPath::FSegment& A, const FSIOJsonPath::FSegment& B)
+	{
+		if (A.bIsIndex != B.bIsIndex)
+		{
+			return false;
+		}
+		//case sensitive, std::map keyed trees tell the two apart
+		return A.bIsIndex ? A.Index == B.Index : (A.KeyHash == B.KeyHash && A.Key.Equals(B.Key, ESearchCase::CaseSensitive));
+	}
+}
+
+FSIOJsonPath::FSIOJsonPath(const FString& Path)
+{
+	FString Error;
+	if (!Compile(Path, *this, &Error))
+	{
+		UE_LOG(LogSIOJ, Warning, TEXT("FSIOJsonPath: %s"), *Error);
+	}
+}
+
+bool FSIOJsonPath::Compile(const FString& Path, FSIOJsonPath& OutPath, FString* OutError)
+{
+	FSIOJsonPath Result;
+	Result.Source = Path;
+
+	auto Fail = [&](int32 Position, const TCHAR* Reason)
+	{
+		if (OutError)
+		{
+			*OutError = FString::Printf(TEXT("%s at %d in '%s'"), Reason, Position, *Path);
+		}
+		Result.Segments.Reset();
+		OutPath = MoveTemp(Result);
+		return false;
+	};
+
+	const int32 Length = Path.Len();
+	int32 i = 0;
+	if (i < Length && Path[i] == TEXT('$'))
+	{
+		i++;
+	}
+
+	//keys need a '.' in front except as the very first segment
+	bool bNeedsSeparator = i > 0;
+
+	while (i < Length)
+	{
+		const TCHAR Char = Path[i];
+		if (Char == TEXT('['))
+		{
+			i++;
+			if (i < Length && (Path[i] == TEXT('\'') || Path[i] == TEXT('"')))
+			{
+				const TCHAR Quote = Path[i++];
+				FString Key;
+				while (i < Length && Path[i] != Quote)
+				{
+					if (Path[i] == TEXT('\\') && i + 1 < Length)
+					{
+						i++;
+					}
+					Key.AppendChar(Path[i++]);
+				}
+				if (i >= Length)
+				{
+					return Fail(i, TEXT("Unterminated quoted key"));
+				}
+				i++;
+				if (i >= Length || Path[i] != TEXT(']'))
+				{
+					return Fail(i, TEXT("Expected ']'"));
+				}
+				Result.Segments.Add(KeySegment(Key));
+			}
+			else
+			{
+				const int32 Start = i;
+				if (i < Length && Path[i] == TEXT('-'))
+				{
+					i++;
+				}
+				const int32 DigitStart = i;
+				while (i < Length && FChar::IsDigit(Path[i]))
+				{
+					i++;
+				}
+				if (i == DigitStart)
+				{
+					return Fail(i, TEXT("Expected array index"));
+				}
+				if (i >= Length || Path[i] != TEXT(']'))
+				{
+					return Fail(i, TEXT("Expected ']'"));
+				}
+				Result.Segments.Add(IndexSegment(FCString::Atoi(*Path.Mid(Start, i - Start))));
+			}
+			i++;
+			bNeedsSeparator = true;
+		}
+		else
+		{
+			if (Char == TEXT('.'))
+			{
+				i++;
+			}
+			else if (bNeedsSeparator)
+			{
+				return Fail(i, TEXT("Expected '.' or '['"));
+			}
+
+			const int32 Start = i;
+			while (i < Length && Path[i] != TEXT('.') && Path[i] != TEXT('['))
+			{
+				i++;
+			}
+			if (i == Start)
+			{
+				return Fail(i, TEXT("Empty key"));
+			}
+			Result.Segments.Add(KeySegment(Path.Mid(Start, i - Start)));
+			bNeedsSeparator = true;
+		}
+	}
+
+	Result.bValid = true;
+	OutPath = MoveTemp(Result);
+	return true;
+}
+
+const TSharedPtr<FJsonValue>* FSIOJsonPath::Step(const TSharedPtr<FJsonValue>& Value, const FSegment& Segment)
+{
+	if (!Value.IsValid())
+	{
+		return nullptr;
+	}
+
+	if (Segment.bIsIndex)
+	{
+		const TArray<TSharedPtr<FJsonValue>>* Array = nullptr;
+		if (Value->Type != EJson::Array || !Value->TryGetArray(Array))
+		{
+			return nullptr;
+		}
+		const int32 Index = Segment.Index < 0 ? Array->Num() + Segment.Index : Segment.Index;
+		return Array->IsValidIndex(Index) ? &(*Array)[Index] : nullptr;
+	}
+
+	const TSharedPtr<FJsonObject>* Object = nullptr;
+	if (Value->Type != EJson::Object || !Value->TryGetObject(Object) || !Object->IsValid())
+	{
+		return nullptr;
+	}
+	return (*Object)->Values.FindByHash(Segment.KeyHash, Segment.Key);
+}
+
+const TSharedPtr<FJsonValue>* FSIOJsonPath::Resolve(const TSharedPtr<FJsonValue>& Root) const
+{
+	return ResolveWith(Root, &FSIOJsonPath::Step);
+}
+
+const TSharedPtr<FJsonValue>* FSIOJsonPath::Resolve(const TSharedPtr<FJsonObject>& Root) const
+{
+	//an object root has no value to hand back for the empty path
+	if (!bValid || !Root.IsValid() || Segments.Num() == 0 || Segments[0].bIsIndex)
+	{
+		return nullptr;
+	}
+
+	const TSharedPtr<FJsonValue>* Value = Root->Values.FindByHash(Segments[0].KeyHash, Segments[0].Key);
+	for (int32 i = 1; Value && i < Segments.Num(); i++)
+	{
+		Value = Step(*Value, Segments[i]);
+	}
+	return Value;
+}
+
+bool FSIOJsonPath::TryGetNumber(const TSharedPtr<FJsonValue>& Root, double& OutNumber) const
+{
+	const TSharedPtr<FJsonValue>* Value = Resolve(Root);
+	return Value && Value->IsValid() && (*Value)->TryGetNumber(OutNumber);
+}
+
+bool FSIOJsonPath::TryGetString(const TSharedPtr<FJsonValue>& Root, FString& OutString) const
+{
+	const TSharedPtr<FJsonValue>* Value = Resolve(Root);
+	return Value && Value->IsValid() && (*Value)->TryGetString(OutString);
+}
+
+bool FSIOJsonPath::TryGetBool(const TSharedPtr<FJsonValue>& Root, bool& bOutBool) const
+{
+	const TSharedPtr<FJsonValue>* Value = Resolve(Root);
+	return Value && Value->IsValid() && (*Value)->TryGetBool(bOutBool);
+}
+
+bool FSIOJsonPath::TryGetObject(const TSharedPtr<FJsonValue>& Root, const TSharedPtr<FJsonObject>*& OutObject) const
+{
+	const TSharedPtr<FJsonValue>* Value = Resolve(Root);
+	return Value && Value->IsValid() && (*Value)->TryGetObject(OutObject);
+}
+
+bool FSIOJsonPath::TryGetArray(const TSharedPtr<FJsonValue>& Root, const TArray<TSharedPtr<FJsonValue>>*& OutArray) const
+{
+	const TSharedPtr<FJsonValue>* Value = Resolve(Root);
+	return Value && Value->IsValid() && (*Value)->TryGetArray(OutArray);
+}
+
+double FSIOJsonPath::GetNumber(const TSharedPtr<FJsonValue>& Root, double Default) const
+{
+	double Number = Default;
+	return TryGetNumber(Root, Number) ? Number : Default;
+}
+
+FString FSIOJsonPath::GetString(const TSharedPtr<FJsonValue>& Root, const FString& Default) const
+{
+	FString String;
+	return TryGetString(Root, String) ? String : Default;
+}
+
+bool FSIOJsonPath::GetBool(const TSharedPtr<FJsonValue>& Root, bool bDefault) const
+{
+	bool bValue = bDefault;
+	return TryGetBool(Root, bValue) ? bValue : bDefault;
+}
+
+FSIOJsonPathSet::FSIOJsonPathSet(const TArray<FSIOJsonPath>& Paths)
+{
+	for (const FSIOJsonPath& Path : Paths)
+	{
+		Add(Path);
+	}
+}
+
+FSIOJsonPathSet::FSIOJsonPathSet(const TArray<FString>& Paths)
+{
+	for (const FString& Path : Paths)
+	{
+		Add(FSIOJsonPath(Path));
+	}
+}
+
+int32 FSIOJsonPathSet::Add(const FSIOJsonPath& Path)
+{
+	const int32 Output = NumPaths++;
+	NextOutput.Add(INDEX_NONE);
+
+	//invalid paths keep their slot but never resolve
+	if (!Path.IsValid())
+	{
+		return Output;
+	}
+
+	if (Nodes.Num() == 0)
+	{
+		Nodes.AddDefaulted();
+	}
+
+	int32 NodeIndex = 0;
+	for (const FSIOJsonPath::FSegment& Segment : Path.GetSegments())
+	{
+		int32 Last = INDEX_NONE;
+		int32 Child = Nodes[NodeIndex].FirstChild;
+		while (Child != INDEX_NONE && !IsSameSegment(Nodes[Child].Segment, Segment))
+		{
+			Last = Child;
+			Child = Nodes[Child].NextSibling;
+		}
+
+		if (Child == INDEX_NONE)
+		{
+			Child = Nodes.Num();
+			Nodes.AddDefaulted_GetRef().Segment = Segment;
+			if (Last == INDEX_NONE)
+			{
+				Nodes[NodeIndex].FirstChild = Child;
+			}
+			else
+			{
+				Nodes[Last].NextSibling = Child;
+			}
+		}
+		NodeIndex = Child;
+	}
+
+	NextOutput[Output] = Nodes[NodeIndex].FirstOutput;
+	Nodes[NodeIndex].FirstOutput = Output;
+	return Output;
+}
+
+void FSIOJsonPathSet::Resolve(const TSharedPtr<FJsonValue>& Root, TArray<const TSharedPtr<FJsonValue>*>& OutValues) const
+{
+	ResolveWith(Root, &FSIOJsonPath::Step, OutValues);
+}
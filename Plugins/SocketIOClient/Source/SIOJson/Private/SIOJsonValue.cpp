@@ -7,6 +7,7 @@
 #include "SIOJConvert.h"
 #include "SIOJsonObject.h"
 #include "ISIOJson.h"
+#include "SIOJsonWrapperPool.h"
 #include "Misc/Base64.h"
 
 #if PLATFORM_WINDOWS
@@ -168,12 +169,17 @@ void USIOJsonValue::SetRootValue(TSharedPtr<FJsonValue>& JsonValue)
 
 ESIOJson::Type USIOJsonValue::GetType() const
 {
-	if (!JsonVal.IsValid())
+	return GetTypeOf(JsonVal);
+}
+
+ESIOJson::Type USIOJsonValue::GetTypeOf(const TSharedPtr<FJsonValue>& InValue)
+{
+	if (!InValue.IsValid())
 	{
 		return ESIOJson::None;
 	}
 
-	switch (JsonVal->Type)
+	switch (InValue->Type)
 	{
 	case EJson::None:
 		return ESIOJson::None;
@@ -182,7 +188,7 @@ ESIOJson::Type USIOJsonValue::GetType() const
 		return ESIOJson::Null;
 
 	case EJson::String:
-		if (FJsonValueBinary::IsBinary(JsonVal))
+		if (FJsonValueBinary::IsBinary(InValue))
 		{
 			return ESIOJson::Binary;
 		}
@@ -306,10 +312,7 @@ TArray<USIOJsonValue*> USIOJsonValue::AsArray() const
 	TArray< TSharedPtr<FJsonValue> > ValArray = JsonVal->AsArray();
 	for (auto Value : ValArray)
 	{
-		USIOJsonValue* NewValue = NewObject<USIOJsonValue>();
-		NewValue->SetRootValue(Value);
-
-		OutArray.Add(NewValue);
+		OutArray.Add(FSIOJsonWrapperPool::AcquireValue(Value));
 	}
 
 	return OutArray;
@@ -325,10 +328,7 @@ USIOJsonObject* USIOJsonValue::AsObject()
 
 	TSharedPtr<FJsonObject> NewObj = JsonVal->AsObject();
 
-	USIOJsonObject* JsonObj = NewObject<USIOJsonObject>();
-	JsonObj->SetRootObject(NewObj);
-
-	return JsonObj;
+	return FSIOJsonWrapperPool::AcquireObject(NewObj);
 }
 
 
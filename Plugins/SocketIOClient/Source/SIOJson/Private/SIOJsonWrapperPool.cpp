@@ -0,0 +1,142 @@
+// Copyright 2018-current Getnamo. All Rights Reserved
+
+#include "SIOJsonWrapperPool.h"
+#include "SIOJsonValue.h"
+#include "SIOJsonObject.h"
+#include "HAL/IConsoleManager.h"
+#include "Misc/CoreDelegates.h"
+
+namespace
+{
+	bool bRecycleWrappers = false;
+
+	FAutoConsoleVariableRef CVarRecycleWrappers(
+		TEXT("SIOJson.RecycleWrappers"),
+		bRecycleWrappers,
+		TEXT("Recycle json wrappers handed out by accessors and events at the end of each frame. Only safe if blueprints don't keep them past that frame."));
+
+	//Free wrappers kept beyond this are left to the GC
+	const int32 MaxFreeWrappers = 4096;
+
+	FSIOJsonWrapperPool* PoolInstance = nullptr;
+}
+
+USIOJsonValue* FSIOJsonWrapperPool::AcquireValue(const TSharedPtr<FJsonValue>& InValue)
+{
+	TSharedPtr<FJsonValue> Value = InValue;
+	USIOJsonValue* Wrapper = nullptr;
+
+	FSIOJsonWrapperPool* Pool = (bRecycleWrappers && IsInGameThread()) ? Get() : nullptr;
+	if (Pool && Pool->FreeValues.Num() > 0)
+	{
+		Wrapper = Pool->FreeValues.Pop(EAllowShrinking::No);
+	}
+	else
+	{
+		Wrapper = NewObject<USIOJsonValue>();
+	}
+	if (Pool)
+	{
+		Pool->UsedValues.Add(Wrapper);
+	}
+
+	Wrapper->SetRootValue(Value);
+	return Wrapper;
+}
+
+USIOJsonObject* FSIOJsonWrapperPool::AcquireObject(const TSharedPtr<FJsonObject>& InObject)
+{
+	USIOJsonObject* Wrapper = nullptr;
+
+	FSIOJsonWrapperPool* Pool = (bRecycleWrappers && IsInGameThread()) ? Get() : nullptr;
+	if (Pool && Pool->FreeObjects.Num() > 0)
+	{
+		Wrapper = Pool->FreeObjects.Pop(EAllowShrinking::No);
+	}
+	else
+	{
+		Wrapper = NewObject<USIOJsonObject>();
+	}
+	if (Pool)
+	{
+		Pool->UsedObjects.Add(Wrapper);
+	}
+
+	Wrapper->SetRootObject(InObject);
+	return Wrapper;
+}
+
+void FSIOJsonWrapperPool::SetEnabled(bool bEnabled)
+{
+	bRecycleWrappers = bEnabled;
+}
+
+bool FSIOJsonWrapperPool::IsEnabled()
+{
+	return bRecycleWrappers;
+}
+
+void FSIOJsonWrapperPool::Shutdown()
+{
+	delete PoolInstance;
+	PoolInstance = nullptr;
+}
+
+FSIOJsonWrapperPool* FSIOJsonWrapperPool::Get()
+{
+	if (!PoolInstance)
+	{
+		PoolInstance = new FSIOJsonWrapperPool();
+	}
+	return PoolInstance;
+}
+
+FSIOJsonWrapperPool::FSIOJsonWrapperPool()
+{
+	EndFrameHandle = FCoreDelegates::OnEndFrame.AddRaw(this, &FSIOJsonWrapperPool::Recycle);
+}
+
+FSIOJsonWrapperPool::~FSIOJsonWrapperPool()
+{
+	FCoreDelegates::OnEndFrame.Remove(EndFrameHandle);
+}
+
+void FSIOJsonWrapperPool::Recycle()
+{
+	TSharedPtr<FJsonValue> EmptyValue;
+	for (USIOJsonValue* Wrapper : UsedValues)
+	{
+		if (FreeValues.Num() >= MaxFreeWrappers)
+		{
+			break;
+		}
+		//drop the json it held now rather than when it's next handed out
+		Wrapper->SetRootValue(EmptyValue);
+		FreeValues.Add(Wrapper);
+	}
+	UsedValues.Reset();
+
+	for (USIOJsonObject* Wrapper : UsedObjects)
+	{
+		if (FreeObjects.Num() >= MaxFreeWrappers)
+		{
+			break;
+		}
+		Wrapper->SetRootObject(nullptr);
+		FreeObjects.Add(Wrapper);
+	}
+	UsedObjects.Reset();
+}
+
+void FSIOJsonWrapperPool::AddReferencedObjects(FReferenceCollector& Collector)
+{
+	Collector.AddReferencedObjects(FreeValues);
+	Collector.AddReferencedObjects(UsedValues);
+	Collector.AddReferencedObjects(FreeObjects);
+	Collector.AddReferencedObjects(UsedObjects);
+}
+
+FString FSIOJsonWrapperPool::GetReferencerName() const
+{
+	return TEXT("FSIOJsonWrapperPool");
+}
@@ -51,6 +51,10 @@ public:
 	static bool StructToBytes(UStruct* Struct, void* StructPtr, TArray<uint8>& OutBytes, bool IsBlueprintStruct = false);
 	static bool BytesToStruct(const TArray<uint8>& InBytes, UStruct* Struct, void* StructPtr, bool IsBlueprintStruct = false);
 
+	//Tagged binary, smaller and faster than json and tolerant of added/removed fields, see FSIOJStructPlan
+	static bool StructToCompactBytes(UStruct* Struct, const void* StructPtr, TArray<uint8>& OutBytes);
+	static bool CompactBytesToStruct(TArrayView<const uint8> InBytes, UStruct* Struct, void* StructPtr);
+
 	//typically from callbacks
 	static class USIOJsonValue* ToSIOJsonValue(const TArray<TSharedPtr<FJsonValue>>& JsonValueArray);
 
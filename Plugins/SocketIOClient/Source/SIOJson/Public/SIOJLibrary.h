@@ -225,6 +225,56 @@ public:
 		P_NATIVE_END;
 	}
 
+	/**
+	* Writes a struct in the compact tagged binary format. Much smaller than json and safe to read
+	* with a different version of the struct, unknown fields are skipped and missing ones defaulted.
+	*
+	* @param AnyStruct		The struct you wish to convert
+	* @param OutBytes		Compact bytes, e.g. to emit as a binary message or save
+	*/
+	UFUNCTION(BlueprintCallable, Category = "SocketIOFunctions", CustomThunk, meta = (CustomStructureParam = "AnyStruct"))
+	static bool StructToCompactBytes(TFieldPath<FProperty> AnyStruct, TArray<uint8>& OutBytes);
+
+	/**
+	* Fills a struct from bytes written by StructToCompactBytes
+	*
+	* @param InBytes		Compact bytes
+	* @param AnyStruct		The struct you wish to fill
+	* @return				False if the bytes were malformed or a field didn't match its type
+	*/
+	UFUNCTION(BlueprintCallable, Category = "SocketIOFunctions", CustomThunk, meta = (CustomStructureParam = "AnyStruct"))
+	static bool CompactBytesToStruct(const TArray<uint8>& InBytes, TFieldPath<FProperty> AnyStruct);
+
+	//custom thunk needed to handle wildcard structs
+	DECLARE_FUNCTION(execStructToCompactBytes)
+	{
+		Stack.StepCompiledIn<FStructProperty>(NULL);
+		FStructProperty* StructProp = CastField<FStructProperty>(Stack.MostRecentProperty);
+		void* StructPtr = Stack.MostRecentPropertyAddress;
+
+		P_GET_TARRAY_REF(uint8, OutBytes);
+		P_FINISH;
+
+		P_NATIVE_BEGIN;
+		OutBytes.Reset();
+		*(bool*)RESULT_PARAM = USIOJConvert::StructToCompactBytes(StructProp->Struct, StructPtr, OutBytes);
+		P_NATIVE_END;
+	}
+
+	//custom thunk needed to handle wildcard structs
+	DECLARE_FUNCTION(execCompactBytesToStruct)
+	{
+		P_GET_TARRAY_REF(uint8, InBytes);
+		Stack.StepCompiledIn<FStructProperty>(NULL);
+		FStructProperty* StructProp = CastField<FStructProperty>(Stack.MostRecentProperty);
+		void* StructPtr = Stack.MostRecentPropertyAddress;
+		P_FINISH;
+
+		P_NATIVE_BEGIN;
+		*(bool*)RESULT_PARAM = USIOJConvert::CompactBytesToStruct(InBytes, StructProp->Struct, StructPtr);
+		P_NATIVE_END;
+	}
+
 	//Conversion Nodes - comments added for blueprint hover with compact nodes
 
 	//To JsonValue (Array)
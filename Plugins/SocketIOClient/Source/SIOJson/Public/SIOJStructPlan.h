@@ -0,0 +1,183 @@
+// Copyright 2018-current Getnamo. All Rights Reserved
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/UnrealType.h"
+#include "Dom/JsonValue.h"
+#include "Serialization/JsonReader.h"
+#include <atomic>
+
+struct FTrimmedKeyMap;
+
+/**
+* Cached json codec for one UStruct. Keys are standardized (and trimmed for blueprint structs) once,
+* each field keeps its offset and a reader/writer picked for its property type. Writes condensed
+* UTF-8 json straight from struct memory and reads with the streaming json reader straight into it,
+* no FJsonObject is built in between. Keys and layout follow USIOJConvert::ToJsonObject + ToJsonString
+* with three differences: blueprint field names only lose a generated _N_<guid> suffix where TrimKey
+* cuts any name at its second to last '_', floats and doubles are written with the fewest of 6..9 and
+* 15..17 significant digits that read back to the same value rather than widened to double first, and
+* uint64 is written exactly rather than rounded through a double.
+*
+* Plans are shared and thread safe, Get rebuilds them when a struct or any struct it contains
+* changes layout e.g. a recompiled blueprint struct.
+*
+* The same plan also writes a compact tagged binary format. Each field is prefixed with a varint tag
+* holding an id hashed from its json key and a wire type, integers are zig-zag varints, floats are
+* fixed width and strings, containers and nested structs are length prefixed. Length prefixed wire
+* types also tell strings, structs, sequences, maps and json apart. Readers skip fields they don't
+* know, fields whose kind changed and length prefixed fields whose contents don't fit, and leave
+* fields missing from the bytes at their struct defaults, so peers on different struct versions
+* stay compatible as long as renamed fields aren't expected to carry over.
+*/
+class SIOJSON_API FSIOJStructPlan
+{
+public:
+	typedef TSharedPtr<const FSIOJStructPlan, ESPMode::ThreadSafe> FPlanPtr;
+
+	static FPlanPtr Get(const UStruct* Struct, bool bBlueprintStruct = false);
+
+	/** Appends the struct as json to OutUtf8 */
+	void Write(const void* StructPtr, TArray<uint8>& OutUtf8) const;
+
+	/**
+	* Appends a json object holding only the fields of StructPtr that differ from BasePtr, nested structs
+	* recurse so only their changed fields are written. Other containers are written whole when any item
+	* differs. Reading the result onto a copy of the base (Read or FJsonObjectConverter) gives StructPtr.
+	* Returns false and appends {} if nothing changed.
+	*/
+	bool WriteDelta(const void* StructPtr, const void* BasePtr, TArray<uint8>& OutUtf8) const;
+
+	/** Fills StructPtr from json text, fields missing from the json keep their value. False on malformed json or mismatched fields. */
+	bool Read(FStringView Json, void* StructPtr) const;
+
+	/** Appends the struct in the compact tagged binary format */
+	void WriteCompact(const void* StructPtr, TArray<uint8>& OutBytes) const;
+
+	/** Resets StructPtr to its defaults then fills it from compact bytes. False on malformed bytes or mismatched fields. */
+	bool ReadCompact(TArrayView<const uint8> Bytes, void* StructPtr) const;
+
+	/** Long blueprint key lookup for USIOJConvert::JsonObjectToUStruct, built once per plan */
+	TSharedPtr<FTrimmedKeyMap> GetTrimmedKeyMap() const;
+
+	const UStruct* GetStruct() const
+	{
+		return Struct;
+	}
+
+	~FSIOJStructPlan();
+
+private:
+	enum class EKind : uint8
+	{
+		Bool,
+		Int,
+		UInt,
+		Float,
+		Double,
+		Enum,
+		EnumDisplayName,	//blueprint byte enums
+		String,
+		Name,
+		Text,
+		Array,
+		Bytes,				//blueprint byte arrays, base64
+		Set,
+		Map,
+		Struct,
+		ExportText,			//structs with ExportTextItem e.g. FDateTime, written as a string
+		Converter			//anything else goes through FJsonObjectConverter
+	};
+
+	struct FCodec
+	{
+		EKind Kind = EKind::Converter;
+		FProperty* Property = nullptr;
+		FNumericProperty* Numeric = nullptr;
+		UEnum* Enum = nullptr;
+		FPlanPtr StructPlan;
+		const UStruct* RecursiveStruct = nullptr;	//struct contains itself, plan looked up on use
+		TUniquePtr<FCodec> Inner;					//array/set element or map value
+		TUniquePtr<FCodec> Key;						//map key
+	};
+
+	enum class EWireType : uint8
+	{
+		Varint = 0,
+		Fixed64 = 1,
+		LengthPrefixed = 2,		//strings and raw bytes
+		Struct = 3,
+		Sequence = 4,			//arrays, sets and static arrays, a count then the items
+		Fixed32 = 5,
+		Map = 6,
+		Json = 7				//FJsonObjectConverter fallback
+	};
+
+	struct FFieldPlan
+	{
+		TArray<uint8> QuotedKey;	//"key": as UTF-8
+		uint32 CompactTag = 0;		//id << 3 | wire type, 0 if the id collides with an earlier field
+		int32 Offset = 0;
+		int32 ArrayDim = 1;
+		int32 ElementSize = 0;
+		FCodec Codec;
+	};
+
+	struct FStamp
+	{
+		TWeakObjectPtr<const UStruct> Struct;
+		FField* FirstProperty = nullptr;
+		int32 PropertiesSize = 0;
+	};
+
+	struct FReadContext;
+	struct FCompactReader;
+
+	FSIOJStructPlan(const UStruct* InStruct, bool bInBlueprintStruct);
+
+	static FPlanPtr GetInternal(const UStruct* Struct, bool bBlueprintStruct, TArray<const UStruct*>& Building);
+	static FStamp MakeStamp(const UStruct* Struct);
+	bool IsCurrent() const;
+
+	void Build(TArray<const UStruct*>& Building);
+	void BuildCodec(FProperty* Property, FCodec& OutCodec, TArray<const UStruct*>& Building);
+
+	void WriteStruct(const void* StructPtr, TArray<uint8>& Out) const;
+	void WriteField(const FFieldPlan& Field, const uint8* FieldPtr, TArray<uint8>& Out) const;
+	bool WriteDeltaStruct(const void* StructPtr, const void* BasePtr, TArray<uint8>& Out) const;
+	void WriteValue(const FCodec& Codec, const void* Value, TArray<uint8>& Out) const;
+
+	bool ReadStruct(FReadContext& Context, void* StructPtr) const;
+	bool ReadValue(FReadContext& Context, const FCodec& Codec, EJsonNotation Notation, void* Value) const;
+	bool ReadFromString(const FCodec& Codec, const FString& String, void* Value) const;
+
+	static EWireType GetWireType(const FCodec& Codec, int32 ArrayDim);
+	static bool IsLengthPrefixed(EWireType WireType);
+	static bool IsRawBytes(const FCodec& Codec);
+	void WriteCompactStruct(const void* StructPtr, TArray<uint8>& Out) const;
+	void WriteCompactValue(const FCodec& Codec, const void* Value, TArray<uint8>& Out) const;
+	bool ReadCompactStruct(FCompactReader& Reader, int64 End, void* StructPtr) const;
+	bool ReadCompactValue(FCompactReader& Reader, const FCodec& Codec, void* Value) const;
+
+	const UStruct* Struct;
+	bool bBlueprintStruct;
+
+	/** FJsonObjectWrapper and friends only FJsonObjectConverter knows how to handle */
+	bool bUseConverter = false;
+
+	TArray<FFieldPlan> Fields;
+	TMap<FString, int32> FieldIndices;
+
+	/** Compact field id to index in Fields */
+	TMap<uint32, int32> CompactIndices;
+
+	/** This struct and every struct it contains, checked by IsCurrent */
+	TArray<FStamp> Stamps;
+
+	mutable FCriticalSection KeyMapSection;
+	mutable TSharedPtr<FTrimmedKeyMap> TrimmedKeyMap;
+
+	/** Output size of the last write, reserved up front on the next one */
+	mutable std::atomic<int32> LastWriteSize{ 0 };
+};
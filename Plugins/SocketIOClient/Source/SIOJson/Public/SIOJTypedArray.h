@@ -0,0 +1,126 @@
+// Copyright 2018-current Getnamo. All Rights Reserved
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Dom/JsonValue.h"
+
+/** Element type of a typed array binary, stored in its header */
+enum class ESIOJTypedArrayType : uint8
+{
+	None = 0,
+	Float32 = 1,
+	Int32 = 2,
+	UInt16 = 3,
+	Vector3f = 4	//x,y,z float32 triplets
+};
+
+template<typename T> struct TSIOJTypedArrayType { static constexpr ESIOJTypedArrayType Value = ESIOJTypedArrayType::None; };
+template<> struct TSIOJTypedArrayType<float> { static constexpr ESIOJTypedArrayType Value = ESIOJTypedArrayType::Float32; };
+template<> struct TSIOJTypedArrayType<int32> { static constexpr ESIOJTypedArrayType Value = ESIOJTypedArrayType::Int32; };
+template<> struct TSIOJTypedArrayType<uint16> { static constexpr ESIOJTypedArrayType Value = ESIOJTypedArrayType::UInt16; };
+template<> struct TSIOJTypedArrayType<FVector3f> { static constexpr ESIOJTypedArrayType Value = ESIOJTypedArrayType::Vector3f; };
+
+/**
+* Numeric arrays as one binary attachment instead of a json number array: a 4 byte header
+* ('s', 't', element type, 0) followed by the little-endian elements. Received arrays are read
+* in place through typed views, no element is converted.
+*
+* In node.js: new Float32Array(buf.buffer.slice(buf.byteOffset + 4, buf.byteOffset + buf.length))
+*/
+struct SIOJSON_API FSIOJTypedArray
+{
+	static constexpr int32 HeaderSize = 4;
+
+	/** Writes header plus elements to Out, which has room for EncodedSize bytes */
+	template<typename T>
+	static void Encode(TArrayView<const T> Values, uint8* Out)
+	{
+		static_assert(TSIOJTypedArrayType<T>::Value != ESIOJTypedArrayType::None, "Typed arrays hold float, int32, uint16 or FVector3f");
+		static_assert(PLATFORM_LITTLE_ENDIAN, "Typed arrays are sent in memory order");
+		WriteHeader(TSIOJTypedArrayType<T>::Value, Out);
+		FMemory::Memcpy(Out + HeaderSize, Values.GetData(), Values.Num() * sizeof(T));
+	}
+
+	template<typename T>
+	static int64 EncodedSize(TArrayView<const T> Values)
+	{
+		return HeaderSize + (int64)Values.Num() * sizeof(T);
+	}
+
+	template<typename T>
+	static void Encode(TArrayView<const T> Values, TArray<uint8>& OutBytes)
+	{
+		OutBytes.SetNumUninitialized(EncodedSize(Values));
+		Encode(Values, OutBytes.GetData());
+	}
+
+	/** FVector arrays are sent as float32 triplets */
+	static void Encode(TArrayView<const FVector> Values, uint8* Out);
+
+	static int64 EncodedSize(TArrayView<const FVector> Values)
+	{
+		return HeaderSize + (int64)Values.Num() * sizeof(FVector3f);
+	}
+
+	static void Encode(TArrayView<const FVector> Values, TArray<uint8>& OutBytes)
+	{
+		OutBytes.SetNumUninitialized(EncodedSize(Values));
+		Encode(Values, OutBytes.GetData());
+	}
+
+	/** Binary FJsonValue holding the typed array, emits as an attachment */
+	template<typename T>
+	static TSharedPtr<FJsonValue> MakeValue(TArrayView<const T> Values)
+	{
+		TArray<uint8> Bytes;
+		Encode(Values, Bytes);
+		return MakeBinaryValue(MoveTemp(Bytes));
+	}
+
+	static TSharedPtr<FJsonValue> MakeValue(TArrayView<const FVector> Values);
+
+	template<typename T, typename AllocatorType>
+	static TSharedPtr<FJsonValue> MakeValue(const TArray<T, AllocatorType>& Values)
+	{
+		return MakeValue(TArrayView<const T>(Values));
+	}
+
+	/** Element type of Bytes, None if they don't start with a typed array header */
+	static ESIOJTypedArrayType GetType(const uint8* Bytes, int64 Num);
+
+	/** Elements of Bytes as T without a copy, false if they hold another type or are misaligned */
+	template<typename T>
+	static bool View(const uint8* Bytes, int64 Num, TArrayView<const T>& OutView)
+	{
+		OutView = TArrayView<const T>();
+		if (GetType(Bytes, Num) != TSIOJTypedArrayType<T>::Value ||
+			(Num - HeaderSize) % sizeof(T) != 0 || !IsAligned(Bytes + HeaderSize, alignof(T)))
+		{
+			return false;
+		}
+		OutView = TArrayView<const T>((const T*)(Bytes + HeaderSize), (int32)((Num - HeaderSize) / sizeof(T)));
+		return true;
+	}
+
+	/** View into a binary FJsonValue, valid while the value is */
+	template<typename T>
+	static bool View(const TSharedPtr<FJsonValue>& Value, TArrayView<const T>& OutView)
+	{
+		const TArray<uint8>* Bytes = GetBinary(Value);
+		if (!Bytes)
+		{
+			OutView = TArrayView<const T>();
+			return false;
+		}
+		return View(Bytes->GetData(), Bytes->Num(), OutView);
+	}
+
+	/** Float32, Int32 or UInt16 typed array as floats, false for other values */
+	static bool ToNumbers(const TSharedPtr<FJsonValue>& Value, TArray<float>& OutNumbers);
+
+protected:
+	static void WriteHeader(ESIOJTypedArrayType Type, uint8* Out);
+	static const TArray<uint8>* GetBinary(const TSharedPtr<FJsonValue>& Value);
+	static TSharedPtr<FJsonValue> MakeBinaryValue(TArray<uint8>&& Bytes);
+};
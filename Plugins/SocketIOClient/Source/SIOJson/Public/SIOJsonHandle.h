@@ -0,0 +1,33 @@
+// Copyright 2018-current Getnamo. All Rights Reserved
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Dom/JsonValue.h"
+#include "SIOJsonHandle.generated.h"
+
+/**
+* Blueprint handle to a json value without a UObject wrapper, nothing for the GC to trace or free.
+* Copies share the value, a field set through one copy shows in all of them.
+*/
+USTRUCT(BlueprintType, meta = (HasNativeMake = "/Script/SIOJson.SIOJsonHandleLibrary.MakeJsonHandle", HasNativeBreak = "/Script/SIOJson.SIOJsonHandleLibrary.BreakJsonHandle"))
+struct SIOJSON_API FSIOJsonHandle
+{
+	GENERATED_BODY()
+
+	FSIOJsonHandle()
+	{
+	}
+
+	FSIOJsonHandle(const TSharedPtr<FJsonValue>& InValue)
+		: Value(InValue)
+	{
+	}
+
+	TSharedPtr<FJsonValue> Value;
+
+	bool IsValid() const
+	{
+		return Value.IsValid();
+	}
+};
@@ -0,0 +1,160 @@
+// Copyright 2018-current Getnamo. All Rights Reserved
+
+#pragma once
+
+#include "Kismet/BlueprintFunctionLibrary.h"
+#include "SIOJsonHandle.h"
+#include "SIOJsonPath.h"
+#include "SIOJsonValue.h"
+#include "SIOJsonHandleLibrary.generated.h"
+
+class USIOJsonObject;
+
+/**
+* Blueprint access to FSIOJsonHandle. Reading fields and array items hands out more handles,
+* no UObjects are made unless converting to the USIOJsonValue/USIOJsonObject wrappers.
+*/
+UCLASS()
+class SIOJSON_API USIOJsonHandleLibrary : public UBlueprintFunctionLibrary
+{
+	GENERATED_BODY()
+
+public:
+
+	//////////////////////////////////////////////////////////////////////////
+	// Make / Break
+
+	/** Parse json text into a handle, plain numbers and empty text become number and null values */
+	UFUNCTION(BlueprintPure, Category = "SIOJ|Handle", meta = (NativeMakeFunc))
+	static FSIOJsonHandle MakeJsonHandle(const FString& Json);
+
+	/** Type and leaf values of a handle, outputs that don't match the type are left at their defaults */
+	UFUNCTION(BlueprintPure, Category = "SIOJ|Handle", meta = (NativeBreakFunc))
+	static void BreakJsonHandle(const FSIOJsonHandle& Handle, TEnumAsByte<ESIOJson::Type>& Type, double& Number, FString& String, bool& Bool);
+
+	UFUNCTION(BlueprintPure, Category = "SIOJ|Handle")
+	static FSIOJsonHandle MakeStringHandle(const FString& Value);
+
+	UFUNCTION(BlueprintPure, Category = "SIOJ|Handle")
+	static FSIOJsonHandle MakeNumberHandle(double Value);
+
+	UFUNCTION(BlueprintPure, Category = "SIOJ|Handle")
+	static FSIOJsonHandle MakeBoolHandle(bool Value);
+
+	UFUNCTION(BlueprintPure, Category = "SIOJ|Handle")
+	static FSIOJsonHandle MakeNullHandle();
+
+	UFUNCTION(BlueprintPure, Category = "SIOJ|Handle")
+	static FSIOJsonHandle MakeBinaryHandle(const TArray<uint8>& Value);
+
+	UFUNCTION(BlueprintPure, Category = "SIOJ|Handle")
+	static FSIOJsonHandle MakeArrayHandle(const TArray<FSIOJsonHandle>& Items);
+
+	/** A new empty object, fill it with Set Field */
+	UFUNCTION(BlueprintPure, Category = "SIOJ|Handle")
+	static FSIOJsonHandle MakeObjectHandle();
+
+	//////////////////////////////////////////////////////////////////////////
+	// Read
+
+	UFUNCTION(BlueprintPure, Category = "SIOJ|Handle")
+	static bool IsValidHandle(const FSIOJsonHandle& Handle);
+
+	UFUNCTION(BlueprintPure, Category = "SIOJ|Handle")
+	static TEnumAsByte<ESIOJson::Type> GetType(const FSIOJsonHandle& Handle);
+
+	UFUNCTION(BlueprintPure, Category = "SIOJ|Handle")
+	static bool IsNull(const FSIOJsonHandle& Handle);
+
+	/** Field of an object, invalid handle if missing or not an object */
+	UFUNCTION(BlueprintPure, Category = "SIOJ|Handle")
+	static FSIOJsonHandle GetField(const FSIOJsonHandle& Handle, const FString& FieldName);
+
+	UFUNCTION(BlueprintPure, Category = "SIOJ|Handle")
+	static bool HasField(const FSIOJsonHandle& Handle, const FString& FieldName);
+
+	UFUNCTION(BlueprintPure, Category = "SIOJ|Handle")
+	static TArray<FString> GetFieldNames(const FSIOJsonHandle& Handle);
+
+	/** Array item, invalid handle if out of range or not an array */
+	UFUNCTION(BlueprintPure, Category = "SIOJ|Handle")
+	static FSIOJsonHandle GetArrayItem(const FSIOJsonHandle& Handle, int32 Index);
+
+	/** Number of array items, 0 if not an array */
+	UFUNCTION(BlueprintPure, Category = "SIOJ|Handle")
+	static int32 GetArrayLength(const FSIOJsonHandle& Handle);
+
+	UFUNCTION(BlueprintPure, Category = "SIOJ|Handle")
+	static TArray<FSIOJsonHandle> AsArray(const FSIOJsonHandle& Handle);
+
+	UFUNCTION(BlueprintPure, Category = "SIOJ|Handle")
+	static double AsNumber(const FSIOJsonHandle& Handle);
+
+	UFUNCTION(BlueprintPure, Category = "SIOJ|Handle")
+	static int32 AsInt(const FSIOJsonHandle& Handle);
+
+	UFUNCTION(BlueprintPure, Category = "SIOJ|Handle")
+	static FString AsString(const FSIOJsonHandle& Handle);
+
+	UFUNCTION(BlueprintPure, Category = "SIOJ|Handle")
+	static bool AsBool(const FSIOJsonHandle& Handle);
+
+	UFUNCTION(BlueprintPure, Category = "SIOJ|Handle")
+	static TArray<uint8> AsBinary(const FSIOJsonHandle& Handle);
+
+	UFUNCTION(BlueprintPure, Category = "SIOJ|Handle")
+	static FString EncodeJson(const FSIOJsonHandle& Handle);
+
+	//////////////////////////////////////////////////////////////////////////
+	// Write
+
+	/** Sets a field on an object handle, shared by every copy of the handle. Returns the handle for chaining. */
+	UFUNCTION(BlueprintCallable, Category = "SIOJ|Handle")
+	static FSIOJsonHandle SetField(const FSIOJsonHandle& Handle, const FString& FieldName, const FSIOJsonHandle& Value);
+
+	UFUNCTION(BlueprintCallable, Category = "SIOJ|Handle")
+	static FSIOJsonHandle RemoveField(const FSIOJsonHandle& Handle, const FString& FieldName);
+
+	//////////////////////////////////////////////////////////////////////////
+	// Path
+
+	/** Compiles a path like "state.players[3].pos.x". Store it in a variable so it's only parsed once. */
+	UFUNCTION(BlueprintPure, Category = "SIOJ|Path", meta = (NativeMakeFunc))
+	static FSIOJsonPath MakeJsonPath(const FString& Path);
+
+	/** Compiles several paths to resolve in one walk with Get Paths */
+	UFUNCTION(BlueprintPure, Category = "SIOJ|Path", meta = (NativeMakeFunc))
+	static FSIOJsonPathSet MakeJsonPathSet(const TArray<FString>& Paths);
+
+	UFUNCTION(BlueprintPure, Category = "SIOJ|Path")
+	static bool IsValidPath(const FSIOJsonPath& Path);
+
+	/** Value at the path, invalid handle if it doesn't resolve */
+	UFUNCTION(BlueprintPure, Category = "SIOJ|Path")
+	static FSIOJsonHandle GetPath(const FSIOJsonHandle& Handle, const FSIOJsonPath& Path);
+
+	UFUNCTION(BlueprintPure, Category = "SIOJ|Path", meta = (ReturnDisplayName = "Found"))
+	static bool GetPathNumber(const FSIOJsonHandle& Handle, const FSIOJsonPath& Path, double& Number);
+
+	UFUNCTION(BlueprintPure, Category = "SIOJ|Path", meta = (ReturnDisplayName = "Found"))
+	static bool GetPathString(const FSIOJsonHandle& Handle, const FSIOJsonPath& Path, FString& String);
+
+	UFUNCTION(BlueprintPure, Category = "SIOJ|Path", meta = (ReturnDisplayName = "Found"))
+	static bool GetPathBool(const FSIOJsonHandle& Handle, const FSIOJsonPath& Path, bool& Bool);
+
+	/** One handle per path in the set, in order, invalid where a path doesn't resolve */
+	UFUNCTION(BlueprintPure, Category = "SIOJ|Path")
+	static TArray<FSIOJsonHandle> GetPaths(const FSIOJsonHandle& Handle, const FSIOJsonPathSet& Paths);
+
+	//////////////////////////////////////////////////////////////////////////
+	// Wrapper interop
+
+	UFUNCTION(BlueprintPure, meta = (DisplayName = "To Json Value (Handle)", BlueprintAutocast), Category = "SIOJ|Handle")
+	static USIOJsonValue* Conv_HandleToJsonValue(const FSIOJsonHandle& Handle);
+
+	UFUNCTION(BlueprintPure, meta = (DisplayName = "To Json Handle (JsonValue)", BlueprintAutocast), Category = "SIOJ|Handle")
+	static FSIOJsonHandle Conv_JsonValueToHandle(USIOJsonValue* Value);
+
+	UFUNCTION(BlueprintPure, meta = (DisplayName = "To Json Handle (JsonObject)", BlueprintAutocast), Category = "SIOJ|Handle")
+	static FSIOJsonHandle Conv_JsonObjectToHandle(USIOJsonObject* Object);
+};
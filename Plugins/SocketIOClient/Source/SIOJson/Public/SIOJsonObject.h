@@ -153,6 +153,7 @@ class SIOJSON_API USIOJsonObject : public UObject
 	// Array fields helpers (uniform arrays)
 
 	/** Get the field named FieldName as a Number Array. Use it only if you're sure that array is uniform!
+	 * Also reads float32, int32 and uint16 typed array binaries, see FSIOJTypedArray.
 	 * Attn.!! float used instead of double to make the function blueprintable! */
 	UFUNCTION(BlueprintCallable, Category = "SIOJ|Json")
 	TArray<float> GetNumberArrayField(const FString& FieldName);
@@ -0,0 +1,176 @@
+// Copyright 2018-current Getnamo. All Rights Reserved
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Dom/JsonValue.h"
+#include "Dom/JsonObject.h"
+#include <string>
+#include "SIOJsonPath.generated.h"
+
+/**
+* A path into nested json e.g. "state.players[3].pos.x", parsed once into keys with precomputed hashes
+* and array indices. Resolving walks the tree without allocating or copying shared pointers.
+*
+* Syntax: optional leading '$', dot separated keys, [N] array indices (negative counts from the end)
+* and ['key'] or ["key"] for keys containing '.', '[' or quotes. An empty path resolves the root.
+*
+* Key matching follows the tree: FJsonObject keys compare case-insensitively like FJsonObject::Values
+* itself, so "Pos" finds "pos". sio::message objects are std::map keyed and compare case-sensitively.
+* Use the exact key casing when one path is resolved against both.
+*/
+USTRUCT(BlueprintType, meta = (HasNativeMake = "/Script/SIOJson.SIOJsonHandleLibrary.MakeJsonPath"))
+struct SIOJSON_API FSIOJsonPath
+{
+	GENERATED_BODY()
+
+	struct FSegment
+	{
+		FString Key;
+		std::string Utf8Key;	//for lookups in std::map keyed trees e.g. sio::message
+		uint32 KeyHash = 0;
+		int32 Index = 0;
+		bool bIsIndex = false;
+	};
+
+	FSIOJsonPath()
+	{
+	}
+
+	/** Compiles Path, an invalid path is logged and resolves nothing */
+	explicit FSIOJsonPath(const FString& Path);
+
+	/** Compiles Path into OutPath, returns false with a reason in OutError on a syntax error */
+	static bool Compile(const FString& Path, FSIOJsonPath& OutPath, FString* OutError = nullptr);
+
+	bool IsValid() const
+	{
+		return bValid;
+	}
+
+	const FString& ToString() const
+	{
+		return Source;
+	}
+
+	const TArray<FSegment>& GetSegments() const
+	{
+		return Segments;
+	}
+
+	/** Value at the path, nullptr if any step is missing or of the wrong type */
+	const TSharedPtr<FJsonValue>* Resolve(const TSharedPtr<FJsonValue>& Root) const;
+	const TSharedPtr<FJsonValue>* Resolve(const TSharedPtr<FJsonObject>& Root) const;
+
+	bool TryGetNumber(const TSharedPtr<FJsonValue>& Root, double& OutNumber) const;
+	bool TryGetString(const TSharedPtr<FJsonValue>& Root, FString& OutString) const;
+	bool TryGetBool(const TSharedPtr<FJsonValue>& Root, bool& bOutBool) const;
+	bool TryGetObject(const TSharedPtr<FJsonValue>& Root, const TSharedPtr<FJsonObject>*& OutObject) const;
+	bool TryGetArray(const TSharedPtr<FJsonValue>& Root, const TArray<TSharedPtr<FJsonValue>>*& OutArray) const;
+
+	double GetNumber(const TSharedPtr<FJsonValue>& Root, double Default = 0.0) const;
+	FString GetString(const TSharedPtr<FJsonValue>& Root, const FString& Default = FString()) const;
+	bool GetBool(const TSharedPtr<FJsonValue>& Root, bool bDefault = false) const;
+
+	/** One step down a FJsonValue tree, keys match case-insensitively */
+	static const TSharedPtr<FJsonValue>* Step(const TSharedPtr<FJsonValue>& Value, const FSegment& Segment);
+
+	/** Resolves against any tree given a Step(const ValueType&, const FSegment&) -> const ValueType* */
+	template<typename ValueType, typename StepFunctionType>
+	const ValueType* ResolveWith(const ValueType& Root, StepFunctionType&& StepFunction) const
+	{
+		if (!bValid)
+		{
+			return nullptr;
+		}
+		const ValueType* Value = &Root;
+		for (const FSegment& Segment : Segments)
+		{
+			Value = StepFunction(*Value, Segment);
+			if (!Value)
+			{
+				return nullptr;
+			}
+		}
+		return Value;
+	}
+
+private:
+	FString Source;
+	TArray<FSegment> Segments;
+	bool bValid = false;
+};
+
+/**
+* Several paths compiled into a prefix tree so one walk resolves all of them, shared prefixes are only
+* looked up once. Results come back in the order the paths were given.
+*/
+USTRUCT(BlueprintType, meta = (HasNativeMake = "/Script/SIOJson.SIOJsonHandleLibrary.MakeJsonPathSet"))
+struct SIOJSON_API FSIOJsonPathSet
+{
+	GENERATED_BODY()
+
+	FSIOJsonPathSet()
+	{
+	}
+
+	explicit FSIOJsonPathSet(const TArray<FSIOJsonPath>& Paths);
+	explicit FSIOJsonPathSet(const TArray<FString>& Paths);
+
+	/** Adds a path, returns its result index */
+	int32 Add(const FSIOJsonPath& Path);
+
+	int32 Num() const
+	{
+		return NumPaths;
+	}
+
+	/** Fills OutValues with one entry per path, nullptr where it didn't resolve. Reuses OutValues' allocation. */
+	void Resolve(const TSharedPtr<FJsonValue>& Root, TArray<const TSharedPtr<FJsonValue>*>& OutValues) const;
+
+	/** ResolveWith for any tree, see FSIOJsonPath::ResolveWith */
+	template<typename ValueType, typename StepFunctionType>
+	void ResolveWith(const ValueType& Root, StepFunctionType&& StepFunction, TArray<const ValueType*>& OutValues) const
+	{
+		OutValues.Reset(NumPaths);
+		OutValues.AddZeroed(NumPaths);
+		if (Nodes.Num() > 0)
+		{
+			Walk(0, &Root, StepFunction, OutValues);
+		}
+	}
+
+private:
+	struct FNode
+	{
+		FSIOJsonPath::FSegment Segment;
+		int32 FirstChild = INDEX_NONE;
+		int32 NextSibling = INDEX_NONE;
+		int32 FirstOutput = INDEX_NONE;
+	};
+
+	template<typename ValueType, typename StepFunctionType>
+	void Walk(int32 NodeIndex, const ValueType* Value, StepFunctionType& StepFunction, TArray<const ValueType*>& OutValues) const
+	{
+		const FNode& Node = Nodes[NodeIndex];
+		for (int32 Output = Node.FirstOutput; Output != INDEX_NONE; Output = NextOutput[Output])
+		{
+			OutValues[Output] = Value;
+		}
+		for (int32 Child = Node.FirstChild; Child != INDEX_NONE; Child = Nodes[Child].NextSibling)
+		{
+			if (const ValueType* ChildValue = StepFunction(*Value, Nodes[Child].Segment))
+			{
+				Walk(Child, ChildValue, StepFunction, OutValues);
+			}
+		}
+	}
+
+	//Node 0 is the root
+	TArray<FNode> Nodes;
+
+	//Paths ending on the same node, chained from FNode::FirstOutput
+	TArray<int32> NextOutput;
+
+	int32 NumPaths = 0;
+};
@@ -36,6 +36,7 @@ class SIOJSON_API FJsonValueBinary : public FJsonValue
 {
 public:
 	FJsonValueBinary(const TArray<uint8>& InBinary) : Value(InBinary) { Type = EJson::String; }	//pretends to be none
+	FJsonValueBinary(TArray<uint8>&& InBinary) : Value(MoveTemp(InBinary)) { Type = EJson::String; }
 
 	virtual bool TryGetString(FString& OutString) const override 
 	{
@@ -55,6 +56,9 @@ public:
 	/** Return our binary data from this value */
 	TArray<uint8> AsBinary() { return Value; }
 
+	/** Binary data without a copy, valid while this value is */
+	const TArray<uint8>& GetBinary() const { return Value; }
+
 	/** Convenience method to determine if passed FJsonValue is a FJsonValueBinary or not. */
 	static bool IsBinary(const TSharedPtr<FJsonValue>& InJsonValue);
 
@@ -123,6 +127,9 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "SIOJ|Json")
 	ESIOJson::Type GetType() const;
 
+	/** Type of a raw FJsonValue, binary included */
+	static ESIOJson::Type GetTypeOf(const TSharedPtr<FJsonValue>& InValue);
+
 	/** Get type of Json value (String) */
 	UFUNCTION(BlueprintCallable, Category = "SIOJ|Json")
 	FString GetTypeString() const;
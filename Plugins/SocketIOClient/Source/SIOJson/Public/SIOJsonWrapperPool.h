@@ -0,0 +1,49 @@
+// Copyright 2018-current Getnamo. All Rights Reserved
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/GCObject.h"
+#include "Dom/JsonValue.h"
+#include "Dom/JsonObject.h"
+
+class USIOJsonValue;
+class USIOJsonObject;
+
+/**
+* Opt-in recycling of the USIOJsonValue/USIOJsonObject wrappers handed out while reading json, i.e. field and
+* array accessors and event payloads. Wrappers handed out during a frame return to the pool at its end, only
+* enable it if no blueprint keeps such a wrapper past that frame. Game thread only, other threads and a
+* disabled pool get regular NewObject wrappers. Toggle with SetEnabled or the SIOJson.RecycleWrappers cvar.
+*/
+class SIOJSON_API FSIOJsonWrapperPool : public FGCObject
+{
+public:
+	static USIOJsonValue* AcquireValue(const TSharedPtr<FJsonValue>& InValue);
+	static USIOJsonObject* AcquireObject(const TSharedPtr<FJsonObject>& InObject);
+
+	static void SetEnabled(bool bEnabled);
+	static bool IsEnabled();
+
+	/** Releases the pool, called on module shutdown */
+	static void Shutdown();
+
+	virtual void AddReferencedObjects(FReferenceCollector& Collector) override;
+	virtual FString GetReferencerName() const override;
+
+protected:
+	FSIOJsonWrapperPool();
+	virtual ~FSIOJsonWrapperPool();
+
+	static FSIOJsonWrapperPool* Get();
+
+	/** End of frame, everything handed out goes back to the free lists */
+	void Recycle();
+
+	TArray<TObjectPtr<USIOJsonValue>> FreeValues;
+	TArray<TObjectPtr<USIOJsonValue>> UsedValues;
+	TArray<TObjectPtr<USIOJsonObject>> FreeObjects;
+	TArray<TObjectPtr<USIOJsonObject>> UsedObjects;
+
+	FDelegateHandle EndFrameHandle;
+};
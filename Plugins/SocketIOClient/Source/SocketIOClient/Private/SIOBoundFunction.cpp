@@ -0,0 +1,267 @@
+// Copyright 2018-current Getnamo. All Rights Reserved
+
+#include "SIOBoundFunction.h"
+#include "SIOMessageConvert.h"
+#include "SIOJConvert.h"
+#include "SIOJsonValue.h"
+#include "SIOJsonObject.h"
+#include "SIOJsonHandle.h"
+#include "SIOJsonWrapperPool.h"
+#include "UObject/UnrealType.h"
+
+//Starts at 1, a binding at generation 0 has never resolved
+std::atomic<uint32> FSIOBoundFunction::GlobalGeneration{ 1 };
+
+FSIOBoundFunction::FSIOBoundFunction(UObject* InTarget, const FString& InFunctionName)
+	: Target(InTarget)
+	, FunctionName(InFunctionName)
+{
+	if (InTarget)
+	{
+		Resolved = Resolve(InTarget);
+	}
+}
+
+void FSIOBoundFunction::InvalidateAll()
+{
+	GlobalGeneration++;
+}
+
+FSIOBoundFunction::FResolvedPtr FSIOBoundFunction::GetResolved(UObject* InTarget)
+{
+	FScopeLock Lock(&ResolveSection);
+
+	//recompiled or reinstanced since the last call
+	if (!Resolved.IsValid() || Resolved->Generation != GlobalGeneration || Resolved->ResolvedClass.Get() != InTarget->GetClass() || !Resolved->Function.IsValid())
+	{
+		Resolved = Resolve(InTarget);
+	}
+	return Resolved;
+}
+
+FSIOBoundFunction::FResolvedPtr FSIOBoundFunction::Resolve(UObject* InTarget) const
+{
+	TSharedRef<FResolved, ESPMode::ThreadSafe> State = MakeShared<FResolved, ESPMode::ThreadSafe>();
+	State->ResolvedClass = InTarget->GetClass();
+	State->Generation = GlobalGeneration;
+
+	UFunction* FoundFunction = InTarget->FindFunction(FName(*FunctionName));
+	if (!FoundFunction)
+	{
+		return State;
+	}
+	State->Function = FoundFunction;
+
+	TArray<FProperty*>& Params = State->Params;
+	EParamKind& Kind = State->Kind;
+
+	for (TFieldIterator<FProperty> It(FoundFunction); It && (It->PropertyFlags & CPF_Parm); ++It)
+	{
+		Params.Add(*It);
+	}
+	if (Params.Num() == 0)
+	{
+		return State;
+	}
+
+	FProperty* FirstParam = Params[0];
+	if (FObjectProperty* ObjectProperty = CastField<FObjectProperty>(FirstParam))
+	{
+		if (ObjectProperty->PropertyClass->IsChildOf(USIOJsonValue::StaticClass()))
+		{
+			Kind = EParamKind::JsonValue;
+		}
+		else if (ObjectProperty->PropertyClass->IsChildOf(USIOJsonObject::StaticClass()))
+		{
+			Kind = EParamKind::JsonObject;
+		}
+		else
+		{
+			Kind = EParamKind::Unsupported;
+		}
+
+		//json wrappers may take the full response as a second parameter
+		FObjectProperty* SecondParam = Params.Num() > 1 ? CastField<FObjectProperty>(Params[1]) : nullptr;
+		if (Kind != EParamKind::Unsupported && SecondParam && SecondParam->PropertyClass->IsChildOf(USIOJsonValue::StaticClass()))
+		{
+			State->ResponseParam = SecondParam;
+		}
+	}
+	else if (FStructProperty* StructProperty = CastField<FStructProperty>(FirstParam))
+	{
+		Kind = StructProperty->Struct == FSIOJsonHandle::StaticStruct() ? EParamKind::Handle : EParamKind::Unsupported;
+	}
+	else if (CastField<FStrProperty>(FirstParam))
+	{
+		Kind = EParamKind::String;
+	}
+	else if (CastField<FBoolProperty>(FirstParam))
+	{
+		Kind = EParamKind::Bool;
+	}
+	else if (FNumericProperty* NumericProperty = CastField<FNumericProperty>(FirstParam))
+	{
+		if (NumericProperty->IsFloatingPoint())
+		{
+			Kind = EParamKind::Float;
+		}
+		else if (NumericProperty->IsInteger() && !NumericProperty->IsEnum())
+		{
+			Kind = EParamKind::Int;
+		}
+		else
+		{
+			Kind = EParamKind::Unsupported;
+		}
+	}
+	else if (FArrayProperty* ArrayProperty = CastField<FArrayProperty>(FirstParam))
+	{
+		//byte array is the only supported version
+		FByteProperty* Inner = CastField<FByteProperty>(ArrayProperty->Inner);
+		Kind = (Inner && !Inner->IsEnum()) ? EParamKind::Bytes : EParamKind::Unsupported;
+	}
+	else
+	{
+		Kind = EParamKind::Unsupported;
+	}
+	return State;
+}
+
+bool FSIOBoundFunction::Call(const TSharedPtr<FJsonValue>& Message)
+{
+	TArray<TSharedPtr<FJsonValue>> Response;
+	Response.Add(Message);
+
+	return Call(Response);
+}
+
+bool FSIOBoundFunction::Call(const TArray<TSharedPtr<FJsonValue>>& Response)
+{
+	UObject* TargetObject = Target.Get();
+	if (!TargetObject)
+	{
+		UE_LOG(SocketIO, Warning, TEXT("CallFunctionByNameWithArguments: Target not found for '%s'"), *FunctionName);
+		return false;
+	}
+	UWorld* World = TargetObject->GetWorld();
+	if (!World)
+	{
+		UE_LOG(SocketIO, Log, TEXT("World is invalid, %s BP function call ignored."), *FunctionName);
+		return false;
+	}
+	if (World->bIsTearingDown)
+	{
+		UE_LOG(SocketIO, Log, TEXT("World tearing down, %s BP function call ignored."), *FunctionName);
+		return false;
+	}
+
+	const FResolvedPtr State = GetResolved(TargetObject);
+	const EParamKind Kind = State->Kind;
+
+	UFunction* TargetFunction = State->Function.Get();
+	if (!TargetFunction)
+	{
+		UE_LOG(SocketIO, Warning, TEXT("CallFunctionByNameWithArguments: Function not found '%s'"), *FunctionName);
+		return false;
+	}
+
+	if (Kind == EParamKind::None)
+	{
+		const bool bNullResponse = Response.Num() == 0 || (Response.Num() == 1 && (!Response[0].IsValid() || Response[0]->IsNull()));
+		if (!bNullResponse)
+		{
+			UE_LOG(SocketIO, Warning, TEXT("CallFunctionByNameWithArguments: Function '%s' has too few parameters, callback parameters ignored : <%s>"), *FunctionName, *USIOJConvert::ToJsonString(Response));
+		}
+		TargetObject->ProcessEvent(TargetFunction, nullptr);
+		return true;
+	}
+
+	if (Response.Num() == 0 || !Response[0].IsValid() || Kind == EParamKind::Unsupported)
+	{
+		UE_LOG(SocketIO, Warning, TEXT("CallFunctionByNameWithArguments: Function '%s' signature not supported expected <%s>"), *FunctionName, *USIOJConvert::ToJsonString(Response));
+		return false;
+	}
+
+	uint8* ParamBuffer = (uint8*)FMemory_Alloca_Aligned(TargetFunction->ParmsSize, TargetFunction->GetMinAlignment());
+	FMemory::Memzero(ParamBuffer, TargetFunction->ParmsSize);
+	for (FProperty* Param : State->Params)
+	{
+		Param->InitializeValue_InContainer(ParamBuffer);
+	}
+
+	const bool bFilled = FillParams(*State, ParamBuffer, Response);
+	if (bFilled)
+	{
+		TargetObject->ProcessEvent(TargetFunction, ParamBuffer);
+	}
+
+	for (FProperty* Param : State->Params)
+	{
+		Param->DestroyValue_InContainer(ParamBuffer);
+	}
+	return bFilled;
+}
+
+bool FSIOBoundFunction::FillParams(const FResolved& State, uint8* ParamBuffer, const TArray<TSharedPtr<FJsonValue>>& Response)
+{
+	FProperty* FirstParam = State.Params[0];
+	void* FirstValue = FirstParam->ContainerPtrToValuePtr<void>(ParamBuffer);
+	const TSharedPtr<FJsonValue>& FirstJsonValue = Response[0];
+
+	switch (State.Kind)
+	{
+	case EParamKind::JsonValue:
+	{
+		//convenience wrapper, response is a single object
+		USIOJsonValue* Value = FSIOJsonWrapperPool::AcquireValue(FirstJsonValue);
+		CastField<FObjectProperty>(FirstParam)->SetObjectPropertyValue(FirstValue, Value);
+		break;
+	}
+	case EParamKind::JsonObject:
+	{
+		USIOJsonObject* ObjectValue = FSIOJsonWrapperPool::AcquireObject(FirstJsonValue->AsObject());
+		CastField<FObjectProperty>(FirstParam)->SetObjectPropertyValue(FirstValue, ObjectValue);
+		break;
+	}
+	case EParamKind::Handle:
+		*(FSIOJsonHandle*)FirstValue = FSIOJsonHandle(FirstJsonValue);
+		break;
+	case EParamKind::String:
+		*(FString*)FirstValue = USIOJConvert::ToJsonString(FirstJsonValue);
+		break;
+	case EParamKind::Float:
+		CastField<FNumericProperty>(FirstParam)->SetFloatingPointPropertyValue(FirstValue, FirstJsonValue->AsNumber());
+		break;
+	case EParamKind::Int:
+		CastField<FNumericProperty>(FirstParam)->SetIntPropertyValue(FirstValue, (int64)FirstJsonValue->AsNumber());
+		break;
+	case EParamKind::Bool:
+		CastField<FBoolProperty>(FirstParam)->SetPropertyValue(FirstValue, FirstJsonValue->AsBool());
+		break;
+	case EParamKind::Bytes:
+		if (FJsonValueBinary::IsBinary(FirstJsonValue))
+		{
+			*(TArray<uint8>*)FirstValue = FJsonValueBinary::AsBinary(FirstJsonValue);
+		}
+		else if (FirstJsonValue->Type == EJson::String)
+		{
+			//hex string fallback, same decode as USIOJsonValue::AsBinary without the wrapper
+			const FString& HexString = FirstJsonValue->AsString();
+			TArray<uint8>& ByteArray = *(TArray<uint8>*)FirstValue;
+			ByteArray.SetNumUninitialized(HexString.Len() / 2);
+			if (!FString::ToHexBlob(HexString, ByteArray.GetData(), ByteArray.Num()))
+			{
+				ByteArray.Empty();
+			}
+		}
+		break;
+	default:
+		return false;
+	}
+
+	if (State.ResponseParam)
+	{
+		CastField<FObjectProperty>(State.ResponseParam)->SetObjectPropertyValue_InContainer(ParamBuffer, USIOJConvert::ToSIOJsonValue(Response));
+	}
+	return true;
+}
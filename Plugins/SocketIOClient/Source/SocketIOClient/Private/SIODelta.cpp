@@ -0,0 +1,173 @@
+// Copyright 2018-current Getnamo. All Rights Reserved
+
+#include "SIODelta.h"
+#include "SIOJStructPlan.h"
+#include "SIOMessageConvert.h"
+#include "Policies/CondensedJsonPrintPolicy.h"
+#include "Serialization/JsonSerializer.h"
+
+namespace
+{
+	const TCHAR* SeqField = TEXT("seq");
+	const TCHAR* BaseField = TEXT("base");
+	const TCHAR* DeltaField = TEXT("delta");
+}
+
+FSIODeltaSender::FSIODeltaSender(const UScriptStruct* InStruct)
+	: MaxPending(32)
+	, Struct(InStruct)
+	, NextSeq(1)
+	, BaseSeq(0)
+{
+}
+
+TSharedPtr<FStructOnScope> FSIODeltaSender::CopyStruct(const void* StructPtr) const
+{
+	TSharedPtr<FStructOnScope> Copy = MakeShared<FStructOnScope>(Struct.Get());
+	if (StructPtr)
+	{
+		Struct->CopyScriptStruct(Copy->GetStructMemory(), StructPtr);
+	}
+	return Copy;
+}
+
+sio::prepared_packet::ptr FSIODeltaSender::Encode(const FString& EventName, const void* StructPtr, int64& OutSeq)
+{
+	OutSeq = 0;
+	if (!Struct.IsValid() || !StructPtr)
+	{
+		return nullptr;
+	}
+
+	FScopeLock Lock(&Section);
+
+	//receiver stopped acking, start over from defaults so it can always apply
+	if (Pending.Num() >= MaxPending)
+	{
+		UE_LOG(SocketIO, Warning, TEXT("FSIODeltaSender: %d %s updates unacked, resending against defaults"), Pending.Num(), *Struct->GetName());
+		Pending.Reset();
+		Base.Reset();
+		BaseSeq = 0;
+	}
+	if (!Base.IsValid())
+	{
+		Base = CopyStruct(nullptr);
+	}
+
+	TArray<uint8> DeltaJson;
+	FSIOJStructPlan::Get(Struct.Get())->WriteDelta(StructPtr, Base->GetStructMemory(), DeltaJson);
+
+	OutSeq = NextSeq++;
+	Pending.Emplace(OutSeq, CopyStruct(StructPtr));
+
+	const std::string Name = USIOMessageConvert::StdString(EventName);
+	sio::event_writer Writer;
+	Writer.begin_event(sio::event_writer::quote(Name.data(), Name.size()));
+	Writer.start_object();
+	Writer.key("seq", 3);
+	Writer.int_value(OutSeq);
+	Writer.key("base", 4);
+	Writer.int_value(BaseSeq);
+	Writer.key("delta", 5);
+	Writer.raw_value((const char*)DeltaJson.GetData(), DeltaJson.Num());
+	Writer.end_object();
+	return Writer.finish(Name);
+}
+
+void FSIODeltaSender::Acknowledge(int64 Seq)
+{
+	FScopeLock Lock(&Section);
+	if (Seq <= BaseSeq)
+	{
+		return;
+	}
+
+	const int32 Index = Pending.IndexOfByPredicate([Seq](const FSnapshot& Snapshot) { return Snapshot.Key == Seq; });
+	if (Index == INDEX_NONE)
+	{
+		return;
+	}
+
+	//older sends can't become the base anymore
+	BaseSeq = Seq;
+	Base = Pending[Index].Value;
+	Pending.RemoveAt(0, Index + 1, EAllowShrinking::No);
+}
+
+void FSIODeltaSender::Reset()
+{
+	FScopeLock Lock(&Section);
+	Pending.Reset();
+	Base.Reset();
+	BaseSeq = 0;
+}
+
+FSIODeltaReceiver::FSIODeltaReceiver(const UScriptStruct* InStruct)
+	: MaxSnapshots(32)
+	, Struct(InStruct)
+	, LatestSeq(0)
+{
+}
+
+bool FSIODeltaReceiver::Apply(const TSharedPtr<FJsonObject>& Message, void* StructPtr, int64& OutSeq)
+{
+	OutSeq = 0;
+	int64 Seq = 0;
+	int64 BaseSeq = 0;
+	const TSharedPtr<FJsonObject>* Delta = nullptr;
+	if (!Struct.IsValid() || !StructPtr || !Message.IsValid() ||
+		!Message->TryGetNumberField(SeqField, Seq) || !Message->TryGetNumberField(BaseField, BaseSeq) ||
+		!Message->TryGetObjectField(DeltaField, Delta))
+	{
+		UE_LOG(SocketIO, Warning, TEXT("FSIODeltaReceiver: malformed delta message"));
+		return false;
+	}
+
+	//a late message would roll the struct back to an older state
+	if (Seq <= LatestSeq)
+	{
+		UE_LOG(SocketIO, Verbose, TEXT("FSIODeltaReceiver: %s delta %lld is older than %lld, dropped"), *Struct->GetName(), Seq, LatestSeq);
+		return false;
+	}
+
+	TSharedPtr<FStructOnScope> Result = MakeShared<FStructOnScope>(Struct.Get());
+	if (BaseSeq != 0)
+	{
+		const FSnapshot* Base = Snapshots.FindByPredicate([BaseSeq](const FSnapshot& Snapshot) { return Snapshot.Key == BaseSeq; });
+		if (!Base)
+		{
+			UE_LOG(SocketIO, Warning, TEXT("FSIODeltaReceiver: %s base %lld is unknown, waiting for the sender to resync"), *Struct->GetName(), BaseSeq);
+			return false;
+		}
+		Struct->CopyScriptStruct(Result->GetStructMemory(), Base->Value->GetStructMemory());
+	}
+
+	//missing fields are left alone, which is what makes the object a delta
+	FString DeltaJson;
+	TSharedRef<TJsonWriter<TCHAR, TCondensedJsonPrintPolicy<TCHAR>>> Writer = TJsonWriterFactory<TCHAR, TCondensedJsonPrintPolicy<TCHAR>>::Create(&DeltaJson);
+	FJsonSerializer::Serialize(Delta->ToSharedRef(), Writer);
+	if (!FSIOJStructPlan::Get(Struct.Get())->Read(DeltaJson, Result->GetStructMemory()))
+	{
+		UE_LOG(SocketIO, Warning, TEXT("FSIODeltaReceiver: delta %lld doesn't match %s"), Seq, *Struct->GetName());
+		return false;
+	}
+	Struct->CopyScriptStruct(StructPtr, Result->GetStructMemory());
+
+	//the sender never diffs against anything older than the base it just used
+	Snapshots.RemoveAll([BaseSeq, Seq](const FSnapshot& Snapshot) { return Snapshot.Key < BaseSeq || Snapshot.Key == Seq; });
+	Snapshots.Emplace(Seq, Result);
+	if (Snapshots.Num() > MaxSnapshots)
+	{
+		Snapshots.RemoveAt(0, Snapshots.Num() - MaxSnapshots);
+	}
+
+	LatestSeq = FMath::Max(LatestSeq, Seq);
+	OutSeq = Seq;
+	return true;
+}
+
+void FSIODeltaReceiver::Reset()
+{
+	Snapshots.Reset();
+	LatestSeq = 0;
+}
@@ -0,0 +1,509 @@
+// Copyright 2018-current Getnamo. All Rights Reserved
+
+#include "SIODocumentStore.h"
+#include "SIOMessageConvert.h"
+
+namespace
+{
+	/** RFC 6901 reference tokens, "" is the root */
+	bool ParsePointer(const FString& Pointer, TArray<FString>& OutTokens)
+	{
+		OutTokens.Reset();
+		if (Pointer.IsEmpty())
+		{
+			return true;
+		}
+		if (Pointer[0] != TEXT('/'))
+		{
+			return false;
+		}
+
+		int32 Start = 1;
+		for (int32 i = 1; i <= Pointer.Len(); i++)
+		{
+			if (i == Pointer.Len() || Pointer[i] == TEXT('/'))
+			{
+				FString Token = Pointer.Mid(Start, i - Start);
+				Token.ReplaceInline(TEXT("~1"), TEXT("/"), ESearchCase::CaseSensitive);
+				Token.ReplaceInline(TEXT("~0"), TEXT("~"), ESearchCase::CaseSensitive);
+				OutTokens.Add(MoveTemp(Token));
+				Start = i + 1;
+			}
+		}
+		return true;
+	}
+
+	/** Pointer of the container holding the value at Pointer */
+	FString ParentPointer(const FString& Pointer)
+	{
+		const int32 Slash = Pointer.Find(TEXT("/"), ESearchCase::CaseSensitive, ESearchDir::FromEnd);
+		return Slash == INDEX_NONE ? FString() : Pointer.Left(Slash);
+	}
+
+	/** Array index token, "-" is one past the end when bAllowEnd */
+	bool ParseIndex(const FString& Token, int32 Num, bool bAllowEnd, int32& OutIndex)
+	{
+		if (Token == TEXT("-"))
+		{
+			OutIndex = Num;
+			return bAllowEnd;
+		}
+		if (Token.IsEmpty() || Token.Len() > 9 || (Token.Len() > 1 && Token[0] == TEXT('0')))
+		{
+			return false;
+		}
+		for (const TCHAR Char : Token)
+		{
+			if (!FChar::IsDigit(Char))
+			{
+				return false;
+			}
+		}
+		OutIndex = FCString::Atoi(*Token);
+		return bAllowEnd ? OutIndex <= Num : OutIndex < Num;
+	}
+
+	//The store owns its tree (every node is a copy), so its arrays can be edited in place
+	TArray<TSharedPtr<FJsonValue>>* MutableArray(const TSharedPtr<FJsonValue>& Value)
+	{
+		const TArray<TSharedPtr<FJsonValue>>* Array = nullptr;
+		if (Value.IsValid() && Value->Type == EJson::Array && Value->TryGetArray(Array))
+		{
+			return const_cast<TArray<TSharedPtr<FJsonValue>>*>(Array);
+		}
+		return nullptr;
+	}
+
+	/** Slot holding the value after the first Count tokens, nullptr if missing */
+	TSharedPtr<FJsonValue>* FindSlot(TSharedPtr<FJsonValue>& Root, const TArray<FString>& Tokens, int32 Count)
+	{
+		TSharedPtr<FJsonValue>* Slot = &Root;
+		for (int32 i = 0; i < Count; i++)
+		{
+			const TSharedPtr<FJsonValue>& Value = *Slot;
+			if (!Value.IsValid())
+			{
+				return nullptr;
+			}
+			if (Value->Type == EJson::Object)
+			{
+				Slot = Value->AsObject()->Values.Find(Tokens[i]);
+			}
+			else if (TArray<TSharedPtr<FJsonValue>>* Array = MutableArray(Value))
+			{
+				int32 Index = 0;
+				Slot = ParseIndex(Tokens[i], Array->Num(), false, Index) ? &(*Array)[Index] : nullptr;
+			}
+			else
+			{
+				Slot = nullptr;
+			}
+			if (!Slot)
+			{
+				return nullptr;
+			}
+		}
+		return Slot;
+	}
+
+	/** RFC 6902 add, OutChanged is the array itself for inserts since later indices move */
+	bool AddValue(TSharedPtr<FJsonValue>& Root, const FString& Pointer, const TArray<FString>& Tokens, const TSharedPtr<FJsonValue>& Value, FString& OutChanged)
+	{
+		OutChanged = Pointer;
+		if (Tokens.Num() == 0)
+		{
+			Root = Value;
+			return true;
+		}
+
+		TSharedPtr<FJsonValue>* Parent = FindSlot(Root, Tokens, Tokens.Num() - 1);
+		if (!Parent || !Parent->IsValid())
+		{
+			return false;
+		}
+		if ((*Parent)->Type == EJson::Object)
+		{
+			(*Parent)->AsObject()->SetField(Tokens.Last(), Value);
+			return true;
+		}
+		if (TArray<TSharedPtr<FJsonValue>>* Array = MutableArray(*Parent))
+		{
+			int32 Index = 0;
+			if (!ParseIndex(Tokens.Last(), Array->Num(), true, Index))
+			{
+				return false;
+			}
+			Array->Insert(Value, Index);
+			OutChanged = ParentPointer(Pointer);
+			return true;
+		}
+		return false;
+	}
+
+	/** RFC 6902 remove, the root can't be removed */
+	bool RemoveValue(TSharedPtr<FJsonValue>& Root, const FString& Pointer, const TArray<FString>& Tokens, TSharedPtr<FJsonValue>& OutRemoved, FString& OutChanged)
+	{
+		OutChanged = Pointer;
+		if (Tokens.Num() == 0)
+		{
+			return false;
+		}
+
+		TSharedPtr<FJsonValue>* Parent = FindSlot(Root, Tokens, Tokens.Num() - 1);
+		if (!Parent || !Parent->IsValid())
+		{
+			return false;
+		}
+		if ((*Parent)->Type == EJson::Object)
+		{
+			return (*Parent)->AsObject()->Values.RemoveAndCopyValue(Tokens.Last(), OutRemoved);
+		}
+		if (TArray<TSharedPtr<FJsonValue>>* Array = MutableArray(*Parent))
+		{
+			int32 Index = 0;
+			if (!ParseIndex(Tokens.Last(), Array->Num(), false, Index))
+			{
+				return false;
+			}
+			OutRemoved = (*Array)[Index];
+			Array->RemoveAt(Index);
+			OutChanged = ParentPointer(Pointer);
+			return true;
+		}
+		return false;
+	}
+
+	/** Both pointers name the same value or one contains the other */
+	bool PointersOverlap(const FString& A, const FString& B)
+	{
+		if (A.Len() == B.Len())
+		{
+			return A.Equals(B, ESearchCase::CaseSensitive);
+		}
+		const FString& Shorter = A.Len() < B.Len() ? A : B;
+		const FString& Longer = A.Len() < B.Len() ? B : A;
+		return Longer.StartsWith(Shorter, ESearchCase::CaseSensitive) && Longer[Shorter.Len()] == TEXT('/');
+	}
+}
+
+FSIODocumentStore::FSIODocumentStore()
+	: NextSubscriptionId(1)
+{
+}
+
+bool FSIODocumentStore::ApplyMessage(const FString& DefaultChannel, const TSharedPtr<FJsonValue>& Message)
+{
+	const TSharedPtr<FJsonObject>* Object = nullptr;
+	if (!Message.IsValid() || !Message->TryGetObject(Object))
+	{
+		UE_LOG(SocketIO, Warning, TEXT("FSIODocumentStore: %s message is not an object"), *DefaultChannel);
+		return false;
+	}
+
+	FString Channel = DefaultChannel;
+	(*Object)->TryGetStringField(TEXT("channel"), Channel);
+
+	int64 Version = 0;
+	if (!(*Object)->TryGetNumberField(TEXT("version"), Version))
+	{
+		UE_LOG(SocketIO, Warning, TEXT("FSIODocumentStore: %s message has no version"), *Channel);
+		return false;
+	}
+
+	const TArray<TSharedPtr<FJsonValue>>* Operations = nullptr;
+	if ((*Object)->TryGetArrayField(TEXT("patch"), Operations))
+	{
+		return ApplyPatch(Channel, *Operations, Version);
+	}
+
+	TSharedPtr<FJsonValue> Snapshot = (*Object)->TryGetField(TEXT("snapshot"));
+	if (Snapshot.IsValid())
+	{
+		return ApplySnapshot(Channel, Snapshot, Version);
+	}
+
+	UE_LOG(SocketIO, Warning, TEXT("FSIODocumentStore: %s message has neither patch nor snapshot"), *Channel);
+	return false;
+}
+
+bool FSIODocumentStore::ApplySnapshot(const FString& Channel, const TSharedPtr<FJsonValue>& Document, int64 Version)
+{
+	FDocument& Held = Documents.FindOrAdd(Channel);
+	if (Held.Root.IsValid() && Version < Held.Version)
+	{
+		return false;
+	}
+
+	Held.Root = CopyValue(Document);
+	Held.Version = Version;
+	Held.bAwaitingSnapshot = false;
+
+	Notify(Channel, Version, { FString() });
+	return true;
+}
+
+bool FSIODocumentStore::ApplyPatch(const FString& Channel, const TArray<TSharedPtr<FJsonValue>>& Operations, int64 Version)
+{
+	FDocument* Held = Documents.Find(Channel);
+	if (!Held || !Held->Root.IsValid())
+	{
+		if (!Held || !Held->bAwaitingSnapshot)
+		{
+			RequestResync(Channel, TEXT("no snapshot yet"));
+		}
+		return false;
+	}
+
+	//duplicate or late patch, already part of the document
+	if (Version <= Held->Version)
+	{
+		return false;
+	}
+	if (Version != Held->Version + 1)
+	{
+		RequestResync(Channel, FString::Printf(TEXT("version %lld after %lld"), Version, Held->Version));
+		return false;
+	}
+
+	TArray<FString> ChangedPaths;
+	for (const TSharedPtr<FJsonValue>& Operation : Operations)
+	{
+		//earlier operations are already applied, the document can't be trusted anymore
+		if (!ApplyOperation(Held->Root, Operation, ChangedPaths))
+		{
+			RequestResync(Channel, FString::Printf(TEXT("patch %lld failed"), Version));
+			return false;
+		}
+	}
+	Held->Version = Version;
+
+	Notify(Channel, Version, ChangedPaths);
+	return true;
+}
+
+bool FSIODocumentStore::ApplyOperation(TSharedPtr<FJsonValue>& Root, const TSharedPtr<FJsonValue>& Operation, TArray<FString>& OutChangedPaths)
+{
+	const TSharedPtr<FJsonObject>* Object = nullptr;
+	FString Op;
+	FString Path;
+	TArray<FString> Tokens;
+	if (!Operation.IsValid() || !Operation->TryGetObject(Object) ||
+		!(*Object)->TryGetStringField(TEXT("op"), Op) || !(*Object)->TryGetStringField(TEXT("path"), Path) ||
+		!ParsePointer(Path, Tokens))
+	{
+		UE_LOG(SocketIO, Warning, TEXT("FSIODocumentStore: malformed patch operation"));
+		return false;
+	}
+
+	FString Changed;
+	const TSharedPtr<FJsonValue> Value = (*Object)->TryGetField(TEXT("value"));
+
+	if (Op == TEXT("replace"))
+	{
+		TSharedPtr<FJsonValue>* Slot = FindSlot(Root, Tokens, Tokens.Num());
+		if (!Slot || !Value.IsValid())
+		{
+			return false;
+		}
+		*Slot = CopyValue(Value);
+		OutChangedPaths.AddUnique(Path);
+		return true;
+	}
+	if (Op == TEXT("add"))
+	{
+		if (!Value.IsValid() || !AddValue(Root, Path, Tokens, CopyValue(Value), Changed))
+		{
+			return false;
+		}
+		OutChangedPaths.AddUnique(Changed);
+		return true;
+	}
+	if (Op == TEXT("remove"))
+	{
+		TSharedPtr<FJsonValue> Removed;
+		if (!RemoveValue(Root, Path, Tokens, Removed, Changed))
+		{
+			return false;
+		}
+		OutChangedPaths.AddUnique(Changed);
+		return true;
+	}
+	if (Op == TEXT("test"))
+	{
+		TSharedPtr<FJsonValue>* Slot = FindSlot(Root, Tokens, Tokens.Num());
+		return Slot && Slot->IsValid() && Value.IsValid() && FJsonValue::CompareEqual(**Slot, *Value);
+	}
+
+	FString From;
+	TArray<FString> FromTokens;
+	if (!(*Object)->TryGetStringField(TEXT("from"), From) || !ParsePointer(From, FromTokens))
+	{
+		UE_LOG(SocketIO, Warning, TEXT("FSIODocumentStore: %s operation without from"), *Op);
+		return false;
+	}
+
+	if (Op == TEXT("copy"))
+	{
+		TSharedPtr<FJsonValue>* Slot = FindSlot(Root, FromTokens, FromTokens.Num());
+		if (!Slot || !AddValue(Root, Path, Tokens, CopyValue(*Slot), Changed))
+		{
+			return false;
+		}
+		OutChangedPaths.AddUnique(Changed);
+		return true;
+	}
+	if (Op == TEXT("move"))
+	{
+		if (From.Equals(Path, ESearchCase::CaseSensitive))
+		{
+			return FindSlot(Root, FromTokens, FromTokens.Num()) != nullptr;
+		}
+		//a value can't move into itself
+		if (Path.StartsWith(From + TEXT("/"), ESearchCase::CaseSensitive))
+		{
+			return false;
+		}
+		TSharedPtr<FJsonValue> Moved;
+		FString RemovedChanged;
+		if (!RemoveValue(Root, From, FromTokens, Moved, RemovedChanged) || !AddValue(Root, Path, Tokens, Moved, Changed))
+		{
+			return false;
+		}
+		OutChangedPaths.AddUnique(RemovedChanged);
+		OutChangedPaths.AddUnique(Changed);
+		return true;
+	}
+
+	UE_LOG(SocketIO, Warning, TEXT("FSIODocumentStore: unknown patch operation %s"), *Op);
+	return false;
+}
+
+void FSIODocumentStore::RequestResync(const FString& Channel, const FString& Reason)
+{
+	FDocument& Held = Documents.FindOrAdd(Channel);
+	const int64 LastVersion = Held.Root.IsValid() ? Held.Version : -1;
+	Held.Root.Reset();
+	Held.bAwaitingSnapshot = true;
+
+	UE_LOG(SocketIO, Warning, TEXT("FSIODocumentStore: %s needs a new snapshot, %s"), *Channel, *Reason);
+	if (OnResyncNeeded)
+	{
+		OnResyncNeeded(Channel, LastVersion);
+	}
+}
+
+void FSIODocumentStore::Notify(const FString& Channel, int64 Version, const TArray<FString>& ChangedPaths)
+{
+	if (Subscriptions.Num() == 0 || ChangedPaths.Num() == 0)
+	{
+		return;
+	}
+
+	//callbacks may (un)subscribe, collect first
+	TArray<TPair<FOnDocumentChanged, FSIODocumentChange>> Calls;
+	for (const TPair<uint32, FSubscription>& Pair : Subscriptions)
+	{
+		const FSubscription& Subscription = Pair.Value;
+		if (Subscription.Channel != Channel)
+		{
+			continue;
+		}
+
+		FSIODocumentChange Change;
+		for (const FString& Changed : ChangedPaths)
+		{
+			if (PointersOverlap(Subscription.Pointer, Changed))
+			{
+				Change.ChangedPaths.Add(Changed);
+			}
+		}
+		if (Change.ChangedPaths.Num() > 0)
+		{
+			Change.Channel = Channel;
+			Change.Version = Version;
+			Calls.Emplace(Subscription.Callback, MoveTemp(Change));
+		}
+	}
+
+	const TSharedPtr<FJsonValue> Document = GetDocument(Channel);
+	for (TPair<FOnDocumentChanged, FSIODocumentChange>& Call : Calls)
+	{
+		Call.Value.Document = Document;
+		Call.Key(Call.Value);
+	}
+}
+
+TSharedPtr<FJsonValue> FSIODocumentStore::GetDocument(const FString& Channel) const
+{
+	const FDocument* Held = Documents.Find(Channel);
+	return Held ? Held->Root : nullptr;
+}
+
+int64 FSIODocumentStore::GetVersion(const FString& Channel) const
+{
+	const FDocument* Held = Documents.Find(Channel);
+	return Held && Held->Root.IsValid() ? Held->Version : -1;
+}
+
+const TSharedPtr<FJsonValue>* FSIODocumentStore::Resolve(const FString& Channel, const FSIOJsonPath& Path) const
+{
+	const FDocument* Held = Documents.Find(Channel);
+	return Held && Held->Root.IsValid() ? Path.Resolve(Held->Root) : nullptr;
+}
+
+uint32 FSIODocumentStore::Subscribe(const FString& Channel, const FString& Pointer, FOnDocumentChanged Callback)
+{
+	const uint32 Id = NextSubscriptionId++;
+	Subscriptions.Add(Id, { Channel, Pointer, MoveTemp(Callback) });
+	return Id;
+}
+
+void FSIODocumentStore::Unsubscribe(uint32 SubscriptionId)
+{
+	Subscriptions.Remove(SubscriptionId);
+}
+
+void FSIODocumentStore::Reset(const FString& Channel)
+{
+	Documents.Remove(Channel);
+}
+
+TSharedPtr<FJsonValue> FSIODocumentStore::CopyValue(const TSharedPtr<FJsonValue>& Value)
+{
+	if (!Value.IsValid())
+	{
+		return MakeShared<FJsonValueNull>();
+	}
+
+	//leaves are never edited in place, only containers need their own copy
+	switch (Value->Type)
+	{
+	case EJson::Object:
+	{
+		TSharedPtr<FJsonObject> Copy = MakeShared<FJsonObject>();
+		const TSharedPtr<FJsonObject>& Source = Value->AsObject();
+		if (Source.IsValid())
+		{
+			Copy->Values.Reserve(Source->Values.Num());
+			for (const TPair<FString, TSharedPtr<FJsonValue>>& Pair : Source->Values)
+			{
+				Copy->Values.Add(Pair.Key, CopyValue(Pair.Value));
+			}
+		}
+		return MakeShared<FJsonValueObject>(Copy);
+	}
+	case EJson::Array:
+	{
+		const TArray<TSharedPtr<FJsonValue>>& Source = Value->AsArray();
+		TArray<TSharedPtr<FJsonValue>> Copy;
+		Copy.Reserve(Source.Num());
+		for (const TSharedPtr<FJsonValue>& Item : Source)
+		{
+			Copy.Add(CopyValue(Item));
+		}
+		return MakeShared<FJsonValueArray>(Copy);
+	}
+	default:
+		return Value;
+	}
+}
@@ -216,3 +216,83 @@ std::map<std::string, std::string> USIOMessageConvert::FStringMapToStdStringMap(
 
 	return ParamMap;
 }
+
+const sio::message::ptr* USIOMessageConvert::StepMessage(const sio::message::ptr& Message, const FSIOJsonPath::FSegment& Segment)
+{
+	if (!Message)
+	{
+		return nullptr;
+	}
+
+	if (Segment.bIsIndex)
+	{
+		if (Message->get_flag() != sio::message::flag_array)
+		{
+			return nullptr;
+		}
+		const std::vector<sio::message::ptr>& Vector = static_cast<const sio::message*>(Message.get())->get_vector();
+		const int64 Index = Segment.Index < 0 ? (int64)Vector.size() + Segment.Index : Segment.Index;
+		return (Index >= 0 && Index < (int64)Vector.size()) ? &Vector[Index] : nullptr;
+	}
+
+	if (Message->get_flag() != sio::message::flag_object)
+	{
+		return nullptr;
+	}
+	const std::map<std::string, sio::message::ptr>& Map = static_cast<const sio::message*>(Message.get())->get_map();
+	auto Found = Map.find(Segment.Utf8Key);
+	return Found != Map.end() ? &Found->second : nullptr;
+}
+
+const sio::message::ptr* USIOMessageConvert::ResolvePath(const sio::message::ptr& Message, const FSIOJsonPath& Path)
+{
+	return Path.ResolveWith(Message, &USIOMessageConvert::StepMessage);
+}
+
+void USIOMessageConvert::ResolvePaths(const sio::message::ptr& Message, const FSIOJsonPathSet& Paths, TArray<const sio::message::ptr*>& OutMessages)
+{
+	Paths.ResolveWith(Message, &USIOMessageConvert::StepMessage, OutMessages);
+}
+
+bool USIOMessageConvert::TryGetPathNumber(const sio::message::ptr& Message, const FSIOJsonPath& Path, double& OutNumber)
+{
+	const sio::message::ptr* Value = ResolvePath(Message, Path);
+	if (!Value || !*Value)
+	{
+		return false;
+	}
+	switch ((*Value)->get_flag())
+	{
+	case sio::message::flag_integer:
+		OutNumber = (double)(*Value)->get_int();
+		return true;
+	case sio::message::flag_double:
+		OutNumber = (*Value)->get_double();
+		return true;
+	default:
+		return false;
+	}
+}
+
+bool USIOMessageConvert::TryGetPathString(const sio::message::ptr& Message, const FSIOJsonPath& Path, FString& OutString)
+{
+	const sio::message::ptr* Value = ResolvePath(Message, Path);
+	if (!Value || !*Value || (*Value)->get_flag() != sio::message::flag_string)
+	{
+		return false;
+	}
+	const std::string& String = (*Value)->get_string();
+	OutString = FString(UTF8_TO_TCHAR(String.c_str()));
+	return true;
+}
+
+bool USIOMessageConvert::TryGetPathBool(const sio::message::ptr& Message, const FSIOJsonPath& Path, bool& bOutBool)
+{
+	const sio::message::ptr* Value = ResolvePath(Message, Path);
+	if (!Value || !*Value || (*Value)->get_flag() != sio::message::flag_boolean)
+	{
+		return false;
+	}
+	bOutBool = (*Value)->get_bool();
+	return true;
+}
@@ -0,0 +1,457 @@
+// Copyright 2018-current Getnamo. All Rights Reserved
+
+#include "SIONetworkActorRegistry.h"
+#include "SIOJsonValue.h"
+#include "SIOJsonWrapperPool.h"
+#include "SIOSnapshotInterpolationComponent.h"
+#include "SocketIOClientComponent.h"
+#include "Engine/World.h"
+#include "GameFramework/CharacterMovementComponent.h"
+
+namespace
+{
+	//Entities of a message: an object with the id field, an array of them, or a plain id
+	void ForEachEntity(const TSharedPtr<FJsonValue>& Message, const FString& IdField, TFunctionRef<void(const FString&, const TSharedPtr<FJsonValue>&)> Callback)
+	{
+		if (!Message.IsValid())
+		{
+			return;
+		}
+
+		if (Message->Type == EJson::Array)
+		{
+			for (const TSharedPtr<FJsonValue>& Item : Message->AsArray())
+			{
+				ForEachEntity(Item, IdField, Callback);
+			}
+			return;
+		}
+
+		FString Id;
+		const TSharedPtr<FJsonObject>* Object;
+		if (Message->TryGetObject(Object))
+		{
+			if ((*Object)->TryGetStringField(IdField, Id))
+			{
+				Callback(Id, Message);
+			}
+		}
+		else if (Message->TryGetString(Id))
+		{
+			Callback(Id, Message);
+		}
+	}
+
+	bool ToSnapshot(const TSharedPtr<FJsonValue>& State, FSIOTransformSnapshot& OutSnapshot)
+	{
+		const TSharedPtr<FJsonObject>* Object;
+		return State.IsValid() && State->TryGetObject(Object) && FSIOTransformSnapshot::FromJson(*Object, OutSnapshot);
+	}
+
+	USIOJsonValue* ToWrapper(const TSharedPtr<FJsonValue>& State)
+	{
+		return FSIOJsonWrapperPool::AcquireValue(State.IsValid() ? State : MakeShared<FJsonValueNull>());
+	}
+}
+
+USIONetworkActorRegistry::USIONetworkActorRegistry()
+{
+	WarmUpSpawnsPerTick = 4;
+}
+
+void USIONetworkActorRegistry::WarmUpPool(TSubclassOf<AActor> ActorClass, int32 WarmUpCount)
+{
+	if (!ActorClass)
+	{
+		return;
+	}
+	Pools.FindOrAdd(ActorClass.Get()).WarmUpCount = FMath::Max(WarmUpCount, 0);
+}
+
+void USIONetworkActorRegistry::QueueJoin(const FString& NetworkId, TSubclassOf<AActor> ActorClass, USIOJsonValue* State)
+{
+	QueueJoinNative(NetworkId, ActorClass.Get(), State ? State->GetRootValue() : nullptr);
+}
+
+void USIONetworkActorRegistry::QueueJoinNative(const FString& NetworkId, UClass* ActorClass, const TSharedPtr<FJsonValue>& State)
+{
+	if (!ActorClass)
+	{
+		return;
+	}
+
+	//only the newest join of an id applies, updates already routed to the replaced one carry over
+	TSharedPtr<FJsonValue> LatestUpdate;
+	if (const int32* Index = PendingJoins.Find(NetworkId))
+	{
+		PendingChanges[*Index].Type = FPendingChange::Cancelled;
+		LatestUpdate = MoveTemp(PendingChanges[*Index].LatestUpdate);
+	}
+
+	PendingJoins.Add(NetworkId, PendingChanges.Num());
+	FPendingChange& Change = PendingChanges.AddDefaulted_GetRef();
+	Change.Type = FPendingChange::Join;
+	Change.NetworkId = NetworkId;
+	Change.ActorClass = ActorClass;
+	Change.State = State;
+	Change.LatestUpdate = MoveTemp(LatestUpdate);
+}
+
+void USIONetworkActorRegistry::QueueLeave(const FString& NetworkId)
+{
+	//joined and left within one tick, nothing to do
+	int32 JoinIndex;
+	if (PendingJoins.RemoveAndCopyValue(NetworkId, JoinIndex))
+	{
+		PendingChanges[JoinIndex].Type = FPendingChange::Cancelled;
+	}
+
+	if (ActiveActors.Contains(NetworkId))
+	{
+		FPendingChange& Change = PendingChanges.AddDefaulted_GetRef();
+		Change.Type = FPendingChange::Leave;
+		Change.NetworkId = NetworkId;
+	}
+}
+
+void USIONetworkActorRegistry::RouteUpdate(const FString& NetworkId, USIOJsonValue* State)
+{
+	if (State)
+	{
+		RouteUpdateNative(NetworkId, State->GetRootValue());
+	}
+}
+
+void USIONetworkActorRegistry::RouteUpdateNative(const FString& NetworkId, const TSharedPtr<FJsonValue>& State)
+{
+	if (const FSIONetworkActorEntry* Entry = ActiveActors.Find(NetworkId))
+	{
+		if (IsValid(Entry->Actor))
+		{
+			RouteToEntry(*Entry, State);
+		}
+		return;
+	}
+
+	//not active yet, routed once the join applies
+	if (const int32* Index = PendingJoins.Find(NetworkId))
+	{
+		PendingChanges[*Index].LatestUpdate = State;
+	}
+}
+
+AActor* USIONetworkActorRegistry::FindActor(const FString& NetworkId) const
+{
+	const FSIONetworkActorEntry* Entry = ActiveActors.Find(NetworkId);
+	return Entry ? Entry->Actor.Get() : nullptr;
+}
+
+int32 USIONetworkActorRegistry::NumActive() const
+{
+	return ActiveActors.Num();
+}
+
+int32 USIONetworkActorRegistry::NumPooled(TSubclassOf<AActor> ActorClass) const
+{
+	const FSIONetworkActorPool* Pool = Pools.Find(ActorClass.Get());
+	return Pool ? Pool->Free.Num() : 0;
+}
+
+void USIONetworkActorRegistry::BindSocketEvents(USocketIOClientComponent* Client, TSubclassOf<AActor> ActorClass,
+	const FString& JoinEvent /*= TEXT("join")*/,
+	const FString& LeaveEvent /*= TEXT("leave")*/,
+	const FString& UpdateEvent /*= TEXT("update")*/,
+	const FString& IdField /*= TEXT("id")*/,
+	const FString& Namespace /*= TEXT("/")*/)
+{
+	if (!Client || !ActorClass)
+	{
+		return;
+	}
+
+	TWeakObjectPtr<USIONetworkActorRegistry> WeakThis(this);
+	TWeakObjectPtr<UClass> WeakClass(ActorClass.Get());
+
+	const uint32 JoinListener = Client->AddNativeEventListener(JoinEvent, [WeakThis, WeakClass, IdField](const FString& Event, const TSharedPtr<FJsonValue>& Message)
+	{
+		if (!WeakThis.IsValid() || !WeakClass.IsValid())
+		{
+			return;
+		}
+		ForEachEntity(Message, IdField, [&](const FString& Id, const TSharedPtr<FJsonValue>& State)
+		{
+			WeakThis->QueueJoinNative(Id, WeakClass.Get(), State);
+		});
+	}, Namespace);
+
+	const uint32 LeaveListener = Client->AddNativeEventListener(LeaveEvent, [WeakThis, IdField](const FString& Event, const TSharedPtr<FJsonValue>& Message)
+	{
+		if (!WeakThis.IsValid())
+		{
+			return;
+		}
+		ForEachEntity(Message, IdField, [&](const FString& Id, const TSharedPtr<FJsonValue>& State)
+		{
+			WeakThis->QueueLeave(Id);
+		});
+	}, Namespace);
+
+	const uint32 UpdateListener = Client->AddNativeEventListener(UpdateEvent, [WeakThis, IdField](const FString& Event, const TSharedPtr<FJsonValue>& Message)
+	{
+		if (!WeakThis.IsValid())
+		{
+			return;
+		}
+		ForEachEntity(Message, IdField, [&](const FString& Id, const TSharedPtr<FJsonValue>& State)
+		{
+			WeakThis->RouteUpdateNative(Id, State);
+		});
+	}, Namespace);
+
+	Listeners.Emplace(Client, JoinListener);
+	Listeners.Emplace(Client, LeaveListener);
+	Listeners.Emplace(Client, UpdateListener);
+}
+
+void USIONetworkActorRegistry::UnbindSocketEvents()
+{
+	for (const TPair<TWeakObjectPtr<USocketIOClientComponent>, uint32>& Listener : Listeners)
+	{
+		if (Listener.Key.IsValid())
+		{
+			Listener.Key->RemoveNativeEventListener(Listener.Value);
+		}
+	}
+	Listeners.Empty();
+}
+
+void USIONetworkActorRegistry::Deinitialize()
+{
+	UnbindSocketEvents();
+	PendingChanges.Empty();
+	PendingJoins.Empty();
+	Super::Deinitialize();
+}
+
+bool USIONetworkActorRegistry::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void USIONetworkActorRegistry::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	//changes queued by join and leave callbacks wait for the next tick
+	Swap(PendingChanges, ApplyingChanges);
+	PendingJoins.Reset();
+
+	for (FPendingChange& Change : ApplyingChanges)
+	{
+		if (Change.Type == FPendingChange::Join)
+		{
+			if (UClass* ActorClass = Change.ActorClass.Get())
+			{
+				Activate(Change.NetworkId, ActorClass, Change.State);
+				if (Change.LatestUpdate.IsValid())
+				{
+					RouteUpdateNative(Change.NetworkId, Change.LatestUpdate);
+				}
+			}
+		}
+		else if (Change.Type == FPendingChange::Leave)
+		{
+			Release(Change.NetworkId);
+		}
+	}
+	ApplyingChanges.Reset();
+
+	//refill pools a few actors at a time so warming up doesn't hitch either. BeginPlay of a spawned actor may
+	//add pools, so walk a copy of the classes and look the pool up again after every spawn
+	int32 SpawnBudget = WarmUpSpawnsPerTick;
+	TArray<TObjectPtr<UClass>> PoolClasses;
+	Pools.GetKeys(PoolClasses);
+	for (UClass* PoolClass : PoolClasses)
+	{
+		while (SpawnBudget > 0)
+		{
+			const FSIONetworkActorPool* Pool = Pools.Find(PoolClass);
+			if (!Pool || Pool->Free.Num() >= Pool->WarmUpCount)
+			{
+				break;
+			}
+			AActor* Actor = SpawnPooledActor(PoolClass);
+			if (!Actor)
+			{
+				break;
+			}
+			Pools.FindOrAdd(PoolClass).Free.Add(Actor);
+			SpawnBudget--;
+		}
+	}
+}
+
+TStatId USIONetworkActorRegistry::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(USIONetworkActorRegistry, STATGROUP_Tickables);
+}
+
+void USIONetworkActorRegistry::Activate(const FString& NetworkId, UClass* ActorClass, const TSharedPtr<FJsonValue>& State)
+{
+	//a join for an active id refreshes it
+	if (const FSIONetworkActorEntry* Existing = ActiveActors.Find(NetworkId))
+	{
+		if (IsValid(Existing->Actor))
+		{
+			RouteToEntry(*Existing, State);
+			return;
+		}
+		ActiveActors.Remove(NetworkId);
+	}
+
+	AActor* Actor = nullptr;
+	FSIONetworkActorPool& Pool = Pools.FindOrAdd(ActorClass);
+	while (!Actor && Pool.Free.Num() > 0)
+	{
+		Actor = Pool.Free.Pop(EAllowShrinking::No);
+		if (!IsValid(Actor))
+		{
+			Actor = nullptr;
+		}
+	}
+
+	//pool ran dry, this is the hitch the warm-up count is for
+	if (!Actor)
+	{
+		Actor = SpawnPooledActor(ActorClass);
+		if (!Actor)
+		{
+			return;
+		}
+	}
+
+	FSIONetworkActorEntry Entry;
+	Entry.Actor = Actor;
+	Entry.PoolClass = ActorClass;
+	Entry.Interpolation = Actor->FindComponentByClass<USIOSnapshotInterpolationComponent>();
+	Entry.bIsNetworkActor = Actor->Implements<USIONetworkActor>();
+	Entry.NativeNetworkActor = Cast<ISIONetworkActor>(Actor);
+
+	//start at the joined transform instead of sliding over from where the actor was pooled
+	FSIOTransformSnapshot Snapshot;
+	if (ToSnapshot(State, Snapshot))
+	{
+		Actor->SetActorLocationAndRotation(Snapshot.Location, Snapshot.Rotation, false, nullptr, ETeleportType::ResetPhysics);
+		if (Entry.Interpolation)
+		{
+			Entry.Interpolation->ClearSnapshots();
+			Entry.Interpolation->AddSnapshot(Snapshot);
+		}
+	}
+
+	SetPooledActorActive(Actor, Entry.Interpolation, true);
+	ActiveActors.Add(NetworkId, Entry);
+
+	if (Entry.bIsNetworkActor)
+	{
+		ISIONetworkActor::Execute_OnNetworkActivated(Actor, NetworkId, ToWrapper(State));
+	}
+	OnActorJoined.Broadcast(NetworkId, Actor);
+}
+
+void USIONetworkActorRegistry::Release(const FString& NetworkId)
+{
+	FSIONetworkActorEntry Entry;
+	if (!ActiveActors.RemoveAndCopyValue(NetworkId, Entry) || !IsValid(Entry.Actor))
+	{
+		return;
+	}
+
+	if (Entry.bIsNetworkActor)
+	{
+		ISIONetworkActor::Execute_OnNetworkReleased(Entry.Actor);
+	}
+	OnActorLeft.Broadcast(NetworkId, Entry.Actor);
+
+	if (Entry.Interpolation)
+	{
+		Entry.Interpolation->ClearSnapshots();
+	}
+	SetPooledActorActive(Entry.Actor, Entry.Interpolation, false);
+	Pools.FindOrAdd(Entry.PoolClass).Free.Add(Entry.Actor);
+}
+
+void USIONetworkActorRegistry::RouteToEntry(const FSIONetworkActorEntry& Entry, const TSharedPtr<FJsonValue>& State)
+{
+	FSIOTransformSnapshot Snapshot;
+	if (Entry.Interpolation && ToSnapshot(State, Snapshot))
+	{
+		Entry.Interpolation->AddSnapshot(Snapshot);
+	}
+
+	if (Entry.bIsNetworkActor && !(Entry.NativeNetworkActor && Entry.NativeNetworkActor->HandleNetworkUpdate(State)))
+	{
+		ISIONetworkActor::Execute_OnNetworkUpdate(Entry.Actor, ToWrapper(State));
+	}
+}
+
+AActor* USIONetworkActorRegistry::SpawnPooledActor(UClass* ActorClass)
+{
+	UWorld* World = GetWorld();
+	if (!World || !ActorClass)
+	{
+		return nullptr;
+	}
+
+	FActorSpawnParameters Params;
+	Params.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+	Params.ObjectFlags |= RF_Transient;
+
+	AActor* Actor = World->SpawnActor<AActor>(ActorClass, FTransform::Identity, Params);
+	if (Actor)
+	{
+		SetPooledActorActive(Actor, Actor->FindComponentByClass<USIOSnapshotInterpolationComponent>(), false);
+	}
+	return Actor;
+}
+
+void USIONetworkActorRegistry::SetPooledActorActive(AActor* Actor, USIOSnapshotInterpolationComponent* Interpolation, bool bActive)
+{
+	Actor->SetActorHiddenInGame(!bActive);
+	Actor->SetActorEnableCollision(bActive);
+	Actor->SetActorTickEnabled(bActive);
+
+	//free actors cost nothing per frame, active ones get the tick state they were spawned with
+	for (UActorComponent* Component : Actor->GetComponents())
+	{
+		if (!Component)
+		{
+			continue;
+		}
+		if (UMovementComponent* Movement = Cast<UMovementComponent>(Component))
+		{
+			if (!bActive)
+			{
+				Movement->StopMovementImmediately();
+				if (UCharacterMovementComponent* CharacterMovement = Cast<UCharacterMovementComponent>(Movement))
+				{
+					CharacterMovement->DisableMovement();
+				}
+				Movement->Deactivate();
+			}
+			else if (Movement->bAutoActivate)
+			{
+				Movement->Activate(true);
+				if (UCharacterMovementComponent* CharacterMovement = Cast<UCharacterMovementComponent>(Movement))
+				{
+					CharacterMovement->SetDefaultMovementMode();
+				}
+			}
+		}
+		Component->SetComponentTickEnabled(bActive && Component->PrimaryComponentTick.bStartWithTickEnabled && Component->IsActive());
+	}
+	if (Interpolation)
+	{
+		Interpolation->SetComponentTickEnabled(bActive);
+	}
+}
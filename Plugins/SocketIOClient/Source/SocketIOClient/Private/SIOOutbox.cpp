@@ -0,0 +1,741 @@
+// Copyright 2018-current Getnamo. All Rights Reserved
+
+#include "SIOOutbox.h"
+#include "SIOMessageConvert.h"
+#include "CUFileSubsystem.h"
+#include "CULambdaRunnable.h"
+#include "Misc/SecureHash.h"
+#include "Engine/Engine.h"
+#include "Serialization/MemoryReader.h"
+#include "Serialization/MemoryWriter.h"
+
+namespace
+{
+	void WriteStdString(FArchive& Ar, const std::string& Value)
+	{
+		int32 Length = (int32)Value.size();
+		Ar << Length;
+		Ar.Serialize((void*)Value.data(), Length);
+	}
+
+	bool ReadStdString(FArchive& Ar, std::string& OutValue)
+	{
+		int32 Length = 0;
+		Ar << Length;
+		if (Ar.IsError() || Length < 0 || Length > Ar.TotalSize() - Ar.Tell())
+		{
+			return false;
+		}
+		OutValue.resize(Length);
+		if (Length > 0)
+		{
+			Ar.Serialize(&OutValue[0], Length);
+		}
+		return !Ar.IsError();
+	}
+
+	void WriteMessage(FArchive& Ar, const sio::message::ptr& Message)
+	{
+		uint8 Flag = Message ? (uint8)Message->get_flag() : (uint8)sio::message::flag_null;
+		Ar << Flag;
+
+		switch ((sio::message::flag)Flag)
+		{
+		case sio::message::flag_integer:
+		{
+			int64 Value = Message->get_int();
+			Ar << Value;
+			break;
+		}
+		case sio::message::flag_double:
+		{
+			double Value = Message->get_double();
+			Ar << Value;
+			break;
+		}
+		case sio::message::flag_string:
+			WriteStdString(Ar, Message->get_string());
+			break;
+		case sio::message::flag_binary:
+			WriteStdString(Ar, Message->get_binary() ? *Message->get_binary() : std::string());
+			break;
+		case sio::message::flag_array:
+		{
+			int32 Count = (int32)Message->get_vector().size();
+			Ar << Count;
+			for (const sio::message::ptr& Item : Message->get_vector())
+			{
+				WriteMessage(Ar, Item);
+			}
+			break;
+		}
+		case sio::message::flag_object:
+		{
+			int32 Count = (int32)Message->get_map().size();
+			Ar << Count;
+			for (const auto& Pair : Message->get_map())
+			{
+				WriteStdString(Ar, Pair.first);
+				WriteMessage(Ar, Pair.second);
+			}
+			break;
+		}
+		case sio::message::flag_boolean:
+		{
+			uint8 Value = Message->get_bool() ? 1 : 0;
+			Ar << Value;
+			break;
+		}
+		default:
+			break;
+		}
+	}
+
+	sio::message::ptr ReadMessage(FArchive& Ar, int32 Depth = 0)
+	{
+		uint8 Flag = 0;
+		Ar << Flag;
+		if (Ar.IsError() || Depth > 256)
+		{
+			return nullptr;
+		}
+
+		switch ((sio::message::flag)Flag)
+		{
+		case sio::message::flag_integer:
+		{
+			int64 Value = 0;
+			Ar << Value;
+			return sio::int_message::create(Value);
+		}
+		case sio::message::flag_double:
+		{
+			double Value = 0;
+			Ar << Value;
+			return sio::double_message::create(Value);
+		}
+		case sio::message::flag_string:
+		{
+			std::string Value;
+			return ReadStdString(Ar, Value) ? sio::string_message::create(std::move(Value)) : nullptr;
+		}
+		case sio::message::flag_binary:
+		{
+			std::string Value;
+			return ReadStdString(Ar, Value) ? sio::binary_message::create(std::make_shared<const std::string>(std::move(Value))) : nullptr;
+		}
+		case sio::message::flag_array:
+		{
+			int32 Count = 0;
+			Ar << Count;
+			sio::message::ptr Array = sio::array_message::create();
+			for (int32 i = 0; i < Count && !Ar.IsError(); i++)
+			{
+				sio::message::ptr Item = ReadMessage(Ar, Depth + 1);
+				if (!Item)
+				{
+					return nullptr;
+				}
+				Array->get_vector().push_back(Item);
+			}
+			return Array;
+		}
+		case sio::message::flag_object:
+		{
+			int32 Count = 0;
+			Ar << Count;
+			sio::message::ptr Object = sio::object_message::create();
+			for (int32 i = 0; i < Count && !Ar.IsError(); i++)
+			{
+				std::string Key;
+				if (!ReadStdString(Ar, Key))
+				{
+					return nullptr;
+				}
+				sio::message::ptr Item = ReadMessage(Ar, Depth + 1);
+				if (!Item)
+				{
+					return nullptr;
+				}
+				Object->get_map()[Key] = Item;
+			}
+			return Object;
+		}
+		case sio::message::flag_boolean:
+		{
+			uint8 Value = 0;
+			Ar << Value;
+			return sio::bool_message::create(Value != 0);
+		}
+		case sio::message::flag_null:
+			return sio::null_message::create();
+		default:
+			return nullptr;
+		}
+	}
+
+	FCriticalSection& JournalClaimSection()
+	{
+		static FCriticalSection Section;
+		return Section;
+	}
+
+	//journal paths held by live outboxes in this process
+	TSet<FString>& ClaimedJournalPaths()
+	{
+		static TSet<FString> Paths;
+		return Paths;
+	}
+
+	FString ClaimJournalPath(const FString& Path)
+	{
+		if (Path.IsEmpty())
+		{
+			return Path;
+		}
+
+		FScopeLock Lock(&JournalClaimSection());
+		FString Claimed = Path;
+		for (int32 Suffix = 2; ClaimedJournalPaths().Contains(Claimed); Suffix++)
+		{
+			Claimed = FPaths::Combine(FPaths::GetPath(Path), FString::Printf(TEXT("%s-%d%s"), *FPaths::GetBaseFilename(Path), Suffix, *FPaths::GetExtension(Path, true)));
+		}
+		ClaimedJournalPaths().Add(Claimed);
+		return Claimed;
+	}
+
+	void ReleaseJournalPath(const FString& Path)
+	{
+		if (!Path.IsEmpty())
+		{
+			FScopeLock Lock(&JournalClaimSection());
+			ClaimedJournalPaths().Remove(Path);
+		}
+	}
+}
+
+FSIOOutbox::FSIOOutbox()
+	: Writer(MakeShared<FJournalWriter, ESPMode::ThreadSafe>())
+{
+	MemoryBudget = 256 * 1024;
+	MaxEntries = 4096;
+	MaxAgeSeconds = 24 * 60 * 60;
+	MemoryBytes = 0;
+	bSpilled = false;
+	JournalRecordCount = 0;
+	InstanceId = FGuid::NewGuid().ToString(EGuidFormats::Digits);
+	NextSequence = 0;
+}
+
+FSIOOutbox::~FSIOOutbox()
+{
+	//the next owner of the path reads what we queued
+	Writer->Flush();
+	ReleaseJournalPath(JournalPath);
+}
+
+void FSIOOutbox::SetJournalPath(const FString& Path)
+{
+	FScopeLock Lock(&Section);
+
+	if (GEngine)
+	{
+		FileSubsystem = GEngine->GetEngineSubsystem<UCUFileSubsystem>();
+		Writer->FileSubsystem = FileSubsystem;
+	}
+
+	if (RequestedJournalPath == Path)
+	{
+		return;
+	}
+
+	//Journaled entries belong to the old file's connection and stay there
+	if (!JournalPath.IsEmpty())
+	{
+		if (!bSpilled && MemoryEntries.Num() > 0)
+		{
+			Spill();
+		}
+		if (bSpilled)
+		{
+			JournalPending.Empty();
+			JournalRecordCount = 0;
+			bSpilled = false;
+		}
+		ReleaseJournalPath(JournalPath);
+	}
+
+	RequestedJournalPath = Path;
+	JournalPath = ClaimJournalPath(Path);
+	if (JournalPath != Path)
+	{
+		UE_LOG(SocketIO, Warning, TEXT("Outbox journal %s is used by another client, using %s"), *Path, *JournalPath);
+	}
+
+	//Entries left by a previous run are older than anything added since
+	TArray<FSIOOutboxEntry> PreviousEntries;
+	Writer->Flush();
+	ReadJournal(FileSubsystem.Get(), JournalPath, PreviousEntries);
+	if (FileSubsystem.IsValid() && !JournalPath.IsEmpty())
+	{
+		Writer->Queue(FJournalWriter::EOp::Delete, JournalPath);
+	}
+
+	PreviousEntries.Append(MoveTemp(MemoryEntries));
+	MemoryEntries = MoveTemp(PreviousEntries);
+
+	MemoryBytes = 0;
+	for (const FSIOOutboxEntry& Entry : MemoryEntries)
+	{
+		MemoryBytes += Entry.Payload.Num();
+	}
+	Prune(0);
+	if (MemoryBytes > MemoryBudget)
+	{
+		Spill();
+	}
+}
+
+FString FSIOOutbox::GetJournalPath()
+{
+	FScopeLock Lock(&Section);
+	return JournalPath;
+}
+
+FString FSIOOutbox::DefaultJournalPath(const FString& ConnectionKey)
+{
+	UCUFileSubsystem* Files = GEngine ? GEngine->GetEngineSubsystem<UCUFileSubsystem>() : nullptr;
+	if (!Files)
+	{
+		return FString();
+	}
+	const FString FileName = FString::Printf(TEXT("SIOOutbox-%s.journal"), *FMD5::HashAnsiString(*ConnectionKey));
+	return FPaths::Combine(Files->ExternalSaveDirectory(), TEXT("SocketIO"), FileName);
+}
+
+FString FSIOOutbox::Add(const FString& Namespace, const FString& EventName, const sio::message::list& MessageList, bool bBulk /*= false*/)
+{
+	FSIOOutboxEntry Entry;
+	Entry.Namespace = Namespace;
+	Entry.EventName = EventName;
+	Entry.CreatedUtc = FDateTime::UtcNow();
+	Entry.bBulk = bBulk;
+	EncodeMessageList(MessageList, Entry.Payload);
+
+	FScopeLock Lock(&Section);
+	Entry.Id = FString::Printf(TEXT("%s-%llu"), *InstanceId, ++NextSequence);
+	const FString Id = Entry.Id;
+
+	Prune(1);
+
+	if (!bSpilled && MemoryBytes + Entry.Payload.Num() > MemoryBudget)
+	{
+		Spill();
+	}
+
+	if (bSpilled)
+	{
+		TArray<uint8> Record;
+		WriteJournalRecord(Record, EJournalRecord::Entry, Entry);
+		Writer->Queue(FJournalWriter::EOp::Append, JournalPath, MoveTemp(Record));
+		JournalRecordCount++;
+
+		Entry.Payload.Empty();
+		JournalPending.Add(MoveTemp(Entry));
+	}
+	else
+	{
+		MemoryBytes += Entry.Payload.Num();
+		MemoryEntries.Add(MoveTemp(Entry));
+	}
+	return Id;
+}
+
+void FSIOOutbox::Acknowledge(const FString& Id)
+{
+	FScopeLock Lock(&Section);
+
+	const auto HasId = [&Id](const FSIOOutboxEntry& Entry)
+	{
+		return Entry.Id == Id;
+	};
+
+	const int32 Index = MemoryEntries.IndexOfByPredicate(HasId);
+	if (Index != INDEX_NONE)
+	{
+		MemoryBytes -= MemoryEntries[Index].Payload.Num();
+		MemoryEntries.RemoveAt(Index);
+		return;
+	}
+
+	const int32 JournalIndex = bSpilled ? JournalPending.IndexOfByPredicate(HasId) : INDEX_NONE;
+	if (JournalIndex != INDEX_NONE)
+	{
+		JournalPending.RemoveAt(JournalIndex);
+		RemoveFromJournal({ Id });
+	}
+}
+
+void FSIOOutbox::GetPending(const FString& Namespace, TArray<FSIOOutboxEntry>& OutEntries)
+{
+	TSet<FString> JournalIds;
+	FString Path;
+	{
+		FScopeLock Lock(&Section);
+
+		//expired entries are not worth replaying
+		Prune(0);
+
+		if (!bSpilled)
+		{
+			for (const FSIOOutboxEntry& Entry : MemoryEntries)
+			{
+				if (Entry.Namespace == Namespace)
+				{
+					OutEntries.Add(Entry);
+				}
+			}
+			return;
+		}
+
+		for (const FSIOOutboxEntry& Entry : JournalPending)
+		{
+			if (Entry.Namespace == Namespace)
+			{
+				JournalIds.Add(Entry.Id);
+			}
+		}
+		Path = JournalPath;
+	}
+
+	if (JournalIds.Num() == 0)
+	{
+		return;
+	}
+
+	//payloads are only on disk, read them without blocking emits and acks
+	Writer->Flush();
+	TArray<FSIOOutboxEntry> Entries;
+	ReadJournal(FileSubsystem.Get(), Path, Entries);
+	for (FSIOOutboxEntry& Entry : Entries)
+	{
+		if (JournalIds.Contains(Entry.Id))
+		{
+			OutEntries.Add(MoveTemp(Entry));
+		}
+	}
+}
+
+int32 FSIOOutbox::Num()
+{
+	FScopeLock Lock(&Section);
+	return bSpilled ? JournalPending.Num() : MemoryEntries.Num();
+}
+
+void FSIOOutbox::Persist()
+{
+	{
+		FScopeLock Lock(&Section);
+		if (!bSpilled && MemoryEntries.Num() > 0)
+		{
+			Spill();
+		}
+	}
+	Writer->Flush();
+}
+
+void FSIOOutbox::Spill()
+{
+	if (!FileSubsystem.IsValid() || JournalPath.IsEmpty())
+	{
+		//nowhere to spill to, keep growing in memory
+		return;
+	}
+
+	TArray<uint8> Records;
+	for (FSIOOutboxEntry& Entry : MemoryEntries)
+	{
+		WriteJournalRecord(Records, EJournalRecord::Entry, Entry);
+		Entry.Payload.Empty();
+	}
+	Writer->Queue(FJournalWriter::EOp::Append, JournalPath, MoveTemp(Records));
+	JournalRecordCount += MemoryEntries.Num();
+
+	JournalPending.Append(MoveTemp(MemoryEntries));
+	MemoryEntries.Empty();
+	MemoryBytes = 0;
+	bSpilled = true;
+}
+
+void FSIOOutbox::Prune(int32 Reserve)
+{
+	TArray<FSIOOutboxEntry>& Entries = bSpilled ? JournalPending : MemoryEntries;
+	const FDateTime Now = FDateTime::UtcNow();
+
+	//entries are oldest first, so drop from the front
+	int32 DropCount = 0;
+	while (DropCount < Entries.Num())
+	{
+		const bool bOverLimit = MaxEntries > 0 && Entries.Num() - DropCount + Reserve > MaxEntries;
+		const bool bExpired = MaxAgeSeconds > 0 && (Now - Entries[DropCount].CreatedUtc).GetTotalSeconds() > MaxAgeSeconds;
+		if (!bOverLimit && !bExpired)
+		{
+			break;
+		}
+		DropCount++;
+	}
+
+	if (DropCount == 0)
+	{
+		return;
+	}
+
+	UE_LOG(SocketIO, Warning, TEXT("Outbox dropped %d unacknowledged emits past its entry or age limit"), DropCount);
+
+	if (bSpilled)
+	{
+		TArray<FString> Ids;
+		for (int32 i = 0; i < DropCount; i++)
+		{
+			Ids.Add(JournalPending[i].Id);
+		}
+		JournalPending.RemoveAt(0, DropCount);
+		RemoveFromJournal(Ids);
+	}
+	else
+	{
+		for (int32 i = 0; i < DropCount; i++)
+		{
+			MemoryBytes -= MemoryEntries[i].Payload.Num();
+		}
+		MemoryEntries.RemoveAt(0, DropCount);
+	}
+}
+
+void FSIOOutbox::RemoveFromJournal(const TArray<FString>& Ids)
+{
+	if (!FileSubsystem.IsValid())
+	{
+		return;
+	}
+
+	if (JournalPending.Num() == 0)
+	{
+		//Everything in our journal is acked, start over in memory
+		Writer->Queue(FJournalWriter::EOp::Delete, JournalPath);
+		JournalRecordCount = 0;
+		bSpilled = false;
+		return;
+	}
+
+	TArray<uint8> Records;
+	for (const FString& Id : Ids)
+	{
+		FSIOOutboxEntry AckEntry;
+		AckEntry.Id = Id;
+		WriteJournalRecord(Records, EJournalRecord::Ack, AckEntry);
+	}
+	Writer->Queue(FJournalWriter::EOp::Append, JournalPath, MoveTemp(Records));
+	JournalRecordCount += Ids.Num();
+
+	//a long lived journal would otherwise grow with every ack
+	if (JournalRecordCount > JournalPending.Num() * 2 + 64)
+	{
+		Writer->Queue(FJournalWriter::EOp::Compact, JournalPath);
+		JournalRecordCount = JournalPending.Num();
+	}
+}
+
+void FSIOOutbox::FJournalWriter::Queue(EOp Type, const FString& Path, TArray<uint8> Bytes /*= TArray<uint8>()*/)
+{
+	FScopeLock Lock(&QueueSection);
+	if (Type == EOp::Append && Ops.Num() > 0 && Ops.Last().Type == EOp::Append && Ops.Last().Path == Path)
+	{
+		Ops.Last().Bytes.Append(Bytes);
+	}
+	else
+	{
+		Ops.Add({ Type, Path, MoveTemp(Bytes) });
+	}
+
+	if (!bDrainQueued)
+	{
+		bDrainQueued = true;
+		TSharedRef<FJournalWriter, ESPMode::ThreadSafe> Self = AsShared();
+		FCULambdaRunnable::RunLambdaOnBackGroundThreadPool([Self]
+		{
+			Self->Flush();
+		});
+	}
+}
+
+void FSIOOutbox::FJournalWriter::Flush()
+{
+	FScopeLock WriteLock(&WriteSection);
+
+	TArray<FOp> Batch;
+	{
+		FScopeLock Lock(&QueueSection);
+		Batch = MoveTemp(Ops);
+		Ops.Reset();
+		bDrainQueued = false;
+	}
+
+	UCUFileSubsystem* Files = FileSubsystem.Get();
+	if (!Files)
+	{
+		return;
+	}
+
+	for (const FOp& Op : Batch)
+	{
+		switch (Op.Type)
+		{
+		case EOp::Append:
+			Files->AppendBytesToPath(Op.Bytes, Op.Path);
+			break;
+		case EOp::Delete:
+			Files->DeleteFileAtPath(Op.Path);
+			break;
+		case EOp::Compact:
+		{
+			TArray<FSIOOutboxEntry> Entries;
+			ReadJournal(Files, Op.Path, Entries);
+
+			TArray<uint8> Records;
+			for (const FSIOOutboxEntry& Entry : Entries)
+			{
+				WriteJournalRecord(Records, EJournalRecord::Entry, Entry);
+			}
+			Files->SaveBytesToPath(Records, Op.Path);
+			break;
+		}
+		default:
+			break;
+		}
+	}
+}
+
+void FSIOOutbox::WriteJournalRecord(TArray<uint8>& OutRecords, EJournalRecord Type, const FSIOOutboxEntry& Entry)
+{
+	//[type][body size][body], a crash mid-append leaves a short last record that reads skip
+	TArray<uint8> Body;
+	FMemoryWriter BodyWriter(Body);
+	FString Id = Entry.Id;
+	BodyWriter << Id;
+	if (Type == EJournalRecord::Entry)
+	{
+		FString Namespace = Entry.Namespace;
+		FString EventName = Entry.EventName;
+		TArray<uint8> Payload = Entry.Payload;
+		int64 CreatedTicks = Entry.CreatedUtc.GetTicks();
+		uint8 Bulk = Entry.bBulk ? 1 : 0;
+		BodyWriter << Namespace;
+		BodyWriter << EventName;
+		BodyWriter << Payload;
+		BodyWriter << CreatedTicks;
+		BodyWriter << Bulk;
+	}
+
+	FMemoryWriter RecordWriter(OutRecords, false, true);
+	uint8 TypeByte = (uint8)Type;
+	int32 BodySize = Body.Num();
+	RecordWriter << TypeByte;
+	RecordWriter << BodySize;
+	RecordWriter.Serialize(Body.GetData(), Body.Num());
+}
+
+void FSIOOutbox::ReadJournal(UCUFileSubsystem* Files, const FString& Path, TArray<FSIOOutboxEntry>& OutEntries)
+{
+	if (!Files || Path.IsEmpty() || !FPaths::FileExists(Path))
+	{
+		return;
+	}
+
+	TArray<FSIOOutboxEntry> Entries;
+	TSet<FString> AckedIds;
+
+	Files->ReadMappedPath(Path, [&](const uint8* Data, int64 Size)
+	{
+		FMemoryReaderView Reader(TArrayView<const uint8>(Data, (int32)Size));
+		while (Reader.Tell() + 5 <= Size)
+		{
+			uint8 TypeByte = 0;
+			int32 BodySize = 0;
+			Reader << TypeByte;
+			Reader << BodySize;
+			if (Reader.IsError() || BodySize < 0 || Reader.Tell() + BodySize > Size)
+			{
+				break;
+			}
+
+			const int64 BodyEnd = Reader.Tell() + BodySize;
+			FString Id;
+			Reader << Id;
+			if ((EJournalRecord)TypeByte == EJournalRecord::Entry)
+			{
+				FSIOOutboxEntry& Entry = Entries.AddDefaulted_GetRef();
+				Entry.Id = Id;
+				Reader << Entry.Namespace;
+				Reader << Entry.EventName;
+				Reader << Entry.Payload;
+				int64 CreatedTicks = 0;
+				Reader << CreatedTicks;
+				Entry.CreatedUtc = FDateTime(CreatedTicks);
+
+				//records written before the lane was stored end here
+				if (Reader.Tell() < BodyEnd)
+				{
+					uint8 Bulk = 0;
+					Reader << Bulk;
+					Entry.bBulk = Bulk != 0;
+				}
+			}
+			else if ((EJournalRecord)TypeByte == EJournalRecord::Ack)
+			{
+				AckedIds.Add(Id);
+			}
+			if (Reader.IsError())
+			{
+				break;
+			}
+			Reader.Seek(BodyEnd);
+		}
+	});
+
+	for (FSIOOutboxEntry& Entry : Entries)
+	{
+		if (!AckedIds.Contains(Entry.Id))
+		{
+			OutEntries.Add(MoveTemp(Entry));
+		}
+	}
+}
+
+void FSIOOutbox::EncodeMessageList(const sio::message::list& MessageList, TArray<uint8>& OutBytes)
+{
+	FMemoryWriter Writer(OutBytes);
+	int32 Count = (int32)MessageList.size();
+	Writer << Count;
+	for (int32 i = 0; i < Count; i++)
+	{
+		WriteMessage(Writer, MessageList[i]);
+	}
+}
+
+bool FSIOOutbox::DecodeMessageList(const TArray<uint8>& Bytes, sio::message::list& OutMessageList)
+{
+	FMemoryReader Reader(Bytes);
+	int32 Count = 0;
+	Reader << Count;
+	for (int32 i = 0; i < Count && !Reader.IsError(); i++)
+	{
+		sio::message::ptr Message = ReadMessage(Reader);
+		if (!Message)
+		{
+			return false;
+		}
+		OutMessageList.push(Message);
+	}
+	return !Reader.IsError();
+}
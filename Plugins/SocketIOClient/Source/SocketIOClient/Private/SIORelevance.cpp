@@ -0,0 +1,154 @@
+// Copyright 2018-current Getnamo. All Rights Reserved
+
+#include "SIORelevance.h"
+#include "SIOMessageConvert.h"
+
+FSIOInterestGrid::FSIOInterestGrid(float InCellSize /*= 5000.f*/)
+	: bRelevantWithoutRegions(true)
+	, CellSize(FMath::Max(InCellSize, 1.f))
+{
+}
+
+void FSIOInterestGrid::SetRegions(TArrayView<const FSphere> Regions)
+{
+	TSharedPtr<TSet<FIntPoint>, ESPMode::ThreadSafe> NewCells = MakeShared<TSet<FIntPoint>, ESPMode::ThreadSafe>();
+
+	//every cell under the region's bounding square, a little generous at the corners
+	for (const FSphere& Region : Regions)
+	{
+		const int32 MinX = FMath::FloorToInt32((Region.Center.X - Region.W) / CellSize);
+		const int32 MaxX = FMath::FloorToInt32((Region.Center.X + Region.W) / CellSize);
+		const int32 MinY = FMath::FloorToInt32((Region.Center.Y - Region.W) / CellSize);
+		const int32 MaxY = FMath::FloorToInt32((Region.Center.Y + Region.W) / CellSize);
+		for (int32 Y = MinY; Y <= MaxY; Y++)
+		{
+			for (int32 X = MinX; X <= MaxX; X++)
+			{
+				NewCells->Add(FIntPoint(X, Y));
+			}
+		}
+	}
+
+	//readers keep the set they grabbed, the old one goes away with the last of them
+	FScopeLock Lock(&Section);
+	Cells = NewCells;
+}
+
+bool FSIOInterestGrid::IsRelevant(double X, double Y) const
+{
+	FCellSetPtr CurrentCells;
+	{
+		FScopeLock Lock(&Section);
+		CurrentCells = Cells;
+	}
+
+	if (!CurrentCells.IsValid())
+	{
+		return bRelevantWithoutRegions;
+	}
+	return CurrentCells->Contains(FIntPoint(FMath::FloorToInt32(X / CellSize), FMath::FloorToInt32(Y / CellSize)));
+}
+
+FSIORelevanceFilter::FSIORelevanceFilter(const FSIOInterestGridPtr& InGrid, const FString& PositionPath /*= TEXT("location")*/, const FString& InIdPath /*= TEXT("id")*/)
+	: Grid(InGrid)
+	, XPath(PositionPath.IsEmpty() ? FString(TEXT("x")) : PositionPath + TEXT(".x"))
+	, YPath(PositionPath.IsEmpty() ? FString(TEXT("y")) : PositionPath + TEXT(".y"))
+	, IdPath(InIdPath)
+{
+}
+
+void FSIORelevanceFilter::SetAlwaysRelevant(const TArray<FString>& Ids)
+{
+	TSharedPtr<TSet<FString>, ESPMode::ThreadSafe> NewIds = MakeShared<TSet<FString>, ESPMode::ThreadSafe>();
+	NewIds->Append(Ids);
+
+	FScopeLock Lock(&IdSection);
+	AlwaysRelevant = NewIds;
+}
+
+bool FSIORelevanceFilter::IsRelevant(const sio::message::ptr& Entity) const
+{
+	double X, Y;
+	if (!USIOMessageConvert::TryGetPathNumber(Entity, XPath, X) || !USIOMessageConvert::TryGetPathNumber(Entity, YPath, Y))
+	{
+		return true;
+	}
+
+	if (!Grid.IsValid() || Grid->IsRelevant(X, Y))
+	{
+		return true;
+	}
+
+	//the id is only read for entities outside the grid
+	FIdSetPtr Ids;
+	{
+		FScopeLock Lock(&IdSection);
+		Ids = AlwaysRelevant;
+	}
+	if (!Ids.IsValid() || Ids->Num() == 0)
+	{
+		return false;
+	}
+
+	const sio::message::ptr* Id = USIOMessageConvert::ResolvePath(Entity, IdPath);
+	if (!Id || !*Id)
+	{
+		return false;
+	}
+
+	switch ((*Id)->get_flag())
+	{
+	case sio::message::flag_string:
+		return Ids->Contains(FString(UTF8_TO_TCHAR((*Id)->get_string().c_str())));
+	case sio::message::flag_integer:
+		return Ids->Contains(LexToString((*Id)->get_int()));
+	default:
+		return false;
+	}
+}
+
+bool FSIORelevanceFilter::Filter(sio::message::ptr& InOutMessage) const
+{
+	if (!InOutMessage || InOutMessage->get_flag() != sio::message::flag_array)
+	{
+		const bool bRelevant = IsRelevant(InOutMessage);
+		(bRelevant ? PassedCount : DroppedCount)++;
+		return bRelevant;
+	}
+
+	const std::vector<sio::message::ptr>& Entities = static_cast<const sio::message*>(InOutMessage.get())->get_vector();
+
+	//the array is only copied once an entity has to go
+	sio::message::ptr Filtered;
+	for (size_t i = 0; i < Entities.size(); i++)
+	{
+		if (IsRelevant(Entities[i]))
+		{
+			PassedCount++;
+			if (Filtered)
+			{
+				Filtered->get_vector().push_back(Entities[i]);
+			}
+		}
+		else
+		{
+			DroppedCount++;
+			if (!Filtered)
+			{
+				Filtered = sio::array_message::create();
+				Filtered->get_vector().assign(Entities.begin(), Entities.begin() + i);
+			}
+		}
+	}
+
+	if (!Filtered)
+	{
+		return true;
+	}
+	if (Filtered->get_vector().empty())
+	{
+		return false;
+	}
+	InOutMessage = Filtered;
+	return true;
+}
@@ -0,0 +1,86 @@
+// Copyright 2018-current Getnamo. All Rights Reserved
+
+#include "SIORpc.h"
+#include <atomic>
+
+void FSIORpcCancellation::Cancel()
+{
+	TArray<TFunction<void()>> PendingCallbacks;
+	{
+		FScopeLock Lock(&Section);
+		if (bCancelled)
+		{
+			return;
+		}
+		bCancelled = true;
+		PendingCallbacks = MoveTemp(Callbacks);
+	}
+
+	//Run outside the lock, callbacks complete futures whose continuations may use this token
+	for (TFunction<void()>& Callback : PendingCallbacks)
+	{
+		Callback();
+	}
+}
+
+bool FSIORpcCancellation::IsCancelled() const
+{
+	FScopeLock Lock(&Section);
+	return bCancelled;
+}
+
+void FSIORpcCancellation::OnCancelled(TFunction<void()> OnCancel)
+{
+	{
+		FScopeLock Lock(&Section);
+		if (!bCancelled)
+		{
+			Callbacks.Add(MoveTemp(OnCancel));
+			return;
+		}
+	}
+	OnCancel();
+}
+
+TFuture<TArray<FSIORpcResult>> FSIORpc::WhenAll(TArray<TFuture<FSIORpcResult>>&& Futures)
+{
+	struct FWhenAllState
+	{
+		TPromise<TArray<FSIORpcResult>> Promise;
+		TArray<FSIORpcResult> Results;
+		std::atomic<int32> Remaining;
+	};
+
+	TSharedRef<FWhenAllState, ESPMode::ThreadSafe> State = MakeShared<FWhenAllState, ESPMode::ThreadSafe>();
+	TFuture<TArray<FSIORpcResult>> AllFuture = State->Promise.GetFuture();
+
+	if (Futures.Num() == 0)
+	{
+		State->Promise.SetValue(TArray<FSIORpcResult>());
+		return AllFuture;
+	}
+
+	State->Results.SetNum(Futures.Num());
+	State->Remaining = Futures.Num();
+
+	for (int32 i = 0; i < Futures.Num(); i++)
+	{
+		//each continuation writes its own slot, the last one to finish publishes the array
+		Futures[i].Then([State, i](TFuture<FSIORpcResult> Completed)
+		{
+			State->Results[i] = Completed.Consume();
+			if (--State->Remaining == 0)
+			{
+				State->Promise.SetValue(MoveTemp(State->Results));
+			}
+		});
+	}
+	return AllFuture;
+}
+
+#if SIO_WITH_COROUTINES
+TSIOFutureAwaitable<TArray<FSIORpcResult>> FSIORpc::AwaitAll(TArray<TFuture<FSIORpcResult>>&& Futures, bool bResumeOnGameThread /*= true*/)
+{
+	return TSIOFutureAwaitable<TArray<FSIORpcResult>>(WhenAll(MoveTemp(Futures)), bResumeOnGameThread);
+}
+#endif
@@ -0,0 +1,367 @@
+// Copyright 2018-current Getnamo. All Rights Reserved
+
+#include "SIOSharedConnection.h"
+#include "SocketIONative.h"
+#include "SIOMessageConvert.h"
+#include "CULambdaRunnable.h"
+
+namespace
+{
+	FCriticalSection PoolSection;
+	TMap<FString, FSIOSharedConnection::FPtr> ConnectionPool;
+
+	void AppendSortedMap(FString& OutKey, const TMap<FString, FString>& Map)
+	{
+		TArray<FString> Keys;
+		Map.GetKeys(Keys);
+		Keys.Sort();
+		for (const FString& MapKey : Keys)
+		{
+			OutKey += MapKey + TEXT("=") + Map[MapKey] + TEXT("&");
+		}
+		OutKey += TEXT("|");
+	}
+}
+
+FString FSIOSharedConnection::MakeKey(const FSIOConnectParams& Params, bool bUseTLS, bool bVerifyTLSCertificate)
+{
+	FString Key = Params.AddressAndPort.ToLower();
+	Key.RemoveFromEnd(TEXT("/"));
+	Key += TEXT("|") + Params.Path + TEXT("|") + Params.AuthToken + TEXT("|");
+	AppendSortedMap(Key, Params.ExtraAuth);
+	AppendSortedMap(Key, Params.Query);
+	AppendSortedMap(Key, Params.Headers);
+	Key += FString::Printf(TEXT("%d%d"), bUseTLS ? 1 : 0, bVerifyTLSCertificate ? 1 : 0);
+	return Key;
+}
+
+FSIOSharedConnection::FPtr FSIOSharedConnection::Acquire(const FString& Key, bool bUseTLS, bool bVerifyTLSCertificate)
+{
+	FScopeLock Lock(&PoolSection);
+	FPtr Connection;
+	if (FPtr* Existing = ConnectionPool.Find(Key))
+	{
+		Connection = *Existing;
+	}
+	else
+	{
+		Connection = MakeShared<FSIOSharedConnection, ESPMode::ThreadSafe>(Key, bUseTLS, bVerifyTLSCertificate);
+		Connection->WeakSelf = Connection;
+		Connection->SetupClientListeners();
+		ConnectionPool.Add(Key, Connection);
+	}
+
+	//counted under the pool lock so a detaching last native doesn't close it before we attach
+	FScopeLock ConnectionLock(&Connection->Section);
+	Connection->NumAcquiring++;
+	return Connection;
+}
+
+int32 FSIOSharedConnection::NumPooled()
+{
+	FScopeLock Lock(&PoolSection);
+	return ConnectionPool.Num();
+}
+
+FString FSIOSharedConnection::NormalizeNamespace(const FString& Namespace)
+{
+	if (Namespace.IsEmpty())
+	{
+		return TEXT("/");
+	}
+	if (!Namespace.StartsWith(TEXT("/")))
+	{
+		return TEXT("/") + Namespace;
+	}
+	return Namespace;
+}
+
+FSIOSharedConnection::FSIOSharedConnection(const FString& InKey, bool bUseTLS, bool bVerifyTLSCertificate)
+	: Key(InKey)
+{
+	Client = MakeShareable(new sio::client(bUseTLS, bVerifyTLSCertificate));
+}
+
+void FSIOSharedConnection::Attach(FSocketIONative* Native)
+{
+	//namespace open/close callbacks also run under the dispatch lock, so none is missed or replayed twice
+	FScopeLock DispatchLock(&DispatchSection);
+
+	//Joining a live connection, the native missed the open callbacks. Default namespace first, it sets the session.
+	TArray<FString> Replay;
+	{
+		FScopeLock Lock(&Section);
+		NumAcquiring = FMath::Max(NumAcquiring - 1, 0);
+		TSet<FString>& Namespaces = Natives.FindOrAdd(Native);
+		Namespaces.Add(TEXT("/"));
+
+		if (OpenNamespaces.Contains(TEXT("/")))
+		{
+			Replay.Add(TEXT("/"));
+		}
+		for (const FString& Namespace : OpenNamespaces)
+		{
+			if (Namespace != TEXT("/") && Namespaces.Contains(Namespace))
+			{
+				Replay.Add(Namespace);
+			}
+		}
+	}
+
+	for (const FString& Namespace : Replay)
+	{
+		Native->HandleNamespaceOpened(Namespace);
+	}
+}
+
+void FSIOSharedConnection::Detach(FSocketIONative* Native, bool bSyncClose)
+{
+	TArray<FString> UnusedNamespaces;
+	bool bLast = false;
+	{
+		FScopeLock Lock(&Section);
+		TSet<FString> Namespaces;
+		if (!Natives.RemoveAndCopyValue(Native, Namespaces))
+		{
+			return;
+		}
+		bLast = Natives.Num() == 0;
+
+		for (const FString& Namespace : Namespaces)
+		{
+			bool bUsedByOthers = Namespace == TEXT("/");
+			for (const TPair<FSocketIONative*, TSet<FString>>& Pair : Natives)
+			{
+				bUsedByOthers = bUsedByOthers || Pair.Value.Contains(Namespace);
+			}
+			if (!bUsedByOthers)
+			{
+				UnusedNamespaces.Add(Namespace);
+			}
+		}
+	}
+
+	//wait out a callback into the native that passed its attached check before we removed it
+	{
+		FScopeLock DispatchLock(&DispatchSection);
+	}
+
+	if (!bLast)
+	{
+		for (const FString& Namespace : UnusedNamespaces)
+		{
+			Client->socket(USIOMessageConvert::StdString(Namespace))->close();
+		}
+		return;
+	}
+
+	{
+		FScopeLock Lock(&PoolSection);
+
+		//another native may have acquired or attached since we saw the list empty, it keeps the connection
+		{
+			FScopeLock ConnectionLock(&Section);
+			if (Natives.Num() > 0 || NumAcquiring > 0)
+			{
+				return;
+			}
+		}
+
+		FPtr* Pooled = ConnectionPool.Find(Key);
+		if (Pooled && Pooled->Get() == this)
+		{
+			ConnectionPool.Remove(Key);
+		}
+	}
+
+	if (bSyncClose)
+	{
+		Client->sync_close();
+	}
+	else
+	{
+		//closing joins the network thread, keep that and the client teardown off the caller's thread
+		TSharedPtr<sio::client> ClosingClient = Client;
+		FCULambdaRunnable::RunLambdaOnBackGroundThread([ClosingClient]
+		{
+			ClosingClient->sync_close();
+		});
+	}
+}
+
+int32 FSIOSharedConnection::NumAttached()
+{
+	FScopeLock Lock(&Section);
+	return Natives.Num();
+}
+
+bool FSIOSharedConnection::IsOnlyAttachedBy(const TSet<const FSocketIONative*>& Closing)
+{
+	FScopeLock Lock(&Section);
+	for (const TPair<FSocketIONative*, TSet<FString>>& Pair : Natives)
+	{
+		if (!Closing.Contains(Pair.Key))
+		{
+			return false;
+		}
+	}
+	return NumAcquiring == 0;
+}
+
+void FSIOSharedConnection::UseNamespace(FSocketIONative* Native, const FString& Namespace)
+{
+	FScopeLock Lock(&Section);
+	if (TSet<FString>* Namespaces = Natives.Find(Native))
+	{
+		Namespaces->Add(NormalizeNamespace(Namespace));
+	}
+}
+
+bool FSIOSharedConnection::ReleaseNamespace(FSocketIONative* Native, const FString& Namespace)
+{
+	const FString Normalized = NormalizeNamespace(Namespace);
+
+	FScopeLock Lock(&Section);
+	if (TSet<FString>* Namespaces = Natives.Find(Native))
+	{
+		Namespaces->Remove(Normalized);
+	}
+	for (const TPair<FSocketIONative*, TSet<FString>>& Pair : Natives)
+	{
+		if (Pair.Value.Contains(Normalized))
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+void FSIOSharedConnection::Connect(const std::string& Address, const std::string& Path,
+	const std::map<std::string, std::string>& Query,
+	const std::map<std::string, std::string>& Headers,
+	const sio::message::ptr& Auth,
+	uint32 MaxReconnectionAttempts, uint32 ReconnectionDelay)
+{
+	FPtr Self = WeakSelf.Pin();
+	FCULambdaRunnable::RunLambdaOnBackGroundThread([Self, Address, Path, Query, Headers, Auth, MaxReconnectionAttempts, ReconnectionDelay]
+	{
+		//serialized so only the first of several attaching natives starts the connection, connect() ignores the rest
+		FScopeLock Lock(&Self->ConnectSection);
+		if (Self->Client->opened())
+		{
+			return;
+		}
+		Self->Client->set_reconnect_attempts(MaxReconnectionAttempts);
+		Self->Client->set_reconnect_delay(ReconnectionDelay);
+		Self->Client->set_path(Path);
+		Self->Client->connect(Address, Query, Headers, Auth);
+	});
+}
+
+void FSIOSharedConnection::SetupClientListeners()
+{
+	TWeakPtr<FSIOSharedConnection, ESPMode::ThreadSafe> Weak = WeakSelf;
+
+	Client->set_close_listener(sio::client::close_listener([Weak](sio::client::close_reason const& reason)
+	{
+		if (FPtr Self = Weak.Pin())
+		{
+			FScopeLock DispatchLock(&Self->DispatchSection);
+			{
+				FScopeLock Lock(&Self->Section);
+				Self->OpenNamespaces.Empty();
+			}
+			const ESIOConnectionCloseReason Reason = (ESIOConnectionCloseReason)reason;
+			Self->ForEachNative(FString(), [Reason](FSocketIONative* Native)
+			{
+				Native->HandleConnectionClosed(Reason);
+			});
+		}
+	}));
+
+	Client->set_socket_open_listener(sio::client::socket_listener([Weak](std::string const& nsp)
+	{
+		if (FPtr Self = Weak.Pin())
+		{
+			const FString Namespace = NormalizeNamespace(USIOMessageConvert::FStringFromStd(nsp));
+			FScopeLock DispatchLock(&Self->DispatchSection);
+			{
+				FScopeLock Lock(&Self->Section);
+				Self->OpenNamespaces.Add(Namespace);
+			}
+			Self->ForEachNative(Namespace, [&Namespace](FSocketIONative* Native)
+			{
+				Native->HandleNamespaceOpened(Namespace);
+			});
+		}
+	}));
+
+	Client->set_socket_close_listener(sio::client::socket_listener([Weak](std::string const& nsp)
+	{
+		if (FPtr Self = Weak.Pin())
+		{
+			const FString Namespace = NormalizeNamespace(USIOMessageConvert::FStringFromStd(nsp));
+			FScopeLock DispatchLock(&Self->DispatchSection);
+			{
+				FScopeLock Lock(&Self->Section);
+				Self->OpenNamespaces.Remove(Namespace);
+			}
+			Self->ForEachNative(Namespace, [&Namespace](FSocketIONative* Native)
+			{
+				Native->HandleNamespaceClosed(Namespace);
+			});
+		}
+	}));
+
+	Client->set_fail_listener(sio::client::con_listener([Weak]()
+	{
+		if (FPtr Self = Weak.Pin())
+		{
+			Self->ForEachNative(FString(), [](FSocketIONative* Native)
+			{
+				Native->HandleConnectionFailed();
+			});
+		}
+	}));
+
+	Client->set_reconnect_listener(sio::client::reconnect_listener([Weak](unsigned num, unsigned delay)
+	{
+		if (FPtr Self = Weak.Pin())
+		{
+			Self->ForEachNative(FString(), [num, delay](FSocketIONative* Native)
+			{
+				Native->HandleReconnecting(num, delay);
+			});
+		}
+	}));
+}
+
+void FSIOSharedConnection::ForEachNative(const FString& Namespace, TFunctionRef<void(FSocketIONative*)> Callback)
+{
+	TArray<FSocketIONative*> Targets;
+	{
+		FScopeLock Lock(&Section);
+		for (const TPair<FSocketIONative*, TSet<FString>>& Pair : Natives)
+		{
+			if (Namespace.IsEmpty() || Pair.Value.Contains(Namespace))
+			{
+				Targets.Add(Pair.Key);
+			}
+		}
+	}
+
+	//a callback may detach its own or another native, skip natives gone meanwhile
+	FScopeLock DispatchLock(&DispatchSection);
+	for (FSocketIONative* Native : Targets)
+	{
+		bool bAttached = false;
+		{
+			FScopeLock Lock(&Section);
+			bAttached = Natives.Contains(Native);
+		}
+		if (bAttached)
+		{
+			Callback(Native);
+		}
+	}
+}
@@ -0,0 +1,330 @@
+// Copyright 2018-current Getnamo. All Rights Reserved
+
+#include "SIOSnapshotInterpolationComponent.h"
+#include "SocketIOClientComponent.h"
+#include "JsonObjectConverter.h"
+#include "Camera/PlayerCameraManager.h"
+#include "Kismet/GameplayStatics.h"
+
+bool FSIOTransformSnapshot::FromJson(const TSharedPtr<FJsonObject>& Object, FSIOTransformSnapshot& OutSnapshot)
+{
+	if (!Object.IsValid() || !Object->HasField(TEXT("time")) || !Object->HasField(TEXT("location")))
+	{
+		return false;
+	}
+	OutSnapshot = FSIOTransformSnapshot();
+	if (!FJsonObjectConverter::JsonObjectToUStruct(Object.ToSharedRef(), &OutSnapshot))
+	{
+		return false;
+	}
+	OutSnapshot.bHasVelocity = Object->HasField(TEXT("velocity"));
+	return true;
+}
+
+USIOSnapshotInterpolationComponent::USIOSnapshotInterpolationComponent(const FObjectInitializer& init) : UActorComponent(init)
+{
+	PrimaryComponentTick.bCanEverTick = true;
+	PrimaryComponentTick.TickGroup = TG_PrePhysics;
+
+	InterpolationDelay = 0.1f;
+	MaxExtrapolation = 0.25f;
+	BufferSize = 32;
+	TeleportDistance = 500.f;
+	ClockSampleCount = 8;
+
+	FullRateDistance = 2000.f;
+	ThrottledDistance = 10000.f;
+	MaxThrottledInterval = 0.1f;
+
+	Head = 0;
+	Count = 0;
+	ListenerId = 0;
+}
+
+void USIOSnapshotInterpolationComponent::AddSnapshot(const FSIOTransformSnapshot& Snapshot)
+{
+	//transport is ordered, older times come from a server restart or a duplicate
+	if (Count > 0 && Snapshot.Time <= GetSnapshot(Count - 1).Snapshot.Time)
+	{
+		//a jump further back than anything we could still be rendering means the server clock was reset,
+		//start over on the new clock instead of freezing on the last snapshot
+		const double Newest = GetSnapshot(Count - 1).Snapshot.Time;
+		const double BufferSpan = Newest - GetSnapshot(0).Snapshot.Time;
+		if (Newest - Snapshot.Time <= MaxExtrapolation + InterpolationDelay + BufferSpan)
+		{
+			return;
+		}
+		ClearSnapshots();
+		ClockSamples.Empty();
+	}
+
+	const int32 Capacity = FMath::Max(BufferSize, 2);
+	if (Snapshots.Num() != Capacity)
+	{
+		//keep the newest snapshots in order
+		TArray<FBufferedSnapshot> Resized;
+		Resized.Reserve(Capacity);
+		for (int32 i = FMath::Max(0, Count - Capacity); i < Count; i++)
+		{
+			Resized.Add(GetSnapshot(i));
+		}
+		Count = Resized.Num();
+		Resized.SetNum(Capacity);
+		Snapshots = MoveTemp(Resized);
+		Head = 0;
+	}
+
+	int32 Slot;
+	if (Count < Capacity)
+	{
+		Slot = (Head + Count) % Capacity;
+		Count++;
+	}
+	else
+	{
+		Slot = Head;
+		Head = (Head + 1) % Capacity;
+	}
+
+	FBufferedSnapshot& Buffered = Snapshots[Slot];
+	Buffered.Snapshot = Snapshot;
+	Buffered.Rotation = Snapshot.Rotation.Quaternion();
+	Buffered.ArrivalOffset = Snapshot.Time - FPlatformTime::Seconds();
+}
+
+void USIOSnapshotInterpolationComponent::AddClockSample(double ServerTime, float RoundTripTime)
+{
+	if (RoundTripTime < 0.f)
+	{
+		return;
+	}
+
+	//the answer is assumed half way through the round trip
+	ClockSamples.Add({ ServerTime + RoundTripTime * 0.5 - FPlatformTime::Seconds(), RoundTripTime });
+
+	const int32 Excess = ClockSamples.Num() - FMath::Max(ClockSampleCount, 1);
+	if (Excess > 0)
+	{
+		ClockSamples.RemoveAt(0, Excess);
+	}
+}
+
+void USIOSnapshotInterpolationComponent::RequestClockSample(USocketIOClientComponent* Client, const FString& EventName /*= TEXT("time")*/, const FString& Namespace /*= TEXT("/")*/)
+{
+	if (!Client)
+	{
+		return;
+	}
+
+	TWeakObjectPtr<USIOSnapshotInterpolationComponent> WeakThis(this);
+	const double SentTime = FPlatformTime::Seconds();
+
+	//a bare nullptr picks the text overload and would send ""
+	Client->EmitNative(EventName, TSharedPtr<FJsonValue>(), [WeakThis, SentTime](const TArray<TSharedPtr<FJsonValue>>& Response)
+	{
+		double ServerTime;
+		if (!WeakThis.IsValid() || Response.Num() == 0 || !Response[0].IsValid() || !Response[0]->TryGetNumber(ServerTime))
+		{
+			return;
+		}
+		WeakThis->AddClockSample(ServerTime, (float)(FPlatformTime::Seconds() - SentTime));
+	}, Namespace);
+}
+
+void USIOSnapshotInterpolationComponent::BindToSocketEvent(USocketIOClientComponent* Client, const FString& EventName, const FString& Namespace /*= TEXT("/")*/, const FString& IdField /*= TEXT("")*/, const FString& Id /*= TEXT("")*/)
+{
+	UnbindFromSocketEvent();
+	if (!Client)
+	{
+		return;
+	}
+
+	TWeakObjectPtr<USIOSnapshotInterpolationComponent> WeakThis(this);
+	ListenerId = Client->AddNativeEventListener(EventName, [WeakThis, IdField, Id](const FString& Event, const TSharedPtr<FJsonValue>& Message)
+	{
+		const TSharedPtr<FJsonObject>* Object;
+		if (!WeakThis.IsValid() || !Message.IsValid() || !Message->TryGetObject(Object))
+		{
+			return;
+		}
+
+		FString MessageId;
+		if (!IdField.IsEmpty() && (!(*Object)->TryGetStringField(IdField, MessageId) || MessageId != Id))
+		{
+			return;
+		}
+
+		FSIOTransformSnapshot Snapshot;
+		if (FSIOTransformSnapshot::FromJson(*Object, Snapshot))
+		{
+			WeakThis->AddSnapshot(Snapshot);
+		}
+	}, Namespace);
+	BoundClient = Client;
+}
+
+void USIOSnapshotInterpolationComponent::UnbindFromSocketEvent()
+{
+	if (BoundClient.IsValid())
+	{
+		BoundClient->RemoveNativeEventListener(ListenerId);
+	}
+	BoundClient.Reset();
+	ListenerId = 0;
+}
+
+void USIOSnapshotInterpolationComponent::ClearSnapshots()
+{
+	Head = 0;
+	Count = 0;
+}
+
+double USIOSnapshotInterpolationComponent::GetServerTime() const
+{
+	return FPlatformTime::Seconds() + GetClockOffset();
+}
+
+double USIOSnapshotInterpolationComponent::GetRenderTime() const
+{
+	return GetServerTime() - InterpolationDelay;
+}
+
+bool USIOSnapshotInterpolationComponent::Sample(double Time, FVector& OutLocation, FQuat& OutRotation) const
+{
+	if (Count == 0)
+	{
+		return false;
+	}
+
+	//past the newest snapshot, keep moving for a bit then hold
+	const FBufferedSnapshot& Newest = GetSnapshot(Count - 1);
+	if (Time >= Newest.Snapshot.Time)
+	{
+		const double Extrapolation = FMath::Min(Time - Newest.Snapshot.Time, (double)MaxExtrapolation);
+		OutLocation = Newest.Snapshot.Location + GetTangent(Count - 1) * Extrapolation;
+		OutRotation = Newest.Rotation;
+		return true;
+	}
+
+	const FBufferedSnapshot& Oldest = GetSnapshot(0);
+	if (Time <= Oldest.Snapshot.Time)
+	{
+		OutLocation = Oldest.Snapshot.Location;
+		OutRotation = Oldest.Rotation;
+		return true;
+	}
+
+	//render time is usually in the last couple of intervals
+	int32 Index = Count - 2;
+	while (Index > 0 && GetSnapshot(Index).Snapshot.Time > Time)
+	{
+		Index--;
+	}
+
+	const FBufferedSnapshot& From = GetSnapshot(Index);
+	const FBufferedSnapshot& To = GetSnapshot(Index + 1);
+	const double Interval = To.Snapshot.Time - From.Snapshot.Time;
+	const float Alpha = (float)((Time - From.Snapshot.Time) / Interval);
+
+	//hermite tangents are per interval, not per second
+	OutLocation = FMath::CubicInterp(From.Snapshot.Location, GetTangent(Index) * Interval, To.Snapshot.Location, GetTangent(Index + 1) * Interval, Alpha);
+	OutRotation = FQuat::Slerp(From.Rotation, To.Rotation, Alpha);
+	return true;
+}
+
+void USIOSnapshotInterpolationComponent::TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction)
+{
+	Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
+
+	AActor* Owner = GetOwner();
+	FVector Location;
+	FQuat Rotation;
+	if (!Owner || !Sample(GetRenderTime(), Location, Rotation))
+	{
+		return;
+	}
+
+	const bool bTeleport = FVector::DistSquared(Owner->GetActorLocation(), Location) > FMath::Square(TeleportDistance);
+	Owner->SetActorLocationAndRotation(Location, Rotation, false, nullptr, bTeleport ? ETeleportType::TeleportPhysics : ETeleportType::None);
+
+	UpdateTickInterval();
+}
+
+void USIOSnapshotInterpolationComponent::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	UnbindFromSocketEvent();
+	Super::EndPlay(EndPlayReason);
+}
+
+const USIOSnapshotInterpolationComponent::FBufferedSnapshot& USIOSnapshotInterpolationComponent::GetSnapshot(int32 Index) const
+{
+	return Snapshots[(Head + Index) % Snapshots.Num()];
+}
+
+FVector USIOSnapshotInterpolationComponent::GetTangent(int32 Index) const
+{
+	const FSIOTransformSnapshot& Snapshot = GetSnapshot(Index).Snapshot;
+	if (Snapshot.bHasVelocity)
+	{
+		return Snapshot.Velocity;
+	}
+
+	//finite difference over the neighbours, one sided at the ends
+	const int32 Before = FMath::Max(Index - 1, 0);
+	const int32 After = FMath::Min(Index + 1, Count - 1);
+	if (Before == After)
+	{
+		return FVector::ZeroVector;
+	}
+	const FSIOTransformSnapshot& First = GetSnapshot(Before).Snapshot;
+	const FSIOTransformSnapshot& Last = GetSnapshot(After).Snapshot;
+	return (Last.Location - First.Location) / (Last.Time - First.Time);
+}
+
+double USIOSnapshotInterpolationComponent::GetClockOffset() const
+{
+	if (ClockSamples.Num() > 0)
+	{
+		//queueing only ever adds delay, so the shortest round trip is the most accurate
+		const FClockSample* Best = &ClockSamples[0];
+		for (const FClockSample& ClockSample : ClockSamples)
+		{
+			if (ClockSample.RoundTripTime < Best->RoundTripTime)
+			{
+				Best = &ClockSample;
+			}
+		}
+		return Best->Offset;
+	}
+
+	//without pings, the buffered snapshot with the shortest trip is the closest to the server clock.
+	//it is late by one way latency, which the interpolation delay has to cover.
+	double Offset = 0.0;
+	for (int32 i = 0; i < Count; i++)
+	{
+		Offset = i == 0 ? GetSnapshot(i).ArrivalOffset : FMath::Max(Offset, GetSnapshot(i).ArrivalOffset);
+	}
+	return Offset;
+}
+
+void USIOSnapshotInterpolationComponent::UpdateTickInterval()
+{
+	if (MaxThrottledInterval <= 0.f)
+	{
+		SetComponentTickInterval(0.f);
+		return;
+	}
+
+	APlayerCameraManager* Camera = UGameplayStatics::GetPlayerCameraManager(this, 0);
+	if (!Camera)
+	{
+		return;
+	}
+
+	//far away actors move less on screen, update them less often
+	const float Distance = FVector::Dist(Camera->GetCameraLocation(), GetOwner()->GetActorLocation());
+	const float Alpha = ThrottledDistance > FullRateDistance ?
+		FMath::Clamp((Distance - FullRateDistance) / (ThrottledDistance - FullRateDistance), 0.f, 1.f) :
+		(Distance > FullRateDistance ? 1.f : 0.f);
+	SetComponentTickInterval(Alpha * MaxThrottledInterval);
+}
@@ -0,0 +1,167 @@
+// Copyright 2018-current Getnamo. All Rights Reserved
+
+#include "SIOTypedEmit.h"
+#include "SIOJsonValue.h"
+#include "SIOJStructPlan.h"
+#include "Misc/ScopeRWLock.h"
+
+namespace
+{
+	FRWLock EventNameLock;
+	TMap<uint32, TArray<TUniquePtr<FSIOEncodedEventName>>> EventNameCache;
+
+	const FSIOEncodedEventName* FindEventName(const FSIOEventName& EventName)
+	{
+		const TArray<TUniquePtr<FSIOEncodedEventName>>* Bucket = EventNameCache.Find(EventName.Hash);
+		if (!Bucket)
+		{
+			return nullptr;
+		}
+		for (const TUniquePtr<FSIOEncodedEventName>& Entry : *Bucket)
+		{
+			if (Entry->Name.Len() == EventName.Length &&
+				FCString::Strncmp(*Entry->Name, EventName.Name, EventName.Length) == 0)
+			{
+				return Entry.Get();
+			}
+		}
+		return nullptr;
+	}
+
+	void WriteKey(sio::event_writer& Writer, const FString& Key)
+	{
+		FTCHARToUTF8 Utf8Key(*Key, Key.Len());
+		Writer.key(Utf8Key.Get(), Utf8Key.Length());
+	}
+}
+
+const FSIOEncodedEventName& FSIOTypedEmit::ResolveEventName(const FSIOEventName& EventName)
+{
+	{
+		FReadScopeLock ReadLock(EventNameLock);
+		if (const FSIOEncodedEventName* Found = FindEventName(EventName))
+		{
+			return *Found;
+		}
+	}
+
+	FWriteScopeLock WriteLock(EventNameLock);
+	if (const FSIOEncodedEventName* Found = FindEventName(EventName))
+	{
+		return *Found;
+	}
+
+	//entries are never removed, references stay valid for the process lifetime
+	TUniquePtr<FSIOEncodedEventName> Entry = MakeUnique<FSIOEncodedEventName>();
+	Entry->Name = FString::ConstructFromPtrSize(EventName.Name, EventName.Length);
+	FTCHARToUTF8 Utf8Name(EventName.Name, EventName.Length);
+	Entry->Utf8 = std::string(Utf8Name.Get(), Utf8Name.Length());
+	Entry->Quoted = sio::event_writer::quote(Entry->Utf8.data(), Entry->Utf8.size());
+
+	const FSIOEncodedEventName& Result = *Entry;
+	EventNameCache.FindOrAdd(EventName.Hash).Add(MoveTemp(Entry));
+	return Result;
+}
+
+void FSIOTypedEmit::Write(sio::event_writer& Writer, const TArray<uint8>& Value)
+{
+	Writer.binary_value(std::make_shared<const std::string>((const char*)Value.GetData(), Value.Num()));
+}
+
+void FSIOTypedEmit::Write(sio::event_writer& Writer, const TSharedPtr<FJsonValue>& Value)
+{
+	if (!Value.IsValid())
+	{
+		Writer.null_value();
+		return;
+	}
+
+	switch (Value->Type)
+	{
+	case EJson::String:
+		if (FJsonValueBinary::IsBinary(Value))
+		{
+			Write(Writer, FJsonValueBinary::AsBinary(Value));
+		}
+		else
+		{
+			Write(Writer, Value->AsString());
+		}
+		break;
+	case EJson::Number:
+		Writer.double_value(Value->AsNumber());
+		break;
+	case EJson::Boolean:
+		Writer.bool_value(Value->AsBool());
+		break;
+	case EJson::Array:
+		Writer.start_array();
+		for (const TSharedPtr<FJsonValue>& Item : Value->AsArray())
+		{
+			Write(Writer, Item);
+		}
+		Writer.end_array();
+		break;
+	case EJson::Object:
+		Write(Writer, Value->AsObject());
+		break;
+	default:
+		Writer.null_value();
+		break;
+	}
+}
+
+void FSIOTypedEmit::Write(sio::event_writer& Writer, const TSharedPtr<FJsonObject>& Value)
+{
+	if (!Value.IsValid())
+	{
+		Writer.null_value();
+		return;
+	}
+
+	Writer.start_object();
+	for (const TPair<FString, TSharedPtr<FJsonValue>>& Pair : Value->Values)
+	{
+		WriteKey(Writer, Pair.Key);
+		Write(Writer, Pair.Value);
+	}
+	Writer.end_object();
+}
+
+void FSIOTypedEmit::WriteString(sio::event_writer& Writer, const TCHAR* Value, int32 Length)
+{
+	FTCHARToUTF8 Utf8Value(Value, Length);
+	Writer.string_value(Utf8Value.Get(), Utf8Value.Length());
+}
+
+sio::prepared_packet::ptr FSIOTypedEmit::EncodeStruct(const FSIOEventName& EventName, const UStruct* Struct, const void* StructPtr)
+{
+	const FSIOEncodedEventName& Name = ResolveEventName(EventName);
+
+	sio::event_writer Writer;
+	Writer.begin_event(Name.Quoted);
+	WriteStruct(Writer, Struct, StructPtr);
+	return Writer.finish(Name.Utf8);
+}
+
+sio::prepared_packet::ptr FSIOTypedEmit::EncodeCompactStruct(const FSIOEventName& EventName, const UStruct* Struct, const void* StructPtr)
+{
+	const FSIOEncodedEventName& Name = ResolveEventName(EventName);
+
+	TArray<uint8> Bytes;
+	FSIOJStructPlan::Get(Struct)->WriteCompact(StructPtr, Bytes);
+
+	sio::event_writer Writer;
+	Writer.begin_event(Name.Quoted);
+	Writer.binary_value(std::make_shared<const std::string>((const char*)Bytes.GetData(), Bytes.Num()));
+	return Writer.finish(Name.Utf8);
+}
+
+void FSIOTypedEmit::WriteStruct(sio::event_writer& Writer, const UStruct* Struct, const void* StructPtr)
+{
+	//the cached plan writes the object text, reused per thread so steady emits don't allocate for it
+	static thread_local TArray<uint8> StructJson;
+	StructJson.Reset();
+	FSIOJStructPlan::Get(Struct)->Write(StructPtr, StructJson);
+	Writer.raw_value((const char*)StructJson.GetData(), StructJson.Num());
+}
@@ -5,12 +5,51 @@
 #include "SocketIONative.h"
 #include "SIOMessageConvert.h"
 #include "CULambdaRunnable.h"
+#include "SIOBoundFunction.h"
+#include "UObject/UObjectGlobals.h"
 #include "Runtime/Core/Public/HAL/ThreadSafeBool.h"
 
 #define LOCTEXT_NAMESPACE "FSocketIOClientModule"
 
 //struct 
 
+namespace
+{
+	//Max time module shutdown waits for connections to close before aborting them
+	const float ShutdownTimeoutInSec = 2.f;
+
+	//Plugin scoped natives, shared with release lambdas so they never touch the module itself
+	struct FSIONativePointerSet
+	{
+		FCriticalSection Section;
+		TArray<TSharedPtr<FSocketIONative>> Pointers;
+		FThreadSafeBool bHasActiveNativePointers;
+	};
+
+	struct FSIOTeardownState
+	{
+		FCriticalSection Section;
+		TPromise<FSIOTeardownReport> Promise;
+		TArray<TSharedPtr<FSocketIONative>> Pending;
+
+		//Taken on the calling thread, the natives may change while the deadline reads them
+		TMap<TSharedPtr<FSocketIONative>, FString> Descriptions;
+		TSet<const FSocketIONative*> Closing;
+		FSIOTeardownReport Report;
+		FCUTimeoutHandle Deadline;
+		double StartTime = 0.0;
+		bool bFinished = false;
+
+		//Call with Section held
+		void Finish()
+		{
+			bFinished = true;
+			Report.ElapsedSeconds = FPlatformTime::Seconds() - StartTime;
+			Promise.SetValue(Report);
+		}
+	};
+}
+
 class FSocketIOClientModule : public ISocketIOClientModule
 {
 public:
@@ -18,22 +57,24 @@ public:
 	virtual TSharedPtr<FSocketIONative> NewValidNativePointer(const bool bShouldUseTlsLibraries, const bool bShouldVerifyTLSCertificate) override;
 	virtual TSharedPtr<FSocketIONative> ValidSharedNativePointer(FString SharedId, const bool bShouldUseTlsLibraries, const bool bShouldVerifyTLSCertificate) override;
 	void ReleaseNativePointer(TSharedPtr<FSocketIONative> PointerToRelease) override;
+	virtual TFuture<FSIOTeardownReport> ReleaseAllNativePointersAsync(float TimeoutInSec = 1.f) override;
 
 	/** IModuleInterface implementation */
 	virtual void StartupModule() override;
 	virtual void ShutdownModule() override;
 
 private:
-	FCriticalSection DeleteSection;
+	void ReleaseNativePointerInternal(TSharedPtr<FSocketIONative> PointerToRelease, TFunction<void()> OnReleased);
 
-	//All native pointers manages by the plugin
-	TArray<TSharedPtr<FSocketIONative>> PluginNativePointers;
+	//All native pointers manages by the plugin, outlives the module while releases finish
+	TSharedRef<FSIONativePointerSet, ESPMode::ThreadSafe> PluginNativePointers = MakeShared<FSIONativePointerSet, ESPMode::ThreadSafe>();
 
 	//Shared pointers, these will typically be alive past game world lifecycles
 	TMap<FString, TSharedPtr<FSocketIONative>> SharedNativePointers;
 	TSet<TSharedPtr<FSocketIONative>> AllSharedPtrs;	//reverse lookup
 
-	FThreadSafeBool bHasActiveNativePointers;
+	FDelegateHandle ReloadCompleteHandle;
+	FDelegateHandle ObjectsReplacedHandle;
 };
 
 
@@ -41,7 +82,22 @@ void FSocketIOClientModule::StartupModule()
 {
 	// This code will execute after your module is loaded into memory; the exact timing is specified in the .uplugin file per-module
 
-	PluginNativePointers.Empty();
+	{
+		FScopeLock Lock(&PluginNativePointers->Section);
+		PluginNativePointers->Pointers.Empty();
+	}
+
+	//Bound BP functions cache their UFunction, hot reload and blueprint recompiles invalidate it
+	ReloadCompleteHandle = FCoreUObjectDelegates::ReloadCompleteDelegate.AddLambda([](EReloadCompleteReason)
+	{
+		FSIOBoundFunction::InvalidateAll();
+	});
+#if WITH_EDITOR
+	ObjectsReplacedHandle = FCoreUObjectDelegates::OnObjectsReplaced.AddLambda([](const TMap<UObject*, UObject*>&)
+	{
+		FSIOBoundFunction::InvalidateAll();
+	});
+#endif
 }
 
 void FSocketIOClientModule::ShutdownModule()
@@ -49,43 +105,50 @@ void FSocketIOClientModule::ShutdownModule()
 	// This function may be called during shutdown to clean up your module.  For modules that support dynamic reloading,
 	// we call this function before unloading the module.
 
+	FCoreUObjectDelegates::ReloadCompleteDelegate.Remove(ReloadCompleteHandle);
+#if WITH_EDITOR
+	FCoreUObjectDelegates::OnObjectsReplaced.Remove(ObjectsReplacedHandle);
+#endif
+
 	/*
 	Ensure we call release pointers, this will catch all the plugin scoped 
 	connections pointers which don't get auto-released between game worlds.
 	*/
-	auto AllActivePointers = PluginNativePointers;
-	for (auto& Pointer : AllActivePointers)
+	TFuture<FSIOTeardownReport> Teardown = ReleaseAllNativePointersAsync(ShutdownTimeoutInSec);
+
+	//The deadline sets the future, the extra second only guards against the timer never firing
+	if (!Teardown.WaitFor(FTimespan::FromSeconds(ShutdownTimeoutInSec + 1.f)))
 	{
-		ReleaseNativePointer(Pointer);
+		UE_LOG(SocketIO, Warning, TEXT("FSocketIOClientModule::ShutdownModule force quit due to long wait to quit."));
 	}
-	AllActivePointers.Empty();
-
-	//Wait for all pointers to release
-	float Elapsed = 0.f;
-	while (bHasActiveNativePointers)
+	else
 	{
-		FPlatformProcess::Sleep(0.01f);
-		Elapsed += 0.01f;
-
-		//if it takes more than 5 seconds, just quit
-		if (Elapsed > 5.f)
+		const FSIOTeardownReport& Report = Teardown.Get();
+		if (Report.Aborted.Num() > 0)
+		{
+			UE_LOG(SocketIO, Warning, TEXT("FSocketIOClientModule::ShutdownModule aborted connections still closing: %s"), *FString::Join(Report.Aborted, TEXT(", ")));
+		}
+		if (Report.SkippedShared.Num() > 0)
 		{
-			UE_LOG(SocketIO, Warning, TEXT("FSocketIOClientModule::ShutdownModule force quit due to long wait to quit."));
-			break;
+			UE_LOG(SocketIO, Warning, TEXT("FSocketIOClientModule::ShutdownModule left shared connections still closing: %s"), *FString::Join(Report.SkippedShared, TEXT(", ")));
 		}
 	}
 
 	//Native pointers will be automatically released by uninitialize components
-	PluginNativePointers.Empty();
+	FScopeLock Lock(&PluginNativePointers->Section);
+	PluginNativePointers->Pointers.Empty();
 }
 
 TSharedPtr<FSocketIONative> FSocketIOClientModule::NewValidNativePointer(const bool bShouldUseTlsLibraries, const bool bShouldVerifyTLSCertificate)
 {
 	TSharedPtr<FSocketIONative> NewPointer = MakeShareable(new FSocketIONative(bShouldUseTlsLibraries, bShouldVerifyTLSCertificate));
 	
-	PluginNativePointers.Add(NewPointer);
+	{
+		FScopeLock Lock(&PluginNativePointers->Section);
+		PluginNativePointers->Pointers.Add(NewPointer);
+	}
 	
-	bHasActiveNativePointers = true;
+	PluginNativePointers->bHasActiveNativePointers = true;
 
 	return NewPointer;
 }
@@ -108,6 +171,82 @@ TSharedPtr<FSocketIONative> FSocketIOClientModule::ValidSharedNativePointer(FStr
 }
 
 void FSocketIOClientModule::ReleaseNativePointer(TSharedPtr<FSocketIONative> PointerToRelease)
+{
+	ReleaseNativePointerInternal(PointerToRelease, nullptr);
+}
+
+TFuture<FSIOTeardownReport> FSocketIOClientModule::ReleaseAllNativePointersAsync(float TimeoutInSec /*= 1.f*/)
+{
+	TSharedPtr<FSIOTeardownState, ESPMode::ThreadSafe> State = MakeShared<FSIOTeardownState, ESPMode::ThreadSafe>();
+	State->StartTime = FPlatformTime::Seconds();
+	TFuture<FSIOTeardownReport> Future = State->Promise.GetFuture();
+
+	TArray<TSharedPtr<FSocketIONative>> Pointers;
+	{
+		FScopeLock Lock(&PluginNativePointers->Section);
+		Pointers = PluginNativePointers->Pointers;
+	}
+
+	FScopeLock Lock(&State->Section);
+	State->Pending = Pointers;
+	for (const TSharedPtr<FSocketIONative>& Pointer : Pointers)
+	{
+		State->Descriptions.Add(Pointer, FString::Printf(TEXT("%s (%s)"), *Pointer->URLParams.AddressAndPort, *Pointer->SessionId));
+		State->Closing.Add(Pointer.Get());
+	}
+	if (Pointers.Num() == 0)
+	{
+		State->Finish();
+		return Future;
+	}
+
+	State->Deadline = FCULambdaRunnable::SetTimeout([State]
+	{
+		FScopeLock Lock(&State->Section);
+		if (State->bFinished)
+		{
+			return;
+		}
+		for (const TSharedPtr<FSocketIONative>& Pointer : State->Pending)
+		{
+			const FString& Description = State->Descriptions.FindChecked(Pointer);
+
+			//unblocks its SyncDisconnect, which then finishes on its own. A shared connection held only
+			//by natives of this teardown is dropped too.
+			if (Pointer->AbortConnection(State->Closing))
+			{
+				State->Report.Aborted.Add(Description);
+			}
+			else
+			{
+				State->Report.SkippedShared.Add(Description);
+			}
+		}
+		State->Finish();
+	}, TimeoutInSec, false);
+
+	for (const TSharedPtr<FSocketIONative>& Pointer : Pointers)
+	{
+		ReleaseNativePointerInternal(Pointer, [State, Pointer]
+		{
+			FScopeLock Lock(&State->Section);
+			State->Pending.Remove(Pointer);
+			if (State->bFinished)
+			{
+				return;
+			}
+			State->Report.Closed++;
+			if (State->Pending.Num() == 0)
+			{
+				FCULambdaRunnable::ClearTimeout(State->Deadline);
+				State->Finish();
+			}
+		});
+	}
+	return Future;
+}
+
+void FSocketIOClientModule::ReleaseNativePointerInternal(TSharedPtr<FSocketIONative> PointerToRelease, TFunction<void()> OnReleased)
 {
 	//Remove shared ptr references if any
 	if (AllSharedPtrs.Contains(PointerToRelease))
@@ -124,14 +263,16 @@ void FSocketIOClientModule::ReleaseNativePointer(TSharedPtr<FSocketIONative> Poi
 	}
 
 	//Release the pointer on the background thread pool, this can take ~ 1 sec per connection
-	FCULambdaRunnable::RunLambdaOnBackGroundThread([PointerToRelease, this]
+	//may still run after the module shut down, so only the pointer set is captured
+	TSharedRef<FSIONativePointerSet, ESPMode::ThreadSafe> PointerSet = PluginNativePointers;
+	FCULambdaRunnable::RunLambdaOnBackGroundThread([PointerToRelease, OnReleased, PointerSet]
 	{
 		if (PointerToRelease.IsValid())
 		{
 			//Ensure only one thread at a time removes from array 
 			{
-				FScopeLock Lock(&DeleteSection);
-				PluginNativePointers.Remove(PointerToRelease);
+				FScopeLock Lock(&PointerSet->Section);
+				PointerSet->Pointers.Remove(PointerToRelease);
 			}
 
 			//Disconnect, this can happen simultaneously
@@ -141,7 +282,13 @@ void FSocketIOClientModule::ReleaseNativePointer(TSharedPtr<FSocketIONative> Poi
 			}
 
 			//Update our active status
-			bHasActiveNativePointers = PluginNativePointers.Num() > 0;
+			FScopeLock Lock(&PointerSet->Section);
+			PointerSet->bHasActiveNativePointers = PointerSet->Pointers.Num() > 0;
+		}
+
+		if (OnReleased)
+		{
+			OnReleased();
 		}
 	});
 }
@@ -5,6 +5,8 @@
 #include "SIOJConvert.h"
 #include "SIOMessageConvert.h"
 #include "SIOJRequestJSON.h"
+#include "SIOBoundFunction.h"
+#include "SIOJsonWrapperPool.h"
 #include "SocketIOClient.h"
 #include "Engine/Engine.h"
 
@@ -25,12 +27,17 @@ USocketIOClientComponent::USocketIOClientComponent(const FObjectInitializer &ini
 	//Plugin scoped utilities
 	bPluginScopedConnection = false;
 	PluginScopedId = TEXT("Default");
+	bShareConnection = false;
 	bVerboseConnectionLog = true;
 	ReconnectionTimeout = 0.f;
 	MaxReconnectionAttempts = -1.f;
 	ReconnectionDelayInMs = 5000;
 
 	bStaticallyInitialized = false;
+	bBatchEmits = false;
+	OutboxMemoryBudget = 256 * 1024;
+	OutboxMaxEntries = 4096;
+	OutboxMaxAgeSeconds = 24 * 60 * 60;
 
 	ClearCallbacks();
 }
@@ -76,6 +83,20 @@ void USocketIOClientComponent::InitializeNative()
 		NativeClient = ISocketIOClientModule::Get().NewValidNativePointer(bForceTLS, bShouldVerifyTLSCertificate);
 	}
 
+	NativeClient->bShareConnection = bShareConnection;
+	NativeClient->bBatchEmits = bBatchEmits;
+	for (const FSIOConflationSettings& Settings : ConflatedEvents)
+	{
+		NativeClient->SetEventConflation(Settings.EventName, Settings.KeyField, Settings.MaxFlushRate, Settings.Namespace);
+	}
+	NativeClient->Outbox->MemoryBudget = OutboxMemoryBudget;
+	NativeClient->Outbox->MaxEntries = OutboxMaxEntries;
+	NativeClient->Outbox->MaxAgeSeconds = OutboxMaxAgeSeconds;
+	for (const FString& EventName : OutboxEvents)
+	{
+		NativeClient->SetEventOutbox(EventName);
+	}
+
 	SetupCallbacks();
 }
 
@@ -216,152 +237,13 @@ void USocketIOClientComponent::ClearCallbacks()
 
 bool USocketIOClientComponent::CallBPFunctionWithResponse(UObject* Target, const FString& FunctionName, TArray<TSharedPtr<FJsonValue>> Response)
 {
-	if (!Target->IsValidLowLevel())
-	{
-		UE_LOG(SocketIO, Warning, TEXT("CallFunctionByNameWithArguments: Target not found for '%s'"), *FunctionName);
-		return false;
-	}
-	UWorld* World = GEngine->GetWorldFromContextObject(Target, EGetWorldErrorMode::LogAndReturnNull);
-	if (!World)
-	{
-		UE_LOG(SocketIO, Log, TEXT("World is invalid, %s BP function call ignored."), *FunctionName);
-		return false;
-	}	
-	if (World && World->bIsTearingDown)
-	{
-		UE_LOG(SocketIO, Log, TEXT("World tearing down, %s BP function call ignored."), *FunctionName);
-		return false;
-	}
-
-	UFunction* Function = Target->FindFunction(FName(*FunctionName));
-	if (nullptr == Function)
-	{
-		UE_LOG(SocketIO, Warning, TEXT("CallFunctionByNameWithArguments: Function not found '%s'"), *FunctionName);
-		return false;
-	}
-
-	//Check function signature
-	TFieldIterator<FProperty> Iterator(Function);
-
-	TArray<FProperty*> Properties;
-	while (Iterator && (Iterator->PropertyFlags & CPF_Parm))
-	{
-		FProperty* Prop = *Iterator;
-		Properties.Add(Prop);
-		++Iterator;
-	}
-
-	auto ResponseJsonValue = USIOJConvert::ToSIOJsonValue(Response);
-
-	bool bResponseNumNotZero = Response.Num() > 0;
-	bool bNoFunctionParams = Properties.Num() == 0;
-	bool bNullResponse = ResponseJsonValue->IsNull();
-
-	if (bNullResponse && bNoFunctionParams)
-	{
-		Target->ProcessEvent(Function, nullptr);
-		return true;
-	}
-	else if (bResponseNumNotZero)
-	{
-		//function has too few params
-		if (bNoFunctionParams)
-		{
-			UE_LOG(SocketIO, Warning, TEXT("CallFunctionByNameWithArguments: Function '%s' has too few parameters, callback parameters ignored : <%s>"), *FunctionName, *ResponseJsonValue->EncodeJson());
-			Target->ProcessEvent(Function, nullptr);
-			return true;
-		}
-		struct FDynamicArgs
-		{
-			void* Arg01 = nullptr;
-			USIOJsonValue* Arg02 = nullptr;
-		};
-		//create the container
-		FDynamicArgs Args = FDynamicArgs();
-
-		//add the full response array as second param
-		Args.Arg02 = ResponseJsonValue;
-		const FString& FirstParam = Properties[0]->GetCPPType();
-		auto FirstFJsonValue = Response[0];
-
-		//Is first param...
-		//SIOJsonValue?
-		if (FirstParam.Equals("USIOJsonValue*"))
-		{
-			//convenience wrapper, response is a single object
-			USIOJsonValue* Value = NewObject<USIOJsonValue>();
-			Value->SetRootValue(FirstFJsonValue);
-			Args.Arg01 = Value;
-			Target->ProcessEvent(Function, &Args);
-			return true;
-		}
-		//SIOJsonObject?
-		else if (FirstParam.Equals("USIOJsonObject*"))
-		{
-			//convenience wrapper, response is a single object
-			USIOJsonObject* ObjectValue = NewObject<USIOJsonObject>();
-			ObjectValue->SetRootObject(FirstFJsonValue->AsObject());
-			Args.Arg01 = ObjectValue;
-			Target->ProcessEvent(Function, &Args);
-			return true;
-		}
-		//String?
-		else if (FirstParam.Equals("FString"))
-		{
-			FString	StringValue = USIOJConvert::ToJsonString(FirstFJsonValue);
-			
-			Target->ProcessEvent(Function, &StringValue);
-			return true;
-		}
-		//Float?
-		else if (FirstParam.Equals("float"))
-		{
-			float NumberValue = (float)FirstFJsonValue->AsNumber();
-			Target->ProcessEvent(Function, &NumberValue);
-			return true;
-		}
-		//Int?
-		else if (FirstParam.Equals("int32"))
-		{
-			int NumberValue = (int)FirstFJsonValue->AsNumber();
-			Target->ProcessEvent(Function, &NumberValue);
-			return true;
-		}
-		//bool?
-		else if (FirstParam.Equals("bool"))
-		{
-			bool BoolValue = FirstFJsonValue->AsBool();
-			Target->ProcessEvent(Function, &BoolValue);
-			return true;
-		}
-		//array?
-		else if (FirstParam.Equals("TArray"))
-		{
-			FArrayProperty* ArrayProp = CastField<FArrayProperty>(Properties[0]);
-
-			FString Inner;
-			ArrayProp->GetCPPMacroType(Inner);
-
-			//byte array is the only supported version
-			if (Inner.Equals("uint8"))
-			{
-				TArray<uint8> Bytes = ResponseJsonValue->AsArray()[0]->AsBinary();
-				Target->ProcessEvent(Function, &Bytes);
-				return true;
-			}
-		}
-	}
-
-	UE_LOG(SocketIO, Warning, TEXT("CallFunctionByNameWithArguments: Function '%s' signature not supported expected <%s>"), *FunctionName, *ResponseJsonValue->EncodeJson());
-	return false;
+	//one-off call, bindings keep their FSIOBoundFunction and skip the lookup
+	return FSIOBoundFunction(Target, FunctionName).Call(Response);
 }
 
 bool USocketIOClientComponent::CallBPFunctionWithMessage(UObject* Target, const FString& FunctionName, TSharedPtr<FJsonValue> Message)
 {
-	TArray<TSharedPtr<FJsonValue>> Response;
-	Response.Add(Message);
-
-	return CallBPFunctionWithResponse(Target, FunctionName, Response);
+	return FSIOBoundFunction(Target, FunctionName).Call(Message);
 }
 
 #if PLATFORM_WINDOWS
@@ -475,7 +357,7 @@ void USocketIOClientComponent::LeaveNamespace(const FString& Namespace)
 #pragma region Emit
 #endif
 
-void USocketIOClientComponent::Emit(const FString& EventName, USIOJsonValue* Message, const FString& Namespace /*= FString(TEXT("/"))*/)
+void USocketIOClientComponent::Emit(const FString& EventName, USIOJsonValue* Message, const FString& Namespace /*= FString(TEXT("/"))*/, ESIOEmitPriority Priority /*= EMIT_REALTIME*/)
 {
 	//Set the message is not null
 	TSharedPtr<FJsonValue> JsonMessage = nullptr;
@@ -488,7 +370,7 @@ void USocketIOClientComponent::Emit(const FString& EventName, USIOJsonValue* Mes
 		JsonMessage = MakeShareable(new FJsonValueNull);
 	}
 
-	NativeClient->Emit(EventName, JsonMessage, nullptr, Namespace);
+	NativeClient->Emit(EventName, JsonMessage, nullptr, Namespace, Priority);
 }
 
 void USocketIOClientComponent::EmitWithCallBack(const FString& EventName, USIOJsonValue* Message /*= nullptr*/, const FString& CallbackFunctionName /*= FString(TEXT(""))*/, UObject* Target /*= nullptr*/, const FString& Namespace /*= FString(TEXT("/"))*/, UObject* WorldContextObject /*= nullptr*/)
@@ -511,9 +393,11 @@ void USocketIOClientComponent::EmitWithCallBack(const FString& EventName, USIOJs
 			JsonMessage = MakeShareable(new FJsonValueNull);
 		}
 
-		EmitNative(EventName, JsonMessage, [&, Target, CallbackFunctionName, this](const TArray<TSharedPtr<FJsonValue>>& Response)
+		//resolved now rather than when the response arrives
+		TSharedPtr<FSIOBoundFunction, ESPMode::ThreadSafe> BoundFunction = MakeShared<FSIOBoundFunction, ESPMode::ThreadSafe>(Target, CallbackFunctionName);
+		EmitNative(EventName, JsonMessage, [BoundFunction](const TArray<TSharedPtr<FJsonValue>>& Response)
 		{
-			CallBPFunctionWithResponse(Target, CallbackFunctionName, Response);
+			BoundFunction->Call(Response);
 		}, Namespace);
 	}
 	else 
@@ -554,9 +438,9 @@ void USocketIOClientComponent::EmitWithGraphCallBack(const FString& EventName, s
 	}
 }
 
-void USocketIOClientComponent::EmitNative(const FString& EventName, const TSharedPtr<FJsonValue>& Message /*= nullptr*/, TFunction< void(const TArray<TSharedPtr<FJsonValue>>&)> CallbackFunction /*= nullptr*/, const FString& Namespace /*= FString(TEXT("/"))*/)
+void USocketIOClientComponent::EmitNative(const FString& EventName, const TSharedPtr<FJsonValue>& Message /*= nullptr*/, TFunction< void(const TArray<TSharedPtr<FJsonValue>>&)> CallbackFunction /*= nullptr*/, const FString& Namespace /*= FString(TEXT("/"))*/, ESIOEmitPriority Priority /*= EMIT_REALTIME*/)
 {
-	NativeClient->Emit(EventName, Message, CallbackFunction, Namespace);
+	NativeClient->Emit(EventName, Message, CallbackFunction, Namespace, Priority);
 }
 
 void USocketIOClientComponent::EmitNative(const FString& EventName, const TSharedPtr<FJsonObject>& ObjectMessage /*= nullptr*/, TFunction< void(const TArray<TSharedPtr<FJsonValue>>&)> CallbackFunction /*= nullptr*/, const FString& Namespace /*= FString(TEXT("/"))*/)
@@ -574,9 +458,9 @@ void USocketIOClientComponent::EmitNative(const FString& EventName, double Numbe
 	EmitNative(EventName, MakeShareable(new FJsonValueNumber(NumberMessage)), CallbackFunction, Namespace);
 }
 
-void USocketIOClientComponent::EmitNative(const FString& EventName, const TArray<uint8>& BinaryMessage, TFunction< void(const TArray<TSharedPtr<FJsonValue>>&)> CallbackFunction /*= nullptr*/, const FString& Namespace /*= FString(TEXT("/"))*/)
+void USocketIOClientComponent::EmitNative(const FString& EventName, const TArray<uint8>& BinaryMessage, TFunction< void(const TArray<TSharedPtr<FJsonValue>>&)> CallbackFunction /*= nullptr*/, const FString& Namespace /*= FString(TEXT("/"))*/, ESIOEmitPriority Priority /*= EMIT_REALTIME*/)
 {
-	EmitNative(EventName, MakeShareable(new FJsonValueBinary(BinaryMessage)), CallbackFunction, Namespace);
+	EmitNative(EventName, MakeShareable(new FJsonValueBinary(BinaryMessage)), CallbackFunction, Namespace, Priority);
 }
 
 void USocketIOClientComponent::EmitNative(const FString& EventName, const TArray<TSharedPtr<FJsonValue>>& ArrayMessage, TFunction< void(const TArray<TSharedPtr<FJsonValue>>&)> CallbackFunction /*= nullptr*/, const FString& Namespace /*= FString(TEXT("/"))*/)
@@ -591,7 +475,17 @@ void USocketIOClientComponent::EmitNative(const FString& EventName, bool Boolean
 
 void USocketIOClientComponent::EmitNative(const FString& EventName, UStruct* Struct, const void* StructPtr, TFunction< void(const TArray<TSharedPtr<FJsonValue>>&)> CallbackFunction /*= nullptr*/, const FString& Namespace /*= FString(TEXT("/"))*/)
 {
-	EmitNative(EventName, USIOJConvert::ToJsonObject(Struct, (void*)StructPtr), CallbackFunction, Namespace);
+	NativeClient->Emit(EventName, Struct, StructPtr, CallbackFunction, Namespace);
+}
+
+void USocketIOClientComponent::EmitNativeCompact(const FString& EventName, const UStruct* Struct, const void* StructPtr, const FString& Namespace /*= FString(TEXT("/"))*/, ESIOEmitPriority Priority /*= EMIT_REALTIME*/)
+{
+	NativeClient->EmitCompact(EventName, Struct, StructPtr, Namespace, Priority);
+}
+
+void USocketIOClientComponent::EmitNativeDelta(const FString& EventName, const UScriptStruct* Struct, const void* StructPtr, const FString& Namespace /*= FString(TEXT("/"))*/, ESIOEmitPriority Priority /*= EMIT_REALTIME*/)
+{
+	NativeClient->EmitDelta(EventName, Struct, StructPtr, Namespace, Priority);
 }
 
 void USocketIOClientComponent::EmitNative(const FString& EventName, const SIO_TEXT_TYPE StringMessage /*= TEXT("")*/, TFunction< void(const TArray<TSharedPtr<FJsonValue>>&)> CallbackFunction /*= nullptr*/, const FString& Namespace /*= FString(TEXT("/"))*/)
@@ -604,14 +498,43 @@ void USocketIOClientComponent::EmitNative(const FString& EventName, const SIO_TE
 #pragma region OnEvents
 #endif
 
+void USocketIOClientComponent::SetEventConflation(const FString& EventName, const FSIOConflationSettings& Settings)
+{
+	//one entry per (namespace, event), as on the native
+	FSIOConflationSettings Entry = Settings;
+	Entry.EventName = EventName;
+	ConflatedEvents.RemoveAll([&](const FSIOConflationSettings& Existing)
+	{
+		return Existing.EventName == EventName && Existing.Namespace == Entry.Namespace;
+	});
+	ConflatedEvents.Add(Entry);
+	NativeClient->SetEventConflation(EventName, Entry.KeyField, Entry.MaxFlushRate, Entry.Namespace);
+}
+
+void USocketIOClientComponent::ClearEventConflation(const FString& EventName, const FString& Namespace /*= TEXT("/")*/)
+{
+	ConflatedEvents.RemoveAll([&](const FSIOConflationSettings& Existing)
+	{
+		return Existing.EventName == EventName && Existing.Namespace == Namespace;
+	});
+	NativeClient->ClearEventConflation(EventName, Namespace);
+}
+
+void USocketIOClientComponent::SetEventOutbox(const FString& EventName, const FString& Namespace /*= TEXT("/")*/)
+{
+	NativeClient->SetEventOutbox(EventName, Namespace);
+}
+
+void USocketIOClientComponent::ClearEventOutbox(const FString& EventName, const FString& Namespace /*= TEXT("/")*/)
+{
+	NativeClient->ClearEventOutbox(EventName, Namespace);
+}
+
 void USocketIOClientComponent::BindEventToGenericEvent(const FString& EventName, const FString& Namespace)
 {
 	NativeClient->OnEvent(EventName, [&](const FString& Event, const TSharedPtr<FJsonValue>& EventValue)
 	{
-		USIOJsonValue* NewValue = NewObject<USIOJsonValue>();
-		TSharedPtr<FJsonValue> NonConstValue = EventValue;
-		NewValue->SetRootValue(NonConstValue);
-		OnGenericEvent.Broadcast(Event, NewValue);
+		OnGenericEvent.Broadcast(Event, FSIOJsonWrapperPool::AcquireValue(EventValue));
 	}, Namespace);
 }
 
@@ -623,11 +546,19 @@ void USocketIOClientComponent::BindEventToDelegate(const FString& EventName,
 	const FSIOJsonValueSignature SafeCallback = CallbackDelegate;	//copy for lambda ref
 	OnNativeEvent(EventName, [&, SafeCallback](const FString& Event, const TSharedPtr<FJsonValue>& Message)
 	{
-		USIOJsonValue* Value = NewObject<USIOJsonValue>();
-		TSharedPtr<FJsonValue> NonConstValue = Message;
-		Value->SetRootValue(NonConstValue);
+		SafeCallback.ExecuteIfBound(FSIOJsonWrapperPool::AcquireValue(Message));
+	}, Namespace, ThreadOverride);
+}
 
-		SafeCallback.ExecuteIfBound(Value);
+void USocketIOClientComponent::BindEventToHandleDelegate(const FString& EventName,
+	const FSIOJsonHandleSignature& CallbackDelegate,
+	const FString& Namespace /*= TEXT("/")*/,
+	ESIOThreadOverrideOption ThreadOverride /*= USE_DEFAULT*/)
+{
+	const FSIOJsonHandleSignature SafeCallback = CallbackDelegate;	//copy for lambda ref
+	OnNativeEvent(EventName, [SafeCallback](const FString& Event, const TSharedPtr<FJsonValue>& Message)
+	{
+		SafeCallback.ExecuteIfBound(FSIOJsonHandle(Message));
 	}, Namespace, ThreadOverride);
 }
 
@@ -646,9 +577,11 @@ void USocketIOClientComponent::BindEventToFunction(const FString& EventName,
 		{
 			Target = WorldContextObject;
 		}
-		OnNativeEvent(EventName, [&, FunctionName, Target](const FString& Event, const TSharedPtr<FJsonValue>& Message)
+		//function and parameter layout resolved once here, each event only fills params and calls
+		TSharedPtr<FSIOBoundFunction, ESPMode::ThreadSafe> BoundFunction = MakeShared<FSIOBoundFunction, ESPMode::ThreadSafe>(Target, FunctionName);
+		OnNativeEvent(EventName, [BoundFunction](const FString& Event, const TSharedPtr<FJsonValue>& Message)
 		{
-			CallBPFunctionWithMessage(Target, FunctionName, Message);
+			BoundFunction->Call(Message);
 		}, Namespace, ThreadOverride);
 	}
 	else
@@ -671,6 +604,24 @@ void USocketIOClientComponent::OnNativeEvent(const FString& EventName,
 	NativeClient->OnEvent(EventName, CallbackFunction, Namespace, ThreadOverride);
 }
 
+uint32 USocketIOClientComponent::AddNativeEventListener(const FString& EventName,
+	TFunction< void(const FString&, const TSharedPtr<FJsonValue>&)> CallbackFunction,
+	const FString& Namespace /*= FString(TEXT("/"))*/,
+	ESIOThreadOverrideOption ThreadOverride /*= USE_DEFAULT*/)
+{
+	return NativeClient->AddEventListener(EventName, CallbackFunction, Namespace, ThreadOverride);
+}
+
+void USocketIOClientComponent::RemoveNativeEventListener(uint32 ListenerId)
+{
+	NativeClient->RemoveEventListener(ListenerId);
+}
+
+void USocketIOClientComponent::SetNativeRelevanceFilter(const FString& EventName, const FSIORelevanceFilterPtr& Filter, const FString& Namespace /*= FString(TEXT("/"))*/)
+{
+	NativeClient->SetRelevanceFilter(EventName, Filter, Namespace);
+}
+
 #if PLATFORM_WINDOWS
 #pragma endregion OnEvents
 #endif
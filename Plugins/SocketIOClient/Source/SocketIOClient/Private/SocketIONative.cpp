@@ -3,6 +3,7 @@
 
 #include "SocketIONative.h"
 #include "SIOMessageConvert.h"
+#include "SIOSharedConnection.h"
 #include "CULambdaRunnable.h"
 #include "SIOJConvert.h"
 #include "sio_client.h"
@@ -19,12 +20,40 @@ FSocketIONative::FSocketIONative(const bool bForceTLS, const bool bShouldVerifyT
 	ReconnectionDelay = 5000;
 	bCallbackOnGameThread = true;
 	bUnbindEventsOnDisconnect = false;
+	bBatchEmits = false;
+	bShareConnection = false;
+	Outbox = MakeShared<FSIOOutbox, ESPMode::ThreadSafe>();
 	bForceTLSUse = bForceTLS;
 	InitPrivateClient(bForceTLS, bShouldVerifyTLSCertificate);
 
 	ClearAllCallbacks();
 }
 
+FSocketIONative::~FSocketIONative()
+{
+	if (SharedConnection.IsValid())
+	{
+		DetachSharedConnection(false, false);
+	}
+
+	if (OutboundTickerHandle.IsValid())
+	{
+		FTSTicker::GetCoreTicker().RemoveTicker(OutboundTickerHandle);
+		OutboundTickerHandle.Reset();
+	}
+
+	FailPendingRpcs(ESIORpcStatus::Disconnected);
+	Outbox->Persist();
+	{
+		FScopeLock Lock(&RpcSection);
+		if (RpcTickerHandle.IsValid())
+		{
+			FTSTicker::GetCoreTicker().RemoveTicker(RpcTickerHandle);
+			RpcTickerHandle.Reset();
+		}
+	}
+}
+
 
 void FSocketIONative::InitPrivateClient(const bool bShouldUseTlsLibraries /*= false*/, const bool bShouldVerifyTLSCertificate /*= false*/)
 {
@@ -39,9 +68,18 @@ void FSocketIONative::Connect(const FSIOConnectParams& InConnectParams)
 	if (!InConnectParams.AddressAndPort.IsEmpty())
 	{
 		URLParams = InConnectParams;
+		UpdateDefaultOutboxJournal();
 	}
 
-	SyncPrivateClientToTLSMode(URLParams.AddressAndPort);
+	if (!bShareConnection)
+	{
+		if (SharedConnection.IsValid())
+		{
+			DetachSharedConnection(false);
+			RebindCurrentEventMap();
+		}
+		SyncPrivateClientToTLSMode(URLParams.AddressAndPort);
+	}
 	
 	//Fill std types before going to background thread.
 
@@ -70,6 +108,47 @@ void FSocketIONative::Connect(const FSIOConnectParams& InConnectParams)
 	QueryMap = USIOMessageConvert::FStringMapToStdStringMap(URLParams.Query);
 	HeadersMap = USIOMessageConvert::FStringMapToStdStringMap(URLParams.Headers);
 
+	if (bShareConnection)
+	{
+		const bool bUseTLS = IsTLSURL(URLParams.AddressAndPort) || bForceTLSUse;
+		const FString Key = FSIOSharedConnection::MakeKey(URLParams, bUseTLS, bUsingTLSCertVerification);
+		if (SharedConnection.IsValid())
+		{
+			if (SharedConnection->Key == Key)
+			{
+				//a failed connection retries, a live one ignores it
+				SharedConnection->Connect(StdAddressString, StdPathString, QueryMap, HeadersMap, AuthMessage, MaxReconnectionAttempts, ReconnectionDelay);
+				return;
+			}
+			DetachSharedConnection(false);
+		}
+		else if (PrivateClient->opened())
+		{
+			PrivateClient->sync_close();
+		}
+
+		FSIOSharedConnection::FPtr Connection = FSIOSharedConnection::Acquire(Key, bUseTLS, bUsingTLSCertVerification);
+
+		//move every binding over to the shared client
+		UnbindSocketListeners();
+		bIsSetupForTLS = bUseTLS;
+		PrivateClient = Connection->Client;
+		SharedConnection = Connection;
+		RebindCurrentEventMap();
+
+		Connection->Attach(this);
+		for (const TPair<TPair<FString, FString>, uint32>& Pair : PrimaryListenerIds)
+		{
+			Connection->UseNamespace(this, Pair.Key.Key);
+		}
+		for (const TPair<uint32, FSIOBoundListener>& Pair : EventListenerMap)
+		{
+			Connection->UseNamespace(this, Pair.Value.Namespace);
+		}
+		Connection->Connect(StdAddressString, StdPathString, QueryMap, HeadersMap, AuthMessage, MaxReconnectionAttempts, ReconnectionDelay);
+		return;
+	}
+
 	//Connect to the server on a background thread so it never blocks
 	FCULambdaRunnable::RunLambdaOnBackGroundThread([&, StdAddressString, StdPathString, QueryMap, HeadersMap, AuthMessage]
 	{
@@ -108,12 +187,19 @@ void FSocketIONative::Connect(const FString& InAddressAndPort)
 
 void FSocketIONative::JoinNamespace(const FString& Namespace)
 {
+	UseNamespace(Namespace);
+
 	//just referencing the namespace will join it
 	PrivateClient->socket(USIOMessageConvert::StdString(Namespace));
 }
 
 void FSocketIONative::LeaveNamespace(const FString& Namespace)
 {
+	//other natives on a shared connection may still be in it
+	if (SharedConnection.IsValid() && !SharedConnection->ReleaseNamespace(this, Namespace))
+	{
+		return;
+	}
 	PrivateClient->socket(USIOMessageConvert::StdString(Namespace))->close();
 }
 
@@ -127,6 +213,23 @@ void FSocketIONative::Disconnect()
 	}
 	bIsConnected = false;
 
+	FailPendingRpcs(ESIORpcStatus::Disconnected);
+
+	if (SharedConnection.IsValid())
+	{
+		//only the last native on the connection closes it
+		DetachSharedConnection(false);
+		if (bUnbindEventsOnDisconnect)
+		{
+			ClearAllCallbacks();
+		}
+		else
+		{
+			RebindCurrentEventMap();
+		}
+		return;
+	}
+
 	if (bUnbindEventsOnDisconnect)
 	{
 		ClearAllCallbacks();
@@ -151,6 +254,23 @@ void FSocketIONative::SyncDisconnect()
 	}
 	bIsConnected = false;
 
+	FailPendingRpcs(ESIORpcStatus::Disconnected);
+
+	if (SharedConnection.IsValid())
+	{
+		//only the last native on the connection closes it
+		DetachSharedConnection(true);
+		if (bUnbindEventsOnDisconnect)
+		{
+			ClearAllCallbacks();
+		}
+		else
+		{
+			RebindCurrentEventMap();
+		}
+		return;
+	}
+
 	if (bUnbindEventsOnDisconnect)
 	{
 		ClearAllCallbacks();
@@ -165,11 +285,34 @@ void FSocketIONative::SyncDisconnect()
 	}
 }
 
+bool FSocketIONative::AbortConnection(const TSet<const FSocketIONative*>& Closing /*= TSet<const FSocketIONative*>()*/)
+{
+	FSIOSharedConnection::FPtr Connection = SharedConnection;
+	if (Connection.IsValid())
+	{
+		TSet<const FSocketIONative*> Owners = Closing;
+		Owners.Add(this);
+		if (!Connection->IsOnlyAttachedBy(Owners))
+		{
+			return false;
+		}
+	}
+
+	TSharedPtr<sio::client> Client = PrivateClient;
+	if (Client.IsValid())
+	{
+		Client->stop();
+	}
+	return true;
+}
+
 void FSocketIONative::ClearAllCallbacks()
 {
-	PrivateClient->clear_socket_listeners();
+	UnbindSocketListeners();
+	ClearInternalCallbacks();
 	SetupInternalCallbacks();					//if clear socket listeners cleared our internal callbacks. reset them
 	EventFunctionMap.Empty();
+	EventListenerMap.Empty();
 
 	OnConnectedCallback = nullptr;
 	OnDisconnectedCallback = nullptr;
@@ -179,7 +322,7 @@ void FSocketIONative::ClearAllCallbacks()
 	OnFailCallback = nullptr;
 }
 
-void FSocketIONative::Emit(const FString& EventName, const TSharedPtr<FJsonValue>& Message /*= nullptr*/, TFunction< void(const TArray<TSharedPtr<FJsonValue>>&)> CallbackFunction /*= nullptr*/, const FString& Namespace /*= FString(TEXT("/"))*/)
+void FSocketIONative::Emit(const FString& EventName, const TSharedPtr<FJsonValue>& Message /*= nullptr*/, TFunction< void(const TArray<TSharedPtr<FJsonValue>>&)> CallbackFunction /*= nullptr*/, const FString& Namespace /*= FString(TEXT("/"))*/, ESIOEmitPriority Priority /*= EMIT_REALTIME*/)
 {
 	TFunction<void(const sio::message::list&)> RawCallback = nullptr;
 
@@ -206,7 +349,8 @@ void FSocketIONative::Emit(const FString& EventName, const TSharedPtr<FJsonValue
 		EventName,
 		USIOMessageConvert::ToSIOMessage(Message),
 		RawCallback,
-		Namespace);
+		Namespace,
+		Priority);
 }
 
 void FSocketIONative::Emit(const FString& EventName, const TSharedPtr<FJsonObject>& ObjectMessage /*= nullptr*/, TFunction< void(const TArray<TSharedPtr<FJsonValue>>&)> CallbackFunction /*= nullptr*/, const FString& Namespace /*= FString(TEXT("/"))*/)
@@ -229,9 +373,9 @@ void FSocketIONative::Emit(const FString& EventName, bool BooleanMessage, TFunct
 	Emit(EventName, MakeShareable(new FJsonValueBoolean(BooleanMessage)), CallbackFunction, Namespace);
 }
 
-void FSocketIONative::Emit(const FString& EventName, const TArray<uint8>& BinaryMessage, TFunction< void(const TArray<TSharedPtr<FJsonValue>>&)> CallbackFunction /*= nullptr*/, const FString& Namespace /*= FString(TEXT("/"))*/)
+void FSocketIONative::Emit(const FString& EventName, const TArray<uint8>& BinaryMessage, TFunction< void(const TArray<TSharedPtr<FJsonValue>>&)> CallbackFunction /*= nullptr*/, const FString& Namespace /*= FString(TEXT("/"))*/, ESIOEmitPriority Priority /*= EMIT_REALTIME*/)
 {
-	Emit(EventName, MakeShareable(new FJsonValueBinary(BinaryMessage)), CallbackFunction, Namespace);
+	Emit(EventName, MakeShareable(new FJsonValueBinary(BinaryMessage)), CallbackFunction, Namespace, Priority);
 }
 
 void FSocketIONative::Emit(const FString& EventName, const TArray<TSharedPtr<FJsonValue>>& ArrayMessage, TFunction< void(const TArray<TSharedPtr<FJsonValue>>&)> CallbackFunction /*= nullptr*/, const FString& Namespace /*= FString(TEXT("/"))*/)
@@ -241,6 +385,12 @@ void FSocketIONative::Emit(const FString& EventName, const TArray<TSharedPtr<FJs
 
 void FSocketIONative::Emit(const FString& EventName, UStruct* Struct, const void* StructPtr, TFunction< void(const TArray<TSharedPtr<FJsonValue>>&)> CallbackFunction /*= nullptr*/, const FString& Namespace /*= FString(TEXT("/"))*/)
 {
+	//Encoded straight from struct memory unless the emit needs a message tree for acks or routing
+	if (!CallbackFunction && !HasEmitRouting(EventName, Namespace, EMIT_REALTIME))
+	{
+		EmitPrepared(FSIOPreparedPacket::PrepareStruct(EventName, Struct, StructPtr), Namespace);
+		return;
+	}
 	Emit(EventName, USIOJConvert::ToJsonObject(Struct, (void*)StructPtr), CallbackFunction, Namespace);
 }
 
@@ -255,8 +405,29 @@ void FSocketIONative::Emit(const FString& EventName, const SIO_TEXT_TYPE StringM
 	Emit(EventName, MakeShareable(new FJsonValueString(FString(StringMessage))), CallbackFunction, Namespace);
 }
 
-void FSocketIONative::EmitRaw(const FString& EventName, const sio::message::list& MessageList /*= nullptr*/, TFunction<void(const sio::message::list&)> CallbackFunction /*= nullptr*/, const FString& Namespace /*= FString(TEXT("/"))*/)
+void FSocketIONative::EmitRaw(const FString& EventName, const sio::message::list& MessageList /*= nullptr*/, TFunction<void(const sio::message::list&)> CallbackFunction /*= nullptr*/, const FString& Namespace /*= FString(TEXT("/"))*/, ESIOEmitPriority Priority /*= EMIT_REALTIME*/)
 {
+	//Outbox events are kept until acked, conflated events only keep the latest value until the next flush,
+	//batched ones wait for the next tick
+	if (!CallbackFunction)
+	{
+		if (TryOutboxEmit(EventName, MessageList, Namespace, Priority))
+		{
+			return;
+		}
+		if (TryConflateEmit(EventName, MessageList, Namespace))
+		{
+			return;
+		}
+		if (bBatchEmits && Priority == EMIT_REALTIME)
+		{
+			AddToBatch(EventName, MessageList, Namespace);
+			return;
+		}
+	}
+
+	FlushBatch(Namespace);
+
 	std::function<void(sio::message::list const&)> RawCallback = nullptr;
 
 	//Only have non-null raw callback if we pass in a callback function
@@ -288,320 +459,1034 @@ void FSocketIONative::EmitRaw(const FString& EventName, const sio::message::list
 	PrivateClient->socket(USIOMessageConvert::StdString(Namespace))->emit(
 		USIOMessageConvert::StdString(EventName),
 		MessageList,
-		RawCallback);
+		RawCallback,
+		Priority == EMIT_BULK ? sio::socket::emit_priority_bulk : sio::socket::emit_priority_realtime);
 }
 
-void FSocketIONative::EmitRawBinary(const FString& EventName, uint8* Data, int32 DataLength, const FString& Namespace /*= FString(TEXT("/"))*/)
+void FSocketIONative::EmitRawBinary(const FString& EventName, uint8* Data, int32 DataLength, const FString& Namespace /*= FString(TEXT("/"))*/, ESIOEmitPriority Priority /*= EMIT_REALTIME*/)
 {
-	PrivateClient->socket(USIOMessageConvert::StdString(Namespace))->emit(USIOMessageConvert::StdString(EventName), std::make_shared<std::string>((char*)Data, DataLength));
+	FlushBatch(Namespace);
+	PrivateClient->socket(USIOMessageConvert::StdString(Namespace))->emit(
+		USIOMessageConvert::StdString(EventName),
+		std::make_shared<std::string>((char*)Data, DataLength),
+		nullptr,
+		Priority == EMIT_BULK ? sio::socket::emit_priority_bulk : sio::socket::emit_priority_realtime);
 }
 
-void FSocketIONative::OnEvent(const FString& EventName, 
-	TFunction< void(const FString&, const TSharedPtr<FJsonValue>&)> CallbackFunction, 
-	const FString& Namespace /*= FString(TEXT("/"))*/,
-	ESIOThreadOverrideOption CallbackThread /*= USE_DEFAULT*/)
+FSIOPreparedPacket FSIOPreparedPacket::Prepare(const FString& EventName, const TSharedPtr<FJsonValue>& Message /*= nullptr*/)
 {
-	//Keep track of all the bound native JsonValue functions
-	FSIOBoundEvent BoundEvent;
-	BoundEvent.Function = CallbackFunction;
-	BoundEvent.Namespace = Namespace;
-	BoundEvent.ThreadOption = CallbackThread;
-	EventFunctionMap.Add(EventName, BoundEvent);
+	return PrepareRaw(EventName, USIOMessageConvert::ToSIOMessage(Message));
+}
 
-	OnRawEvent(EventName, [&, CallbackFunction](const FString& Event, const sio::message::ptr& RawMessage) {
-		CallbackFunction(Event, USIOMessageConvert::ToJsonValue(RawMessage));
-	}, Namespace, CallbackThread);
+FSIOPreparedPacket FSIOPreparedPacket::PrepareRaw(const FString& EventName, const sio::message::list& MessageList /*= nullptr*/)
+{
+	FSIOPreparedPacket Prepared;
+	Prepared.Packet = sio::prepared_packet::create(USIOMessageConvert::StdString(EventName), MessageList);
+	return Prepared;
 }
 
-void FSocketIONative::OnRawEvent(const FString& EventName, 
-	TFunction< void(const FString&, const sio::message::ptr&)> CallbackFunction, 
-	const FString& Namespace /*= FString(TEXT("/"))*/,
-	ESIOThreadOverrideOption CallbackThread /*= USE_DEFAULT*/)
+FSIOPreparedPacket FSIOPreparedPacket::PrepareStruct(const FString& EventName, const UStruct* Struct, const void* StructPtr)
 {
-	if (CallbackFunction == nullptr)
+	FSIOPreparedPacket Prepared;
+	Prepared.Packet = FSIOTypedEmit::EncodeStruct(EventName, Struct, StructPtr);
+	return Prepared;
+}
+
+FSIOPreparedPacket FSIOPreparedPacket::PrepareCompactStruct(const FString& EventName, const UStruct* Struct, const void* StructPtr)
+{
+	FSIOPreparedPacket Prepared;
+	Prepared.Packet = FSIOTypedEmit::EncodeCompactStruct(EventName, Struct, StructPtr);
+	return Prepared;
+}
+
+void FSocketIONative::EmitPrepared(const FSIOPreparedPacket& Packet, const FString& Namespace /*= TEXT("/")*/, ESIOEmitPriority Priority /*= EMIT_REALTIME*/)
+{
+	if (!Packet.IsValid())
 	{
-		PrivateClient->socket(USIOMessageConvert::StdString(Namespace))->off(USIOMessageConvert::StdString(EventName));
+		return;
 	}
-	else
-	{
-		//determine thread override option
-		bool bCallbackThisEventOnGameThread = bCallbackOnGameThread;
-		switch (CallbackThread)
-		{
-		case USE_DEFAULT:
-			break;
-		case USE_GAME_THREAD:
-			bCallbackThisEventOnGameThread = true;
-			break;
-		case USE_NETWORK_THREAD:
-			bCallbackThisEventOnGameThread = false;
-			break;
-		default:
-			break;
-		}
-
-		const TFunction< void(const FString&, const sio::message::ptr&)> SafeFunction = CallbackFunction;	//copy the function so it remains in context
+	FlushBatch(Namespace);
+	PrivateClient->socket(USIOMessageConvert::StdString(Namespace))->emit_prepared(
+		Packet.Packet,
+		Priority == EMIT_BULK ? sio::socket::emit_priority_bulk : sio::socket::emit_priority_realtime);
+}
 
-		PrivateClient->socket(USIOMessageConvert::StdString(Namespace))->on(
-			USIOMessageConvert::StdString(EventName),
-			sio::socket::event_listener_aux(
-			[&, SafeFunction, bCallbackThisEventOnGameThread](std::string const& name, sio::message::ptr const& data, bool isAck, sio::message::list &ack_resp)
-			{
-				if (SafeFunction != nullptr)
-				{
-					const FString SafeName = USIOMessageConvert::FStringFromStd(name);
+void FSocketIONative::EmitCompact(const FString& EventName, const UStruct* Struct, const void* StructPtr, const FString& Namespace /*= TEXT("/")*/, ESIOEmitPriority Priority /*= EMIT_REALTIME*/)
+{
+	EmitPrepared(FSIOPreparedPacket::PrepareCompactStruct(EventName, Struct, StructPtr), Namespace, Priority);
+}
 
-					if (bCallbackThisEventOnGameThread)
-					{
-						FCULambdaRunnable::RunShortLambdaOnGameThread([&, SafeFunction, SafeName, data]
-							{
-								SafeFunction(SafeName, data);
-							});
-					}
-					else
-					{
-						SafeFunction(SafeName, data);
-					}
-				}
-			}));
+FSocketIONative::FSIODeltaSenderPtr FSocketIONative::FindOrAddDeltaStream(const FString& EventName, const FString& Namespace, const UScriptStruct* Struct)
+{
+	FScopeLock Lock(&DeltaSection);
+	FSIODeltaSenderPtr& Stream = DeltaStreams.FindOrAdd(TPair<FString, FString>(Namespace, EventName));
+	if (Struct && (!Stream.IsValid() || Stream->GetStruct() != Struct))
+	{
+		Stream = MakeShared<FSIODeltaSender, ESPMode::ThreadSafe>(Struct);
 	}
+	return Stream;
 }
 
-void FSocketIONative::OnRawBinaryEvent(const FString& EventName, TFunction< void(const FString&, const TArray<uint8>&)> CallbackFunction, const FString& Namespace /*= FString(TEXT("/"))*/)
+void FSocketIONative::EmitDelta(const FString& EventName, const UScriptStruct* Struct, const void* StructPtr, const FString& Namespace /*= TEXT("/")*/, ESIOEmitPriority Priority /*= EMIT_REALTIME*/)
 {
-	const TFunction< void(const FString&, const TArray<uint8>&)> SafeFunction = CallbackFunction;	//copy the function so it remains in context
+	if (!Struct || !StructPtr)
+	{
+		UE_LOG(SocketIO, Warning, TEXT("EmitDelta: %s has no struct to send"), *EventName);
+		return;
+	}
 
-	PrivateClient->socket(USIOMessageConvert::StdString(Namespace))->on(
-		USIOMessageConvert::StdString(EventName),
-		sio::socket::event_listener_aux(
-			[&, SafeFunction](std::string const& name, sio::message::ptr const& data, bool isAck, sio::message::list &ack_resp)
+	FSIODeltaSenderPtr Stream = FindOrAddDeltaStream(EventName, Namespace, Struct);
+
+	int64 Seq = 0;
+	sio::prepared_packet::ptr Packet = Stream->Encode(EventName, StructPtr, Seq);
+	if (!Packet)
 	{
-		const FString SafeName = USIOMessageConvert::FStringFromStd(name);
+		return;
+	}
 
-		//Construct raw buffer
-		if (data->get_flag() == sio::message::flag_binary)
+	//Acks come straight from the network thread, the stream locks itself
+	TWeakPtr<FSIODeltaSender, ESPMode::ThreadSafe> WeakStream = Stream;
+	FlushBatch(Namespace);
+	PrivateClient->socket(USIOMessageConvert::StdString(Namespace))->emit_prepared(
+		Packet,
+		[WeakStream, Seq](const sio::message::list& Response)
 		{
-			TArray<uint8> Buffer;
-			int32 BufferSize = data->get_binary()->size();
-			auto MessageBuffer = data->get_binary();
-			Buffer.Append((uint8*)(MessageBuffer->data()), BufferSize);
-
-			if (bCallbackOnGameThread)
+			//receivers ack false when they couldn't apply it
+			if (Response.size() > 0 && Response[0] && Response[0]->get_flag() == sio::message::flag_boolean && !Response[0]->get_bool())
 			{
-				FCULambdaRunnable::RunShortLambdaOnGameThread([&, SafeFunction, SafeName, Buffer]
-				{
-					SafeFunction(SafeName, Buffer);
-				});
+				return;
 			}
-			else
+			if (FSIODeltaSenderPtr PinnedStream = WeakStream.Pin())
 			{
-				SafeFunction(SafeName, Buffer);
+				PinnedStream->Acknowledge(Seq);
 			}
-		}
-		else
-		{
-			UE_LOG(SocketIO, Warning, TEXT("Non-binary message received to binary message lambda, check server message data!"));
-		}
-	}));
+		},
+		Priority == EMIT_BULK ? sio::socket::emit_priority_bulk : sio::socket::emit_priority_realtime);
 }
 
-void FSocketIONative::UnbindEvent(const FString& EventName, const FString& Namespace /*= TEXT("/")*/)
+void FSocketIONative::AcknowledgeDelta(const FString& EventName, int64 Seq, const FString& Namespace /*= TEXT("/")*/)
 {
-	OnRawEvent(EventName, nullptr, Namespace);
-	EventFunctionMap.Remove(EventName);
+	FSIODeltaSenderPtr Stream;
+	{
+		FScopeLock Lock(&DeltaSection);
+		Stream = DeltaStreams.FindRef(TPair<FString, FString>(Namespace, EventName));
+	}
+	if (Stream.IsValid())
+	{
+		Stream->Acknowledge(Seq);
+	}
 }
 
-void FSocketIONative::ClearInternalCallbacks()
+void FSocketIONative::ResetDelta(const FString& EventName, const FString& Namespace /*= TEXT("/")*/)
 {
-	PrivateClient->clear_socket_listeners();
+	FSIODeltaSenderPtr Stream;
+	{
+		FScopeLock Lock(&DeltaSection);
+		Stream = DeltaStreams.FindRef(TPair<FString, FString>(Namespace, EventName));
+	}
+	if (Stream.IsValid())
+	{
+		Stream->Reset();
+	}
 }
 
-void FSocketIONative::SetupInternalCallbacks()
+void FSocketIONative::BroadcastPrepared(const TArray<TSharedPtr<FSocketIONative>>& Clients, const FSIOPreparedPacket& Packet, const FString& Namespace /*= TEXT("/")*/, ESIOEmitPriority Priority /*= EMIT_REALTIME*/)
 {
-	PrivateClient->set_open_listener(sio::client::con_listener([&]() 
+	for (const TSharedPtr<FSocketIONative>& Client : Clients)
 	{
-		//too early to get session id here so we defer the connection event until we connect to a namespace
-	}));
+		if (Client.IsValid())
+		{
+			Client->EmitPrepared(Packet, Namespace, Priority);
+		}
+	}
+}
 
-	PrivateClient->set_close_listener(sio::client::close_listener([&](sio::client::close_reason const& reason)
+TFuture<FSIORpcResult> FSocketIONative::EmitRpc(const FString& EventName,
+	const TSharedPtr<FJsonValue>& Message /*= nullptr*/,
+	float TimeoutSeconds /*= 0.f*/,
+	const FString& Namespace /*= TEXT("/")*/,
+	FSIORpcCancellationPtr Cancellation /*= nullptr*/,
+	ESIOEmitPriority Priority /*= EMIT_REALTIME*/)
+{
+	FSIORpcRequestPtr Request = MakeShared<FSIORpcRequest, ESPMode::ThreadSafe>();
+	Request->Namespace = Namespace;
+	TFuture<FSIORpcResult> Future = Request->Promise.GetFuture();
+
+	if (Cancellation.IsValid() && Cancellation->IsCancelled())
 	{
-		bIsConnected = false;
+		FSIORpcResult Result;
+		Result.Status = ESIORpcStatus::Cancelled;
+		Request->bCompleted = true;
+		Request->Promise.SetValue(MoveTemp(Result));
+		return Future;
+	}
 
-		ESIOConnectionCloseReason DisconnectReason = (ESIOConnectionCloseReason)reason;
-		FString DisconnectReasonString = UEnum::GetValueAsString<ESIOConnectionCloseReason>(DisconnectReason);
-		if (VerboseLog)
+	{
+		FScopeLock Lock(&RpcSection);
+		Request->RpcId = ++NextRpcId;
+		if (TimeoutSeconds > 0.f)
 		{
-			UE_LOG(SocketIO, Log, TEXT("SocketIO Disconnected %s reason: %s"), *SessionId, *DisconnectReasonString);
+			Request->Deadline = FPlatformTime::Seconds() + TimeoutSeconds;
+			EnsureRpcTicker();
 		}
-		LastSessionId = SessionId;
-		SessionId = TEXT("Invalid");
+		PendingRpcs.Add(Request->RpcId, Request);
+	}
 
-		if (OnDisconnectedCallback)
-		{
-			if (bCallbackOnGameThread)
-			{
-				FCULambdaRunnable::RunShortLambdaOnGameThread([&, DisconnectReason]
-				{
-					if (OnDisconnectedCallback)
-					{
-						OnDisconnectedCallback(DisconnectReason);
-					}
-				});
-			}
-			else
-			{
-				OnDisconnectedCallback(DisconnectReason);
-			}
-		}
-	}));
+	TWeakPtr<FSIORpcRequest, ESPMode::ThreadSafe> WeakRequest = Request;
 
-	PrivateClient->set_socket_open_listener(sio::client::socket_listener([&](std::string const& nsp)
+	//Resolve straight from the network thread, continuations pick their own thread
+	std::function<void(sio::message::list const&)> AckCallback = [this, WeakRequest](sio::message::list const& Response)
 	{
-		//Special case, we have a latent connection after already having been disconnected
-		if (!PrivateClient.IsValid())
+		FSIORpcRequestPtr PinnedRequest = WeakRequest.Pin();
+		if (!PinnedRequest.IsValid() || PinnedRequest->bCompleted)
 		{
 			return;
 		}
-		if (!bIsConnected)
-		{
-			bIsConnected = true;
-			SessionId = USIOMessageConvert::FStringFromStd(PrivateClient->get_sessionid());
-			SocketId = USIOMessageConvert::FStringFromStd(PrivateClient->socket(nsp)->get_socket_id());
 
-			if (VerboseLog)
-			{
-				UE_LOG(SocketIO, Log, TEXT("SocketIO Connected with session: %s"), *SessionId);
-			}
-			if (OnConnectedCallback)
-			{
-				if (bCallbackOnGameThread)
-				{
-					FCULambdaRunnable::RunShortLambdaOnGameThread([&]
-					{
-						if (OnConnectedCallback)
-						{
-							OnConnectedCallback(SocketId, SessionId);
-						}
-					});
-				}
-				else
-				{
-					OnConnectedCallback(SocketId, SessionId);
-				}
-			}
+		FSIORpcResult Result;
+		for (uint32 i = 0; i < Response.size(); i++)
+		{
+			Result.Response.Add(USIOMessageConvert::ToJsonValue(Response[i]));
 		}
+		CompleteRpc(PinnedRequest, MoveTemp(Result));
+	};
 
-		const FString Namespace = USIOMessageConvert::FStringFromStd(nsp);
+	//Acked emits bypass conflation and batching, each call gets its own packet
+	FlushBatch(Namespace);
+	const uint32 AckId = PrivateClient->socket(USIOMessageConvert::StdString(Namespace))->emit(
+		USIOMessageConvert::StdString(EventName),
+		USIOMessageConvert::ToSIOMessage(Message),
+		AckCallback,
+		Priority == EMIT_BULK ? sio::socket::emit_priority_bulk : sio::socket::emit_priority_realtime);
+	Request->AckId = AckId;
 
-		if (VerboseLog)
-		{
-			UE_LOG(SocketIO, Log, TEXT("SocketIO %s connected to namespace: %s"), *SessionId, *Namespace);
-		}
-		if (OnNamespaceConnectedCallback)
-		{
-			if (bCallbackOnGameThread)
-			{
-				FCULambdaRunnable::RunShortLambdaOnGameThread([&, Namespace]
-				{
-					if (OnNamespaceConnectedCallback)
-					{
-						OnNamespaceConnectedCallback(Namespace);
-					}
-				});
-			}
-			else
-			{
-				OnNamespaceConnectedCallback(Namespace);
-			}
-		}
-	}));
+	//Timed out or cancelled while emit was running, CompleteRpc saw no ack id to free. After an ack
+	//this is a no-op, the socket already dropped the slot.
+	if (Request->bCompleted)
+	{
+		PrivateClient->socket(USIOMessageConvert::StdString(Namespace))->cancel_ack(AckId);
+	}
 
-	PrivateClient->set_socket_close_listener(sio::client::socket_listener([&](std::string const& nsp)
+	if (Cancellation.IsValid())
 	{
-		const FString Namespace = USIOMessageConvert::FStringFromStd(nsp);
-		FString NamespaceSession = SessionId;
-		if (NamespaceSession.Equals(TEXT("Invalid")))
-		{
-			NamespaceSession = LastSessionId;
-		}
-		if (VerboseLog)
+		Cancellation->OnCancelled([this, WeakRequest]
 		{
-			UE_LOG(SocketIO, Log, TEXT("SocketIO %s disconnected from namespace: %s"), *NamespaceSession, *Namespace);
-		}
-		if (OnNamespaceDisconnectedCallback)
-		{
-			if (bCallbackOnGameThread)
-			{
-				FCULambdaRunnable::RunShortLambdaOnGameThread([&, Namespace]
-				{
-					if (OnNamespaceDisconnectedCallback)
-					{
-						OnNamespaceDisconnectedCallback(Namespace);
-					}
-				});
-			}
-			else
+			FSIORpcRequestPtr PinnedRequest = WeakRequest.Pin();
+			if (PinnedRequest.IsValid() && !PinnedRequest->bCompleted)
 			{
-				OnNamespaceDisconnectedCallback(Namespace);
+				FSIORpcResult Result;
+				Result.Status = ESIORpcStatus::Cancelled;
+				CompleteRpc(PinnedRequest, MoveTemp(Result));
 			}
-		}
-	}));
+		});
+	}
+
+	return Future;
+}
+
+UE::Tasks::TTask<FSIORpcResult> FSocketIONative::EmitRpcTask(const FString& EventName,
+	const TSharedPtr<FJsonValue>& Message /*= nullptr*/,
+	float TimeoutSeconds /*= 0.f*/,
+	const FString& Namespace /*= TEXT("/")*/,
+	FSIORpcCancellationPtr Cancellation /*= nullptr*/,
+	ESIOEmitPriority Priority /*= EMIT_REALTIME*/)
+{
+	UE::Tasks::FTaskEvent ResponseEvent(UE_SOURCE_LOCATION);
+	TSharedRef<FSIORpcResult, ESPMode::ThreadSafe> ResultHolder = MakeShared<FSIORpcResult, ESPMode::ThreadSafe>();
+
+	EmitRpc(EventName, Message, TimeoutSeconds, Namespace, Cancellation, Priority).Then(
+		[ResponseEvent, ResultHolder](TFuture<FSIORpcResult> Completed) mutable
+	{
+		*ResultHolder = Completed.Consume();
+		ResponseEvent.Trigger();
+	});
+
+	return UE::Tasks::Launch(UE_SOURCE_LOCATION, [ResultHolder]
+	{
+		return MoveTemp(*ResultHolder);
+	}, UE::Tasks::Prerequisites(ResponseEvent));
+}
+
+#if SIO_WITH_COROUTINES
+TSIOFutureAwaitable<FSIORpcResult> FSocketIONative::AwaitRpc(const FString& EventName,
+	const TSharedPtr<FJsonValue>& Message /*= nullptr*/,
+	float TimeoutSeconds /*= 0.f*/,
+	const FString& Namespace /*= TEXT("/")*/,
+	FSIORpcCancellationPtr Cancellation /*= nullptr*/,
+	ESIOEmitPriority Priority /*= EMIT_REALTIME*/)
+{
+	return TSIOFutureAwaitable<FSIORpcResult>(
+		EmitRpc(EventName, Message, TimeoutSeconds, Namespace, Cancellation, Priority),
+		bCallbackOnGameThread);
+}
+#endif
+
+int32 FSocketIONative::PendingRpcCount()
+{
+	FScopeLock Lock(&RpcSection);
+	return PendingRpcs.Num();
+}
+
+void FSocketIONative::CompleteRpc(const FSIORpcRequestPtr& Request, FSIORpcResult&& Result)
+{
+	bool bExpected = false;
+	if (!Request->bCompleted.compare_exchange_strong(bExpected, true))
+	{
+		return;
+	}
+
+	{
+		FScopeLock Lock(&RpcSection);
+		PendingRpcs.Remove(Request->RpcId);
+	}
+
+	//Timed out or cancelled, free the ack slot so a late ack is dropped by the socket
+	const bool bDropAck = Result.Status == ESIORpcStatus::TimedOut || Result.Status == ESIORpcStatus::Cancelled;
+	const uint32 AckId = Request->AckId;
+	if (bDropAck && AckId != 0 && PrivateClient.IsValid())
+	{
+		PrivateClient->socket(USIOMessageConvert::StdString(Request->Namespace))->cancel_ack(AckId);
+	}
+
+	Request->Promise.SetValue(MoveTemp(Result));
+}
+
+void FSocketIONative::FailPendingRpcs(ESIORpcStatus Status)
+{
+	TArray<FSIORpcRequestPtr> Requests;
+	{
+		FScopeLock Lock(&RpcSection);
+		PendingRpcs.GenerateValueArray(Requests);
+	}
+
+	for (const FSIORpcRequestPtr& Request : Requests)
+	{
+		FSIORpcResult Result;
+		Result.Status = Status;
+		CompleteRpc(Request, MoveTemp(Result));
+	}
+}
+
+void FSocketIONative::EnsureRpcTicker()
+{
+	if (!RpcTickerHandle.IsValid())
+	{
+		RpcTickerHandle = FTSTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateRaw(this, &FSocketIONative::OnRpcTick));
+	}
+}
+
+bool FSocketIONative::OnRpcTick(float DeltaTime)
+{
+	const double Now = FPlatformTime::Seconds();
+	TArray<FSIORpcRequestPtr> Expired;
+	bool bHasDeadlines = false;
+	{
+		FScopeLock Lock(&RpcSection);
+		for (auto& RpcPair : PendingRpcs)
+		{
+			const double Deadline = RpcPair.Value->Deadline;
+			if (Deadline <= 0.0)
+			{
+				continue;
+			}
+			if (Deadline <= Now)
+			{
+				Expired.Add(RpcPair.Value);
+			}
+			else
+			{
+				bHasDeadlines = true;
+			}
+		}
+
+		//the ticker is re-added by the next call with a deadline
+		if (!bHasDeadlines)
+		{
+			RpcTickerHandle.Reset();
+		}
+	}
+
+	for (const FSIORpcRequestPtr& Request : Expired)
+	{
+		FSIORpcResult Result;
+		Result.Status = ESIORpcStatus::TimedOut;
+		CompleteRpc(Request, MoveTemp(Result));
+	}
+	return bHasDeadlines;
+}
+
+void FSocketIONative::OnEvent(const FString& EventName, 
+	TFunction< void(const FString&, const TSharedPtr<FJsonValue>&)> CallbackFunction, 
+	const FString& Namespace /*= FString(TEXT("/"))*/,
+	ESIOThreadOverrideOption CallbackThread /*= USE_DEFAULT*/,
+	const FString& OrderingKeyField /*= TEXT("")*/)
+{
+	//Keep track of all the bound native JsonValue functions
+	FSIOBoundEvent BoundEvent;
+	BoundEvent.Function = CallbackFunction;
+	BoundEvent.Namespace = Namespace;
+	BoundEvent.ThreadOption = CallbackThread;
+	BoundEvent.OrderingKeyField = OrderingKeyField;
+	EventFunctionMap.Add(EventName, BoundEvent);
+
+	OnRawEvent(EventName, [&, CallbackFunction](const FString& Event, const sio::message::ptr& RawMessage) {
+		CallbackFunction(Event, SharedJsonValue(RawMessage));
+	}, Namespace, CallbackThread, OrderingKeyField);
+}
+
+void FSocketIONative::OnRawEvent(const FString& EventName, 
+	TFunction< void(const FString&, const sio::message::ptr&)> CallbackFunction, 
+	const FString& Namespace /*= FString(TEXT("/"))*/,
+	ESIOThreadOverrideOption CallbackThread /*= USE_DEFAULT*/,
+	const FString& OrderingKeyField /*= TEXT("")*/)
+{
+	if (CallbackFunction == nullptr)
+	{
+		BindPrimaryListener(EventName, Namespace, nullptr);
+	}
+	else
+	{
+		BindPrimaryListener(EventName, Namespace, MakeRawListener(CallbackFunction, CallbackThread, OrderingKeyField, Namespace));
+	}
+}
+
+void FSocketIONative::BindPrimaryListener(const FString& EventName, const FString& Namespace, const sio::socket::event_listener_aux& Listener)
+{
+	//Bound as an added listener so natives sharing a connection never replace each other's binding
+	const sio::socket::ptr& Socket = PrivateClient->socket(USIOMessageConvert::StdString(Namespace));
+	const std::string StdEventName = USIOMessageConvert::StdString(EventName);
+	const TPair<FString, FString> BindingKey(Namespace, EventName);
+
+	uint32 PreviousId = 0;
+	if (PrimaryListenerIds.RemoveAndCopyValue(BindingKey, PreviousId))
+	{
+		Socket->remove_listener(StdEventName, PreviousId);
+	}
+	if (Listener)
+	{
+		UseNamespace(Namespace);
+		PrimaryListenerIds.Add(BindingKey, Socket->add_listener(StdEventName, Listener));
+	}
+}
+
+void FSocketIONative::UnbindSocketListeners()
+{
+	for (const TPair<TPair<FString, FString>, uint32>& Pair : PrimaryListenerIds)
+	{
+		PrivateClient->socket(USIOMessageConvert::StdString(Pair.Key.Key))->remove_listener(
+			USIOMessageConvert::StdString(Pair.Key.Value), Pair.Value);
+	}
+	PrimaryListenerIds.Empty();
+
+	for (TPair<uint32, FSIOBoundListener>& Pair : EventListenerMap)
+	{
+		if (Pair.Value.SocketListenerId != 0)
+		{
+			PrivateClient->socket(USIOMessageConvert::StdString(Pair.Value.Namespace))->remove_listener(
+				USIOMessageConvert::StdString(Pair.Value.EventName), Pair.Value.SocketListenerId);
+			Pair.Value.SocketListenerId = 0;
+		}
+	}
+}
+
+void FSocketIONative::UseNamespace(const FString& Namespace)
+{
+	if (SharedConnection.IsValid())
+	{
+		SharedConnection->UseNamespace(this, Namespace);
+	}
+}
+
+void FSocketIONative::DetachSharedConnection(bool bSyncClose, bool bReinitialize /*= true*/)
+{
+	UnbindSocketListeners();
+
+	FSIOSharedConnection::FPtr Connection = SharedConnection;
+	SharedConnection.Reset();
+	Connection->Detach(this, bSyncClose);
+
+	if (!bReinitialize)
+	{
+		//being destroyed, nothing rebinds onto a new client
+		PrivateClient.Reset();
+		return;
+	}
+
+	//the connection stays open for the other natives, so its close listener never tells us
+	if (bIsConnected)
+	{
+		bIsConnected = false;
+		if (OnDisconnectedCallback)
+		{
+			OnDisconnectedCallback(ESIOConnectionCloseReason::CLOSE_REASON_NORMAL);
+		}
+	}
+
+	//back to an unconnected client of our own, callers rebind onto it
+	InitPrivateClient(bIsSetupForTLS, bUsingTLSCertVerification);
+	SetupInternalCallbacks();
+}
+
+uint32 FSocketIONative::AddEventListener(const FString& EventName,
+	TFunction< void(const FString&, const TSharedPtr<FJsonValue>&)> CallbackFunction,
+	const FString& Namespace /*= TEXT("/")*/,
+	ESIOThreadOverrideOption CallbackThread /*= USE_DEFAULT*/,
+	const FString& OrderingKeyField /*= TEXT("")*/)
+{
+	const uint32 ListenerId = ++NextListenerId;
+
+	FSIOBoundListener& Listener = EventListenerMap.Add(ListenerId);
+	Listener.EventName = EventName;
+	Listener.Function = CallbackFunction;
+	Listener.Namespace = Namespace;
+	Listener.ThreadOption = CallbackThread;
+	Listener.OrderingKeyField = OrderingKeyField;
+	BindListener(Listener);
+
+	return ListenerId;
+}
+
+uint32 FSocketIONative::AddRawEventListener(const FString& EventName,
+	TFunction< void(const FString&, const sio::message::ptr&)> CallbackFunction,
+	const FString& Namespace /*= TEXT("/")*/,
+	ESIOThreadOverrideOption CallbackThread /*= USE_DEFAULT*/,
+	const FString& OrderingKeyField /*= TEXT("")*/)
+{
+	const uint32 ListenerId = ++NextListenerId;
+
+	FSIOBoundListener& Listener = EventListenerMap.Add(ListenerId);
+	Listener.EventName = EventName;
+	Listener.RawFunction = CallbackFunction;
+	Listener.Namespace = Namespace;
+	Listener.ThreadOption = CallbackThread;
+	Listener.OrderingKeyField = OrderingKeyField;
+	BindListener(Listener);
+
+	return ListenerId;
+}
+
+void FSocketIONative::RemoveEventListener(uint32 ListenerId)
+{
+	FSIOBoundListener Listener;
+	if (EventListenerMap.RemoveAndCopyValue(ListenerId, Listener))
+	{
+		PrivateClient->socket(USIOMessageConvert::StdString(Listener.Namespace))->remove_listener(
+			USIOMessageConvert::StdString(Listener.EventName), Listener.SocketListenerId);
+	}
+}
+
+uint32 FSocketIONative::BindDocumentStore(const FString& EventName,
+	const TSharedPtr<FSIODocumentStore>& Store,
+	const FString& Namespace /*= TEXT("/")*/,
+	ESIOThreadOverrideOption CallbackThread /*= USE_DEFAULT*/)
+{
+	//only the snapshot or patch in each message is converted, never the whole document again
+	TWeakPtr<FSIODocumentStore> WeakStore = Store;
+	return AddEventListener(EventName, [WeakStore](const FString& Event, const TSharedPtr<FJsonValue>& Message)
+	{
+		if (TSharedPtr<FSIODocumentStore> PinnedStore = WeakStore.Pin())
+		{
+			PinnedStore->ApplyMessage(Event, Message);
+		}
+	}, Namespace, CallbackThread);
+}
+
+void FSocketIONative::BindListener(FSIOBoundListener& Listener)
+{
+	TFunction< void(const FString&, const sio::message::ptr&)> RawFunction = Listener.RawFunction;
+	if (!RawFunction)
+	{
+		const TFunction< void(const FString&, const TSharedPtr<FJsonValue>&)> JsonFunction = Listener.Function;
+		RawFunction = [this, JsonFunction](const FString& Event, const sio::message::ptr& RawMessage)
+		{
+			JsonFunction(Event, SharedJsonValue(RawMessage));
+		};
+	}
+
+	UseNamespace(Listener.Namespace);
+	Listener.SocketListenerId = PrivateClient->socket(USIOMessageConvert::StdString(Listener.Namespace))->add_listener(
+		USIOMessageConvert::StdString(Listener.EventName),
+		MakeRawListener(RawFunction, Listener.ThreadOption, Listener.OrderingKeyField, Listener.Namespace));
+}
+
+sio::socket::event_listener_aux FSocketIONative::MakeRawListener(
+	TFunction< void(const FString&, const sio::message::ptr&)> CallbackFunction,
+	ESIOThreadOverrideOption CallbackThread,
+	const FString& OrderingKeyField,
+	const FString& Namespace)
+{
+	//determine thread override option
+	bool bCallbackThisEventOnGameThread = bCallbackOnGameThread;
+	switch (CallbackThread)
+	{
+	case USE_DEFAULT:
+		break;
+	case USE_GAME_THREAD:
+		bCallbackThisEventOnGameThread = true;
+		break;
+	case USE_NETWORK_THREAD:
+	case USE_WORKER_POOL:
+		bCallbackThisEventOnGameThread = false;
+		break;
+	default:
+		break;
+	}
+
+	const TFunction< void(const FString&, const sio::message::ptr&)> SafeFunction = CallbackFunction;	//copy the function so it remains in context
+	const FString FilterNamespace = FSIOSharedConnection::NormalizeNamespace(Namespace);
+
+	if (CallbackThread == USE_WORKER_POOL)
+	{
+		//One serial queue per event, or a fixed set picked by ordering key hash so equal keys stay in order
+		const int32 QueueCount = OrderingKeyField.IsEmpty() ? 1 : FMath::Max(1, FTaskGraphInterface::Get().GetNumWorkerThreads());
+		TArray<TSharedPtr<FCUSerialTaskQueue, ESPMode::ThreadSafe>> Queues;
+		for (int32 i = 0; i < QueueCount; i++)
+		{
+			Queues.Add(MakeShared<FCUSerialTaskQueue, ESPMode::ThreadSafe>());
+		}
+		const std::string StdOrderingKey = USIOMessageConvert::StdString(OrderingKeyField);
+
+		return sio::socket::event_listener_aux(
+			[&, SafeFunction, Queues, StdOrderingKey, FilterNamespace](std::string const& name, sio::message::ptr const& data, bool isAck, sio::message::list &ack_resp)
+			{
+				const FString SafeName = USIOMessageConvert::FStringFromStd(name);
+				sio::message::ptr Message = data;
+				if (!PassesRelevanceFilter(FilterNamespace, SafeName, Message))
+				{
+					return;
+				}
+
+				int32 QueueIndex = 0;
+				if (Queues.Num() > 1)
+				{
+					QueueIndex = GetTypeHash(KeyFieldValue(Message, StdOrderingKey)) % Queues.Num();
+				}
+				Queues[QueueIndex]->Enqueue([SafeFunction, SafeName, Message]
+				{
+					SafeFunction(SafeName, Message);
+				});
+			});
+	}
+
+	return sio::socket::event_listener_aux(
+		[&, SafeFunction, bCallbackThisEventOnGameThread, FilterNamespace](std::string const& name, sio::message::ptr const& data, bool isAck, sio::message::list &ack_resp)
+		{
+			if (SafeFunction != nullptr)
+			{
+				const FString SafeName = USIOMessageConvert::FStringFromStd(name);
+
+				//dropped here, before any conversion or game thread handoff
+				sio::message::ptr Message = data;
+				if (!PassesRelevanceFilter(FilterNamespace, SafeName, Message))
+				{
+					return;
+				}
+
+				if (bCallbackThisEventOnGameThread)
+				{
+					FCULambdaRunnable::RunShortLambdaOnGameThread([&, SafeFunction, SafeName, Message]
+						{
+							SafeFunction(SafeName, Message);
+						});
+				}
+				else
+				{
+					SafeFunction(SafeName, Message);
+				}
+			}
+		});
+}
+
+void FSocketIONative::SetRelevanceFilter(const FString& EventName, const FSIORelevanceFilterPtr& Filter, const FString& Namespace /*= TEXT("/")*/)
+{
+	FScopeLock Lock(&RelevanceSection);
+	const TPair<FString, FString> FilterKey(FSIOSharedConnection::NormalizeNamespace(Namespace), EventName);
+	if (Filter.IsValid())
+	{
+		RelevanceFilters.Add(FilterKey, Filter);
+	}
+	else
+	{
+		RelevanceFilters.Remove(FilterKey);
+	}
+	NumRelevanceFilters = RelevanceFilters.Num();
+}
+
+bool FSocketIONative::PassesRelevanceFilter(const FString& Namespace, const FString& EventName, sio::message::ptr& InOutMessage)
+{
+	if (NumRelevanceFilters.load() == 0)
+	{
+		return true;
+	}
+
+	const sio::message::ptr Incoming = InOutMessage;
+	FSIORelevanceFilterPtr Filter;
+	{
+		FScopeLock Lock(&RelevanceSection);
+		Filter = RelevanceFilters.FindRef(TPair<FString, FString>(Namespace, EventName));
+		if (!Filter.IsValid())
+		{
+			return true;
+		}
+
+		//later listeners of the same message reuse the first result
+		if (LastFiltered.Incoming.expired())
+		{
+			LastFiltered.Filtered.reset();
+		}
+		else if (Incoming && LastFiltered.Incoming.lock() == Incoming && LastFiltered.EventName == EventName && LastFiltered.Namespace == Namespace)
+		{
+			InOutMessage = LastFiltered.Filtered;
+			return LastFiltered.bPassed;
+		}
+	}
+
+	const bool bPassed = Filter->Filter(InOutMessage);
+	if (Incoming)
+	{
+		FScopeLock Lock(&RelevanceSection);
+		LastFiltered.Incoming = Incoming;
+		LastFiltered.Namespace = Namespace;
+		LastFiltered.EventName = EventName;
+		LastFiltered.Filtered = bPassed ? InOutMessage : nullptr;
+		LastFiltered.bPassed = bPassed;
+	}
+	return bPassed;
+}
+
+TSharedPtr<FJsonValue> FSocketIONative::SharedJsonValue(const sio::message::ptr& Message)
+{
+	if (!Message)
+	{
+		return USIOMessageConvert::ToJsonValue(Message);
+	}
+
+	{
+		FScopeLock Lock(&DecodeCacheSection);
+		for (FSIODecodedMessage& Decoded : DecodeCache)
+		{
+			if (!Decoded.Value.IsValid())
+			{
+				continue;
+			}
+			//drop values of messages that are gone so large trees don't wait for their slot to be reused,
+			//an expired entry never matches so a reused address can't return a stale value
+			if (Decoded.Message.expired())
+			{
+				Decoded.Value.Reset();
+				continue;
+			}
+			if (Decoded.Message.lock() == Message)
+			{
+				return Decoded.Value;
+			}
+		}
+	}
+
+	//Convert outside the lock, a racing listener may convert the same message once more
+	TSharedPtr<FJsonValue> Value = USIOMessageConvert::ToJsonValue(Message);
+
+	FScopeLock Lock(&DecodeCacheSection);
+	FSIODecodedMessage& Slot = DecodeCache[DecodeCacheNext];
+	Slot.Message = Message;
+	Slot.Value = Value;
+	DecodeCacheNext = (DecodeCacheNext + 1) % DecodeCacheSize;
+	return Value;
+}
+
+void FSocketIONative::OnRawBinaryEvent(const FString& EventName, TFunction< void(const FString&, const TArray<uint8>&)> CallbackFunction, const FString& Namespace /*= FString(TEXT("/"))*/)
+{
+	const TFunction< void(const FString&, const TArray<uint8>&)> SafeFunction = CallbackFunction;	//copy the function so it remains in context
+
+	BindPrimaryListener(EventName, Namespace,
+		sio::socket::event_listener_aux(
+			[&, SafeFunction](std::string const& name, sio::message::ptr const& data, bool isAck, sio::message::list &ack_resp)
+	{
+		const FString SafeName = USIOMessageConvert::FStringFromStd(name);
+
+		//Construct raw buffer
+		if (data->get_flag() == sio::message::flag_binary)
+		{
+			TArray<uint8> Buffer;
+			int32 BufferSize = data->get_binary()->size();
+			auto MessageBuffer = data->get_binary();
+			Buffer.Append((uint8*)(MessageBuffer->data()), BufferSize);
+
+			if (bCallbackOnGameThread)
+			{
+				FCULambdaRunnable::RunShortLambdaOnGameThread([&, SafeFunction, SafeName, Buffer]
+				{
+					SafeFunction(SafeName, Buffer);
+				});
+			}
+			else
+			{
+				SafeFunction(SafeName, Buffer);
+			}
+		}
+		else
+		{
+			UE_LOG(SocketIO, Warning, TEXT("Non-binary message received to binary message lambda, check server message data!"));
+		}
+	}));
+}
+
+void FSocketIONative::UnbindEvent(const FString& EventName, const FString& Namespace /*= TEXT("/")*/)
+{
+	OnRawEvent(EventName, nullptr, Namespace);
+	EventFunctionMap.Remove(EventName);
+
+	for (auto It = EventListenerMap.CreateIterator(); It; ++It)
+	{
+		if (It.Value().EventName == EventName && It.Value().Namespace == Namespace)
+		{
+			PrivateClient->socket(USIOMessageConvert::StdString(Namespace))->remove_listener(
+				USIOMessageConvert::StdString(EventName), It.Value().SocketListenerId);
+			It.RemoveCurrent();
+		}
+	}
+}
+
+void FSocketIONative::ClearInternalCallbacks()
+{
+	//the shared connection's client listeners serve every attached native
+	if (!SharedConnection.IsValid())
+	{
+		PrivateClient->clear_socket_listeners();
+	}
+}
+
+void FSocketIONative::SetupInternalCallbacks()
+{
+	//a shared connection owns the client listeners and fans them out to each attached native
+	if (SharedConnection.IsValid())
+	{
+		return;
+	}
+
+	PrivateClient->set_open_listener(sio::client::con_listener([&]() 
+	{
+		//too early to get session id here so we defer the connection event until we connect to a namespace
+	}));
+
+	PrivateClient->set_close_listener(sio::client::close_listener([&](sio::client::close_reason const& reason)
+	{
+		HandleConnectionClosed((ESIOConnectionCloseReason)reason);
+	}));
+
+	PrivateClient->set_socket_open_listener(sio::client::socket_listener([&](std::string const& nsp)
+	{
+		HandleNamespaceOpened(USIOMessageConvert::FStringFromStd(nsp));
+	}));
+
+	PrivateClient->set_socket_close_listener(sio::client::socket_listener([&](std::string const& nsp)
+	{
+		HandleNamespaceClosed(USIOMessageConvert::FStringFromStd(nsp));
+	}));
+
+	PrivateClient->set_fail_listener(sio::client::con_listener([&]()
+	{
+		HandleConnectionFailed();
+	}));
+
+	PrivateClient->set_reconnect_listener(sio::client::reconnect_listener([&](unsigned num, unsigned delay)
+	{
+		HandleReconnecting(num, delay);
+	}));
+}
+
+void FSocketIONative::HandleConnectionClosed(ESIOConnectionCloseReason DisconnectReason)
+{
+	bIsConnected = false;
+
+	//acks of a closed connection never arrive
+	FailPendingRpcs(ESIORpcStatus::Disconnected);
+
+	FString DisconnectReasonString = UEnum::GetValueAsString<ESIOConnectionCloseReason>(DisconnectReason);
+	if (VerboseLog)
+	{
+		UE_LOG(SocketIO, Log, TEXT("SocketIO Disconnected %s reason: %s"), *SessionId, *DisconnectReasonString);
+	}
+	LastSessionId = SessionId;
+	SessionId = TEXT("Invalid");
 
-	PrivateClient->set_fail_listener(sio::client::con_listener([&]()
+	if (OnDisconnectedCallback)
+	{
+		if (bCallbackOnGameThread)
+		{
+			FCULambdaRunnable::RunShortLambdaOnGameThread([&, DisconnectReason]
+			{
+				if (OnDisconnectedCallback)
+				{
+					OnDisconnectedCallback(DisconnectReason);
+				}
+			});
+		}
+		else
+		{
+			OnDisconnectedCallback(DisconnectReason);
+		}
+	}
+}
+
+void FSocketIONative::HandleNamespaceOpened(const FString& Namespace)
+{
+	//Special case, we have a latent connection after already having been disconnected
+	if (!PrivateClient.IsValid())
+	{
+		return;
+	}
+	if (!bIsConnected)
 	{
+		bIsConnected = true;
+		SessionId = USIOMessageConvert::FStringFromStd(PrivateClient->get_sessionid());
+		SocketId = USIOMessageConvert::FStringFromStd(PrivateClient->socket(USIOMessageConvert::StdString(Namespace))->get_socket_id());
+
 		if (VerboseLog)
 		{
-			UE_LOG(SocketIO, Log, TEXT("SocketIO failed to connect."));
+			UE_LOG(SocketIO, Log, TEXT("SocketIO Connected with session: %s"), *SessionId);
 		}
-		if (OnFailCallback)
+		if (OnConnectedCallback)
 		{
 			if (bCallbackOnGameThread)
 			{
 				FCULambdaRunnable::RunShortLambdaOnGameThread([&]
 				{
-					if (OnFailCallback)
+					if (OnConnectedCallback)
 					{
-						OnFailCallback();
+						OnConnectedCallback(SocketId, SessionId);
 					}
 				});
 			}
 			else
 			{
-				OnFailCallback();
+				OnConnectedCallback(SocketId, SessionId);
 			}
 		}
-	}));
+	}
 
-	PrivateClient->set_reconnect_listener(sio::client::reconnect_listener([&](unsigned num, unsigned delay)
+	if (VerboseLog)
 	{
-		bIsConnected = false;
+		UE_LOG(SocketIO, Log, TEXT("SocketIO %s connected to namespace: %s"), *SessionId, *Namespace);
+	}
+	if (OnNamespaceConnectedCallback)
+	{
+		if (bCallbackOnGameThread)
+		{
+			FCULambdaRunnable::RunShortLambdaOnGameThread([&, Namespace]
+			{
+				if (OnNamespaceConnectedCallback)
+				{
+					OnNamespaceConnectedCallback(Namespace);
+				}
+			});
+		}
+		else
+		{
+			OnNamespaceConnectedCallback(Namespace);
+		}
+	}
 
-		if (VerboseLog)
+	//the server side of a delta stream may not have survived the reconnect
+	{
+		FScopeLock Lock(&DeltaSection);
+		for (const TPair<TPair<FString, FString>, FSIODeltaSenderPtr>& Pair : DeltaStreams)
 		{
-			UE_LOG(SocketIO, Log, TEXT("SocketIO %s appears to have lost connection, reconnecting attempt %d with delay %d"), *SessionId, num, delay);
+			if (Pair.Key.Key == Namespace)
+			{
+				Pair.Value->Reset();
+			}
 		}
-		if (OnReconnectionCallback)
+	}
+
+	ReplayOutbox(Namespace);
+}
+
+void FSocketIONative::HandleNamespaceClosed(const FString& Namespace)
+{
+	FString NamespaceSession = SessionId;
+	if (NamespaceSession.Equals(TEXT("Invalid")))
+	{
+		NamespaceSession = LastSessionId;
+	}
+	if (VerboseLog)
+	{
+		UE_LOG(SocketIO, Log, TEXT("SocketIO %s disconnected from namespace: %s"), *NamespaceSession, *Namespace);
+	}
+	if (OnNamespaceDisconnectedCallback)
+	{
+		if (bCallbackOnGameThread)
 		{
-			if (bCallbackOnGameThread)
+			FCULambdaRunnable::RunShortLambdaOnGameThread([&, Namespace]
 			{
-				FCULambdaRunnable::RunShortLambdaOnGameThread([&, num, delay]
+				if (OnNamespaceDisconnectedCallback)
 				{
-					if (OnReconnectionCallback)
-					{
-						OnReconnectionCallback(num, delay);
-					}
-				});
-			}
-			else
+					OnNamespaceDisconnectedCallback(Namespace);
+				}
+			});
+		}
+		else
+		{
+			OnNamespaceDisconnectedCallback(Namespace);
+		}
+	}
+}
+
+void FSocketIONative::HandleConnectionFailed()
+{
+	if (VerboseLog)
+	{
+		UE_LOG(SocketIO, Log, TEXT("SocketIO failed to connect."));
+	}
+	if (OnFailCallback)
+	{
+		if (bCallbackOnGameThread)
+		{
+			FCULambdaRunnable::RunShortLambdaOnGameThread([&]
 			{
-				OnReconnectionCallback(num, delay);
-			}
+				if (OnFailCallback)
+				{
+					OnFailCallback();
+				}
+			});
 		}
-	}));
+		else
+		{
+			OnFailCallback();
+		}
+	}
 }
 
+void FSocketIONative::HandleReconnecting(uint32 Attempt, uint32 Delay)
+{
+	bIsConnected = false;
+
+	if (VerboseLog)
+	{
+		UE_LOG(SocketIO, Log, TEXT("SocketIO %s appears to have lost connection, reconnecting attempt %d with delay %d"), *SessionId, Attempt, Delay);
+	}
+	if (OnReconnectionCallback)
+	{
+		if (bCallbackOnGameThread)
+		{
+			FCULambdaRunnable::RunShortLambdaOnGameThread([&, Attempt, Delay]
+			{
+				if (OnReconnectionCallback)
+				{
+					OnReconnectionCallback(Attempt, Delay);
+				}
+			});
+		}
+		else
+		{
+			OnReconnectionCallback(Attempt, Delay);
+		}
+	}
+}
 void FSocketIONative::RebindCurrentEventMap()
 {
+	//drop what is still registered so rebinding on the same client doesn't double up
+	UnbindSocketListeners();
 	ClearInternalCallbacks();
 
 	for (auto& EventPair : EventFunctionMap)
@@ -610,8 +1495,13 @@ void FSocketIONative::RebindCurrentEventMap()
 		const FSIOBoundEvent EventBind = EventPair.Value;
 
 		OnRawEvent(EventName, [&, EventBind](const FString& Event, const sio::message::ptr& RawMessage) {
-			EventBind.Function(Event, USIOMessageConvert::ToJsonValue(RawMessage));
-		}, EventBind.Namespace, EventBind.ThreadOption);
+			EventBind.Function(Event, SharedJsonValue(RawMessage));
+		}, EventBind.Namespace, EventBind.ThreadOption, EventBind.OrderingKeyField);
+	}
+
+	for (auto& ListenerPair : EventListenerMap)
+	{
+		BindListener(ListenerPair.Value);
 	}
 
 	SetupInternalCallbacks();
@@ -656,3 +1546,329 @@ void FSocketIONative::SyncPrivateClientToTLSMode(const FString& URL)
 	}
 }
 
+void FSocketIONative::SetEventConflation(const FString& EventName, const FString& KeyField /*= TEXT("")*/, float MaxFlushRate /*= 0.f*/, const FString& Namespace /*= TEXT("/")*/)
+{
+	{
+		FScopeLock Lock(&OutboundSection);
+		FSIOConflatedEvent& Conflated = ConflatedEvents.FindOrAdd(Namespace + TEXT("|") + EventName);
+		Conflated.EventName = EventName;
+		Conflated.Namespace = Namespace;
+		Conflated.KeyField = USIOMessageConvert::StdString(KeyField);
+		Conflated.MinFlushInterval = MaxFlushRate > 0.f ? 1.0 / MaxFlushRate : 0.0;
+		EnsureOutboundTicker();
+	}
+}
+
+void FSocketIONative::ClearEventConflation(const FString& EventName, const FString& Namespace /*= TEXT("/")*/)
+{
+	FSIOConflatedEvent Removed;
+	{
+		FScopeLock Lock(&OutboundSection);
+		if (!ConflatedEvents.RemoveAndCopyValue(Namespace + TEXT("|") + EventName, Removed))
+		{
+			return;
+		}
+	}
+	for (const sio::message::list& MessageList : Removed.Slots)
+	{
+		EmitRaw(EventName, MessageList, nullptr, Namespace);
+	}
+}
+
+void FSocketIONative::SetEventOutbox(const FString& EventName, const FString& Namespace /*= TEXT("/")*/)
+{
+	{
+		FScopeLock Lock(&OutboundSection);
+		OutboxEvents.Add(Namespace + TEXT("|") + EventName);
+	}
+	UpdateDefaultOutboxJournal();
+}
+
+void FSocketIONative::ClearEventOutbox(const FString& EventName, const FString& Namespace /*= TEXT("/")*/)
+{
+	FScopeLock Lock(&OutboundSection);
+	OutboxEvents.Remove(Namespace + TEXT("|") + EventName);
+}
+
+void FSocketIONative::SetOutboxJournalPath(const FString& Path)
+{
+	bCustomOutboxJournal = !Path.IsEmpty();
+	if (bCustomOutboxJournal)
+	{
+		//Entries restored from a previous run go out when their namespace next connects
+		Outbox->SetJournalPath(Path);
+	}
+	else
+	{
+		UpdateDefaultOutboxJournal();
+	}
+}
+
+void FSocketIONative::UpdateDefaultOutboxJournal()
+{
+	if (bCustomOutboxJournal || URLParams.AddressAndPort.IsEmpty())
+	{
+		return;
+	}
+	{
+		FScopeLock Lock(&OutboundSection);
+		if (OutboxEvents.Num() == 0)
+		{
+			return;
+		}
+	}
+
+	//one journal per server so a client never replays another connection's emits
+	Outbox->SetJournalPath(FSIOOutbox::DefaultJournalPath(URLParams.AddressAndPort.ToLower() + URLParams.Path));
+}
+
+bool FSocketIONative::TryOutboxEmit(const FString& EventName, const sio::message::list& MessageList, const FString& Namespace, ESIOEmitPriority Priority)
+{
+	{
+		FScopeLock Lock(&OutboundSection);
+		if (OutboxEvents.Num() == 0 || !OutboxEvents.Contains(Namespace + TEXT("|") + EventName))
+		{
+			return false;
+		}
+	}
+
+	const FString Id = Outbox->Add(Namespace, EventName, MessageList, Priority == EMIT_BULK);
+
+	//Offline emits wait for ReplayOutbox, the socket drops its queue on disconnect
+	if (bIsConnected)
+	{
+		SendOutboxEntry(Id, EventName, MessageList, Namespace, Priority);
+	}
+	return true;
+}
+
+bool FSocketIONative::HasEmitRouting(const FString& EventName, const FString& Namespace, ESIOEmitPriority Priority)
+{
+	if (bBatchEmits && Priority == EMIT_REALTIME)
+	{
+		return true;
+	}
+
+	FScopeLock Lock(&OutboundSection);
+	if (OutboxEvents.Num() == 0 && ConflatedEvents.Num() == 0)
+	{
+		return false;
+	}
+	const FString Key = Namespace + TEXT("|") + EventName;
+	return OutboxEvents.Contains(Key) || ConflatedEvents.Contains(Key);
+}
+
+void FSocketIONative::SendOutboxEntry(const FString& Id, const FString& EventName, const sio::message::list& MessageList, const FString& Namespace, ESIOEmitPriority Priority /*= EMIT_REALTIME*/)
+{
+	sio::message::list Arguments(MessageList);
+	sio::message::ptr IdObject = sio::object_message::create();
+	IdObject->get_map()[USIOMessageConvert::StdString(OutboxIdField())] = sio::string_message::create(USIOMessageConvert::StdString(Id));
+	Arguments.push(IdObject);
+
+	TWeakPtr<FSIOOutbox, ESPMode::ThreadSafe> WeakOutbox = Outbox;
+	FlushBatch(Namespace);
+	PrivateClient->socket(USIOMessageConvert::StdString(Namespace))->emit(
+		USIOMessageConvert::StdString(EventName),
+		Arguments,
+		[WeakOutbox, Id](const sio::message::list& Response)
+		{
+			TSharedPtr<FSIOOutbox, ESPMode::ThreadSafe> PinnedOutbox = WeakOutbox.Pin();
+			if (PinnedOutbox.IsValid())
+			{
+				PinnedOutbox->Acknowledge(Id);
+			}
+		},
+		Priority == EMIT_BULK ? sio::socket::emit_priority_bulk : sio::socket::emit_priority_realtime);
+}
+
+void FSocketIONative::ReplayOutbox(const FString& Namespace)
+{
+	TArray<FSIOOutboxEntry> Entries;
+	Outbox->GetPending(Namespace, Entries);
+
+	for (const FSIOOutboxEntry& Entry : Entries)
+	{
+		sio::message::list MessageList;
+		if (!FSIOOutbox::DecodeMessageList(Entry.Payload, MessageList))
+		{
+			UE_LOG(SocketIO, Warning, TEXT("Dropping unreadable outbox entry %s for %s"), *Entry.Id, *Entry.EventName);
+			Outbox->Acknowledge(Entry.Id);
+			continue;
+		}
+		SendOutboxEntry(Entry.Id, Entry.EventName, MessageList, Entry.Namespace, Entry.bBulk ? EMIT_BULK : EMIT_REALTIME);
+	}
+}
+
+void FSocketIONative::FlushOutbound(bool bForce /*= false*/)
+{
+	TArray<TPair<FString, FSIOPendingEmit>> PendingEmits;
+
+	{
+		FScopeLock Lock(&OutboundSection);
+		const double Now = FPlatformTime::Seconds();
+
+		for (TPair<FString, FSIOConflatedEvent>& Pair : ConflatedEvents)
+		{
+			FSIOConflatedEvent& Conflated = Pair.Value;
+			if (Conflated.Slots.Num() == 0 || (!bForce && (Now - Conflated.LastFlushTime) < Conflated.MinFlushInterval))
+			{
+				continue;
+			}
+			Conflated.LastFlushTime = Now;
+
+			for (const sio::message::list& MessageList : Conflated.Slots)
+			{
+				if (bBatchEmits)
+				{
+					PendingBatches.FindOrAdd(Conflated.Namespace).Add({ Conflated.EventName, MessageList });
+				}
+				else
+				{
+					PendingEmits.Emplace(Conflated.Namespace, FSIOPendingEmit{ Conflated.EventName, MessageList });
+				}
+			}
+			Conflated.Slots.Reset();
+			Conflated.SlotIndices.Reset();
+		}
+
+		for (TPair<FString, TArray<FSIOPendingEmit>>& Batch : PendingBatches)
+		{
+			if (Batch.Value.Num() > 0)
+			{
+				PendingEmits.Emplace(Batch.Key, MakeBatchEmit(Batch.Value));
+			}
+		}
+		PendingBatches.Reset();
+	}
+
+	for (const TPair<FString, FSIOPendingEmit>& Pending : PendingEmits)
+	{
+		PrivateClient->socket(USIOMessageConvert::StdString(Pending.Key))->emit(
+			USIOMessageConvert::StdString(Pending.Value.EventName),
+			Pending.Value.MessageList);
+	}
+}
+
+FString FSocketIONative::KeyFieldValue(const sio::message::ptr& Message, const std::string& KeyField)
+{
+	if (!Message || Message->get_flag() != sio::message::flag_object)
+	{
+		return FString();
+	}
+	const std::map<std::string, sio::message::ptr>& Map = Message->get_map();
+	auto It = Map.find(KeyField);
+	if (It == Map.end() || !It->second)
+	{
+		return FString();
+	}
+
+	switch (It->second->get_flag())
+	{
+	case sio::message::flag_string:
+		return USIOMessageConvert::FStringFromStd(It->second->get_string());
+	case sio::message::flag_integer:
+		return FString::Printf(TEXT("%lld"), (long long)It->second->get_int());
+	case sio::message::flag_double:
+		return FString::SanitizeFloat(It->second->get_double());
+	case sio::message::flag_boolean:
+		return It->second->get_bool() ? TEXT("true") : TEXT("false");
+	default:
+		return FString();
+	}
+}
+
+bool FSocketIONative::TryConflateEmit(const FString& EventName, const sio::message::list& MessageList, const FString& Namespace)
+{
+	FScopeLock Lock(&OutboundSection);
+	if (ConflatedEvents.Num() == 0)
+	{
+		return false;
+	}
+	FSIOConflatedEvent* Conflated = ConflatedEvents.Find(Namespace + TEXT("|") + EventName);
+	if (!Conflated)
+	{
+		return false;
+	}
+
+	//Slot key is the string form of KeyField in an object message, everything else shares one slot
+	FString SlotKey;
+	if (!Conflated->KeyField.empty() && MessageList.size() > 0)
+	{
+		SlotKey = KeyFieldValue(MessageList[0], Conflated->KeyField);
+	}
+
+	if (int32* SlotIndex = Conflated->SlotIndices.Find(SlotKey))
+	{
+		Conflated->Slots[*SlotIndex] = sio::message::list(MessageList);
+	}
+	else
+	{
+		Conflated->SlotIndices.Add(SlotKey, Conflated->Slots.Add(MessageList));
+	}
+	return true;
+}
+
+void FSocketIONative::AddToBatch(const FString& EventName, const sio::message::list& MessageList, const FString& Namespace)
+{
+	FScopeLock Lock(&OutboundSection);
+	PendingBatches.FindOrAdd(Namespace).Add({ EventName, MessageList });
+	EnsureOutboundTicker();
+}
+
+void FSocketIONative::FlushBatch(const FString& Namespace)
+{
+	if (!bBatchEmits)
+	{
+		return;
+	}
+
+	FSIOPendingEmit Pending;
+	{
+		FScopeLock Lock(&OutboundSection);
+		TArray<FSIOPendingEmit>* Batch = PendingBatches.Find(Namespace);
+		if (!Batch || Batch->Num() == 0)
+		{
+			return;
+		}
+		Pending = MakeBatchEmit(*Batch);
+		Batch->Reset();
+	}
+
+	PrivateClient->socket(USIOMessageConvert::StdString(Namespace))->emit(
+		USIOMessageConvert::StdString(Pending.EventName),
+		Pending.MessageList);
+}
+
+FSocketIONative::FSIOPendingEmit FSocketIONative::MakeBatchEmit(const TArray<FSIOPendingEmit>& Batch)
+{
+	if (Batch.Num() == 1)
+	{
+		return Batch[0];
+	}
+
+	//One '__batch' event holding [name, [args...]] tuples
+	sio::message::ptr Tuples = sio::array_message::create();
+	for (const FSIOPendingEmit& Pending : Batch)
+	{
+		sio::message::ptr Tuple = sio::array_message::create();
+		Tuple->get_vector().push_back(sio::string_message::create(USIOMessageConvert::StdString(Pending.EventName)));
+		Tuple->get_vector().push_back(Pending.MessageList.to_array_message());
+		Tuples->get_vector().push_back(Tuple);
+	}
+	return FSIOPendingEmit{ UTF8_TO_TCHAR(sio::socket::batch_event_name()), sio::message::list(Tuples) };
+}
+
+void FSocketIONative::EnsureOutboundTicker()
+{
+	if (!OutboundTickerHandle.IsValid())
+	{
+		OutboundTickerHandle = FTSTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateRaw(this, &FSocketIONative::OnOutboundTick));
+	}
+}
+
+bool FSocketIONative::OnOutboundTick(float DeltaTime)
+{
+	FlushOutbound(false);
+	return true;
+}
+
@@ -0,0 +1,72 @@
+// Copyright 2018-current Getnamo. All Rights Reserved
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Dom/JsonValue.h"
+#include "UObject/WeakObjectPtr.h"
+#include <atomic>
+
+/**
+* A BP function bound by name, called with event payloads or emit callback responses. The UFunction, its
+* parameters and how the payload converts into the first one are resolved once and reused by every call.
+* Bindings resolve again after a Blueprint recompile or hot reload. Safe to call from any thread, a resolve
+* publishes a new immutable snapshot and calls already running keep the one they started with.
+*/
+class SOCKETIOCLIENT_API FSIOBoundFunction
+{
+public:
+	FSIOBoundFunction(UObject* InTarget, const FString& InFunctionName);
+
+	/** First response value goes to the first parameter, a USIOJsonValue second parameter receives the whole response */
+	bool Call(const TArray<TSharedPtr<FJsonValue>>& Response);
+
+	/** Single message form used by event bindings */
+	bool Call(const TSharedPtr<FJsonValue>& Message);
+
+	/** Makes every binding resolve again on its next call */
+	static void InvalidateAll();
+
+protected:
+	enum class EParamKind : uint8
+	{
+		None,
+		JsonValue,
+		JsonObject,
+		Handle,
+		String,
+		Float,
+		Int,
+		Bool,
+		Bytes,
+		Unsupported
+	};
+
+	/** Resolved state, never modified once published */
+	struct FResolved
+	{
+		TWeakObjectPtr<UFunction> Function;
+		TWeakObjectPtr<UClass> ResolvedClass;
+		TArray<FProperty*> Params;
+		FProperty* ResponseParam = nullptr;
+		EParamKind Kind = EParamKind::None;
+		uint32 Generation = 0;
+	};
+	typedef TSharedPtr<const FResolved, ESPMode::ThreadSafe> FResolvedPtr;
+
+	FResolvedPtr Resolve(UObject* InTarget) const;
+
+	/** Current snapshot, resolved again first if stale for this target */
+	FResolvedPtr GetResolved(UObject* InTarget);
+
+	/** Writes the first response value into the parameter buffer, false if the kind is unsupported */
+	static bool FillParams(const FResolved& State, uint8* Params, const TArray<TSharedPtr<FJsonValue>>& Response);
+
+	TWeakObjectPtr<UObject> Target;
+	FString FunctionName;
+
+	FResolvedPtr Resolved;
+	FCriticalSection ResolveSection;
+
+	static std::atomic<uint32> GlobalGeneration;
+};
@@ -0,0 +1,99 @@
+// Copyright 2018-current Getnamo. All Rights Reserved
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Dom/JsonObject.h"
+#include "UObject/StructOnScope.h"
+#include "sio_socket.h"
+
+/**
+* Sending side of a delta struct stream. Each update is diffed against the last snapshot the
+* receiver acknowledged and only the changed fields are sent:
+*
+*	{"seq": 12, "base": 9, "delta": {"hp": 90, "pos": {"x": 1.5}}}
+*
+* base 0 is the struct's defaults, so the first update (or one after Reset) only carries fields
+* that differ from them. Thread safe, acks usually arrive on the network thread.
+*/
+class SOCKETIOCLIENT_API FSIODeltaSender
+{
+public:
+	explicit FSIODeltaSender(const UScriptStruct* InStruct);
+
+	/** Sent snapshots kept for acks. When this many go unacked the next update falls back to base 0. */
+	int32 MaxPending;
+
+	/**
+	* Event packet carrying the message for StructPtr, the delta json is written into it as is.
+	* Keeps a copy of StructPtr under the new seq until acked or dropped.
+	*/
+	sio::prepared_packet::ptr Encode(const FString& EventName, const void* StructPtr, int64& OutSeq);
+
+	/** Receiver applied Seq, later updates are diffed against it */
+	void Acknowledge(int64 Seq);
+
+	/** Forgets every snapshot e.g. when the receiver lost its state, the next update is against base 0 */
+	void Reset();
+
+	const UScriptStruct* GetStruct() const
+	{
+		return Struct.Get();
+	}
+
+protected:
+	typedef TPair<int64, TSharedPtr<FStructOnScope>> FSnapshot;
+
+	TSharedPtr<FStructOnScope> CopyStruct(const void* StructPtr) const;
+
+	TWeakObjectPtr<const UScriptStruct> Struct;
+
+	FCriticalSection Section;
+	int64 NextSeq;
+	int64 BaseSeq;
+	TSharedPtr<FStructOnScope> Base;
+
+	/** Sent and unacked, oldest first */
+	TArray<FSnapshot> Pending;
+};
+
+/**
+* Receiving side of a delta struct stream, applies messages from FSIODeltaSender (or a server speaking
+* the same format) to a struct. Keeps the snapshots it built so a delta against any recent base applies.
+* Not thread safe, use it from the thread that receives the event.
+*/
+class SOCKETIOCLIENT_API FSIODeltaReceiver
+{
+public:
+	explicit FSIODeltaReceiver(const UScriptStruct* InStruct);
+
+	/** Snapshots kept by seq, bases older than the newest one a sender used are dropped anyway */
+	int32 MaxSnapshots;
+
+	/**
+	* Rebuilds StructPtr from its base snapshot plus the delta in Message, read with the struct's
+	* FSIOJStructPlan so keys match what FSIODeltaSender wrote. Returns false if the message is no
+	* newer than the latest applied one, its base is no longer known or it is malformed, StructPtr is
+	* untouched then. On success ack OutSeq back to the sender, e.g. as the socket.io ack or with
+	* FSocketIONative::AcknowledgeDelta.
+	*/
+	bool Apply(const TSharedPtr<FJsonObject>& Message, void* StructPtr, int64& OutSeq);
+
+	/** Forgets every snapshot and the latest seq, e.g. when the sender restarted its numbering */
+	void Reset();
+
+	/** Seq of the newest applied message, 0 before the first one */
+	int64 GetLatestSeq() const
+	{
+		return LatestSeq;
+	}
+
+protected:
+	typedef TPair<int64, TSharedPtr<FStructOnScope>> FSnapshot;
+
+	TWeakObjectPtr<const UScriptStruct> Struct;
+	int64 LatestSeq;
+
+	/** Oldest first */
+	TArray<FSnapshot> Snapshots;
+};
@@ -0,0 +1,108 @@
+// Copyright 2018-current Getnamo. All Rights Reserved
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Dom/JsonValue.h"
+#include "Dom/JsonObject.h"
+#include "SIOJsonPath.h"
+
+/** Passed to document subscribers after a snapshot or patch was applied */
+struct SOCKETIOCLIENT_API FSIODocumentChange
+{
+	FString Channel;
+	int64 Version = 0;
+
+	/** JSON pointers (RFC 6901) that changed and concern the subscriber, "" is the whole document */
+	TArray<FString> ChangedPaths;
+
+	/** Document after the change, owned by the store and patched in place by later changes */
+	TSharedPtr<FJsonValue> Document;
+};
+
+/**
+* Client side copy of json documents the server replicates per channel. The server sends a full
+* snapshot once, then RFC 6902 patches with consecutive versions:
+*
+*	{"channel": "match", "version": 7, "snapshot": {...}}
+*	{"channel": "match", "version": 8, "patch": [{"op": "replace", "path": "/players/3/hp", "value": 90}]}
+*
+* channel defaults to the event name. Patches are applied in place on the cached tree so only the
+* changed values are converted, and subscribers hear about the paths below the pointer they watch.
+* A version gap or a failed patch drops the channel's document and calls OnResyncNeeded, the server
+* should answer it with a new snapshot.
+*
+* Not thread safe, use it from the thread its events are received on (game thread by default).
+*/
+class SOCKETIOCLIENT_API FSIODocumentStore
+{
+public:
+	typedef TFunction<void(const FSIODocumentChange&)> FOnDocumentChanged;
+
+	FSIODocumentStore();
+
+	/** Called with the channel and the last version held when a snapshot is needed, -1 if none */
+	TFunction<void(const FString&, int64)> OnResyncNeeded;
+
+	/** Applies a snapshot or patch message, DefaultChannel is used when it has no channel field */
+	bool ApplyMessage(const FString& DefaultChannel, const TSharedPtr<FJsonValue>& Message);
+
+	/** Replaces the channel's document, older versions than the one held are ignored */
+	bool ApplySnapshot(const FString& Channel, const TSharedPtr<FJsonValue>& Document, int64 Version);
+
+	/** Applies an RFC 6902 operation array, Version has to follow the held version */
+	bool ApplyPatch(const FString& Channel, const TArray<TSharedPtr<FJsonValue>>& Operations, int64 Version);
+
+	/** Channel's document, nullptr until the first snapshot. Treat it as read-only. */
+	TSharedPtr<FJsonValue> GetDocument(const FString& Channel) const;
+
+	/** Version of the channel's document, -1 if there is none */
+	int64 GetVersion(const FString& Channel) const;
+
+	/** Value at Path in the channel's document, see FSIOJsonPath */
+	const TSharedPtr<FJsonValue>* Resolve(const FString& Channel, const FSIOJsonPath& Path) const;
+
+	/**
+	* Calls Callback whenever something at, below or above Pointer changes in the channel's document.
+	*
+	* @param Channel		Channel name, usually the event name
+	* @param Pointer		JSON pointer e.g. "/players/3", "" watches the whole document
+	* @param Callback		Called after the change was applied
+	* @return Subscription id for Unsubscribe
+	*/
+	uint32 Subscribe(const FString& Channel, const FString& Pointer, FOnDocumentChanged Callback);
+
+	void Unsubscribe(uint32 SubscriptionId);
+
+	/** Drops the channel's document, the next patch will ask for a resync */
+	void Reset(const FString& Channel);
+
+	/** Deep copy of a json value, the store never shares nodes with received messages */
+	static TSharedPtr<FJsonValue> CopyValue(const TSharedPtr<FJsonValue>& Value);
+
+protected:
+	struct FDocument
+	{
+		TSharedPtr<FJsonValue> Root;
+		int64 Version = -1;
+		bool bAwaitingSnapshot = false;
+	};
+
+	struct FSubscription
+	{
+		FString Channel;
+		FString Pointer;
+		FOnDocumentChanged Callback;
+	};
+
+	/** Applies one operation, adds the pointers it touched to OutChangedPaths */
+	bool ApplyOperation(TSharedPtr<FJsonValue>& Root, const TSharedPtr<FJsonValue>& Operation, TArray<FString>& OutChangedPaths);
+
+	void RequestResync(const FString& Channel, const FString& Reason);
+
+	void Notify(const FString& Channel, int64 Version, const TArray<FString>& ChangedPaths);
+
+	TMap<FString, FDocument> Documents;
+	TMap<uint32, FSubscription> Subscriptions;
+	uint32 NextSubscriptionId;
+};
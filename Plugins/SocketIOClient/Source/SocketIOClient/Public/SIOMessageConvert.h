@@ -7,6 +7,7 @@
 #include "Dom/JsonObject.h"
 #include "sio_client.h"
 #include "SIOJsonValue.h"
+#include "SIOJsonPath.h"
 #include "SIOMessageConvert.generated.h"
 
 DECLARE_LOG_CATEGORY_EXTERN(SocketIO, Log, All);
@@ -51,6 +52,39 @@ struct SOCKETIOCLIENT_API FSIOConnectParams
 	}
 };
 
+/**
+* Outbound latest-value conflation for one event, see FSocketIONative::SetEventConflation
+*/
+USTRUCT(BlueprintType)
+struct SOCKETIOCLIENT_API FSIOConflationSettings
+{
+	GENERATED_USTRUCT_BODY();
+
+	/** Event the settings apply to, filled in by USocketIOClientComponent::SetEventConflation */
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = SocketIOConflation)
+	FString EventName;
+
+	/** Optional field of an object message. Each distinct value keeps its own pending slot, empty = one slot per event. */
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = SocketIOConflation)
+	FString KeyField;
+
+	/** Maximum flushes per second, 0 = flush once per tick. */
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = SocketIOConflation)
+	float MaxFlushRate;
+
+	/** Namespace the event is emitted on */
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = SocketIOConflation)
+	FString Namespace;
+
+	FSIOConflationSettings()
+	{
+		EventName = TEXT("");
+		KeyField = TEXT("");
+		MaxFlushRate = 0.f;
+		Namespace = TEXT("/");
+	}
+};
+
 /**
  * Static Conversion Utilities
  */
@@ -73,4 +107,14 @@ public:
 	static std::map<std::string, std::string> JsonObjectToStdStringMap(TSharedPtr<FJsonObject> InObject);
 	static TMap<FString, FString> JsonObjectToFStringMap(TSharedPtr<FJsonObject> InObject);
 	static std::map<std::string, std::string> FStringMapToStdStringMap(const TMap<FString, FString>& InMap);
+
+	//FSIOJsonPath lookups straight on a sio::message tree, nothing is converted to FJsonValue
+	static const sio::message::ptr* ResolvePath(const sio::message::ptr& Message, const FSIOJsonPath& Path);
+	static void ResolvePaths(const sio::message::ptr& Message, const FSIOJsonPathSet& Paths, TArray<const sio::message::ptr*>& OutMessages);
+	static bool TryGetPathNumber(const sio::message::ptr& Message, const FSIOJsonPath& Path, double& OutNumber);
+	static bool TryGetPathString(const sio::message::ptr& Message, const FSIOJsonPath& Path, FString& OutString);
+	static bool TryGetPathBool(const sio::message::ptr& Message, const FSIOJsonPath& Path, bool& bOutBool);
+
+	/** One step of a path down a sio::message tree, keys match case-sensitively */
+	static const sio::message::ptr* StepMessage(const sio::message::ptr& Message, const FSIOJsonPath::FSegment& Segment);
 }; 
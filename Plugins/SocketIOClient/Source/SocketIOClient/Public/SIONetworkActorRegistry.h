@@ -0,0 +1,200 @@
+// Copyright 2018-current Getnamo. All Rights Reserved
+
+#pragma once
+
+#include "Subsystems/WorldSubsystem.h"
+#include "UObject/Interface.h"
+#include "Dom/JsonValue.h"
+#include "SIONetworkActorRegistry.generated.h"
+
+class USIOJsonValue;
+class USocketIOClientComponent;
+class USIOSnapshotInterpolationComponent;
+
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_TwoParams(FSIONetworkActorSignature, FString, NetworkId, AActor*, Actor);
+
+UINTERFACE(BlueprintType)
+class SOCKETIOCLIENT_API USIONetworkActor : public UInterface
+{
+	GENERATED_BODY()
+};
+
+/** Optional callbacks for actors pooled by USIONetworkActorRegistry */
+class SOCKETIOCLIENT_API ISIONetworkActor
+{
+	GENERATED_BODY()
+
+public:
+	/** Taken from the pool for NetworkId, State is the join message */
+	UFUNCTION(BlueprintNativeEvent, BlueprintCallable, Category = "SocketIO Network Actors")
+	void OnNetworkActivated(const FString& NetworkId, USIOJsonValue* State);
+
+	/** Update routed to this actor. The wrapper may be recycled at the end of the frame, don't keep it. */
+	UFUNCTION(BlueprintNativeEvent, BlueprintCallable, Category = "SocketIO Network Actors")
+	void OnNetworkUpdate(USIOJsonValue* State);
+
+	/** About to go back to the pool, reset any per entity state here */
+	UFUNCTION(BlueprintNativeEvent, BlueprintCallable, Category = "SocketIO Network Actors")
+	void OnNetworkReleased();
+
+	/** C++ fast path, return true to handle the update without a blueprint wrapper */
+	virtual bool HandleNetworkUpdate(const TSharedPtr<FJsonValue>& State) { return false; }
+};
+
+/** Free actors of one class */
+USTRUCT()
+struct FSIONetworkActorPool
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	TArray<TObjectPtr<AActor>> Free;
+
+	/** Free actors kept ready, spawned over the next ticks */
+	int32 WarmUpCount = 0;
+};
+
+/** Active actor of a network id, with what updates are routed to resolved once */
+USTRUCT()
+struct FSIONetworkActorEntry
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	TObjectPtr<AActor> Actor = nullptr;
+
+	UPROPERTY()
+	TObjectPtr<USIOSnapshotInterpolationComponent> Interpolation = nullptr;
+
+	UPROPERTY()
+	TObjectPtr<UClass> PoolClass = nullptr;
+
+	bool bIsNetworkActor = false;
+
+	//set if the actor implements ISIONetworkActor in C++
+	ISIONetworkActor* NativeNetworkActor = nullptr;
+};
+
+/**
+* Network id to actor table for remote entities, backed by per class actor pools. Joins and leaves
+* are queued and applied once per tick, taking actors from the pool instead of spawning them, and
+* pools are refilled up to their warm-up count a few spawns per tick. Updates go straight to the
+* actor of their id: snapshot interpolation components get the transform, ISIONetworkActor actors
+* get OnNetworkUpdate.
+*/
+UCLASS()
+class SOCKETIOCLIENT_API USIONetworkActorRegistry : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	USIONetworkActorRegistry();
+
+	UPROPERTY(BlueprintAssignable, Category = "SocketIO Network Actors")
+	FSIONetworkActorSignature OnActorJoined;
+
+	UPROPERTY(BlueprintAssignable, Category = "SocketIO Network Actors")
+	FSIONetworkActorSignature OnActorLeft;
+
+	/** Pool spawns per tick while warming up */
+	UPROPERTY(BlueprintReadWrite, Category = "SocketIO Network Actors")
+	int32 WarmUpSpawnsPerTick;
+
+	/** Keep WarmUpCount free actors of ActorClass ready, spawned a few per tick */
+	UFUNCTION(BlueprintCallable, Category = "SocketIO Network Actors")
+	void WarmUpPool(TSubclassOf<AActor> ActorClass, int32 WarmUpCount);
+
+	/** Activate a pooled ActorClass actor for NetworkId on the next tick. A join for an active id is routed as an update. */
+	UFUNCTION(BlueprintCallable, Category = "SocketIO Network Actors")
+	void QueueJoin(const FString& NetworkId, TSubclassOf<AActor> ActorClass, USIOJsonValue* State);
+
+	/** Return the actor of NetworkId to its pool on the next tick */
+	UFUNCTION(BlueprintCallable, Category = "SocketIO Network Actors")
+	void QueueLeave(const FString& NetworkId);
+
+	/** Route State to the actor of NetworkId now, or to its queued join */
+	UFUNCTION(BlueprintCallable, Category = "SocketIO Network Actors")
+	void RouteUpdate(const FString& NetworkId, USIOJsonValue* State);
+
+	UFUNCTION(BlueprintPure, Category = "SocketIO Network Actors")
+	AActor* FindActor(const FString& NetworkId) const;
+
+	UFUNCTION(BlueprintPure, Category = "SocketIO Network Actors")
+	int32 NumActive() const;
+
+	UFUNCTION(BlueprintPure, Category = "SocketIO Network Actors")
+	int32 NumPooled(TSubclassOf<AActor> ActorClass) const;
+
+	/**
+	* Feed joins, leaves and updates from socket.io events. Each message is an entity object with
+	* IdField, or an array of them. Leave messages may also be plain ids.
+	*
+	* @param Client			Socket.io client to listen on
+	* @param ActorClass		Class joined entities are pooled as
+	* @param JoinEvent		Event name of joins
+	* @param LeaveEvent		Event name of leaves
+	* @param UpdateEvent	Event name of updates
+	* @param IdField		Field holding the network id
+	* @param Namespace		Optional namespace
+	*/
+	UFUNCTION(BlueprintCallable, Category = "SocketIO Network Actors")
+	void BindSocketEvents(USocketIOClientComponent* Client, TSubclassOf<AActor> ActorClass,
+		const FString& JoinEvent = TEXT("join"),
+		const FString& LeaveEvent = TEXT("leave"),
+		const FString& UpdateEvent = TEXT("update"),
+		const FString& IdField = TEXT("id"),
+		const FString& Namespace = TEXT("/"));
+
+	/** Remove every listener added with BindSocketEvents */
+	UFUNCTION(BlueprintCallable, Category = "SocketIO Network Actors")
+	void UnbindSocketEvents();
+
+	//C++ variants, no blueprint wrappers
+	void QueueJoinNative(const FString& NetworkId, UClass* ActorClass, const TSharedPtr<FJsonValue>& State);
+	void RouteUpdateNative(const FString& NetworkId, const TSharedPtr<FJsonValue>& State);
+
+	virtual void Deinitialize() override;
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+
+protected:
+	struct FPendingChange
+	{
+		enum EType : uint8
+		{
+			Join,
+			Leave,
+			Cancelled
+		};
+
+		EType Type;
+		FString NetworkId;
+		TWeakObjectPtr<UClass> ActorClass;
+		TSharedPtr<FJsonValue> State;
+
+		//newest update that arrived before the join applied
+		TSharedPtr<FJsonValue> LatestUpdate;
+	};
+
+	void Activate(const FString& NetworkId, UClass* ActorClass, const TSharedPtr<FJsonValue>& State);
+	void Release(const FString& NetworkId);
+	void RouteToEntry(const FSIONetworkActorEntry& Entry, const TSharedPtr<FJsonValue>& State);
+	AActor* SpawnPooledActor(UClass* ActorClass);
+	static void SetPooledActorActive(AActor* Actor, USIOSnapshotInterpolationComponent* Interpolation, bool bActive);
+
+	UPROPERTY()
+	TMap<FString, FSIONetworkActorEntry> ActiveActors;
+
+	UPROPERTY()
+	TMap<TObjectPtr<UClass>, FSIONetworkActorPool> Pools;
+
+	//applied in order on the next tick, swapped with ApplyingChanges so both keep their allocation
+	TArray<FPendingChange> PendingChanges;
+	TArray<FPendingChange> ApplyingChanges;
+
+	//index of the queued join of an id, so updates and leaves before it applies find it
+	TMap<FString, int32> PendingJoins;
+
+	TArray<TPair<TWeakObjectPtr<USocketIOClientComponent>, uint32>> Listeners;
+};
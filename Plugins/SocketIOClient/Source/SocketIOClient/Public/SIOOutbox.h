@@ -0,0 +1,157 @@
+// Copyright 2018-current Getnamo. All Rights Reserved
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "sio_message.h"
+
+class UCUFileSubsystem;
+
+/** One unacknowledged outbox emit, Payload is the message list in outbox binary form */
+struct SOCKETIOCLIENT_API FSIOOutboxEntry
+{
+	FString Id;
+	FString Namespace;
+	FString EventName;
+	TArray<uint8> Payload;
+
+	/** When the emit was stored, used by FSIOOutbox::MaxAgeSeconds */
+	FDateTime CreatedUtc;
+
+	/** Emitted as EMIT_BULK, replays go out on the same lane */
+	bool bBulk = false;
+};
+
+/**
+* Keeps emits of opted-in events until the server acks them. Entries live in memory until
+* MemoryBudget is exceeded, then move to an append-only journal file that is reloaded on
+* the next run. Each outbox owns its journal file exclusively. Entries past MaxEntries or
+* MaxAgeSeconds are dropped oldest first. Thread safe, acks arrive on the network thread.
+* Journal writes are batched onto a background thread, emits and acks never wait on the file.
+*/
+class SOCKETIOCLIENT_API FSIOOutbox
+{
+public:
+	FSIOOutbox();
+	~FSIOOutbox();
+
+	/** Bytes of payload kept in memory before spilling to the journal */
+	int64 MemoryBudget;
+
+	/** Most unacknowledged entries kept, <= 0 for no limit */
+	int32 MaxEntries;
+
+	/** Entries older than this are dropped instead of replayed, <= 0 for no limit */
+	double MaxAgeSeconds;
+
+	/**
+	* Sets the journal file and picks up entries a previous run left unacknowledged. Entries already
+	* journaled stay in the old file for whoever uses that path next. A path held by another live
+	* outbox gets a numbered suffix so two outboxes never share a file. Call on game thread.
+	*/
+	void SetJournalPath(const FString& Path);
+
+	/** The claimed journal path, may differ from the requested one by its suffix */
+	FString GetJournalPath();
+
+	/** Journal in the external save directory named after a hash of ConnectionKey, empty without a file subsystem */
+	static FString DefaultJournalPath(const FString& ConnectionKey);
+
+	/** Stores the emit and returns its dedup id */
+	FString Add(const FString& Namespace, const FString& EventName, const sio::message::list& MessageList, bool bBulk = false);
+
+	/** Server acked the entry, drop it */
+	void Acknowledge(const FString& Id);
+
+	/** Unacknowledged entries of the namespace, oldest first */
+	void GetPending(const FString& Namespace, TArray<FSIOOutboxEntry>& OutEntries);
+
+	int32 Num();
+
+	/** Writes entries still in memory to the journal and waits for queued writes so they survive a restart */
+	void Persist();
+
+	/** Lossless binary form of a message list, used for payloads and journal records */
+	static void EncodeMessageList(const sio::message::list& MessageList, TArray<uint8>& OutBytes);
+	static bool DecodeMessageList(const TArray<uint8>& Bytes, sio::message::list& OutMessageList);
+
+protected:
+	enum class EJournalRecord : uint8
+	{
+		Entry = 1,
+		Ack = 2
+	};
+
+	/** Moves memory entries to the journal, call with Section held */
+	void Spill();
+
+	/** Drops expired entries, then the oldest until Reserve more fit under MaxEntries. Call with Section held. */
+	void Prune(int32 Reserve);
+
+	/** Records acks of journal entries already removed from JournalPending, call with Section held */
+	void RemoveFromJournal(const TArray<FString>& Ids);
+
+	static void WriteJournalRecord(TArray<uint8>& OutRecords, EJournalRecord Type, const FSIOOutboxEntry& Entry);
+
+	/** Entries in journal order, acked ones removed. A truncated trailing record is ignored. Flush the writer first. */
+	static void ReadJournal(UCUFileSubsystem* Files, const FString& Path, TArray<FSIOOutboxEntry>& OutEntries);
+
+	/**
+	* Runs journal file operations in queue order on a background thread, consecutive appends to a
+	* file become one write. Queued tasks hold it shared, so it outlives the outbox until they finish.
+	*/
+	struct FJournalWriter : public TSharedFromThis<FJournalWriter, ESPMode::ThreadSafe>
+	{
+		enum class EOp : uint8
+		{
+			Append,
+			Delete,
+
+			//rewrite the file with only its unacked entries
+			Compact
+		};
+
+		struct FOp
+		{
+			EOp Type;
+			FString Path;
+			TArray<uint8> Bytes;
+		};
+
+		void Queue(EOp Type, const FString& Path, TArray<uint8> Bytes = TArray<uint8>());
+
+		/** Runs everything queued so far on the calling thread, returns once it is on disk */
+		void Flush();
+
+		TWeakObjectPtr<UCUFileSubsystem> FileSubsystem;
+
+	protected:
+		//Guards Ops and bDrainQueued, never held during file IO
+		FCriticalSection QueueSection;
+		TArray<FOp> Ops;
+		bool bDrainQueued = false;
+
+		//Held while a batch runs so batches hit the file in order
+		FCriticalSection WriteSection;
+	};
+
+	TSharedRef<FJournalWriter, ESPMode::ThreadSafe> Writer;
+
+	FCriticalSection Section;
+
+	TArray<FSIOOutboxEntry> MemoryEntries;
+	int64 MemoryBytes;
+
+	//While spilled the journal holds every pending entry and new ones append to it.
+	//JournalPending mirrors it oldest first without payloads.
+	bool bSpilled;
+	TArray<FSIOOutboxEntry> JournalPending;
+	int32 JournalRecordCount;
+	FString JournalPath;
+	FString RequestedJournalPath;
+	TWeakObjectPtr<UCUFileSubsystem> FileSubsystem;
+
+	//ids stay unique across runs
+	FString InstanceId;
+	uint64 NextSequence;
+};
@@ -0,0 +1,106 @@
+// Copyright 2018-current Getnamo. All Rights Reserved
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "SIOJsonPath.h"
+#include "sio_client.h"
+#include <atomic>
+
+/**
+* Cells of the XY plane touched by the regions a client is interested in, e.g. a sphere around the
+* camera. The game thread replaces the regions (once per tick is fine), any thread may query. Queries
+* only take a lock to grab the current cell set, the lookup itself is a hash probe.
+*/
+class SOCKETIOCLIENT_API FSIOInterestGrid
+{
+public:
+	explicit FSIOInterestGrid(float InCellSize = 5000.f);
+
+	/** Replaces the interest regions, positions in any cell a region overlaps become relevant */
+	void SetRegions(TArrayView<const FSphere> Regions);
+
+	/** True if the position is in a cell a region overlaps */
+	bool IsRelevant(double X, double Y) const;
+
+	float GetCellSize() const
+	{
+		return CellSize;
+	}
+
+	/** Positions pass while no regions were set yet, e.g. before the local pawn exists. Default true. */
+	bool bRelevantWithoutRegions;
+
+protected:
+	typedef TSharedPtr<const TSet<FIntPoint>, ESPMode::ThreadSafe> FCellSetPtr;
+
+	const float CellSize;
+
+	mutable FCriticalSection Section;
+	FCellSetPtr Cells;
+};
+
+typedef TSharedPtr<FSIOInterestGrid, ESPMode::ThreadSafe> FSIOInterestGridPtr;
+
+/**
+* Drops entity updates outside a client's interest straight on the network thread, before they are
+* converted to FJsonValue or handed to the game thread. Only the position (and the id if there are
+* always relevant ids) is read from the raw sio::message through compiled paths. An update message is
+* an entity object or an array of them, arrays are filtered per entity.
+*
+* Entities without a readable position pass, so unrelated messages on a filtered event aren't lost.
+*/
+class SOCKETIOCLIENT_API FSIORelevanceFilter
+{
+public:
+	/**
+	* @param InGrid			Interest grid the positions are tested against
+	* @param PositionPath	Path of the entity position object with x and y fields e.g. "location" or "state.pos"
+	* @param InIdPath		Path of the entity id, only read for always relevant ids
+	*/
+	FSIORelevanceFilter(const FSIOInterestGridPtr& InGrid, const FString& PositionPath = TEXT("location"), const FString& InIdPath = TEXT("id"));
+
+	/** Entities that pass wherever they are, e.g. the local player or party members. Any thread. */
+	void SetAlwaysRelevant(const TArray<FString>& Ids);
+
+	/**
+	* Removes irrelevant entities from Message. Returns false if nothing relevant is left, the message
+	* should then be dropped. A filtered array is a new message, the original is not modified.
+	*/
+	bool Filter(sio::message::ptr& InOutMessage) const;
+
+	/** True if the entity passes */
+	bool IsRelevant(const sio::message::ptr& Entity) const;
+
+	FSIOInterestGridPtr GetGrid() const
+	{
+		return Grid;
+	}
+
+	/** Entities dropped and passed so far, for diagnostics */
+	int64 NumDropped() const
+	{
+		return DroppedCount.load();
+	}
+
+	int64 NumPassed() const
+	{
+		return PassedCount.load();
+	}
+
+protected:
+	typedef TSharedPtr<const TSet<FString>, ESPMode::ThreadSafe> FIdSetPtr;
+
+	FSIOInterestGridPtr Grid;
+	FSIOJsonPath XPath;
+	FSIOJsonPath YPath;
+	FSIOJsonPath IdPath;
+
+	mutable FCriticalSection IdSection;
+	FIdSetPtr AlwaysRelevant;
+
+	mutable std::atomic<int64> DroppedCount{ 0 };
+	mutable std::atomic<int64> PassedCount{ 0 };
+};
+
+typedef TSharedPtr<FSIORelevanceFilter, ESPMode::ThreadSafe> FSIORelevanceFilterPtr;
@@ -0,0 +1,128 @@
+// Copyright 2018-current Getnamo. All Rights Reserved
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Async/Future.h"
+#include "Dom/JsonValue.h"
+#include "CULambdaRunnable.h"
+
+#if defined(__cpp_impl_coroutine) && __has_include(<coroutine>)
+#include <coroutine>
+#define SIO_WITH_COROUTINES 1
+#else
+#define SIO_WITH_COROUTINES 0
+#endif
+
+enum class ESIORpcStatus : uint8
+{
+	Ok,
+	TimedOut,		//No ack before the deadline
+	Cancelled,		//Cancelled through its FSIORpcCancellation
+	Disconnected	//Connection closed while the call was pending
+};
+
+/** Outcome of an acked emit made through FSocketIONative::EmitRpc */
+struct SOCKETIOCLIENT_API FSIORpcResult
+{
+	ESIORpcStatus Status = ESIORpcStatus::Ok;
+
+	/** Ack arguments, empty unless Status is Ok */
+	TArray<TSharedPtr<FJsonValue>> Response;
+
+	bool IsOk() const { return Status == ESIORpcStatus::Ok; }
+};
+
+/**
+* Cancellation token, can be shared by every call of a flow.
+* Cancelled calls resolve with ESIORpcStatus::Cancelled and drop their late ack.
+*/
+class SOCKETIOCLIENT_API FSIORpcCancellation
+{
+public:
+	void Cancel();
+
+	bool IsCancelled() const;
+
+	/** Runs OnCancel once cancelled, immediately if already cancelled */
+	void OnCancelled(TFunction<void()> OnCancel);
+
+private:
+	mutable FCriticalSection Section;
+	bool bCancelled = false;
+	TArray<TFunction<void()>> Callbacks;
+};
+
+typedef TSharedPtr<FSIORpcCancellation, ESPMode::ThreadSafe> FSIORpcCancellationPtr;
+
+#if SIO_WITH_COROUTINES
+/**
+* co_await adapter for a TFuture. Resumes on the thread that completed the future,
+* or on the game thread if bResumeOnGameThread is set.
+*/
+template<typename ResultType>
+class TSIOFutureAwaitable
+{
+public:
+	TSIOFutureAwaitable(TFuture<ResultType>&& InFuture, bool bInResumeOnGameThread)
+		: Future(MoveTemp(InFuture))
+		, bResumeOnGameThread(bInResumeOnGameThread)
+	{
+	}
+
+	bool await_ready() const
+	{
+		return Future.IsReady() && (!bResumeOnGameThread || IsInGameThread());
+	}
+
+	void await_suspend(std::coroutine_handle<> Handle)
+	{
+		//The continuation may resume and destroy this awaitable before Then returns, don't touch members after it
+		TFuture<ResultType> Pending = MoveTemp(Future);
+		ResultType* ResultSlot = &Result;
+		const bool bGameThread = bResumeOnGameThread;
+
+		Pending.Then([Handle, ResultSlot, bGameThread](TFuture<ResultType> Completed)
+		{
+			*ResultSlot = Completed.Consume();
+			if (bGameThread && !IsInGameThread())
+			{
+				FCULambdaRunnable::RunShortLambdaOnGameThread([Handle]
+				{
+					Handle.resume();
+				});
+			}
+			else
+			{
+				Handle.resume();
+			}
+		});
+	}
+
+	ResultType await_resume()
+	{
+		if (Future.IsValid())
+		{
+			return Future.Consume();
+		}
+		return MoveTemp(Result);
+	}
+
+private:
+	TFuture<ResultType> Future;
+	ResultType Result;
+	bool bResumeOnGameThread;
+};
+#endif
+
+class SOCKETIOCLIENT_API FSIORpc
+{
+public:
+	/** Resolves once every future has, results keep the order of Futures */
+	static TFuture<TArray<FSIORpcResult>> WhenAll(TArray<TFuture<FSIORpcResult>>&& Futures);
+
+#if SIO_WITH_COROUTINES
+	/** co_await form of WhenAll */
+	static TSIOFutureAwaitable<TArray<FSIORpcResult>> AwaitAll(TArray<TFuture<FSIORpcResult>>&& Futures, bool bResumeOnGameThread = true);
+#endif
+};
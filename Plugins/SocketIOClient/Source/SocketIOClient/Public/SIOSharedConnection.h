@@ -0,0 +1,91 @@
+// Copyright 2018-current Getnamo. All Rights Reserved
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "sio_client.h"
+
+class FSocketIONative;
+struct FSIOConnectParams;
+
+/**
+* One sio::client, and so one websocket and engine.io session, shared by every FSocketIONative with
+* bShareConnection that connects to the same address, path, auth, query and headers. Like the socket.io
+* JS Manager: each native keeps its own bindings, callbacks and namespaces. Connection callbacks are
+* fanned out to the attached natives and the connection closes when the last one detaches.
+*/
+class SOCKETIOCLIENT_API FSIOSharedConnection
+{
+public:
+	typedef TSharedPtr<FSIOSharedConnection, ESPMode::ThreadSafe> FPtr;
+
+	/** Pool key for the connect params, sharing only happens between equal keys */
+	static FString MakeKey(const FSIOConnectParams& Params, bool bUseTLS, bool bVerifyTLSCertificate);
+
+	/** The pooled connection for Key, made if there is none yet. It stays pooled until the caller attaches, Attach to hold it. */
+	static FPtr Acquire(const FString& Key, bool bUseTLS, bool bVerifyTLSCertificate);
+
+	/** Number of pooled connections, for diagnostics */
+	static int32 NumPooled();
+
+	/** Namespaces are normalized like sio::client does, "" and "chat" become "/" and "/chat" */
+	static FString NormalizeNamespace(const FString& Namespace);
+
+	FSIOSharedConnection(const FString& InKey, bool bUseTLS, bool bVerifyTLSCertificate);
+
+	const FString Key;
+
+	TSharedPtr<sio::client> Client;
+
+	/** Adds the native and replays already open namespaces it uses to it, call once after Acquire */
+	void Attach(FSocketIONative* Native);
+
+	/**
+	* Removes the native, leaves namespaces nobody else uses. The last native out drops the connection
+	* from the pool and closes it, synchronously if bSyncClose.
+	*/
+	void Detach(FSocketIONative* Native, bool bSyncClose);
+
+	int32 NumAttached();
+
+	/** True if every attached native is in Closing, nobody else would lose the connection if it were dropped */
+	bool IsOnlyAttachedBy(const TSet<const FSocketIONative*>& Closing);
+
+	/** Marks Namespace as used by Native so it receives that namespace's callbacks */
+	void UseNamespace(FSocketIONative* Native, const FString& Namespace);
+
+	/** Returns true if no other attached native uses Namespace, the caller may then leave it */
+	bool ReleaseNamespace(FSocketIONative* Native, const FString& Namespace);
+
+	/** Connects on a background thread unless already open or opening. First caller's settings win. */
+	void Connect(const std::string& Address, const std::string& Path,
+		const std::map<std::string, std::string>& Query,
+		const std::map<std::string, std::string>& Headers,
+		const sio::message::ptr& Auth,
+		uint32 MaxReconnectionAttempts, uint32 ReconnectionDelay);
+
+protected:
+	/** Client listeners that fan out to attached natives, installed once the connection is shared */
+	void SetupClientListeners();
+
+	/** Runs Callback for every attached native using Namespace, or every native if Namespace is empty */
+	void ForEachNative(const FString& Namespace, TFunctionRef<void(FSocketIONative*)> Callback);
+
+	//Guards Natives and OpenNamespaces, never held while calling into a native
+	FCriticalSection Section;
+
+	//Held while a native is called, Detach takes it so a native is not destroyed mid callback.
+	//Also held across open namespace changes and their callbacks so Attach replays each one exactly once.
+	FCriticalSection DispatchSection;
+
+	//Attached natives and the namespaces each uses
+	TMap<FSocketIONative*, TSet<FString>> Natives;
+	TSet<FString> OpenNamespaces;
+
+	//Acquired but not yet attached, the connection isn't closed while any are pending
+	int32 NumAcquiring = 0;
+
+	FCriticalSection ConnectSection;
+
+	TWeakPtr<FSIOSharedConnection, ESPMode::ThreadSafe> WeakSelf;
+};
@@ -0,0 +1,178 @@
+// Copyright 2018-current Getnamo. All Rights Reserved
+
+#pragma once
+
+#include "Components/ActorComponent.h"
+#include "Dom/JsonObject.h"
+#include "SIOSnapshotInterpolationComponent.generated.h"
+
+class USocketIOClientComponent;
+
+/** Transform of a remote actor at a point in sender time */
+USTRUCT(BlueprintType)
+struct SOCKETIOCLIENT_API FSIOTransformSnapshot
+{
+	GENERATED_BODY()
+
+	/** Sender (server) time in seconds */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "SocketIO Interpolation")
+	double Time = 0.0;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "SocketIO Interpolation")
+	FVector Location = FVector::ZeroVector;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "SocketIO Interpolation")
+	FRotator Rotation = FRotator::ZeroRotator;
+
+	/** Velocity in cm/s, used as the curve tangent if bHasVelocity */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "SocketIO Interpolation")
+	FVector Velocity = FVector::ZeroVector;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "SocketIO Interpolation")
+	bool bHasVelocity = false;
+
+	/** Reads {"time", "location", "rotation", "velocity"?}, false if time or location are missing */
+	static bool FromJson(const TSharedPtr<FJsonObject>& Object, FSIOTransformSnapshot& OutSnapshot);
+};
+
+/**
+* Moves its owner along timestamped transform snapshots of a remote actor. Snapshots are kept in a
+* small ring buffer and rendered a fixed delay behind the estimated server time, so there is usually
+* a snapshot on either side to interpolate between (hermite for location, slerp for rotation). If
+* snapshots stop arriving the owner is extrapolated by its velocity for a bounded time, then held.
+* Remote actors look smooth at 10-20 Hz snapshot rates.
+*
+* Server time is estimated from ping samples (AddClockSample / RequestClockSample), the sample with
+* the lowest round trip wins. Without samples the snapshot arrival times are used instead.
+*/
+UCLASS(BlueprintType, ClassGroup = "Networking", meta = (BlueprintSpawnableComponent))
+class SOCKETIOCLIENT_API USIOSnapshotInterpolationComponent : public UActorComponent
+{
+	GENERATED_UCLASS_BODY()
+public:
+
+	/** Seconds the owner is rendered behind server time, ~2 snapshot intervals hides one lost snapshot */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "SocketIO Interpolation", meta = (ClampMin = "0"))
+	float InterpolationDelay;
+
+	/** Seconds the owner keeps moving past the newest snapshot before it is held in place */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "SocketIO Interpolation", meta = (ClampMin = "0"))
+	float MaxExtrapolation;
+
+	/** Snapshots kept, older ones are overwritten. Applied on the next snapshot. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "SocketIO Interpolation", meta = (ClampMin = "2"))
+	int32 BufferSize;
+
+	/** Moves longer than this teleport instead of sweeping physics along */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "SocketIO Interpolation")
+	float TeleportDistance;
+
+	/** Ping samples kept for the clock estimate */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "SocketIO Interpolation", meta = (ClampMin = "1"))
+	int32 ClockSampleCount;
+
+	/** Owners closer than this to the local camera update every frame */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "SocketIO Interpolation|Throttling")
+	float FullRateDistance;
+
+	/** Owners at or beyond this distance update every MaxThrottledInterval seconds */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "SocketIO Interpolation|Throttling")
+	float ThrottledDistance;
+
+	/** Update interval at ThrottledDistance, 0 disables throttling */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "SocketIO Interpolation|Throttling", meta = (ClampMin = "0"))
+	float MaxThrottledInterval;
+
+	/**
+	* Add a snapshot, snapshots not newer than the newest one are dropped. One further back than the
+	* buffer span plus delay and extrapolation is taken as a server clock reset, the buffer and clock
+	* samples are cleared and it is kept.
+	*/
+	UFUNCTION(BlueprintCallable, Category = "SocketIO Interpolation")
+	void AddSnapshot(const FSIOTransformSnapshot& Snapshot);
+
+	/**
+	* Add a ping sample for the server clock estimate.
+	*
+	* @param ServerTime			Server time in seconds when it answered
+	* @param RoundTripTime		Seconds from sending the ping to receiving the answer
+	*/
+	UFUNCTION(BlueprintCallable, Category = "SocketIO Interpolation")
+	void AddClockSample(double ServerTime, float RoundTripTime);
+
+	/**
+	* Emit EventName with an ack and add the server time the server acks with as a clock sample.
+	* e.g. socket.on('time', (ack) => ack(performance.timeOrigin / 1000 + performance.now() / 1000))
+	*/
+	UFUNCTION(BlueprintCallable, Category = "SocketIO Interpolation")
+	void RequestClockSample(USocketIOClientComponent* Client, const FString& EventName = TEXT("time"), const FString& Namespace = TEXT("/"));
+
+	/**
+	* Add every snapshot received on EventName. Replaces a previous bind.
+	*
+	* @param Client			Socket.io client to listen on
+	* @param EventName		Event carrying snapshot objects
+	* @param Namespace		Optional namespace
+	* @param IdField		Optional field holding the actor id, with Id only matching snapshots are added
+	* @param Id				Id of this actor
+	*/
+	UFUNCTION(BlueprintCallable, Category = "SocketIO Interpolation")
+	void BindToSocketEvent(USocketIOClientComponent* Client, const FString& EventName, const FString& Namespace = TEXT("/"), const FString& IdField = TEXT(""), const FString& Id = TEXT(""));
+
+	UFUNCTION(BlueprintCallable, Category = "SocketIO Interpolation")
+	void UnbindFromSocketEvent();
+
+	/** Drop buffered snapshots, e.g. on respawn */
+	UFUNCTION(BlueprintCallable, Category = "SocketIO Interpolation")
+	void ClearSnapshots();
+
+	/** Estimated current server time in seconds */
+	UFUNCTION(BlueprintPure, Category = "SocketIO Interpolation")
+	double GetServerTime() const;
+
+	/** Server time the owner is currently rendered at */
+	UFUNCTION(BlueprintPure, Category = "SocketIO Interpolation")
+	double GetRenderTime() const;
+
+	/**
+	* Transform at a server time, interpolated or extrapolated from the buffered snapshots.
+	* Returns false if no snapshot was received yet.
+	*/
+	bool Sample(double Time, FVector& OutLocation, FQuat& OutRotation) const;
+
+	virtual void TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction) override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+protected:
+	struct FBufferedSnapshot
+	{
+		FSIOTransformSnapshot Snapshot;
+		FQuat Rotation;
+
+		//sender time minus local arrival time, the largest one had the shortest trip
+		double ArrivalOffset;
+	};
+
+	struct FClockSample
+	{
+		double Offset;
+		float RoundTripTime;
+	};
+
+	//oldest first
+	const FBufferedSnapshot& GetSnapshot(int32 Index) const;
+	FVector GetTangent(int32 Index) const;
+	double GetClockOffset() const;
+	void UpdateTickInterval();
+
+	//ring buffer of Count snapshots starting at Head
+	TArray<FBufferedSnapshot> Snapshots;
+	int32 Head;
+	int32 Count;
+
+	//oldest first
+	TArray<FClockSample> ClockSamples;
+
+	TWeakObjectPtr<USocketIOClientComponent> BoundClient;
+	uint32 ListenerId;
+};
@@ -0,0 +1,308 @@
+// Copyright 2018-current Getnamo. All Rights Reserved
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Dom/JsonValue.h"
+#include "Dom/JsonObject.h"
+#include "Templates/IsEnum.h"
+#include "Templates/IsSigned.h"
+#include "sio_socket.h"
+#include "SIOJTypedArray.h"
+
+#if defined(__cpp_consteval)
+#define SIO_CONSTEVAL consteval
+#else
+#define SIO_CONSTEVAL constexpr
+#endif
+
+/**
+* Event name for typed emits. Literal names are hashed at compile time, the escaped
+* UTF-8 form is built once per distinct name and reused by every later emit.
+*/
+struct SOCKETIOCLIENT_API FSIOEventName
+{
+	/** String literal only, anything else goes through the FString constructor */
+	template<uint32 N>
+	SIO_CONSTEVAL FSIOEventName(const TCHAR(&InName)[N])
+		: Name(InName)
+		, Length(N - 1)
+		, Hash(HashName(InName, N - 1))
+	{
+	}
+
+	/** Only valid while InName is, don't keep the event name around */
+	FSIOEventName(const FString& InName)
+		: Name(*InName)
+		, Length(InName.Len())
+		, Hash(HashName(*InName, InName.Len()))
+	{
+	}
+
+	const TCHAR* Name;
+	int32 Length;
+	uint32 Hash;
+
+	/** FNV-1a over the TCHAR code units */
+	static constexpr uint32 HashName(const TCHAR* InName, int32 InLength)
+	{
+		uint32 Result = 2166136261u;
+		for (int32 i = 0; i < InLength; i++)
+		{
+			Result = (Result ^ (uint32)InName[i]) * 16777619u;
+		}
+		return Result;
+	}
+};
+
+/** Typed emit argument sent as a typed array binary instead of a json number array, see FSIOJTypedArray */
+template<typename T>
+struct TSIOTypedArrayArg
+{
+	TArrayView<const T> Values;
+};
+
+/** e.g. EmitTyped(TEXT("heights"), SIOTypedArray(Heights)). float, int32, uint16, FVector3f or FVector (sent as floats). */
+template<typename T, typename AllocatorType>
+TSIOTypedArrayArg<T> SIOTypedArray(const TArray<T, AllocatorType>& Values)
+{
+	return TSIOTypedArrayArg<T>{ TArrayView<const T>(Values) };
+}
+
+/**
+* View of a typed array binary received as a raw sio::message e.g. in OnRawEvent, the elements are
+* read from the received buffer in place. Holds a reference to the buffer so it can outlive the callback.
+*/
+template<typename T>
+class TSIOTypedArrayView
+{
+public:
+	TSIOTypedArrayView()
+	{
+	}
+
+	/** Empty if Message isn't a binary holding a typed array of T */
+	explicit TSIOTypedArrayView(const sio::message::ptr& Message)
+	{
+		if (Message && Message->get_flag() == sio::message::flag_binary && Message->get_binary())
+		{
+			const std::shared_ptr<const std::string>& Bytes = Message->get_binary();
+			if (FSIOJTypedArray::View((const uint8*)Bytes->data(), (int64)Bytes->size(), Elements))
+			{
+				Buffer = Bytes;
+			}
+		}
+	}
+
+	bool IsValid() const
+	{
+		return Buffer != nullptr;
+	}
+
+	TArrayView<const T> Get() const
+	{
+		return Elements;
+	}
+
+	int32 Num() const
+	{
+		return Elements.Num();
+	}
+
+	const T& operator[](int32 Index) const
+	{
+		return Elements[Index];
+	}
+
+	const T* begin() const { return Elements.GetData(); }
+	const T* end() const { return Elements.GetData() + Elements.Num(); }
+
+private:
+	std::shared_ptr<const std::string> Buffer;
+	TArrayView<const T> Elements;
+};
+
+/** Cached encoded form of an FSIOEventName */
+struct FSIOEncodedEventName
+{
+	FString Name;
+	std::string Utf8;
+	std::string Quoted;
+};
+
+/**
+* Serializes C++ arguments straight into the event JSON, no FJsonValue or sio::message tree is built.
+* Supported: bool, integers, floats, enums, FString, FName, FText, TCHAR*, vectors, rotators, quats,
+* TArray of any supported type, TArray<uint8> as binary attachment, FJsonValue/FJsonObject and
+* USTRUCTs (same keys FJsonObjectConverter writes, see FSIOJStructPlan).
+*/
+class SOCKETIOCLIENT_API FSIOTypedEmit
+{
+public:
+	template<typename... ArgTypes>
+	static sio::prepared_packet::ptr Encode(const FSIOEventName& EventName, const ArgTypes&... Args)
+	{
+		const FSIOEncodedEventName& Name = ResolveEventName(EventName);
+
+		sio::event_writer Writer;
+		Writer.begin_event(Name.Quoted);
+		(Write(Writer, Args), ...);
+		return Writer.finish(Name.Utf8);
+	}
+
+	static const FSIOEncodedEventName& ResolveEventName(const FSIOEventName& EventName);
+
+	/** Event with a single struct argument whose type is only known at runtime */
+	static sio::prepared_packet::ptr EncodeStruct(const FSIOEventName& EventName, const UStruct* Struct, const void* StructPtr);
+
+	/** EncodeStruct with the struct as a compact binary attachment, see USIOJConvert::StructToCompactBytes */
+	static sio::prepared_packet::ptr EncodeCompactStruct(const FSIOEventName& EventName, const UStruct* Struct, const void* StructPtr);
+
+	static void Write(sio::event_writer& Writer, bool Value)
+	{
+		Writer.bool_value(Value);
+	}
+
+	template<typename T>
+	static typename TEnableIf<TIsIntegral<T>::Value>::Type Write(sio::event_writer& Writer, T Value)
+	{
+		if constexpr (TIsSigned<T>::Value)
+		{
+			Writer.int_value((int64)Value);
+		}
+		else
+		{
+			Writer.uint_value((uint64)Value);
+		}
+	}
+
+	template<typename T>
+	static typename TEnableIf<TIsFloatingPoint<T>::Value>::Type Write(sio::event_writer& Writer, T Value)
+	{
+		Writer.double_value((double)Value);
+	}
+
+	template<typename T>
+	static typename TEnableIf<TIsEnum<T>::Value>::Type Write(sio::event_writer& Writer, T Value)
+	{
+		Writer.int_value((int64)Value);
+	}
+
+	template<typename T>
+	static void Write(sio::event_writer& Writer, TEnumAsByte<T> Value)
+	{
+		Writer.int_value((int64)Value.GetValue());
+	}
+
+	static void Write(sio::event_writer& Writer, const FString& Value)
+	{
+		WriteString(Writer, *Value, Value.Len());
+	}
+
+	static void Write(sio::event_writer& Writer, const TCHAR* Value)
+	{
+		WriteString(Writer, Value, FCString::Strlen(Value));
+	}
+
+	static void Write(sio::event_writer& Writer, const FName& Value)
+	{
+		Write(Writer, Value.ToString());
+	}
+
+	static void Write(sio::event_writer& Writer, const FText& Value)
+	{
+		Write(Writer, Value.ToString());
+	}
+
+	template<typename T>
+	static void Write(sio::event_writer& Writer, const UE::Math::TVector<T>& Value)
+	{
+		Writer.start_object();
+		Writer.key("x", 1);
+		Writer.double_value(Value.X);
+		Writer.key("y", 1);
+		Writer.double_value(Value.Y);
+		Writer.key("z", 1);
+		Writer.double_value(Value.Z);
+		Writer.end_object();
+	}
+
+	template<typename T>
+	static void Write(sio::event_writer& Writer, const UE::Math::TVector2<T>& Value)
+	{
+		Writer.start_object();
+		Writer.key("x", 1);
+		Writer.double_value(Value.X);
+		Writer.key("y", 1);
+		Writer.double_value(Value.Y);
+		Writer.end_object();
+	}
+
+	template<typename T>
+	static void Write(sio::event_writer& Writer, const UE::Math::TRotator<T>& Value)
+	{
+		Writer.start_object();
+		Writer.key("pitch", 5);
+		Writer.double_value(Value.Pitch);
+		Writer.key("yaw", 3);
+		Writer.double_value(Value.Yaw);
+		Writer.key("roll", 4);
+		Writer.double_value(Value.Roll);
+		Writer.end_object();
+	}
+
+	template<typename T>
+	static void Write(sio::event_writer& Writer, const UE::Math::TQuat<T>& Value)
+	{
+		Writer.start_object();
+		Writer.key("x", 1);
+		Writer.double_value(Value.X);
+		Writer.key("y", 1);
+		Writer.double_value(Value.Y);
+		Writer.key("z", 1);
+		Writer.double_value(Value.Z);
+		Writer.key("w", 1);
+		Writer.double_value(Value.W);
+		Writer.end_object();
+	}
+
+	/** Sent as a binary attachment like a TArray<uint8> passed to EmitRaw */
+	static void Write(sio::event_writer& Writer, const TArray<uint8>& Value);
+
+	/** Typed array binary attachment, encoded straight into the attachment buffer */
+	template<typename T>
+	static void Write(sio::event_writer& Writer, const TSIOTypedArrayArg<T>& Value)
+	{
+		std::string Bytes;
+		Bytes.resize((size_t)FSIOJTypedArray::EncodedSize(Value.Values));
+		FSIOJTypedArray::Encode(Value.Values, (uint8*)&Bytes[0]);
+		Writer.binary_value(std::make_shared<const std::string>(MoveTemp(Bytes)));
+	}
+
+	template<typename T, typename AllocatorType>
+	static void Write(sio::event_writer& Writer, const TArray<T, AllocatorType>& Value)
+	{
+		Writer.start_array();
+		for (const T& Item : Value)
+		{
+			Write(Writer, Item);
+		}
+		Writer.end_array();
+	}
+
+	static void Write(sio::event_writer& Writer, const TSharedPtr<FJsonValue>& Value);
+
+	static void Write(sio::event_writer& Writer, const TSharedPtr<FJsonObject>& Value);
+
+	/** Any USTRUCT */
+	template<typename T>
+	static auto Write(sio::event_writer& Writer, const T& Value) -> decltype(T::StaticStruct(), void())
+	{
+		WriteStruct(Writer, T::StaticStruct(), &Value);
+	}
+
+	static void WriteString(sio::event_writer& Writer, const TCHAR* Value, int32 Length);
+
+	/** Same json USIOJConvert::StructToBytes writes, through the struct's cached FSIOJStructPlan */
+	static void WriteStruct(sio::event_writer& Writer, const UStruct* Struct, const void* StructPtr);
+};
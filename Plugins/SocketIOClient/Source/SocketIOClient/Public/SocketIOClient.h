@@ -4,8 +4,24 @@
 #pragma once
 
 #include "Runtime/Core/Public/Modules/ModuleManager.h"
+#include "Async/Future.h"
 class FSocketIONative;
 
+/** What ReleaseAllNativePointersAsync got done before its deadline */
+struct FSIOTeardownReport
+{
+	/** Natives that finished disconnecting in time */
+	int32 Closed = 0;
+
+	/** Address and session of each native still disconnecting at the deadline whose connection was aborted */
+	TArray<FString> Aborted;
+
+	/** Natives still disconnecting at the deadline on a shared connection a native outside the teardown uses, left open */
+	TArray<FString> SkippedShared;
+
+	double ElapsedSeconds = 0.0;
+};
+
 
 class SOCKETIOCLIENT_API ISocketIOClientModule : public IModuleInterface
 {
@@ -47,4 +63,10 @@ public:
 	* After calling this function make sure to set your pointer to nullptr.
 	*/
 	virtual void ReleaseNativePointer(TSharedPtr<FSocketIONative> PointerToRelease) {};
+
+	/**
+	* Releases every plugin scoped pointer, all disconnecting in parallel. Connections still closing after
+	* TimeoutInSec are aborted without the close handshake. The future is set when all closed or at the deadline.
+	*/
+	virtual TFuture<FSIOTeardownReport> ReleaseAllNativePointersAsync(float TimeoutInSec = 1.f) { return MakeFulfilledPromise<FSIOTeardownReport>().GetFuture(); };
 };
\ No newline at end of file
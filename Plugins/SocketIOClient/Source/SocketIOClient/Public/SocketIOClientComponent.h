@@ -5,6 +5,7 @@
 
 #include "Components/ActorComponent.h"
 #include "SocketIONative.h"
+#include "SIOJsonHandle.h"
 #include "Runtime/Engine/Classes/Engine/LatentActionManager.h"
 #include "SocketIOClientComponent.generated.h"
 
@@ -17,6 +18,7 @@ DECLARE_DYNAMIC_MULTICAST_DELEGATE_ThreeParams(FSIOConnectionProblemSignature, i
 
 //For Direct Delegate Event Bind
 DECLARE_DYNAMIC_DELEGATE_OneParam(FSIOJsonValueSignature, USIOJsonValue*, EventData);
+DECLARE_DYNAMIC_DELEGATE_OneParam(FSIOJsonHandleSignature, const FSIOJsonHandle&, EventData);
 
 UCLASS(BlueprintType, ClassGroup = "Networking", meta = (BlueprintSpawnableComponent))
 class SOCKETIOCLIENT_API USocketIOClientComponent : public UActorComponent
@@ -117,6 +119,40 @@ public:
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "SocketIO Connection Properties")
 	bool bVerboseConnectionLog;
 
+	/**
+	* Events emitted with latest-value conflation, one entry per event name and namespace. Repeated
+	* emits of these events overwrite a pending slot and are sent once per tick (or at the configured
+	* max rate). Applied when the native client initializes, use SetEventConflation to change at runtime.
+	*/
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "SocketIO Emit Properties")
+	TArray<FSIOConflationSettings> ConflatedEvents;
+
+	/**
+	* If true, emits without callbacks are packed into one '__batch' event per tick.
+	* Requires the server to unpack batches, see README for a node.js shim.
+	*/
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "SocketIO Emit Properties")
+	bool bBatchEmits;
+
+	/**
+	* Events on the default namespace whose emits are kept until the server acks them and replayed
+	* after reconnect with a dedup id. Applied when the native client initializes, see SetEventOutbox.
+	*/
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "SocketIO Emit Properties")
+	TArray<FString> OutboxEvents;
+
+	/** Bytes of unacked outbox emits kept in memory before spilling to the journal file */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "SocketIO Emit Properties")
+	int32 OutboxMemoryBudget;
+
+	/** Most unacked outbox emits kept, the oldest are dropped past it. 0 for no limit. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "SocketIO Emit Properties")
+	int32 OutboxMaxEntries;
+
+	/** Unacked outbox emits older than this are dropped instead of replayed. 0 for no limit. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "SocketIO Emit Properties")
+	float OutboxMaxAgeSeconds;
+
 
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "SocketIO Scope Properties")
 	bool bLimitConnectionToGameWorld;
@@ -134,6 +170,14 @@ public:
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "SocketIO Scope Properties")
 	FString PluginScopedId;
 
+	/**
+	* If true, components connecting to the same address, path, auth, query and headers share one
+	* connection and session, each keeping its own bindings and namespaces. The connection closes
+	* when the last component disconnects. The server sees them as one socket per namespace.
+	*/
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "SocketIO Scope Properties")
+	bool bShareConnection;
+
 	UPROPERTY(BlueprintReadOnly, Category = "SocketIO Connection Properties")
 	bool bIsConnected;
 
@@ -213,9 +257,10 @@ public:
 	* @param Name		Event name
 	* @param Message	SIOJJsonValue
 	* @param Namespace	Namespace within socket.io
+	* @param Priority	Optional send lane, use EMIT_BULK for large payloads
 	*/
 	UFUNCTION(BlueprintCallable, Category = "SocketIO Functions")
-	void Emit(const FString& EventName, USIOJsonValue* Message = nullptr, const FString& Namespace = TEXT("/"));
+	void Emit(const FString& EventName, USIOJsonValue* Message = nullptr, const FString& Namespace = TEXT("/"), ESIOEmitPriority Priority = EMIT_REALTIME);
 
 	/**
 	* Emit an event with a JsonValue message with a callback function defined by CallBackFunctionName
@@ -253,6 +298,33 @@ public:
 
 
 
+	/**
+	* Conflate outbound emits of this event, only the latest value per slot is sent each flush.
+	* Emits with callbacks are never conflated.
+	*
+	* @param EventName	Event name
+	* @param Settings	Optional key field, max flush rate and namespace
+	*/
+	UFUNCTION(BlueprintCallable, Category = "SocketIO Functions")
+	void SetEventConflation(const FString& EventName, const FSIOConflationSettings& Settings);
+
+	/**
+	* Stop conflating an event, pending values are sent immediately.
+	*/
+	UFUNCTION(BlueprintCallable, Category = "SocketIO Functions")
+	void ClearEventConflation(const FString& EventName, const FString& Namespace = TEXT("/"));
+
+	/**
+	* Keep emits of this event until acked and replay them in order after reconnect.
+	* Emits carry a trailing {"__outboxId": id} argument, the server must ack and deduplicate them.
+	*/
+	UFUNCTION(BlueprintCallable, Category = "SocketIO Functions")
+	void SetEventOutbox(const FString& EventName, const FString& Namespace = TEXT("/"));
+
+	/** Stop routing an event through the outbox */
+	UFUNCTION(BlueprintCallable, Category = "SocketIO Functions")
+	void ClearEventOutbox(const FString& EventName, const FString& Namespace = TEXT("/"));
+
 	/**
 	* Bind an event directly to a matching delegate. Drag off from red box or
 	* use create event option.
@@ -268,6 +340,20 @@ public:
 								const FString& Namespace = TEXT("/"),
 								ESIOThreadOverrideOption ThreadOverride = USE_DEFAULT);
 
+	/**
+	* Bind an event to a delegate receiving a json handle, no UObject is made per event.
+	* 
+	* @param EventName	Event name
+	* @param CallbackDelegate Delegate that needs to be bound
+	* @param Namespace	Optional namespace, defaults to default namespace
+	* @param ThreadOverride	Optional override to receive event on specified thread. Note NETWORK thread is lower latency but unsafe for a lot of blueprint use. Use with CAUTION.
+	*/
+	UFUNCTION(BlueprintCallable, Category = "SocketIO Functions")
+	void BindEventToHandleDelegate(	const FString& EventName, 
+									const FSIOJsonHandleSignature& CallbackDelegate, 
+									const FString& Namespace = TEXT("/"),
+									ESIOThreadOverrideOption ThreadOverride = USE_DEFAULT);
+
 	/**
 	* Bind an event, then respond to it with 'OnGenericEvent' multi-cast delegate.
 	* If you want functions or custom events to receive the event, use Bind Event To Function.
@@ -334,11 +420,13 @@ public:
 	* @param Message				FJsonValue
 	* @param CallbackFunction		Optional callback TFunction
 	* @param Namespace				Optional Namespace within socket.io
+	* @param Priority				Optional send lane, use EMIT_BULK for large payloads
 	*/
 	void EmitNative(const FString& EventName,
 					const TSharedPtr<FJsonValue>& Message = nullptr,
 					TFunction< void(const TArray<TSharedPtr<FJsonValue>>&)> CallbackFunction = nullptr,
-					const FString& Namespace = TEXT("/"));
+					const FString& Namespace = TEXT("/"),
+					ESIOEmitPriority Priority = EMIT_REALTIME);
 
 	/**
 	* (Overloaded) Emit an event with a Json Object message
@@ -412,11 +500,13 @@ public:
 	* @param BinaryMessage			Message in an TArray of uint8
 	* @param CallbackFunction		Optional callback TFunction
 	* @param Namespace				Optional Namespace within socket.io
+	* @param Priority				Optional send lane, use EMIT_BULK for large payloads
 	*/
 	void EmitNative(const FString& EventName,
 					const TArray<uint8>& BinaryMessage,
 					TFunction< void(const TArray<TSharedPtr<FJsonValue>>&)> CallbackFunction = nullptr,
-					const FString& Namespace = TEXT("/"));
+					const FString& Namespace = TEXT("/"),
+					ESIOEmitPriority Priority = EMIT_REALTIME);
 
 	/**
 	* (Overloaded) Emit an event with an array message
@@ -446,6 +536,37 @@ public:
 					TFunction< void(const TArray<TSharedPtr<FJsonValue>>&)> CallbackFunction = nullptr,
 					const FString& Namespace = TEXT("/"));
 
+	/**
+	* Emit an UStruct in the compact tagged binary format as a binary attachment, read it back with
+	* USIOJConvert::CompactBytesToStruct. See FSocketIONative::EmitCompact.
+	*
+	* @param EventName				Event name
+	* @param Struct					UStruct type usually obtained via e.g. FMyStructType::StaticStruct()
+	* @param StructPtr				Pointer to the actual struct memory e.g. &MyStruct
+	* @param Namespace				Optional Namespace within socket.io
+	* @param Priority				Optional send lane, use EMIT_BULK for large payloads
+	*/
+	void EmitNativeCompact(const FString& EventName,
+					const UStruct* Struct,
+					const void* StructPtr,
+					const FString& Namespace = TEXT("/"),
+					ESIOEmitPriority Priority = EMIT_REALTIME);
+
+	/**
+	* Emit only the changed fields of an UStruct against the last acked update, see FSocketIONative::EmitDelta. C++ only.
+	*
+	* @param EventName				Event name
+	* @param Struct					UScriptStruct type usually obtained via e.g. FMyStructType::StaticStruct()
+	* @param StructPtr				Pointer to the actual struct memory e.g. &MyStruct
+	* @param Namespace				Optional Namespace within socket.io
+	* @param Priority				Optional send lane
+	*/
+	void EmitNativeDelta(const FString& EventName,
+					const UScriptStruct* Struct,
+					const void* StructPtr,
+					const FString& Namespace = TEXT("/"),
+					ESIOEmitPriority Priority = EMIT_REALTIME);
+
 	/**
 	* Call function callback on receiving socket event. C++ only.
 	*
@@ -459,6 +580,33 @@ public:
 						const FString& Namespace = TEXT("/"),
 		ESIOThreadOverrideOption ThreadOverride = USE_DEFAULT);
 
+	/**
+	* Add a callback without replacing other bindings of the event. C++ only.
+	* All listeners share one converted JsonValue per message.
+	*
+	* @param EventName	Event name
+	* @param TFunction	Lambda callback, JSONValue
+	* @param Namespace	Optional namespace, defaults to default namespace
+	* @param ThreadOverride	Optional override to receive event on specified thread.
+	* @return Listener id for RemoveNativeEventListener
+	*/
+	uint32 AddNativeEventListener(const FString& EventName,
+						TFunction< void(const FString&, const TSharedPtr<FJsonValue>&)> CallbackFunction,
+						const FString& Namespace = TEXT("/"),
+		ESIOThreadOverrideOption ThreadOverride = USE_DEFAULT);
+
+	/** Remove a listener added with AddNativeEventListener */
+	void RemoveNativeEventListener(uint32 ListenerId);
+
+	/**
+	* Drop messages of an event on the network thread, see FSocketIONative::SetRelevanceFilter. C++ only.
+	*
+	* @param EventName	Event name
+	* @param Filter		Filter to run, nullptr removes it
+	* @param Namespace	Optional namespace, defaults to default namespace
+	*/
+	void SetNativeRelevanceFilter(const FString& EventName, const FSIORelevanceFilterPtr& Filter, const FString& Namespace = TEXT("/"));
+
 	/**
 	* Call function callback on receiving binary event. C++ only.
 	*
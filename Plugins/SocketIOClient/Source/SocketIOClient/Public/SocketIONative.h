@@ -8,7 +8,17 @@
 #include "SIOJsonValue.h"
 #include "SIOJConvert.h"
 #include "SIOMessageConvert.h"
+#include "SIORpc.h"
+#include "SIOOutbox.h"
+#include "SIOTypedEmit.h"
+#include "SIODelta.h"
+#include "SIODocumentStore.h"
+#include "SIORelevance.h"
+#include "SIOSharedConnection.h"
 #include "CoreMinimal.h"
+#include "Containers/Ticker.h"
+#include "Tasks/Task.h"
+#include <atomic>
 
 UENUM(BlueprintType)
 enum ESIOConnectionCloseReason
@@ -22,7 +32,16 @@ enum ESIOThreadOverrideOption
 {
 	USE_DEFAULT,
 	USE_GAME_THREAD,
-	USE_NETWORK_THREAD
+	USE_NETWORK_THREAD,
+	USE_WORKER_POOL		//Decode and callback on the task graph, serial per event (or per ordering key)
+};
+
+/** Send lane for an emit. Realtime emits are written ahead of queued bulk emits; bulk emits are paced and large ones are sent in chunks. */
+UENUM(BlueprintType)
+enum ESIOEmitPriority
+{
+	EMIT_REALTIME,
+	EMIT_BULK
 };
 
 //Used in early (pre-connection) binds and maintaining map if re-setting connection type
@@ -31,6 +50,7 @@ struct FSIOBoundEvent
 	TFunction< void(const FString&, const TSharedPtr<FJsonValue>&)> Function;
 	FString Namespace;
 	ESIOThreadOverrideOption ThreadOption;
+	FString OrderingKeyField;
 
 	FSIOBoundEvent()
 	{
@@ -39,11 +59,58 @@ struct FSIOBoundEvent
 	}
 };
 
+//Additional listener added next to the OnEvent binding, re-added on rebinds
+struct FSIOBoundListener : public FSIOBoundEvent
+{
+	TFunction< void(const FString&, const sio::message::ptr&)> RawFunction;	//set instead of Function for raw listeners
+	FString EventName;
+	uint32 SocketListenerId;
+
+	FSIOBoundListener()
+	{
+		SocketListenerId = 0;
+	}
+};
+
+/**
+* Event encoded once. Emit it through any number of FSocketIONative clients, namespaces or
+* repeatedly without serializing again. Prepared emits carry no callback.
+*/
+struct SOCKETIOCLIENT_API FSIOPreparedPacket
+{
+	sio::prepared_packet::ptr Packet;
+
+	static FSIOPreparedPacket Prepare(const FString& EventName, const TSharedPtr<FJsonValue>& Message = nullptr);
+
+	static FSIOPreparedPacket PrepareRaw(const FString& EventName, const sio::message::list& MessageList = nullptr);
+
+	/** Struct written straight to the packet through its cached FSIOJStructPlan */
+	static FSIOPreparedPacket PrepareStruct(const FString& EventName, const UStruct* Struct, const void* StructPtr);
+
+	/** Struct as a compact binary attachment, see FSocketIONative::EmitCompact */
+	static FSIOPreparedPacket PrepareCompactStruct(const FString& EventName, const UStruct* Struct, const void* StructPtr);
+
+	/** Arguments serialized straight to the packet, see FSIOTypedEmit for supported types */
+	template<typename... ArgTypes>
+	static FSIOPreparedPacket PrepareTyped(const FSIOEventName& EventName, const ArgTypes&... Args)
+	{
+		FSIOPreparedPacket Prepared;
+		Prepared.Packet = FSIOTypedEmit::Encode(EventName, Args...);
+		return Prepared;
+	}
+
+	bool IsValid() const { return Packet != nullptr; }
+
+	/** Encoded JSON body plus binary attachment bytes */
+	int64 EncodedSize() const { return Packet ? (int64)Packet->get_encoded_size() : 0; }
+};
+
 class SOCKETIOCLIENT_API FSocketIONative
 {
 public:
 	/** By default TLS verification is off. TLS mode will be set by URL on connect.*/
 	FSocketIONative(const bool bForceTLSMode = false, const bool bShouldVerifyTLSCertificate = false);
+	~FSocketIONative();
 
 	//Native Callbacks
 	TFunction<void(const FString& SocketId, const FString& SessionId)> OnConnectedCallback;					//TFunction<void(const FString& SessionId)>
@@ -95,6 +162,21 @@ public:
 	/** If true all events are unbound on disconnect */
 	bool bUnbindEventsOnDisconnect;
 
+	/** 
+	* If true, realtime emits without callbacks are packed into one '__batch' event per namespace
+	* and sent once per tick. An unbatched send (acked, bulk, prepared...) sends the pending batch of
+	* its namespace first, so emits keep their order. The server needs to unpack the batch (see README
+	* for a node.js shim). Received '__batch' events are always unpacked and dispatched to the individual event bindings.
+	*/
+	bool bBatchEmits;
+
+	/**
+	* If true, Connect shares one connection with every other sharing native that connects to the same
+	* address, path, auth, query and headers. Bindings, callbacks and namespaces stay per native. The
+	* server sees one socket per namespace for all of them. Set before connecting.
+	*/
+	bool bShareConnection;
+
 	/**
 	* Connect to a socket.io server, optional method if auto-connect is set to true.
 	* Overloaded function where you don't care about query and headers
@@ -134,6 +216,15 @@ public:
 
 	void SyncDisconnect();
 
+	/**
+	* Drops the connection without the close handshake, a SyncDisconnect blocked on it returns right away.
+	* Safe from any thread. A shared connection is only dropped if every native attached to it is in Closing.
+	*
+	* @param Closing	Natives being torn down together with this one
+	* @return false if the connection was left open because a native outside Closing still uses it
+	*/
+	bool AbortConnection(const TSet<const FSocketIONative*>& Closing = TSet<const FSocketIONative*>());
+
 	void ClearAllCallbacks();
 
 	/**
@@ -143,12 +234,14 @@ public:
 	* @param Message				FJsonValue
 	* @param CallbackFunction		Optional callback TFunction
 	* @param Namespace				Optional Namespace within socket.io
+	* @param Priority				Optional send lane, use EMIT_BULK for large payloads
 	*/
 	void Emit(
 		const FString& EventName,
 		const TSharedPtr<FJsonValue>& Message = nullptr,
 		TFunction< void(const TArray<TSharedPtr<FJsonValue>>&)> CallbackFunction = nullptr,
-		const FString& Namespace = TEXT("/"));
+		const FString& Namespace = TEXT("/"),
+		ESIOEmitPriority Priority = EMIT_REALTIME);
 
 	/**
 	* (Overloaded) Emit an event with a Json Object message
@@ -237,12 +330,14 @@ public:
 	* @param BinaryMessage			Message in an TArray of uint8
 	* @param CallbackFunction		Optional callback TFunction
 	* @param Namespace				Optional Namespace within socket.io
+	* @param Priority				Optional send lane, use EMIT_BULK for large payloads
 	*/
 	void Emit
 	(const FString& EventName,
 		const TArray<uint8>& BinaryMessage,
 		TFunction< void(const TArray<TSharedPtr<FJsonValue>>&)> CallbackFunction = nullptr,
-		const FString& Namespace = TEXT("/"));
+		const FString& Namespace = TEXT("/"),
+		ESIOEmitPriority Priority = EMIT_REALTIME);
 
 	/**
 	* (Overloaded) Emit an event with an array message
@@ -295,12 +390,14 @@ public:
 	* @param MessageList			Message in sio::message::list format
 	* @param CallbackFunction		Optional callback TFunction with raw signature
 	* @param Namespace				Optional Namespace within socket.io
+	* @param Priority				Optional send lane, use EMIT_BULK for large payloads
 	*/
 	void EmitRaw(
 		const FString& EventName,
 		const sio::message::list& MessageList = nullptr,
 		TFunction<void(const sio::message::list&)> CallbackFunction = nullptr,
-		const FString& Namespace = TEXT("/"));
+		const FString& Namespace = TEXT("/"),
+		ESIOEmitPriority Priority = EMIT_REALTIME);
 
 	/**
 	* Emit an optimized binary message
@@ -309,13 +406,211 @@ public:
 	* @param Data					Buffer Pointer
 	* @param DataLength				Buffer size
 	* @param Namespace				Optional Namespace within socket.io
+	* @param Priority				Optional send lane, use EMIT_BULK for large payloads
 	*/
 	void EmitRawBinary(
 		const FString& EventName,
 		uint8* Data,
 		int32 DataLength,
+		const FString& Namespace = TEXT("/"),
+		ESIOEmitPriority Priority = EMIT_REALTIME);
+
+	/**
+	* Emit an already encoded event. Skips conflation, batching and the outbox.
+	*
+	* @param Packet					Packet from FSIOPreparedPacket::Prepare
+	* @param Namespace				Optional Namespace within socket.io
+	* @param Priority				Optional send lane, use EMIT_BULK for large payloads
+	*/
+	void EmitPrepared(
+		const FSIOPreparedPacket& Packet,
+		const FString& Namespace = TEXT("/"),
+		ESIOEmitPriority Priority = EMIT_REALTIME);
+
+	/** EmitPrepared on every client, the packet is encoded once for all of them */
+	static void BroadcastPrepared(
+		const TArray<TSharedPtr<FSocketIONative>>& Clients,
+		const FSIOPreparedPacket& Packet,
+		const FString& Namespace = TEXT("/"),
+		ESIOEmitPriority Priority = EMIT_REALTIME);
+
+	/**
+	* Emit with each argument serialized straight into the packet, no FJsonValue or sio::message
+	* is built, e.g. EmitTyped(TEXT("move"), Position, Rotation, Sequence). Like EmitPrepared it
+	* skips conflation, batching and the outbox and carries no callback.
+	*
+	* @param EventName				Event name, literals are hashed at compile time
+	* @param Args					Arguments in order, see FSIOTypedEmit for supported types
+	*/
+	template<typename... ArgTypes>
+	void EmitTyped(const FSIOEventName& EventName, const ArgTypes&... Args)
+	{
+		EmitPrepared(FSIOPreparedPacket::PrepareTyped(EventName, Args...));
+	}
+
+	/** EmitTyped within a namespace */
+	template<typename... ArgTypes>
+	void EmitTypedTo(const FString& Namespace, const FSIOEventName& EventName, const ArgTypes&... Args)
+	{
+		EmitPrepared(FSIOPreparedPacket::PrepareTyped(EventName, Args...), Namespace);
+	}
+
+	/**
+	* Emit an UStruct in the compact tagged binary format, sent as a single binary attachment.
+	* Receivers read it with USIOJConvert::CompactBytesToStruct, which tolerates other versions
+	* of the struct. Like EmitPrepared it skips conflation, batching and the outbox.
+	*
+	* @param EventName				Event name
+	* @param Struct					UStruct type usually obtained via e.g. FMyStructType::StaticStruct()
+	* @param StructPtr				Pointer to the actual struct memory e.g. &MyStruct
+	* @param Namespace				Optional Namespace within socket.io
+	* @param Priority				Optional send lane, use EMIT_BULK for large payloads
+	*/
+	void EmitCompact(
+		const FString& EventName,
+		const UStruct* Struct,
+		const void* StructPtr,
+		const FString& Namespace = TEXT("/"),
+		ESIOEmitPriority Priority = EMIT_REALTIME);
+
+	/** EmitCompact for a USTRUCT value */
+	template<typename T>
+	void EmitCompact(const FString& EventName, const T& Value, const FString& Namespace = TEXT("/"), ESIOEmitPriority Priority = EMIT_REALTIME)
+	{
+		EmitCompact(EventName, T::StaticStruct(), &Value, Namespace, Priority);
+	}
+
+	/**
+	* Emit only the fields of an UStruct that changed since the last update the receiver acked,
+	* as {"seq":N,"base":B,"delta":{...}}, see FSIODeltaSender. An update is acked by the receiver
+	* acking the emit (any ack but false) or by calling AcknowledgeDelta, e.g. from a custom ack event.
+	* Each event and namespace is its own stream, reconnecting the namespace restarts it from defaults.
+	* Skips conflation, batching and the outbox.
+	*
+	* @param EventName				Event name
+	* @param Struct					UScriptStruct type usually obtained via e.g. FMyStructType::StaticStruct()
+	* @param StructPtr				Pointer to the actual struct memory e.g. &MyStruct
+	* @param Namespace				Optional Namespace within socket.io
+	* @param Priority				Optional send lane
+	*/
+	void EmitDelta(
+		const FString& EventName,
+		const UScriptStruct* Struct,
+		const void* StructPtr,
+		const FString& Namespace = TEXT("/"),
+		ESIOEmitPriority Priority = EMIT_REALTIME);
+
+	/** EmitDelta for a USTRUCT value */
+	template<typename T>
+	void EmitDelta(const FString& EventName, const T& Value, const FString& Namespace = TEXT("/"), ESIOEmitPriority Priority = EMIT_REALTIME)
+	{
+		EmitDelta(EventName, T::StaticStruct(), &Value, Namespace, Priority);
+	}
+
+	/** Marks delta Seq of EventName as applied by the receiver, later deltas are against it */
+	void AcknowledgeDelta(const FString& EventName, int64 Seq, const FString& Namespace = TEXT("/"));
+
+	/** Next EmitDelta of EventName is sent against the struct defaults, e.g. after the receiver reloaded */
+	void ResetDelta(const FString& EventName, const FString& Namespace = TEXT("/"));
+
+	/**
+	* Emit an event and resolve the future with its ack. Calls are independent, start several
+	* before waiting on any to overlap them. The future resolves on the network thread for acks
+	* and on the game thread for timeouts, don't block the game thread on it.
+	*
+	* @param EventName				Event name
+	* @param Message				FJsonValue
+	* @param TimeoutSeconds			Optional deadline, 0 = wait until ack or disconnect
+	* @param Namespace				Optional Namespace within socket.io
+	* @param Cancellation			Optional token, cancelling resolves the call with ESIORpcStatus::Cancelled
+	* @param Priority				Optional send lane, use EMIT_BULK for large payloads
+	*/
+	TFuture<FSIORpcResult> EmitRpc(
+		const FString& EventName,
+		const TSharedPtr<FJsonValue>& Message = nullptr,
+		float TimeoutSeconds = 0.f,
+		const FString& Namespace = TEXT("/"),
+		FSIORpcCancellationPtr Cancellation = nullptr,
+		ESIOEmitPriority Priority = EMIT_REALTIME);
+
+	/** EmitRpc as a UE::Tasks task, usable as a prerequisite for other tasks */
+	UE::Tasks::TTask<FSIORpcResult> EmitRpcTask(
+		const FString& EventName,
+		const TSharedPtr<FJsonValue>& Message = nullptr,
+		float TimeoutSeconds = 0.f,
+		const FString& Namespace = TEXT("/"),
+		FSIORpcCancellationPtr Cancellation = nullptr,
+		ESIOEmitPriority Priority = EMIT_REALTIME);
+
+#if SIO_WITH_COROUTINES
+	/** co_await form of EmitRpc, resumes on the game thread if bCallbackOnGameThread is set */
+	TSIOFutureAwaitable<FSIORpcResult> AwaitRpc(
+		const FString& EventName,
+		const TSharedPtr<FJsonValue>& Message = nullptr,
+		float TimeoutSeconds = 0.f,
+		const FString& Namespace = TEXT("/"),
+		FSIORpcCancellationPtr Cancellation = nullptr,
+		ESIOEmitPriority Priority = EMIT_REALTIME);
+#endif
+
+	/** Number of EmitRpc calls waiting on an ack */
+	int32 PendingRpcCount();
+
+
+	/**
+	* Conflate outbound emits of this event. Each emit overwrites a pending slot instead of
+	* sending a frame, and pending slots are sent once per tick (or at most MaxFlushRate per second).
+	* Emits with a callback are never conflated.
+	*
+	* @param EventName		Event name
+	* @param KeyField		Optional object field, each distinct value gets its own slot
+	* @param MaxFlushRate	Optional flush cap in Hz, 0 = once per tick
+	* @param Namespace		Optional Namespace within socket.io
+	*/
+	void SetEventConflation(
+		const FString& EventName,
+		const FString& KeyField = TEXT(""),
+		float MaxFlushRate = 0.f,
 		const FString& Namespace = TEXT("/"));
 
+	/**
+	* Stop conflating an event, pending slots are sent immediately.
+	*/
+	void ClearEventConflation(const FString& EventName, const FString& Namespace = TEXT("/"));
+
+	/**
+	* Keep emits of this event in the outbox until the server acks them. Emits made while offline
+	* are held and every unacked emit is replayed in order once the namespace reconnects. Each emit
+	* carries a trailing {"__outboxId": id} argument for server side deduplication, see README.
+	* Emits with a callback bypass the outbox.
+	*
+	* @param EventName		Event name
+	* @param Namespace		Optional Namespace within socket.io
+	*/
+	void SetEventOutbox(const FString& EventName, const FString& Namespace = TEXT("/"));
+
+	/** Stop routing an event through the outbox, already stored emits are still replayed */
+	void ClearEventOutbox(const FString& EventName, const FString& Namespace = TEXT("/"));
+
+	/**
+	* Journal file the outbox spills to past Outbox->MemoryBudget. The default is
+	* SocketIO/SIOOutbox-<hash of address and path>.journal in the external save directory, chosen
+	* on connect. Clients of the same server get numbered suffixes. An empty path restores the default.
+	*/
+	void SetOutboxJournalPath(const FString& Path);
+
+	/** Argument field carrying the dedup id of outbox emits */
+	static const TCHAR* OutboxIdField() { return TEXT("__outboxId"); }
+
+	/** Unacknowledged emits, memory budget and journal */
+	TSharedPtr<FSIOOutbox, ESPMode::ThreadSafe> Outbox;
+
+	/**
+	* Send pending conflated emits. Called automatically once per tick.
+	*
+	* @param bForce	Ignore MaxFlushRate limits and send everything pending
+	*/
+	void FlushOutbound(bool bForce = false);
 
 	/**
 	* Call function callback on receiving socket event. C++ only.
@@ -324,12 +619,14 @@ public:
 	* @param TFunction	Lambda callback, JSONValue
 	* @param Namespace	Optional namespace, defaults to default namespace
 	* @param CallbackThread Override default bCallbackOnGameThread option to specified option for this event
+	* @param OrderingKeyField USE_WORKER_POOL only: object field whose value orders callbacks, empty = ordered per event
 	*/
 	void OnEvent(
 		const FString& EventName,
 		TFunction< void(const FString&, const TSharedPtr<FJsonValue>&)> CallbackFunction,
 		const FString& Namespace = TEXT("/"),
-		ESIOThreadOverrideOption CallbackThread = USE_DEFAULT);
+		ESIOThreadOverrideOption CallbackThread = USE_DEFAULT,
+		const FString& OrderingKeyField = TEXT(""));
 
 	/**
 	* Call function callback on receiving raw event. C++ only. 
@@ -339,12 +636,14 @@ public:
 	* @param TFunction	Lambda callback, raw flavor
 	* @param Namespace	Optional namespace, defaults to default namespace
 	* @param CallbackThread Override default bCallbackOnGameThread option to specified option for this event
+	* @param OrderingKeyField USE_WORKER_POOL only: object field whose value orders callbacks, empty = ordered per event
 	*/
 	void OnRawEvent(
 		const FString& EventName,
 		TFunction< void(const FString&, const sio::message::ptr&)> CallbackFunction,
 		const FString& Namespace = TEXT("/"),
-		ESIOThreadOverrideOption CallbackThread = USE_DEFAULT);
+		ESIOThreadOverrideOption CallbackThread = USE_DEFAULT,
+		const FString& OrderingKeyField = TEXT(""));
 
 	/**
 	* Call function callback on receiving binary event. C++ only.
@@ -360,7 +659,67 @@ public:
 		const FString& Namespace = TEXT("/"));
 
 	/**
-	* Unbinds currently bound callback from given event.
+	* Adds a callback next to the OnEvent binding instead of replacing it. C++ only.
+	* The message is converted once and the same JsonValue is passed to every listener, treat it as read-only.
+	*
+	* @param EventName	Event name
+	* @param TFunction	Lambda callback, JSONValue
+	* @param Namespace	Optional namespace, defaults to default namespace
+	* @param CallbackThread Override default bCallbackOnGameThread option to specified option for this listener
+	* @param OrderingKeyField USE_WORKER_POOL only: object field whose value orders callbacks, empty = ordered per listener
+	* @return Listener id for RemoveEventListener
+	*/
+	uint32 AddEventListener(
+		const FString& EventName,
+		TFunction< void(const FString&, const TSharedPtr<FJsonValue>&)> CallbackFunction,
+		const FString& Namespace = TEXT("/"),
+		ESIOThreadOverrideOption CallbackThread = USE_DEFAULT,
+		const FString& OrderingKeyField = TEXT(""));
+
+	/**
+	* Raw flavor of AddEventListener, every listener receives the same sio::message. C++ only.
+	*
+	* @return Listener id for RemoveEventListener
+	*/
+	uint32 AddRawEventListener(
+		const FString& EventName,
+		TFunction< void(const FString&, const sio::message::ptr&)> CallbackFunction,
+		const FString& Namespace = TEXT("/"),
+		ESIOThreadOverrideOption CallbackThread = USE_DEFAULT,
+		const FString& OrderingKeyField = TEXT(""));
+
+	/** Removes a listener added with AddEventListener or AddRawEventListener */
+	void RemoveEventListener(uint32 ListenerId);
+
+	/**
+	* Feeds snapshot and JSON patch messages of an event into a document store, see FSIODocumentStore.
+	* The store is held weakly and used on the callback thread. C++ only.
+	*
+	* @param EventName	Event name, used as the channel when messages have none
+	* @param Store		Store receiving the messages
+	* @param Namespace	Optional namespace, defaults to default namespace
+	* @param CallbackThread Override default bCallbackOnGameThread option, the store isn't thread safe
+	* @return Listener id for RemoveEventListener
+	*/
+	uint32 BindDocumentStore(
+		const FString& EventName,
+		const TSharedPtr<FSIODocumentStore>& Store,
+		const FString& Namespace = TEXT("/"),
+		ESIOThreadOverrideOption CallbackThread = USE_DEFAULT);
+
+	/**
+	* Filters messages of an event on the network thread, before they are converted to FJsonValue or
+	* handed to another thread, see FSIORelevanceFilter. Applies to the binding and every listener of
+	* the event, including ones bound later. C++ only.
+	*
+	* @param EventName	Event name
+	* @param Filter		Filter to run, nullptr removes the event's filter
+	* @param Namespace	Optional namespace, defaults to default namespace
+	*/
+	void SetRelevanceFilter(const FString& EventName, const FSIORelevanceFilterPtr& Filter, const FString& Namespace = TEXT("/"));
+
+	/**
+	* Unbinds currently bound callback and all added listeners from given event.
 	*
 	* @param EventName	Event name
 	*/
@@ -374,6 +733,36 @@ protected:
 	/** Linkup PrivateClient callbacks to FSocketIONative */
 	void SetupInternalCallbacks();
 
+	friend class FSIOSharedConnection;
+
+	//Client callbacks, called by our own client listeners or fanned out by a shared connection
+	void HandleConnectionClosed(ESIOConnectionCloseReason DisconnectReason);
+	void HandleNamespaceOpened(const FString& Namespace);
+	void HandleNamespaceClosed(const FString& Namespace);
+	void HandleConnectionFailed();
+	void HandleReconnecting(uint32 Attempt, uint32 Delay);
+
+	/** Replaces our binding of the event (removes it if Listener is empty) without touching other listeners of the socket */
+	void BindPrimaryListener(const FString& EventName, const FString& Namespace, const sio::socket::event_listener_aux& Listener);
+
+	/** Removes every socket listener this native registered on PrivateClient */
+	void UnbindSocketListeners();
+
+	/** Tells a shared connection we use the namespace */
+	void UseNamespace(const FString& Namespace);
+
+	/**
+	* Leaves the shared connection and goes back to an unconnected client of our own, firing
+	* OnDisconnectedCallback if we were connected. bReinitialize false is the teardown path,
+	* no callback fires and no new client is made.
+	*/
+	void DetachSharedConnection(bool bSyncClose, bool bReinitialize = true);
+
+	//Socket listener ids of OnEvent/OnRawEvent/OnRawBinaryEvent bindings by (Namespace, EventName)
+	TMap<TPair<FString, FString>, uint32> PrimaryListenerIds;
+
+	FSIOSharedConnection::FPtr SharedConnection;
+
 	void RebindCurrentEventMap();
 
 	/** Checks for https prepend */
@@ -388,5 +777,157 @@ protected:
 
 	void InitPrivateClient(const bool bShouldUseTlsLibraries = false, const bool bShouldVerifyTLSCertificate = false);
 
+	struct FSIOConflatedEvent
+	{
+		FString EventName;
+		FString Namespace;
+		std::string KeyField;
+		double MinFlushInterval = 0.0;
+		double LastFlushTime = 0.0;
+
+		//Pending latest values in first-emit order
+		TMap<FString, int32> SlotIndices;
+		TArray<sio::message::list> Slots;
+	};
+
+	struct FSIOPendingEmit
+	{
+		FString EventName;
+		sio::message::list MessageList;
+	};
+
+	/** String form of Message[KeyField] if Message is an object, empty otherwise */
+	static FString KeyFieldValue(const sio::message::ptr& Message, const std::string& KeyField);
+
+	/** Wraps a raw callback with the thread option dispatch used by OnRawEvent and AddRawEventListener */
+	sio::socket::event_listener_aux MakeRawListener(
+		TFunction< void(const FString&, const sio::message::ptr&)> CallbackFunction,
+		ESIOThreadOverrideOption CallbackThread,
+		const FString& OrderingKeyField,
+		const FString& Namespace);
+
+	/**
+	* Runs the relevance filter of the event on InOutMessage if it has one, false if the message is dropped.
+	* Each incoming message is filtered once, every listener of it gets the same result.
+	*/
+	bool PassesRelevanceFilter(const FString& Namespace, const FString& EventName, sio::message::ptr& InOutMessage);
+
+	//Relevance filters by (Namespace, EventName), the count skips the lookup while there are none
+	TMap<TPair<FString, FString>, FSIORelevanceFilterPtr> RelevanceFilters;
+	std::atomic<int32> NumRelevanceFilters{ 0 };
+	FCriticalSection RelevanceSection;
+
+	struct FSIOFilteredMessage
+	{
+		std::weak_ptr<sio::message> Incoming;
+		FString Namespace;
+		FString EventName;
+		sio::message::ptr Filtered;
+		bool bPassed = false;
+	};
+
+	//Result for the message being dispatched, sockets call all listeners of a message in a row
+	FSIOFilteredMessage LastFiltered;
+
+	/** Converts the message once and hands the same JsonValue to every listener of that message */
+	TSharedPtr<FJsonValue> SharedJsonValue(const sio::message::ptr& Message);
+
+	struct FSIODecodedMessage
+	{
+		std::weak_ptr<sio::message> Message;
+		TSharedPtr<FJsonValue> Value;
+	};
+
+	//Small ring of recent conversions, listeners on other threads may look up a message late.
+	//Values are only kept while their message is alive, expired ones are dropped at the next lookup.
+	static const int32 DecodeCacheSize = 16;
+	FSIODecodedMessage DecodeCache[DecodeCacheSize];
+	int32 DecodeCacheNext = 0;
+	FCriticalSection DecodeCacheSection;
+
+	/** Registers the listener on its namespace socket and stores the socket listener id */
+	void BindListener(FSIOBoundListener& Listener);
+
+	//Listeners added through AddEventListener/AddRawEventListener by listener id
+	TMap<uint32, FSIOBoundListener> EventListenerMap;
+	uint32 NextListenerId = 0;
+
+	/** Stores the emit in its pending slot if the event is conflated. */
+	bool TryConflateEmit(const FString& EventName, const sio::message::list& MessageList, const FString& Namespace);
+
+	/** Stores the emit in the outbox and sends it if connected, returns false for non-outbox events */
+	bool TryOutboxEmit(const FString& EventName, const sio::message::list& MessageList, const FString& Namespace, ESIOEmitPriority Priority);
+
+	/** True if an emit of EventName would be batched, conflated or kept in the outbox */
+	bool HasEmitRouting(const FString& EventName, const FString& Namespace, ESIOEmitPriority Priority);
+
+	/** Emits an outbox entry with its dedup id, the ack removes it from the outbox */
+	void SendOutboxEntry(const FString& Id, const FString& EventName, const sio::message::list& MessageList, const FString& Namespace, ESIOEmitPriority Priority = EMIT_REALTIME);
+
+	/** Resends every unacked outbox entry of the namespace in order */
+	void ReplayOutbox(const FString& Namespace);
+
+	/** Points the outbox at this connection's default journal unless SetOutboxJournalPath chose one */
+	void UpdateDefaultOutboxJournal();
+
+	/** Appends the emit to this tick's batch for the namespace */
+	void AddToBatch(const FString& EventName, const sio::message::list& MessageList, const FString& Namespace);
+
+	/** Sends the namespace's pending batch now, called before any unbatched send so emits keep their order */
+	void FlushBatch(const FString& Namespace);
+
+	/** The emit a batch is sent as, a lone emit is sent as is */
+	static FSIOPendingEmit MakeBatchEmit(const TArray<FSIOPendingEmit>& Batch);
+
+	/** Registers the core ticker used for tick-aligned outbound flushes, call with OutboundSection held */
+	void EnsureOutboundTicker();
+
+	bool OnOutboundTick(float DeltaTime);
+
+	TMap<FString, FSIOConflatedEvent> ConflatedEvents;
+	TMap<FString, TArray<FSIOPendingEmit>> PendingBatches;
+	TSet<FString> OutboxEvents;
+	bool bCustomOutboxJournal = false;
+	FCriticalSection OutboundSection;
+	FTSTicker::FDelegateHandle OutboundTickerHandle;
+
+	struct FSIORpcRequest
+	{
+		TPromise<FSIORpcResult> Promise;
+		std::atomic<bool> bCompleted{ false };
+		FString Namespace;
+		uint32 RpcId = 0;
+
+		//Set once emit returns, a timeout or cancel may run before that
+		std::atomic<uint32> AckId{ 0 };
+		double Deadline = 0.0;
+	};
+	typedef TSharedPtr<FSIORpcRequest, ESPMode::ThreadSafe> FSIORpcRequestPtr;
+
+	/** Resolves the call once, later acks, timeouts or cancels are ignored */
+	void CompleteRpc(const FSIORpcRequestPtr& Request, FSIORpcResult&& Result);
+
+	/** Resolves every pending call with Status, e.g. on disconnect */
+	void FailPendingRpcs(ESIORpcStatus Status);
+
+	/** Registers the ticker that expires deadlines, call with RpcSection held */
+	void EnsureRpcTicker();
+
+	bool OnRpcTick(float DeltaTime);
+
+	TMap<uint32, FSIORpcRequestPtr> PendingRpcs;
+	uint32 NextRpcId = 0;
+	FCriticalSection RpcSection;
+	FTSTicker::FDelegateHandle RpcTickerHandle;
+
+	typedef TSharedPtr<FSIODeltaSender, ESPMode::ThreadSafe> FSIODeltaSenderPtr;
+
+	/** Stream of EventName, recreated if it was used with another struct */
+	FSIODeltaSenderPtr FindOrAddDeltaStream(const FString& EventName, const FString& Namespace, const UScriptStruct* Struct);
+
+	/** Delta streams keyed by namespace and event name */
+	TMap<TPair<FString, FString>, FSIODeltaSenderPtr> DeltaStreams;
+	FCriticalSection DeltaSection;
+
 	TSharedPtr<sio::client> PrivateClient;
 };
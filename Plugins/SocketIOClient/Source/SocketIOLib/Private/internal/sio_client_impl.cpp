@@ -29,6 +29,7 @@
 #include <sstream>
 #include <mutex>
 #include <cmath>
+#include <algorithm>
 
 // Comment this out to disable handshake logging to stdout
 #define SIO_LIB_DEBUG 0
@@ -53,6 +54,8 @@ namespace sio
         m_ping_interval(0),
         m_ping_timeout(0),
         m_network_thread(),
+        m_bulk_chunk_size(64 * 1024),
+        m_bulk_send_window(256 * 1024),
         m_con_state(con_closed),
         m_reconn_delay(5000),
         m_reconn_delay_max(25000),
@@ -77,7 +80,6 @@ namespace sio
         m_client.set_fail_handler(std::bind(&client_impl<client_type>::on_fail, this, _1));
         m_client.set_message_handler(std::bind(&client_impl<client_type>::on_message, this, _1, _2));
         m_packet_mgr.set_decode_callback(std::bind(&client_impl<client_type>::on_decode, this, _1));
-        m_packet_mgr.set_encode_callback(std::bind(&client_impl<client_type>::on_encode, this, _1, _2));
         template_init();
     }
 
@@ -197,6 +199,14 @@ namespace sio
         }
     }
 
+    template<typename client_type>
+    void client_impl<client_type>::stop()
+    {
+        m_con_state = con_closing;
+        //run_loop returns with handlers still queued, connect() resets the io_service before starting over
+        m_client.stop();
+    }
+
     template<typename client_type>
     void client_impl<client_type>::set_logs_default()
     {
@@ -220,7 +230,27 @@ namespace sio
     template<typename client_type>
     void client_impl<client_type>::send(packet& p)
     {
-        m_packet_mgr.encode(p);
+        //Encode on the calling thread, queue the whole packet on the network thread
+        outgoing_packet_ptr pack = std::make_shared<outgoing_packet>();
+        m_packet_mgr.encode(p, [&](bool isBinary, shared_ptr<const string> const& payload)
+            {
+                pack->frames.push_back({ payload, isBinary ? frame::opcode::binary : frame::opcode::text });
+            });
+        LOG("encoded packet frames:" << pack->frames.size() << endl);
+        this->enqueue_packet(pack, p.get_nsp(), p.get_pack_id(), p.get_lane());
+    }
+
+    template<typename client_type>
+    void client_impl<client_type>::send_frames(std::vector<std::pair<bool, std::shared_ptr<const std::string> > > const& frames, std::string const& nsp, int pack_id, packet::lane send_lane)
+    {
+        //Payloads are shared as is, nothing is encoded here
+        outgoing_packet_ptr pack = std::make_shared<outgoing_packet>();
+        pack->frames.reserve(frames.size());
+        for (auto const& frame : frames)
+        {
+            pack->frames.push_back({ frame.second, frame.first ? frame::opcode::binary : frame::opcode::text });
+        }
+        this->enqueue_packet(pack, nsp, pack_id, send_lane);
     }
 
     template<typename client_type>
@@ -347,19 +377,216 @@ namespace sio
     }
 
     template<typename client_type>
-    void client_impl<client_type>::send_impl(shared_ptr<const string> const& payload_ptr, frame::opcode::value opcode)
+    void client_impl<client_type>::enqueue_packet(outgoing_packet_ptr const& pack, std::string const& nsp, int pack_id, packet::lane send_lane)
+    {
+        std::vector<outgoing_packet_ptr> packs;
+        if (send_lane == packet::lane_bulk)
+        {
+            //Split on the calling thread, the network thread only writes whole packets
+            this->split_bulk_packet(*pack, nsp, pack_id, packs);
+        }
+        else
+        {
+            packs.push_back(pack);
+        }
+        m_client.get_io_service().dispatch(std::bind(&client_impl<client_type>::enqueue_impl, this, std::move(packs), send_lane));
+    }
+
+    /*
+    * A bulk packet larger than the chunk size is sent as a stream of complete '__chunk' events, each
+    * [{"id","index","count","sizes"}, <piece>], so control and realtime packets can be written between
+    * them. The pieces concatenate to the socket.io frames of the original packet: its text without the
+    * engine.io type, then its attachments. "sizes" (first chunk only) holds the length of each frame.
+    * The last chunk carries the ack id of the original packet.
+    */
+    template<typename client_type>
+    void client_impl<client_type>::split_bulk_packet(outgoing_packet const& pack, std::string const& nsp, int pack_id, std::vector<outgoing_packet_ptr>& out_chunks)
+    {
+        const size_t chunk_size = m_bulk_chunk_size;
+        std::vector<std::pair<const char*, size_t> > parts;
+        size_t total = 0;
+        for (outgoing_frame const& out_frame : pack.frames)
+        {
+            const size_t skip = (out_frame.opcode == frame::opcode::text && !out_frame.payload->empty()) ? 1 : 0;
+            parts.push_back(std::make_pair(out_frame.payload->data() + skip, out_frame.payload->size() - skip));
+            total += out_frame.payload->size() - skip;
+        }
+        if (total <= chunk_size)
+        {
+            out_chunks.push_back(std::make_shared<outgoing_packet>(pack));
+            return;
+        }
+
+        const size_t count = (total + chunk_size - 1) / chunk_size;
+        const unsigned stream_id = m_next_chunk_stream++;
+        size_t part = 0;
+        size_t part_offset = 0;
+        out_chunks.reserve(count);
+
+        for (size_t index = 0; index < count; ++index)
+        {
+            std::shared_ptr<std::string> piece = std::make_shared<std::string>();
+            piece->reserve(std::min(chunk_size, total - index * chunk_size));
+            while (piece->size() < chunk_size && part < parts.size())
+            {
+                const size_t length = std::min(chunk_size - piece->size(), parts[part].second - part_offset);
+                piece->append(parts[part].first + part_offset, length);
+                part_offset += length;
+                if (part_offset == parts[part].second)
+                {
+                    ++part;
+                    part_offset = 0;
+                }
+            }
+
+            message::ptr header = object_message::create();
+            std::map<std::string, message::ptr>& fields = header->get_map();
+            fields["id"] = int_message::create(stream_id);
+            fields["index"] = int_message::create(index);
+            fields["count"] = int_message::create(count);
+            if (index == 0)
+            {
+                message::ptr sizes = array_message::create();
+                for (auto const& frame_part : parts)
+                {
+                    sizes->get_vector().push_back(int_message::create(frame_part.second));
+                }
+                fields["sizes"] = sizes;
+            }
+
+            message::ptr body = array_message::create();
+            body->get_vector().push_back(string_message::create(sio::socket::chunk_event_name()));
+            body->get_vector().push_back(header);
+            body->get_vector().push_back(binary_message::create(piece));
+
+            packet chunk(nsp, body, index + 1 == count ? pack_id : -1);
+            outgoing_packet_ptr chunk_pack = std::make_shared<outgoing_packet>();
+            m_packet_mgr.encode(chunk, [&](bool isBinary, shared_ptr<const string> const& payload)
+                {
+                    chunk_pack->frames.push_back({ payload, isBinary ? frame::opcode::binary : frame::opcode::text });
+                });
+            out_chunks.push_back(chunk_pack);
+        }
+        LOG("bulk packet of " << total << " bytes split into " << count << " chunks" << endl);
+    }
+
+    template<typename client_type>
+    void client_impl<client_type>::enqueue_impl(std::vector<outgoing_packet_ptr> const& packs, packet::lane send_lane)
+    {
+        if (m_con_state != con_opened)
+        {
+            return;
+        }
+        for (outgoing_packet_ptr const& pack : packs)
+        {
+            if (!pack->frames.empty())
+            {
+                m_send_lanes[send_lane].push_back(pack);
+            }
+        }
+        this->flush_send_lanes();
+    }
+
+    /*
+    * Lane rules:
+    * - control (engine.io ping/pong) goes first.
+    * - realtime packets are written whole and go ahead of every queued bulk packet.
+    * - bulk packets (at most one chunk each, see split_bulk_packet) are written whole while the
+    *   websocket write buffer is below the send window. A packet's attachments are never
+    *   interleaved with other socket.io packets, so a large message holds up the other lanes for
+    *   one chunk at most.
+    */
+    template<typename client_type>
+    void client_impl<client_type>::flush_send_lanes()
+    {
+        if (m_con_state != con_opened)
+        {
+            return;
+        }
+        lib::error_code ec;
+        typename client_type::connection_ptr con = m_client.get_con_from_hdl(m_con, ec);
+        if (ec)
+        {
+            return;
+        }
+
+        std::deque<outgoing_packet_ptr>& control = m_send_lanes[packet::lane_control];
+        std::deque<outgoing_packet_ptr>& realtime = m_send_lanes[packet::lane_realtime];
+        std::deque<outgoing_packet_ptr>& bulk = m_send_lanes[packet::lane_bulk];
+
+        while (true)
+        {
+            while (!control.empty())
+            {
+                this->write_whole_frames(*control.front());
+                control.pop_front();
+            }
+            while (!realtime.empty())
+            {
+                this->write_whole_frames(*realtime.front());
+                realtime.pop_front();
+            }
+            if (bulk.empty())
+            {
+                return;
+            }
+            if (con->get_buffered_amount() >= m_bulk_send_window)
+            {
+                if (!m_send_timer)
+                {
+                    m_send_timer.reset(new asio_sockio::steady_timer(m_client.get_io_service()));
+                    asio_sockio::error_code timer_ec;
+                    m_send_timer->expires_from_now(milliseconds(5), timer_ec);
+                    m_send_timer->async_wait(std::bind(&client_impl<client_type>::timeout_send, this, std::placeholders::_1));
+                }
+                return;
+            }
+            this->write_whole_frames(*bulk.front());
+            bulk.pop_front();
+        }
+    }
+
+    template<typename client_type>
+    void client_impl<client_type>::write_whole_frames(outgoing_packet& pack)
     {
-        if (m_con_state == con_opened)
+        for (; pack.next_frame < pack.frames.size(); ++pack.next_frame)
         {
+            outgoing_frame const& out_frame = pack.frames[pack.next_frame];
             lib::error_code ec;
-            m_client.send(m_con, *payload_ptr, opcode, ec);
+            m_client.send(m_con, *out_frame.payload, out_frame.opcode, ec);
             if (ec)
             {
-                //DEBUG_LOG(LogTemp, Warning, TEXT("close_impl::Error: Send failed,reason: %s"), *FString(ec.message().c_str()));
+                LOG("Send failed,reason:" << ec.message() << endl);
             }
         }
     }
 
+    template<typename client_type>
+    void client_impl<client_type>::timeout_send(const asio_sockio::error_code& ec)
+    {
+        m_send_timer.reset();
+        if (ec)
+        {
+            return;
+        }
+        this->flush_send_lanes();
+    }
+
+    template<typename client_type>
+    void client_impl<client_type>::clear_send_lanes()
+    {
+        for (std::deque<outgoing_packet_ptr>& lane_queue : m_send_lanes)
+        {
+            lane_queue.clear();
+        }
+        if (m_send_timer)
+        {
+            asio_sockio::error_code ec;
+            m_send_timer->cancel(ec);
+            m_send_timer.reset();
+        }
+    }
+
     template<typename client_type>
     void client_impl<client_type>::ping(const asio_sockio::error_code& ec)
     {
@@ -370,11 +597,12 @@ namespace sio
             return;
         }
         packet p(packet::frame_ping);
-        m_packet_mgr.encode(p, [&](bool /*isBin*/, shared_ptr<const string> payload)
+        outgoing_packet_ptr pack = std::make_shared<outgoing_packet>();
+        m_packet_mgr.encode(p, [&](bool /*isBin*/, shared_ptr<const string> const& payload)
             {
-                lib::error_code ec;
-                this->m_client.send(this->m_con, *payload, frame::opcode::text, ec);
+                pack->frames.push_back({ payload, frame::opcode::text });
             });
+        this->enqueue_impl({ pack }, packet::lane_control);
         if (!m_ping_timeout_timer)
         {
             m_ping_timeout_timer.reset(new asio_sockio::steady_timer(m_client.get_io_service()));
@@ -460,6 +688,7 @@ namespace sio
 
         m_con.reset();
         m_con_state = con_closed;
+        this->clear_send_lanes();
         this->sockets_invoke_void(socket_on_disconnect());
         LOG("Connection failed." << endl);
         if (m_reconn_made < m_reconn_attempts)
@@ -515,6 +744,7 @@ namespace sio
 
         m_con.reset();
         this->clear_timers();
+        this->clear_send_lanes();
         client::close_reason reason;
 
         // If we initiated the close, no matter what the close status was,
@@ -604,10 +834,12 @@ namespace sio
     void client_impl<client_type>::on_ping()
     {
         packet p(packet::frame_pong);
-        m_packet_mgr.encode(p, [&](bool /*isBin*/, shared_ptr<const string> payload)
+        outgoing_packet_ptr pack = std::make_shared<outgoing_packet>();
+        m_packet_mgr.encode(p, [&](bool /*isBin*/, shared_ptr<const string> const& payload)
             {
-                this->m_client.send(this->m_con, *payload, frame::opcode::text);
+                pack->frames.push_back({ payload, frame::opcode::text });
             });
+        this->enqueue_impl({ pack }, packet::lane_control);
 
         if (m_ping_timeout_timer)
         {
@@ -643,13 +875,6 @@ namespace sio
         }
     }
 
-    template<typename client_type>
-    void client_impl<client_type>::on_encode(bool isBinary, shared_ptr<const string> const& payload)
-    {
-        LOG("encoded payload length:" << payload->length() << endl);
-        m_client.get_io_service().dispatch(std::bind(&client_impl<client_type>::send_impl, this, payload, isBinary ? frame::opcode::binary : frame::opcode::text));
-    }
-
     template<typename client_type>
     void client_impl<client_type>::clear_timers()
     {
@@ -68,6 +68,8 @@
 #include <memory>
 #include <map>
 #include <thread>
+#include <deque>
+#include <atomic>
 
 #include "sio_client.h"
 #include "sio_packet.h"
@@ -118,14 +120,18 @@
             virtual sio::socket::ptr const& socket(const std::string& nsp) = 0;
             virtual void close() {};
             virtual void sync_close() {};
+            virtual void stop() {};
             virtual bool opened() const { return false; };
             virtual std::string const& get_sessionid() const = 0;
             virtual void set_reconnect_attempts(unsigned attempts) {};
             virtual void set_reconnect_delay(unsigned millis) {};
             virtual void set_reconnect_delay_max(unsigned millis) {};
+            virtual void set_bulk_send_limits(size_t chunk_size, size_t send_window) {};
 
             // used by sio::socket
             virtual void send(packet& p) {};
+            // already encoded websocket messages of nsp, pair of (is binary, payload)
+            virtual void send_frames(std::vector<std::pair<bool, std::shared_ptr<const std::string> > > const& frames, std::string const& nsp, int pack_id, packet::lane send_lane) {};
             virtual void remove_socket(std::string const& nsp) {};
             virtual asio_sockio::io_service& get_io_service() = 0;
             virtual void on_socket_closed(std::string const& nsp) {};
@@ -175,6 +181,8 @@
 
         void sync_close();
 
+        void stop();
+
         bool opened() const { return m_con_state == con_opened; }
 
         std::string const& get_sessionid() const { return m_sid; }
@@ -187,6 +195,8 @@
 
         void set_reconnect_delay_max(unsigned millis) { m_reconn_delay_max = millis; if (m_reconn_delay > millis) m_reconn_delay = millis; }
 
+        void set_bulk_send_limits(size_t chunk_size, size_t send_window) { m_bulk_chunk_size.store(chunk_size > 0 ? chunk_size : 1); m_bulk_send_window.store(send_window > 0 ? send_window : 1); }
+
         void set_logs_default();
 
         void set_logs_quiet();
@@ -219,6 +229,8 @@
     public:
         void send(packet& p);
 
+        void send_frames(std::vector<std::pair<bool, std::shared_ptr<const std::string> > > const& frames, std::string const& nsp, int pack_id, packet::lane send_lane);
+
         void remove_socket(std::string const& nsp);
 
         asio_sockio::io_service& get_io_service();
@@ -234,7 +246,36 @@
 
         void close_impl(close::status::value const& code, std::string const& reason);
 
-        void send_impl(std::shared_ptr<const std::string> const& payload_ptr, frame::opcode::value opcode);
+        struct outgoing_frame
+        {
+            std::shared_ptr<const std::string> payload;
+            frame::opcode::value opcode;
+        };
+
+        //All websocket messages of one encoded packet (header + binary attachments), written back to back.
+        struct outgoing_packet
+        {
+            std::vector<outgoing_frame> frames;
+            size_t next_frame = 0;
+        };
+
+        typedef std::shared_ptr<outgoing_packet> outgoing_packet_ptr;
+
+        //Queues a packet on its lane, bulk packets above the chunk size are split first
+        void enqueue_packet(outgoing_packet_ptr const& pack, std::string const& nsp, int pack_id, packet::lane send_lane);
+
+        //Splits a packet into complete socket::chunk_event_name() packets of at most m_bulk_chunk_size payload
+        void split_bulk_packet(outgoing_packet const& pack, std::string const& nsp, int pack_id, std::vector<outgoing_packet_ptr>& out_chunks);
+
+        void enqueue_impl(std::vector<outgoing_packet_ptr> const& packs, packet::lane send_lane);
+
+        void flush_send_lanes();
+
+        void write_whole_frames(outgoing_packet& pack);
+
+        void timeout_send(const asio_sockio::error_code& ec);
+
+        void clear_send_lanes();
 
         void ping(const asio_sockio::error_code& ec);
 
@@ -249,7 +290,6 @@
         void sockets_invoke_void(void (sio::socket::* fn)(void));
 
         void on_decode(packet const& pack);
-        void on_encode(bool isBinary, shared_ptr<const string> const& payload);
 
         //websocket callbacks
         void on_fail(connection_hdl con);
@@ -294,6 +334,21 @@
 
         std::unique_ptr<asio_sockio::steady_timer> m_reconn_timer;
 
+        //Outgoing packets per packet::lane, only touched on the network thread
+        std::deque<outgoing_packet_ptr> m_send_lanes[packet::lane_count];
+
+        //Re-polls the websocket write buffer while bulk data is waiting on the send window
+        std::unique_ptr<asio_sockio::steady_timer> m_send_timer;
+
+        //Bulk packets larger than this are sent as chunk packets of at most this many payload bytes, set from any thread
+        std::atomic<size_t> m_bulk_chunk_size;
+
+        //Bulk data is only handed to websocketpp while less than this many bytes are buffered, set from any thread
+        std::atomic<size_t> m_bulk_send_window;
+
+        //Id of the next chunked bulk packet, sends may come from any thread
+        std::atomic<unsigned> m_next_chunk_stream{ 1 };
+
         con_state m_con_state;
 
         client::con_listener m_open_listener;
@@ -24,6 +24,7 @@
 #define _WEBSOCKETPP_CPP11_STL_
 
 #include "sio_packet.h"
+#include "sio_socket.h"
 #include <rapidjson/document.h>
 #include <rapidjson/encodedstream.h>
 #include <rapidjson/writer.h>
@@ -215,7 +216,8 @@ namespace sio
         _nsp(nsp),
         _pack_id(pack_id),
         _message(msg),
-        _pending_buffers(0)
+        _pending_buffers(0),
+        _lane(lane_realtime)
     {
         assert((!isAck
             || (isAck && pack_id >= 0)));
@@ -227,7 +229,8 @@ namespace sio
         _nsp(nsp),
         _pack_id(-1),
         _message(msg),
-        _pending_buffers(0)
+        _pending_buffers(0),
+        _lane(lane_realtime)
     {
 
     }
@@ -236,7 +239,8 @@ namespace sio
         _frame(frame),
         _type(type_undetermined),
         _pack_id(-1),
-        _pending_buffers(0)
+        _pending_buffers(0),
+        _lane(frame == frame_message ? lane_realtime : lane_control)
     {
 
     }
@@ -244,7 +248,8 @@ namespace sio
     packet::packet() :
         _type(type_undetermined),
         _pack_id(-1),
-        _pending_buffers(0)
+        _pending_buffers(0),
+        _lane(lane_realtime)
     {
 
     }
@@ -413,6 +418,44 @@ namespace sio
         return hasBinary;
     }
 
+    string packet::encode_event_body(message::ptr const& msg, vector<shared_ptr<const string> >& buffers)
+    {
+        Document doc;
+        if (!msg)
+        {
+            return string();
+        }
+        accept_message(*msg, doc, doc, buffers);
+        StringBuffer buffer;
+        Writer<StringBuffer> writer(buffer);
+        doc.Accept(writer);
+        return string(buffer.GetString(), buffer.GetSize());
+    }
+
+    string packet::event_header(string const& nsp, size_t attachment_count, int pack_id)
+    {
+        //same layout accept() writes for an event
+        ostringstream ss;
+        ss << (char)(frame_message + '0');
+        if (attachment_count > 0)
+        {
+            ss << (int)type_binary_event << attachment_count << "-";
+        }
+        else
+        {
+            ss << (int)type_event;
+        }
+        if (nsp.size() > 0 && nsp != "/")
+        {
+            ss << nsp << ",";
+        }
+        if (pack_id >= 0)
+        {
+            ss << pack_id;
+        }
+        return ss.str();
+    }
+
     packet::frame_type packet::get_frame() const
     {
         return _frame;
@@ -424,6 +467,16 @@ namespace sio
         return (type)_type;
     }
 
+    packet::lane packet::get_lane() const
+    {
+        return _lane;
+    }
+
+    void packet::set_lane(lane send_lane)
+    {
+        _lane = send_lane;
+    }
+
     string const& packet::get_nsp() const
     {
         return _nsp;
@@ -528,4 +581,126 @@ namespace sio
             m_decode_callback(*p);
         }
     }
+
+    class event_writer::impl
+    {
+    public:
+        impl():
+            writer(buffer)
+        {
+        }
+
+        StringBuffer buffer;
+        Writer<StringBuffer> writer;
+        vector<shared_ptr<const string> > attachments;
+    };
+
+    event_writer::event_writer():
+        m_impl(new impl())
+    {
+    }
+
+    event_writer::~event_writer()
+    {
+        delete m_impl;
+    }
+
+    void event_writer::begin_event(string const& quoted_name)
+    {
+        m_impl->writer.StartArray();
+        m_impl->writer.RawValue(quoted_name.data(), quoted_name.size(), kStringType);
+    }
+
+    void event_writer::null_value()
+    {
+        m_impl->writer.Null();
+    }
+
+    void event_writer::bool_value(bool value)
+    {
+        m_impl->writer.Bool(value);
+    }
+
+    void event_writer::int_value(int64_t value)
+    {
+        m_impl->writer.Int64(value);
+    }
+
+    void event_writer::uint_value(uint64_t value)
+    {
+        m_impl->writer.Uint64(value);
+    }
+
+    void event_writer::double_value(double value)
+    {
+        //rapidjson refuses nan/inf midway through a value, keep the document valid
+        if (value != value || value - value != 0.0)
+        {
+            m_impl->writer.Null();
+            return;
+        }
+        m_impl->writer.Double(value);
+    }
+
+    void event_writer::string_value(const char* utf8, size_t length)
+    {
+        m_impl->writer.String(utf8, (SizeType)length);
+    }
+
+    void event_writer::key(const char* utf8, size_t length)
+    {
+        m_impl->writer.Key(utf8, (SizeType)length);
+    }
+
+    void event_writer::start_array()
+    {
+        m_impl->writer.StartArray();
+    }
+
+    void event_writer::end_array()
+    {
+        m_impl->writer.EndArray();
+    }
+
+    void event_writer::start_object()
+    {
+        m_impl->writer.StartObject();
+    }
+
+    void event_writer::end_object()
+    {
+        m_impl->writer.EndObject();
+    }
+
+    void event_writer::binary_value(shared_ptr<const string> const& bytes)
+    {
+        //same placeholder accept_binary_message writes
+        m_impl->writer.StartObject();
+        m_impl->writer.Key(kBIN_PLACE_HOLDER);
+        m_impl->writer.Bool(true);
+        m_impl->writer.Key("num");
+        m_impl->writer.Int((int)m_impl->attachments.size());
+        m_impl->writer.EndObject();
+        m_impl->attachments.push_back(bytes ? bytes : make_shared<const string>());
+    }
+
+    void event_writer::raw_value(const char* json, size_t length)
+    {
+        m_impl->writer.RawValue(json, length, kObjectType);
+    }
+
+    prepared_packet::ptr event_writer::finish(string const& name)
+    {
+        m_impl->writer.EndArray();
+        string body(m_impl->buffer.GetString(), m_impl->buffer.GetSize());
+        return prepared_packet::create_encoded(name, std::move(body), std::move(m_impl->attachments));
+    }
+
+    string event_writer::quote(const char* utf8, size_t length)
+    {
+        StringBuffer buffer;
+        Writer<StringBuffer> writer(buffer);
+        writer.String(utf8, (SizeType)length);
+        return string(buffer.GetString(), buffer.GetSize());
+    }
 }
@@ -42,6 +42,15 @@ namespace sio
             type_max = 6,
             type_undetermined = 0x10 //undetermined mask bit
         };
+
+        //Outgoing send lane, see client_impl::flush_send_lanes
+        enum lane
+        {
+            lane_control = 0,
+            lane_realtime = 1,
+            lane_bulk = 2,
+            lane_count = 3
+        };
     private:
         frame_type _frame;
         int _type;
@@ -49,6 +58,7 @@ namespace sio
         int _pack_id;
         message::ptr _message;
         unsigned _pending_buffers;
+        lane _lane;
         vector<shared_ptr<const string> > _buffers;
     public:
         packet(string const& nsp, message::ptr const& msg, int pack_id = -1, bool isAck = false);//message type constructor.
@@ -63,6 +73,10 @@ namespace sio
 
         type get_type() const;
 
+        lane get_lane() const;
+
+        void set_lane(lane send_lane);
+
         bool parse(string const& payload_ptr);//return true if need to parse buffer.
 
         bool parse_buffer(string const& buf_payload);
@@ -75,6 +89,13 @@ namespace sio
 
         unsigned get_pack_id() const;
 
+        //Event without namespace or ack id, shared by every send of a prepared_packet.
+        //Returns the JSON body and fills buffers with the binary attachments.
+        static string encode_event_body(message::ptr const& msg, vector<shared_ptr<const string> >& buffers);
+
+        //"4" + event type + attachment count + namespace + ack id if >= 0, the prefix encode_event_body output goes after
+        static string event_header(string const& nsp, size_t attachment_count, int pack_id = -1);
+
         static bool is_message(string const& payload_ptr);
         static bool is_text_message(string const& payload_ptr);
         static bool is_binary_message(string const& payload_ptr);
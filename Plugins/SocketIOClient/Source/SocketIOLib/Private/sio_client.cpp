@@ -182,6 +182,11 @@ namespace sio
         m_impl->set_reconnect_delay_max(millis);
     }
 
+    void client::set_bulk_send_limits(size_t chunk_size, size_t send_window)
+    {
+        m_impl->set_bulk_send_limits(chunk_size, send_window);
+    }
+
     void client::set_path(const std::string& path)
     {
         m_path = path;
@@ -189,7 +194,7 @@ namespace sio
    
    void client::stop()
    {
-       //m_impl->stop();
+       m_impl->stop();
    }
 
     void client::set_logs_default()
@@ -27,6 +27,7 @@
 #include <asio/steady_timer.hpp>
 #include <asio/error_code.hpp>
 #include <queue>
+#include <atomic>
 #include <chrono>
 #include <cstdarg>
 #include <functional>
@@ -139,6 +140,10 @@ namespace sio
         void on(std::string const& event_name,event_listener const& func);
         
         void off(std::string const& event_name);
+
+        unsigned add_listener(std::string const& event_name, event_listener const& func);
+
+        void remove_listener(std::string const& event_name, unsigned listener_id);
         
         void off_all();
         
@@ -156,7 +161,11 @@ namespace sio
         
         void close();
         
-        void emit(std::string const& name, message::list const& msglist, std::function<void (message::list const&)> const& ack);
+        unsigned emit(std::string const& name, message::list const& msglist, std::function<void (message::list const&)> const& ack, emit_priority priority);
+
+        bool cancel_ack(unsigned ack_id);
+
+        unsigned emit_prepared(prepared_packet::ptr const& pack, std::function<void (message::list const&)> const& ack, emit_priority priority);
         
         std::string const& get_namespace() const {return m_nsp;}
 
@@ -177,10 +186,16 @@ namespace sio
         
         // Message Parsing callbacks.
         void on_socketio_event(const std::string& nsp, int msgId,const std::string& name, message::list&& message);
+        void on_socketio_event_array(const std::string& nsp, int msgId, message::ptr const& event_array);
+        void on_socketio_batch(const std::string& nsp, int msgId, message::list const& batch);
+        void on_socketio_chunk(const std::string& nsp, int msgId, message::list const& chunk);
         void on_socketio_ack(int msgId, message::list const& message);
         void on_socketio_error(message::ptr const& err_message);
         
-        event_listener get_bind_listener_locked(string const& event);
+        //listener id 0 is the one set by on(), added listeners follow in insertion order
+        typedef std::vector<std::pair<unsigned, event_listener> > listener_vector;
+
+        listener_vector get_bind_listeners_locked(string const& event);
         
         void ack(int msgId, string const& name, message::list const& ack_message);
         
@@ -189,10 +204,16 @@ namespace sio
         void send_connect();
         
         void send_packet(packet& p);
+
+        //Sends packets queued while not connected, keeps emit order ahead of a new send
+        void flush_packet_queue();
+
+        void send_prepared_frames(prepared_packet::ptr const& pack, int pack_id, packet::lane send_lane);
         
         static event_listener s_null_event_listener;
         
-        static unsigned int s_global_event_id;
+        //emits with acks may come from any thread
+        static std::atomic<unsigned int> s_global_event_id;
         
         sio::client_impl_base *m_client;
         
@@ -204,13 +225,35 @@ namespace sio
         
         std::map<unsigned int, std::function<void (message::list const&)> > m_acks;
         
-        std::map<std::string, event_listener> m_event_binding;
+        std::map<std::string, listener_vector> m_event_binding;
+
+        unsigned m_next_listener_id;
         
         error_listener m_error_listener;
         
         std::unique_ptr<asio_sockio::system_timer> m_connection_timer;
+
+        //Incoming '__chunk' streams by id, only touched on the network thread
+        struct chunk_stream
+        {
+            size_t count = 0;
+            size_t received = 0;
+            std::vector<size_t> sizes;
+            std::string bytes;
+        };
+
+        std::map<int64_t, chunk_stream> m_chunk_streams;
         
-        std::queue<packet> m_packet_queue;
+        //Offline emits, prepared ones keep their encoded frames and are sent as is
+        struct queued_packet
+        {
+            packet pack;
+            prepared_packet::ptr prepared;
+            int prepared_id;
+            packet::lane lane;
+        };
+
+        std::queue<queued_packet> m_packet_queue;
         
         std::mutex m_event_mutex;
 
@@ -227,7 +270,46 @@ namespace sio
     void socket::impl::on(std::string const& event_name,event_listener const& func)
     {
         std::lock_guard<std::mutex> guard(m_event_mutex);
-        m_event_binding[event_name] = func;
+        listener_vector& listeners = m_event_binding[event_name];
+        if(!listeners.empty() && listeners.front().first == 0)
+        {
+            listeners.front().second = func;
+        }
+        else
+        {
+            listeners.insert(listeners.begin(), std::make_pair(0u, func));
+        }
+    }
+
+    unsigned socket::impl::add_listener(std::string const& event_name, event_listener const& func)
+    {
+        std::lock_guard<std::mutex> guard(m_event_mutex);
+        unsigned listener_id = ++m_next_listener_id;
+        m_event_binding[event_name].push_back(std::make_pair(listener_id, func));
+        return listener_id;
+    }
+
+    void socket::impl::remove_listener(std::string const& event_name, unsigned listener_id)
+    {
+        std::lock_guard<std::mutex> guard(m_event_mutex);
+        auto it = m_event_binding.find(event_name);
+        if(it == m_event_binding.end())
+        {
+            return;
+        }
+        listener_vector& listeners = it->second;
+        for(auto listener_it = listeners.begin(); listener_it != listeners.end(); ++listener_it)
+        {
+            if(listener_it->first == listener_id)
+            {
+                listeners.erase(listener_it);
+                break;
+            }
+        }
+        if(listeners.empty())
+        {
+            m_event_binding.erase(it);
+        }
     }
     
     void socket::impl::off(std::string const& event_name)
@@ -260,7 +342,8 @@ namespace sio
         m_client(client),
         m_connected(false),
         m_nsp(nsp),
-        m_auth(auth)
+        m_auth(auth),
+        m_next_listener_id(0)
     {
         NULL_GUARD(client);
         if(m_client->opened())
@@ -274,11 +357,11 @@ namespace sio
         
     }
     
-    unsigned int socket::impl::s_global_event_id = 1;
+    std::atomic<unsigned int> socket::impl::s_global_event_id(1);
     
-    void socket::impl::emit(std::string const& name, message::list const& msglist, std::function<void (message::list const&)> const& ack)
+    unsigned socket::impl::emit(std::string const& name, message::list const& msglist, std::function<void (message::list const&)> const& ack, emit_priority priority)
     {
-        NULL_GUARD(m_client);
+        if(m_client == NULL) return 0;
         message::ptr msg_ptr = msglist.to_array_message(name);
         int pack_id;
         if(ack)
@@ -292,7 +375,39 @@ namespace sio
             pack_id = -1;
         }
         packet p(m_nsp, msg_ptr,pack_id);
+        p.set_lane(priority == emit_priority_bulk ? packet::lane_bulk : packet::lane_realtime);
         send_packet(p);
+        return pack_id < 0 ? 0 : (unsigned)pack_id;
+    }
+
+    bool socket::impl::cancel_ack(unsigned ack_id)
+    {
+        std::lock_guard<std::mutex> guard(m_event_mutex);
+        return m_acks.erase(ack_id) > 0;
+    }
+
+    unsigned socket::impl::emit_prepared(prepared_packet::ptr const& pack, std::function<void (message::list const&)> const& ack, emit_priority priority)
+    {
+        if(m_client == NULL || !pack) return 0;
+        int pack_id = -1;
+        if(ack)
+        {
+            pack_id = s_global_event_id++;
+            std::lock_guard<std::mutex> guard(m_event_mutex);
+            m_acks[pack_id] = ack;
+        }
+        packet::lane send_lane = priority == emit_priority_bulk ? packet::lane_bulk : packet::lane_realtime;
+        if(!m_connected)
+        {
+            std::lock_guard<std::mutex> guard(m_packet_mutex);
+            m_packet_queue.push(queued_packet{packet(), pack, pack_id, send_lane});
+        }
+        else
+        {
+            flush_packet_queue();
+            send_prepared_frames(pack, pack_id, send_lane);
+        }
+        return pack_id < 0 ? 0 : (unsigned)pack_id;
     }
     
     void socket::impl::send_connect()
@@ -336,18 +451,7 @@ namespace sio
             m_connected = true;
             m_client->on_socket_opened(m_nsp);
 
-            while (true) {
-				m_packet_mutex.lock();
-				if(m_packet_queue.empty())
-				{
-					m_packet_mutex.unlock();
-					return;
-				}
-				sio::packet front_pack = std::move(m_packet_queue.front());
-                m_packet_queue.pop();
-				m_packet_mutex.unlock();
-				m_client->send(front_pack);
-            }
+            flush_packet_queue();
         }
     }
     
@@ -369,6 +473,7 @@ namespace sio
 				m_packet_queue.pop();
 			}
 		}
+        m_chunk_streams.clear();
         client->on_socket_closed(m_nsp);
         client->remove_socket(m_nsp);
     }
@@ -384,6 +489,7 @@ namespace sio
         if(m_connected)
         {
             m_connected = false;
+            m_chunk_streams.clear();
 			std::lock_guard<std::mutex> guard(m_packet_mutex);
             while (!m_packet_queue.empty()) {
                 m_packet_queue.pop();
@@ -426,22 +532,7 @@ namespace sio
             case packet::type_binary_event:
             {
                 LOG("Received Message type (Event)"<<std::endl);
-                const message::ptr ptr = p.get_message();
-                if(ptr->get_flag() == message::flag_array)
-                {
-                    const array_message* array_ptr = static_cast<const array_message*>(ptr.get());
-                    if(array_ptr->get_vector().size() >= 1&&array_ptr->get_vector()[0]->get_flag() == message::flag_string)
-                    {
-                        const string_message* name_ptr = static_cast<const string_message*>(array_ptr->get_vector()[0].get());
-                        message::list mlist;
-                        for(size_t i = 1;i<array_ptr->get_vector().size();++i)
-                        {
-                            mlist.push(array_ptr->get_vector()[i]);
-                        }
-                        this->on_socketio_event(p.get_nsp(), p.get_pack_id(),name_ptr->get_string(), std::move(mlist));
-                    }
-                }
-
+                this->on_socketio_event_array(p.get_nsp(), p.get_pack_id(), p.get_message());
                 break;
             }
                 // Ack
@@ -478,14 +569,172 @@ namespace sio
     {
         bool needAck = msgId >= 0;
         event ev = event_adapter::create_event(nsp,name, std::move(message),needAck);
-        event_listener func = this->get_bind_listener_locked(name);
-        if(func)func(ev);
+
+        //every listener receives the same parsed event
+        listener_vector listeners = this->get_bind_listeners_locked(name);
+        for(auto& listener : listeners)
+        {
+            if(listener.second)listener.second(ev);
+        }
         if(needAck)
         {
             this->ack(msgId, name, ev.get_ack_message());
         }
     }
     
+    void socket::impl::on_socketio_event_array(const std::string& nsp, int msgId, message::ptr const& event_array)
+    {
+        if(!event_array || event_array->get_flag() != message::flag_array)
+        {
+            return;
+        }
+        const array_message* array_ptr = static_cast<const array_message*>(event_array.get());
+        if(array_ptr->get_vector().size() >= 1&&array_ptr->get_vector()[0]->get_flag() == message::flag_string)
+        {
+            const string_message* name_ptr = static_cast<const string_message*>(array_ptr->get_vector()[0].get());
+            message::list mlist;
+            for(size_t i = 1;i<array_ptr->get_vector().size();++i)
+            {
+                mlist.push(array_ptr->get_vector()[i]);
+            }
+            if(name_ptr->get_string() == socket::batch_event_name())
+            {
+                this->on_socketio_batch(nsp, msgId, mlist);
+            }
+            else if(name_ptr->get_string() == socket::chunk_event_name())
+            {
+                this->on_socketio_chunk(nsp, msgId, mlist);
+            }
+            else
+            {
+                this->on_socketio_event(nsp, msgId,name_ptr->get_string(), std::move(mlist));
+            }
+        }
+    }
+
+    void socket::impl::on_socketio_batch(const std::string& nsp, int msgId, message::list const& batch)
+    {
+        if(batch.size() > 0 && batch[0] && batch[0]->get_flag() == message::flag_array)
+        {
+            for(message::ptr const& entry : batch[0]->get_vector())
+            {
+                if(!entry || entry->get_flag() != message::flag_array)
+                {
+                    continue;
+                }
+                const std::vector<message::ptr>& tuple = entry->get_vector();
+                if(tuple.empty() || !tuple[0] || tuple[0]->get_flag() != message::flag_string)
+                {
+                    continue;
+                }
+                message::list args;
+                if(tuple.size() > 1 && tuple[1])
+                {
+                    if(tuple[1]->get_flag() == message::flag_array)
+                    {
+                        for(message::ptr const& arg : tuple[1]->get_vector())
+                        {
+                            args.push(arg);
+                        }
+                    }
+                    else
+                    {
+                        args.push(tuple[1]);
+                    }
+                }
+                //batched events never carry their own ack id
+                this->on_socketio_event(nsp, -1, tuple[0]->get_string(), std::move(args));
+            }
+        }
+        if(msgId >= 0)
+        {
+            this->ack(msgId, socket::batch_event_name(), message::list());
+        }
+    }
+    
+    void socket::impl::on_socketio_chunk(const std::string& nsp, int msgId, message::list const& chunk)
+    {
+        if(chunk.size() < 2 || !chunk[0] || chunk[0]->get_flag() != message::flag_object || !chunk[1] || chunk[1]->get_flag() != message::flag_binary)
+        {
+            return;
+        }
+        const std::map<std::string, message::ptr>& header = chunk[0]->get_map();
+        auto field = [&header](const char* key) -> int64_t
+        {
+            auto it = header.find(key);
+            return (it != header.end() && it->second && it->second->get_flag() == message::flag_integer) ? it->second->get_int() : -1;
+        };
+        const int64_t id = field("id");
+        const int64_t index = field("index");
+        const int64_t count = field("count");
+        if(id < 0 || index < 0 || count <= index)
+        {
+            return;
+        }
+
+        if(index == 0)
+        {
+            chunk_stream& started = m_chunk_streams[id];
+            started = chunk_stream();
+            started.count = (size_t)count;
+            auto sizes = header.find("sizes");
+            if(sizes != header.end() && sizes->second && sizes->second->get_flag() == message::flag_array)
+            {
+                for(message::ptr const& size : sizes->second->get_vector())
+                {
+                    started.sizes.push_back(size && size->get_flag() == message::flag_integer ? (size_t)size->get_int() : 0);
+                }
+            }
+        }
+        auto stream_it = m_chunk_streams.find(id);
+        if(stream_it == m_chunk_streams.end())
+        {
+            return;
+        }
+        chunk_stream& stream = stream_it->second;
+        if((size_t)index != stream.received || (size_t)count != stream.count)
+        {
+            //missed a piece, the stream can't be completed
+            m_chunk_streams.erase(stream_it);
+            return;
+        }
+        stream.bytes.append(*chunk[1]->get_binary());
+        if(++stream.received < stream.count)
+        {
+            return;
+        }
+
+        //split back into the socket.io frames and parse them like a received packet
+        chunk_stream completed = std::move(stream);
+        m_chunk_streams.erase(stream_it);
+        if(completed.sizes.empty())
+        {
+            return;
+        }
+        packet inner;
+        size_t offset = 0;
+        for(size_t i = 0; i < completed.sizes.size(); ++i)
+        {
+            if(offset + completed.sizes[i] > completed.bytes.size())
+            {
+                return;
+            }
+            if(i == 0)
+            {
+                std::string text(1, (char)('0' + packet::frame_message));
+                text.append(completed.bytes, offset, completed.sizes[i]);
+                inner.parse(text);
+            }
+            else
+            {
+                inner.parse_buffer(completed.bytes.substr(offset, completed.sizes[i]));
+            }
+            offset += completed.sizes[i];
+        }
+        //the ack id is the last chunk's, not the one encoded in the inner packet
+        this->on_socketio_event_array(nsp, msgId, inner.get_message());
+    }
+
     void socket::impl::ack(int msgId, const string &, const message::list &ack_message)
     {
         packet p(m_nsp, ack_message.to_array_message(),msgId,true);
@@ -530,28 +779,52 @@ namespace sio
         NULL_GUARD(m_client);
         if(m_connected)
         {
-            while (true) {
-				m_packet_mutex.lock();
-				if(m_packet_queue.empty())
-				{
-					m_packet_mutex.unlock();
-					break;
-				}
-				sio::packet front_pack = std::move(m_packet_queue.front());
-                m_packet_queue.pop();
-				m_packet_mutex.unlock();
-				m_client->send(front_pack);
-            }
+            flush_packet_queue();
             m_client->send(p);
         }
         else
         {
 			std::lock_guard<std::mutex> guard(m_packet_mutex);
-            m_packet_queue.push(p);
+            m_packet_queue.push(queued_packet{p, nullptr, -1, p.get_lane()});
+        }
+    }
+    
+    void socket::impl::flush_packet_queue()
+    {
+        while (true) {
+			m_packet_mutex.lock();
+			if(m_packet_queue.empty())
+			{
+				m_packet_mutex.unlock();
+				break;
+			}
+			queued_packet front = std::move(m_packet_queue.front());
+            m_packet_queue.pop();
+			m_packet_mutex.unlock();
+			if(front.prepared)
+			{
+				send_prepared_frames(front.prepared, front.prepared_id, front.lane);
+			}
+			else
+			{
+				m_client->send(front.pack);
+			}
+        }
+    }
+
+    void socket::impl::send_prepared_frames(prepared_packet::ptr const& pack, int pack_id, packet::lane send_lane)
+    {
+        std::vector<std::pair<bool, std::shared_ptr<const std::string> > > frames;
+        frames.reserve(1 + pack->get_attachments().size());
+        frames.push_back(std::make_pair(false, pack->get_text_frame(m_nsp, pack_id)));
+        for(auto const& attachment : pack->get_attachments())
+        {
+            frames.push_back(std::make_pair(true, attachment));
         }
+        m_client->send_frames(frames, m_nsp, pack_id, send_lane);
     }
     
-    socket::event_listener socket::impl::get_bind_listener_locked(const string &event)
+    socket::impl::listener_vector socket::impl::get_bind_listeners_locked(const string &event)
     {
         std::lock_guard<std::mutex> guard(m_event_mutex);
         auto it = m_event_binding.find(event);
@@ -559,7 +832,7 @@ namespace sio
         {
             return it->second;
         }
-        return socket::event_listener();
+        return listener_vector();
     }
     
     socket::socket(client_impl_base* client,std::string const& nsp,message::ptr const& auth):
@@ -586,6 +859,21 @@ namespace sio
     {
         m_impl->off(event_name);
     }
+
+    unsigned socket::add_listener(std::string const& event_name, event_listener const& func)
+    {
+        return m_impl->add_listener(event_name, func);
+    }
+
+    unsigned socket::add_listener(std::string const& event_name, event_listener_aux const& func)
+    {
+        return m_impl->add_listener(event_name, event_adapter::do_adapt(func));
+    }
+
+    void socket::remove_listener(std::string const& event_name, unsigned listener_id)
+    {
+        m_impl->remove_listener(event_name, listener_id);
+    }
     
     void socket::off_all()
     {
@@ -607,9 +895,79 @@ namespace sio
         m_impl->off_error();
     }
 
-    void socket::emit(std::string const& name, message::list const& msglist, std::function<void (message::list const&)> const& ack)
+    unsigned socket::emit(std::string const& name, message::list const& msglist, std::function<void (message::list const&)> const& ack, emit_priority priority)
     {
-        m_impl->emit(name, msglist,ack);
+        return m_impl->emit(name, msglist,ack,priority);
+    }
+
+    bool socket::cancel_ack(unsigned ack_id)
+    {
+        return m_impl->cancel_ack(ack_id);
+    }
+
+    void socket::emit_prepared(prepared_packet::ptr const& pack, emit_priority priority)
+    {
+        m_impl->emit_prepared(pack, nullptr, priority);
+    }
+
+    unsigned socket::emit_prepared(prepared_packet::ptr const& pack, std::function<void (message::list const&)> const& ack, emit_priority priority)
+    {
+        return m_impl->emit_prepared(pack, ack, priority);
+    }
+
+    prepared_packet::prepared_packet(std::string const& name, message::list const& msglist):
+        m_name(name),
+        m_message(msglist.to_array_message(name))
+    {
+        m_body = packet::encode_event_body(m_message, m_attachments);
+    }
+
+    prepared_packet::prepared_packet(std::string const& name, std::string&& body, std::vector<std::shared_ptr<const std::string> >&& attachments):
+        m_name(name),
+        m_body(std::move(body)),
+        m_attachments(std::move(attachments))
+    {
+    }
+
+    prepared_packet::ptr prepared_packet::create(std::string const& name, message::list const& msglist)
+    {
+        return ptr(new prepared_packet(name, msglist));
+    }
+
+    prepared_packet::ptr prepared_packet::create_encoded(std::string const& name, std::string&& body, std::vector<std::shared_ptr<const std::string> >&& attachments)
+    {
+        return ptr(new prepared_packet(name, std::move(body), std::move(attachments)));
+    }
+
+    std::shared_ptr<const std::string> prepared_packet::get_text_frame(std::string const& nsp, int pack_id) const
+    {
+        if(pack_id >= 0)
+        {
+            //ack ids are unique per send
+            std::shared_ptr<std::string> frame = std::make_shared<std::string>(packet::event_header(nsp, m_attachments.size(), pack_id));
+            frame->append(m_body);
+            return frame;
+        }
+        std::lock_guard<std::mutex> guard(m_frame_mutex);
+        auto it = m_frames.find(nsp);
+        if(it != m_frames.end())
+        {
+            return it->second;
+        }
+        std::shared_ptr<std::string> frame = std::make_shared<std::string>(packet::event_header(nsp, m_attachments.size()));
+        frame->append(m_body);
+        m_frames[nsp] = frame;
+        return frame;
+    }
+
+    size_t prepared_packet::get_encoded_size() const
+    {
+        size_t size = m_body.size();
+        for(auto const& attachment : m_attachments)
+        {
+            size += attachment ? attachment->size() : 0;
+        }
+        return size;
     }
     
     std::string const& socket::get_namespace() const
@@ -74,6 +74,10 @@ namespace sio
 
         void set_reconnect_delay_max(unsigned millis);
 
+        //Bulk emits: packets above chunk_size are sent as '__chunk' packets of at most chunk_size bytes,
+        //and bulk data is only handed to the socket while fewer than send_window bytes are waiting to be written.
+        void set_bulk_send_limits(size_t chunk_size, size_t send_window);
+
         void set_path(const std::string& path);
 
         void set_logs_default();
@@ -89,7 +93,7 @@ namespace sio
         
         void sync_close();
 
-        // stop io_service
+        // Drops the connection without the close handshake, a pending sync_close returns right away
         void stop();
         
         bool opened() const;
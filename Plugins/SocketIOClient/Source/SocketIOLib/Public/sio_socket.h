@@ -5,6 +5,7 @@
 #include "sio_message.h"
 #include "SocketIOLib.h"
 #include <functional>
+#include <mutex>
 namespace sio
 {
     class event_adapter;
@@ -44,6 +45,102 @@ namespace sio
     
     class client_impl_base;
     class packet;
+
+    //An event encoded once for any number of sockets, namespaces or repeated sends. The JSON body
+    //and binary attachments are immutable shared buffers, each namespace's header is added once
+    //and the resulting frame is shared too. Only emits without an ack share the cached frame.
+    class SOCKETIOLIB_API prepared_packet
+    {
+    public:
+        typedef std::shared_ptr<const prepared_packet> ptr;
+
+        static ptr create(std::string const& name, message::list const& msglist = nullptr);
+
+        //Wraps an event array body encoded elsewhere, e.g. by a typed writer. body must be the
+        //"[\"name\",...]" JSON text with attachment placeholders numbered in attachments order.
+        static ptr create_encoded(std::string const& name, std::string&& body, std::vector<std::shared_ptr<const std::string> >&& attachments);
+
+        std::string const& get_name() const { return m_name; }
+
+        //Original array message, null for packets made with create_encoded
+        message::ptr const& get_message() const { return m_message; }
+
+        //Text frame of the event for the namespace, frames with an ack id (pack_id >= 0) are not cached
+        std::shared_ptr<const std::string> get_text_frame(std::string const& nsp, int pack_id = -1) const;
+
+        std::vector<std::shared_ptr<const std::string> > const& get_attachments() const { return m_attachments; }
+
+        //Body plus attachment bytes
+        size_t get_encoded_size() const;
+
+    private:
+        prepared_packet(std::string const& name, message::list const& msglist);
+
+        prepared_packet(std::string const& name, std::string&& body, std::vector<std::shared_ptr<const std::string> >&& attachments);
+
+        std::string m_name;
+        message::ptr m_message;
+        std::string m_body;
+        std::vector<std::shared_ptr<const std::string> > m_attachments;
+
+        mutable std::mutex m_frame_mutex;
+        mutable std::map<std::string, std::shared_ptr<const std::string> > m_frames;
+    };
+    
+    //Writes an event array straight to JSON text, no message nodes are built. Calls must form
+    //valid JSON: begin_event, the arguments, then finish once. Not thread safe.
+    class SOCKETIOLIB_API event_writer
+    {
+    public:
+        event_writer();
+        ~event_writer();
+
+        //Opens the array with the event name already escaped and quoted, see quote()
+        void begin_event(std::string const& quoted_name);
+
+        void null_value();
+
+        void bool_value(bool value);
+
+        void int_value(int64_t value);
+
+        void uint_value(uint64_t value);
+
+        //nan and inf are written as null
+        void double_value(double value);
+
+        void string_value(const char* utf8, size_t length);
+
+        void key(const char* utf8, size_t length);
+
+        void start_array();
+
+        void end_array();
+
+        void start_object();
+
+        void end_object();
+
+        //Binary attachment placeholder, bytes are sent as their own frame
+        void binary_value(std::shared_ptr<const std::string> const& bytes);
+
+        //Already encoded JSON value e.g. a whole object, copied as is
+        void raw_value(const char* json, size_t length);
+
+        //Closes the array and hands the body over, the writer is spent afterwards
+        prepared_packet::ptr finish(std::string const& name);
+
+        //JSON string literal of utf8, quotes included
+        static std::string quote(const char* utf8, size_t length);
+
+    private:
+        //disable copy constructor and assign operator.
+        event_writer(event_writer const&){}
+        void operator=(event_writer const&){}
+
+        class impl;
+        impl *m_impl;
+    };
     
     //The name 'socket' is taken from concept of official socket.io.
     class SOCKETIOLIB_API socket
@@ -56,6 +153,14 @@ namespace sio
         typedef std::function<void(message::ptr const& message)> error_listener;
         
         typedef std::shared_ptr<socket> ptr;
+
+        //Send lane used for an emit. Realtime packets are written ahead of any queued bulk packets,
+        //bulk packets are paced and large ones are sent as a stream of '__chunk' events.
+        enum emit_priority
+        {
+            emit_priority_realtime,
+            emit_priority_bulk
+        };
         
         ~socket();
         
@@ -64,6 +169,14 @@ namespace sio
         void on(std::string const& event_name,event_listener_aux const& func);
         
         void off(std::string const& event_name);
+
+        //Additional listeners run after the one set with on(), all share the same decoded event.
+        //Returns an id for remove_listener. off() removes every listener of the event.
+        unsigned add_listener(std::string const& event_name, event_listener const& func);
+
+        unsigned add_listener(std::string const& event_name, event_listener_aux const& func);
+
+        void remove_listener(std::string const& event_name, unsigned listener_id);
         
         void off_all();
         
@@ -73,11 +186,29 @@ namespace sio
         
         void off_error();
 
-        void emit(std::string const& name, message::list const& msglist = nullptr, std::function<void (message::list const&)> const& ack = nullptr);
+        //Returns the ack id when an ack callback is given, 0 otherwise
+        unsigned emit(std::string const& name, message::list const& msglist = nullptr, std::function<void (message::list const&)> const& ack = nullptr, emit_priority priority = emit_priority_realtime);
+
+        //Drops a pending ack callback, a late ack for it is ignored. Returns false if it already ran.
+        bool cancel_ack(unsigned ack_id);
+
+        //Sends a prepared event without encoding it again
+        void emit_prepared(prepared_packet::ptr const& pack, emit_priority priority = emit_priority_realtime);
+
+        //emit_prepared with an ack callback, returns the ack id
+        unsigned emit_prepared(prepared_packet::ptr const& pack, std::function<void (message::list const&)> const& ack, emit_priority priority = emit_priority_realtime);
         
         std::string const& get_namespace() const;
 
         std::string const& get_socket_id() const;
+
+        //Reserved event carrying one array of [name, [args...]] tuples. Received batches are
+        //unpacked and each tuple is dispatched to its own listener.
+        static const char* batch_event_name() { return "__batch"; }
+
+        //Reserved event carrying one piece of a large bulk packet, see client::set_bulk_send_limits.
+        //Received chunk streams are reassembled and dispatched as the original event.
+        static const char* chunk_event_name() { return "__chunk"; }
         
         socket(client_impl_base*,std::string const&,message::ptr const&);
 
@@ -3,6 +3,7 @@
 
 #include "ControlledCharacter.h"
 #include <Kismet/GameplayStatics.h>
+#include "GameFramework/CharacterMovementComponent.h"
 
 // Sets default values
 AControlledCharacter::AControlledCharacter()
@@ -47,3 +48,51 @@ void AControlledCharacter::RotateCharacter(float Value)
 	AddControllerYawInput(Value);
 }
 
+void AControlledCharacter::SimulateCommand(const FInputCommand& Command, float DeltaTime, bool bReplay)
+{
+	FPredictedState State = GetPredictedState();
+	State.Yaw = FRotator::NormalizeAxis(State.Yaw + Command.Yaw);
+	SetPredictedState(State);
+
+	// Yaw only, so movement stays on the ground plane
+	const FRotationMatrix YawMatrix(FRotator(0.f, State.Yaw, 0.f));
+	const FVector Direction = (YawMatrix.GetUnitAxis(EAxis::X) * Command.GetForward() + YawMatrix.GetUnitAxis(EAxis::Y) * Command.GetRight()).GetClampedToMaxSize(1.f);
+	const FVector Delta = Direction * GetCharacterMovement()->MaxWalkSpeed * DeltaTime;
+	if (!Delta.IsNearlyZero())
+	{
+		FHitResult Hit;
+		GetCharacterMovement()->SafeMoveUpdatedComponent(Delta, GetActorQuat(), true, Hit);
+		if (Hit.IsValidBlockingHit())
+		{
+			GetCharacterMovement()->SlideAlongSurface(Delta, 1.f - Hit.Time, Hit.Normal, Hit, false);
+		}
+	}
+
+	if (Command.bJump && !bReplay)
+	{
+		Jump();
+	}
+}
+
+FPredictedState AControlledCharacter::GetPredictedState() const
+{
+	FPredictedState State;
+	State.Location = GetActorLocation();
+	State.Yaw = GetActorRotation().Yaw;
+	return State;
+}
+
+void AControlledCharacter::SetPredictedState(const FPredictedState& State)
+{
+	FRotator Rotation = GetActorRotation();
+	Rotation.Yaw = State.Yaw;
+	SetActorLocationAndRotation(State.Location, Rotation, false, nullptr, ETeleportType::TeleportPhysics);
+
+	// The control rotation drives the actor yaw, keep them together
+	if (Controller)
+	{
+		FRotator ControlRotation = Controller->GetControlRotation();
+		ControlRotation.Yaw = State.Yaw;
+		Controller->SetControlRotation(ControlRotation);
+	}
+}
@@ -4,6 +4,7 @@
 
 #include "CoreMinimal.h"
 #include "GameFramework/Character.h"
+#include "InputCommand.h"
 #include "ControlledCharacter.generated.h"
 
 UCLASS()
@@ -28,4 +29,11 @@ public:
 	void JumpCharacter();
 	void RotateCharacter(float Value);
 
+	// Applies one fixed tick of input, the same movement the server simulates.
+	// Replayed commands don't jump again, vertical motion stays with the movement component.
+	void SimulateCommand(const FInputCommand& Command, float DeltaTime, bool bReplay);
+
+	FPredictedState GetPredictedState() const;
+	void SetPredictedState(const FPredictedState& State);
+
 };
@@ -3,6 +3,81 @@
 
 #include "CustomPlayerController.h"
 #include "ControlledCharacter.h"
+#include "SocketIOClientComponent.h"
+
+ACustomPlayerController::ACustomPlayerController()
+{
+	CommandRate = 60;
+	CommandsPerPacket = 3;
+	RedundantCommands = 9;
+	RotateScale = 2.5f;
+	CorrectionTolerance = 2.f;
+	InputEventName = TEXT("input");
+	StateEventName = TEXT("state");
+
+	NextSequence = 1;
+	AckedSequence = 0;
+	CommandTimeAccumulator = 0.f;
+	CommandsSinceSend = 0;
+
+	ForwardSum = 0.f;
+	RightSum = 0.f;
+	SampledFrames = 0;
+	YawSum = 0.f;
+	bJumpPressed = false;
+	LastForward = 0;
+	LastRight = 0;
+
+	SocketClient = nullptr;
+	StateListenerId = 0;
+}
+
+void ACustomPlayerController::BeginPlay()
+{
+	Super::BeginPlay();
+
+	PacketBuffer.Reserve(6 + 32 * FInputCommand::PackedSize);
+
+	SocketClient = FindComponentByClass<USocketIOClientComponent>();
+	if (SocketClient && IsLocalController())
+	{
+		TWeakObjectPtr<ACustomPlayerController> WeakThis(this);
+		StateListenerId = SocketClient->AddNativeEventListener(StateEventName, [WeakThis](const FString& Event, const TSharedPtr<FJsonValue>& Message)
+		{
+			if (WeakThis.IsValid())
+			{
+				WeakThis->OnServerState(Message);
+			}
+		});
+	}
+}
+
+void ACustomPlayerController::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	if (SocketClient && StateListenerId != 0)
+	{
+		SocketClient->RemoveNativeEventListener(StateListenerId);
+		StateListenerId = 0;
+	}
+	Super::EndPlay(EndPlayReason);
+}
+
+void ACustomPlayerController::PlayerTick(float DeltaTime)
+{
+	// Processes input, the axis bindings add to the sums
+	Super::PlayerTick(DeltaTime);
+	SampledFrames++;
+
+	const float CommandDeltaTime = 1.f / FMath::Clamp(CommandRate, 1, 255);
+
+	// Don't try to catch up after a long hitch
+	CommandTimeAccumulator = FMath::Min(CommandTimeAccumulator + DeltaTime, CommandDeltaTime * 8.f);
+	while (CommandTimeAccumulator >= CommandDeltaTime)
+	{
+		CommandTimeAccumulator -= CommandDeltaTime;
+		TickCommand(CommandDeltaTime);
+	}
+}
 
 void ACustomPlayerController::SetupInputComponent()
 {
@@ -17,36 +92,152 @@ void ACustomPlayerController::SetupInputComponent()
 
 void ACustomPlayerController::CharacterMoveForward(float Value)
 {
-	AControlledCharacter* cc = Cast<AControlledCharacter>(GetPawn());
-	if (cc)
-	{
-		cc->MoveForwardCharacter(Value);
-	}
+	ForwardSum += Value;
 }
 
 void ACustomPlayerController::CharacterMoveRight(float Value)
 {
+	RightSum += Value;
+}
+
+void ACustomPlayerController::CharacterJump()
+{
+	bJumpPressed = true;
+}
+
+void ACustomPlayerController::CharacterRotate(float Value)
+{
+	YawSum += Value * RotateScale;
+}
+
+void ACustomPlayerController::TickCommand(float CommandDeltaTime)
+{
+	// Averaged over the frames since the last command, held if there were none
+	if (SampledFrames > 0)
+	{
+		LastForward = FInputCommand::QuantizeAxis(ForwardSum / SampledFrames);
+		LastRight = FInputCommand::QuantizeAxis(RightSum / SampledFrames);
+	}
+
+	FInputCommand& Command = Commands[NextSequence];
+	Command.Sequence = NextSequence;
+	Command.Forward = LastForward;
+	Command.Right = LastRight;
+	Command.Yaw = YawSum;
+	Command.bJump = bJumpPressed;
+	Command.DeltaTime = CommandDeltaTime;
+
+	ForwardSum = 0.f;
+	RightSum = 0.f;
+	SampledFrames = 0;
+	YawSum = 0.f;
+	bJumpPressed = false;
+
 	AControlledCharacter* cc = Cast<AControlledCharacter>(GetPawn());
-	if (cc)
+	if (!cc)
 	{
-		cc->MoveRightCharacter(Value);
+		return;
+	}
+
+	cc->SimulateCommand(Command, CommandDeltaTime, false);
+	PredictedStates[NextSequence] = cc->GetPredictedState();
+	NextSequence++;
+
+	if (++CommandsSinceSend >= CommandsPerPacket)
+	{
+		CommandsSinceSend = 0;
+		SendCommands();
 	}
 }
 
-void ACustomPlayerController::CharacterJump()
+void ACustomPlayerController::SendCommands()
 {
-	AControlledCharacter* cc = Cast<AControlledCharacter>(GetPawn());
-	if (cc)
+	static_assert(PLATFORM_LITTLE_ENDIAN, "Input packets are written in memory order");
+
+	if (!SocketClient || !SocketClient->bIsConnected)
 	{
-		cc->JumpCharacter();
+		return;
 	}
+
+	// Acked commands are not resent
+	const uint32 Newest = NextSequence - 1;
+	const uint32 Count = FMath::Min3((uint32)FMath::Clamp(RedundantCommands, 1, 32), Newest - AckedSequence, CommandCapacity);
+	if (Count == 0)
+	{
+		return;
+	}
+
+	PacketBuffer.Reset();
+	PacketBuffer.AddUninitialized(6 + Count * FInputCommand::PackedSize);
+
+	uint8* Out = PacketBuffer.GetData();
+	FMemory::Memcpy(Out, &Newest, sizeof(uint32));
+	Out[4] = (uint8)Count;
+	Out[5] = (uint8)FMath::Clamp(CommandRate, 1, 255);
+	Out += 6;
+
+	for (uint32 i = 0; i < Count; i++)
+	{
+		const FInputCommand& Command = Commands[Newest - i];
+		Out[0] = (uint8)Command.Forward;
+		Out[1] = (uint8)Command.Right;
+		FMemory::Memcpy(Out + 2, &Command.Yaw, sizeof(float));
+		Out[6] = Command.bJump ? 1 : 0;
+		Out += FInputCommand::PackedSize;
+	}
+
+	SocketClient->EmitNative(InputEventName, PacketBuffer);
 }
 
-void ACustomPlayerController::CharacterRotate(float Value)
+void ACustomPlayerController::OnServerState(const TSharedPtr<FJsonValue>& Message)
 {
+	const TSharedPtr<FJsonObject>* State;
+	const TSharedPtr<FJsonObject>* Location;
+	double Ack, X, Y, Yaw;
+	if (!Message.IsValid() || !Message->TryGetObject(State) ||
+		!(*State)->TryGetNumberField(TEXT("ack"), Ack) ||
+		!(*State)->TryGetObjectField(TEXT("location"), Location) ||
+		!(*Location)->TryGetNumberField(TEXT("x"), X) ||
+		!(*Location)->TryGetNumberField(TEXT("y"), Y) ||
+		!(*State)->TryGetNumberField(TEXT("yaw"), Yaw))
+	{
+		return;
+	}
+
+	// Ignore stale acks and acks for commands that are no longer kept
+	const uint32 Sequence = (uint32)Ack;
+	if (Sequence <= AckedSequence || Sequence >= NextSequence || NextSequence - Sequence > CommandCapacity)
+	{
+		return;
+	}
+	AckedSequence = Sequence;
+
 	AControlledCharacter* cc = Cast<AControlledCharacter>(GetPawn());
-	if (cc)
+	if (!cc)
+	{
+		return;
+	}
+
+	const FPredictedState& Predicted = PredictedStates[Sequence];
+	const float LocationError = FVector2D::Distance(FVector2D(Predicted.Location), FVector2D(X, Y));
+	const float YawError = FMath::Abs(FRotator::NormalizeAxis(Predicted.Yaw - (float)Yaw));
+	if (LocationError <= CorrectionTolerance && YawError <= CorrectionTolerance)
+	{
+		return;
+	}
+
+	// Rewind to the server state, the height stays with the movement component
+	FPredictedState Rewound = cc->GetPredictedState();
+	Rewound.Location.X = X;
+	Rewound.Location.Y = Y;
+	Rewound.Yaw = (float)Yaw;
+	cc->SetPredictedState(Rewound);
+
+	// Replay what the server hasn't seen yet
+	for (uint32 Replayed = Sequence + 1; Replayed < NextSequence; Replayed++)
 	{
-		cc->RotateCharacter(Value);
+		const FInputCommand& Command = Commands[Replayed];
+		cc->SimulateCommand(Command, Command.DeltaTime, true);
+		PredictedStates[Replayed] = cc->GetPredictedState();
 	}
 }
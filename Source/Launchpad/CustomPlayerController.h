@@ -4,21 +4,98 @@
 
 #include "CoreMinimal.h"
 #include "GameFramework/PlayerController.h"
+#include "Dom/JsonValue.h"
+#include "InputCommand.h"
 #include "CustomPlayerController.generated.h"
 
+class USocketIOClientComponent;
+
 /**
- * 
+ * Samples input into fixed tick commands, applies them to the pawn right away (prediction) and
+ * sends them over the socket.io client component of this controller, if it has one. Each packet
+ * repeats the last RedundantCommands commands so a lost packet costs nothing. When the server
+ * answers with its state for a command, the pawn is put there and the newer commands are replayed.
+ *
+ * Input packet (binary, little endian): uint32 newest sequence, uint8 command count, uint8 command
+ * rate in Hz, then newest first per command int8 forward, int8 right (both / 127), float yaw
+ * degrees, uint8 buttons (1 = jump). The server moves the pawn by
+ * yaw += Yaw; location += clamp(forward * Forward + right * Right, 1) * MaxWalkSpeed / rate.
+ *
+ * State event: { "ack": sequence, "location": { "x", "y" }, "yaw" }
  */
 UCLASS()
 class LAUNCHPAD_API ACustomPlayerController : public APlayerController
 {
 	GENERATED_BODY()
 
+public:
+	ACustomPlayerController();
+
+	/** Commands per second */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Input Prediction", meta = (ClampMin = "1", ClampMax = "255"))
+	int32 CommandRate;
+
+	/** Commands between input packets */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Input Prediction", meta = (ClampMin = "1"))
+	int32 CommandsPerPacket;
+
+	/** Commands in each packet, newest first. More than CommandsPerPacket covers lost packets. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Input Prediction", meta = (ClampMin = "1", ClampMax = "32"))
+	int32 RedundantCommands;
+
+	/** Yaw degrees per unit of Rotate input */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Input Prediction")
+	float RotateScale;
+
+	/** Server corrections smaller than this (cm, or degrees of yaw) are ignored */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Input Prediction")
+	float CorrectionTolerance;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Input Prediction")
+	FString InputEventName;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Input Prediction")
+	FString StateEventName;
+
 protected:
+	virtual void BeginPlay() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+	virtual void PlayerTick(float DeltaTime) override;
 	virtual void SetupInputComponent() override;
 	void CharacterMoveForward(float Value);
 	void CharacterMoveRight(float Value);
 	void CharacterJump();
 	void CharacterRotate(float Value);
-	
+
+	void TickCommand(float CommandDeltaTime);
+	void SendCommands();
+	void OnServerState(const TSharedPtr<FJsonValue>& Message);
+
+	// ~2 seconds of commands at 60 Hz
+	static constexpr uint32 CommandCapacity = 128;
+
+	TSequenceRing<FInputCommand, CommandCapacity> Commands;
+	TSequenceRing<FPredictedState, CommandCapacity> PredictedStates;
+	uint32 NextSequence;
+	uint32 AckedSequence;
+
+	float CommandTimeAccumulator;
+	int32 CommandsSinceSend;
+
+	// Input since the last command
+	float ForwardSum;
+	float RightSum;
+	int32 SampledFrames;
+	float YawSum;
+	bool bJumpPressed;
+	int8 LastForward;
+	int8 LastRight;
+
+	// Reused for every packet
+	TArray<uint8> PacketBuffer;
+
+	UPROPERTY()
+	TObjectPtr<USocketIOClientComponent> SocketClient;
+
+	uint32 StateListenerId;
 };
@@ -0,0 +1,58 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * Input of one fixed tick. Movement axes are quantized when sampled so the client
+ * predicts with exactly the values the server receives.
+ */
+struct FInputCommand
+{
+	uint32 Sequence = 0;
+	int8 Forward = 0;
+	int8 Right = 0;
+	// Degrees
+	float Yaw = 0.f;
+	bool bJump = false;
+	// Local only, the server knows the command rate from the packet header
+	float DeltaTime = 0.f;
+
+	// Forward, right, yaw (4 bytes), buttons
+	static constexpr int32 PackedSize = 7;
+
+	static int8 QuantizeAxis(float Value)
+	{
+		return (int8)FMath::RoundToInt(FMath::Clamp(Value, -1.f, 1.f) * 127.f);
+	}
+
+	float GetForward() const { return Forward / 127.f; }
+	float GetRight() const { return Right / 127.f; }
+};
+
+/** Predicted pawn state after a command was applied */
+struct FPredictedState
+{
+	FVector Location = FVector::ZeroVector;
+	float Yaw = 0.f;
+};
+
+/**
+ * Fixed size ring indexed by sequence number, the last Capacity sequences are kept.
+ * Storage is inline so writing a tick never allocates.
+ */
+template<typename ElementType, uint32 Capacity>
+class TSequenceRing
+{
+	static_assert(Capacity > 0 && (Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two");
+
+public:
+	static constexpr uint32 Num = Capacity;
+
+	ElementType& operator[](uint32 Sequence) { return Items[Sequence & (Capacity - 1)]; }
+	const ElementType& operator[](uint32 Sequence) const { return Items[Sequence & (Capacity - 1)]; }
+
+private:
+	ElementType Items[Capacity];
+};